@@ -0,0 +1,167 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbroadcast.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape1_type = std::array<std::size_t, 1>;
+            using shape2_type = std::array<std::size_t, 2>;
+
+            // a rows x cols matrix, a row and a column
+            struct broadcast_state
+            {
+                explicit broadcast_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols),
+                      m(shape2_type{rows, cols}), row(shape1_type{cols}),
+                      col(shape2_type{rows, 1}), res(shape2_type{rows, cols})
+                {
+                    for (std::size_t i = 0; i < m.size(); ++i)
+                    {
+                        m.data()[i] = 0.001 * static_cast<double>(i % 1000);
+                    }
+                    for (std::size_t j = 0; j < cols; ++j)
+                    {
+                        row(j) = static_cast<double>(j);
+                    }
+                    for (std::size_t i = 0; i < rows; ++i)
+                    {
+                        col(i, 0) = static_cast<double>(i);
+                    }
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                xtensor<double, 2> m;
+                xtensor<double, 1> row;
+                xtensor<double, 2> col;
+                xtensor<double, 2> res;
+            };
+
+            kernel row_expression(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    s.res = s.m + s.row;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel row_loop(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    const double* m = s.m.data().data();
+                    const double* row = s.row.data().data();
+                    double* res = s.res.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = m[i * s.cols + j] + row[j];
+                        }
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel column_expression(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    s.res = s.m * s.col;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel column_loop(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    const double* m = s.m.data().data();
+                    const double* col = s.col.data().data();
+                    double* res = s.res.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = m[i * s.cols + j] * col[i];
+                        }
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel explicit_expression(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    s.res = broadcast(s.row, {s.rows, s.cols}) - s.m;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel explicit_loop(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    const double* m = s.m.data().data();
+                    const double* row = s.row.data().data();
+                    double* res = s.res.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = row[j] - m[i * s.cols + j];
+                        }
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel scalar_expression(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    s.res = 2. * s.m + 1.;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel scalar_loop(std::size_t n)
+            {
+                return make_kernel(broadcast_state(n), [](broadcast_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.res.data().data();
+                    std::size_t size = s.m.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = 2. * m[i] + 1.;
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+        }
+
+        void register_xbroadcast(registry& reg)
+        {
+            reg.add("xbroadcast/row", "xtensor", 16, row_expression);
+            reg.add("xbroadcast/row", "loop", 16, row_loop);
+            reg.add("xbroadcast/column", "xtensor", 16, column_expression);
+            reg.add("xbroadcast/column", "loop", 16, column_loop);
+            reg.add("xbroadcast/explicit", "xtensor", 16, explicit_expression);
+            reg.add("xbroadcast/explicit", "loop", 16, explicit_loop);
+            reg.add("xbroadcast/scalar", "xtensor", 16, scalar_expression);
+            reg.add("xbroadcast/scalar", "loop", 16, scalar_loop);
+        }
+    }
+}
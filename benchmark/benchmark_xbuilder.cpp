@@ -0,0 +1,163 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape1_type = std::array<std::size_t, 1>;
+            using shape2_type = std::array<std::size_t, 2>;
+
+            struct vector_state
+            {
+                explicit vector_state(std::size_t n)
+                    : size(n), res(shape1_type{n})
+                {
+                }
+
+                std::size_t size;
+                xtensor<double, 1> res;
+            };
+
+            struct matrix_state
+            {
+                explicit matrix_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols), res(shape2_type{rows, cols})
+                {
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                xtensor<double, 2> res;
+            };
+
+            /**********
+             * arange *
+             **********/
+
+            kernel arange_expression(std::size_t n)
+            {
+                return make_kernel(vector_state(n), [](vector_state& s) {
+                    s.res = arange(0., static_cast<double>(s.size), 1.);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel arange_loop(std::size_t n)
+            {
+                return make_kernel(vector_state(n), [](vector_state& s) {
+                    double* res = s.res.data().data();
+                    for (std::size_t i = 0; i < s.size; ++i)
+                    {
+                        res[i] = static_cast<double>(i);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /************
+             * linspace *
+             ************/
+
+            kernel linspace_expression(std::size_t n)
+            {
+                return make_kernel(vector_state(n), [](vector_state& s) {
+                    s.res = linspace(0., 1., s.size);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel linspace_loop(std::size_t n)
+            {
+                return make_kernel(vector_state(n), [](vector_state& s) {
+                    double* res = s.res.data().data();
+                    double step = 1. / static_cast<double>(s.size - 1);
+                    for (std::size_t i = 0; i < s.size; ++i)
+                    {
+                        res[i] = static_cast<double>(i) * step;
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /********
+             * ones *
+             ********/
+
+            kernel ones_expression(std::size_t n)
+            {
+                return make_kernel(matrix_state(n), [](matrix_state& s) {
+                    s.res = ones<double>(shape2_type{s.rows, s.cols});
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel ones_loop(std::size_t n)
+            {
+                return make_kernel(matrix_state(n), [](matrix_state& s) {
+                    double* res = s.res.data().data();
+                    std::size_t size = s.res.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = 1.;
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /*******
+             * eye *
+             *******/
+
+            kernel eye_expression(std::size_t n)
+            {
+                return make_kernel(matrix_state(n), [](matrix_state& s) {
+                    s.res = eye<double>({s.rows, s.cols});
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel eye_loop(std::size_t n)
+            {
+                return make_kernel(matrix_state(n), [](matrix_state& s) {
+                    double* res = s.res.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = i == j ? 1. : 0.;
+                        }
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+        }
+
+        void register_xbuilder(registry& reg)
+        {
+            reg.add("xbuilder/arange", "xtensor", 8, arange_expression);
+            reg.add("xbuilder/arange", "loop", 8, arange_loop);
+            reg.add("xbuilder/linspace", "xtensor", 8, linspace_expression);
+            reg.add("xbuilder/linspace", "loop", 8, linspace_loop);
+            reg.add("xbuilder/ones", "xtensor", 8, ones_expression);
+            reg.add("xbuilder/ones", "loop", 8, ones_loop);
+            reg.add("xbuilder/eye", "xtensor", 8, eye_expression);
+            reg.add("xbuilder/eye", "loop", 8, eye_loop);
+        }
+    }
+}
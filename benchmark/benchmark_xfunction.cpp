@@ -0,0 +1,192 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <cmath>
+#include <cstddef>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            template <class E>
+            struct ternary_state
+            {
+                explicit ternary_state(std::size_t n)
+                    : x(typename E::shape_type({n})), y(typename E::shape_type({n})),
+                      z(typename E::shape_type({n})), res(typename E::shape_type({n}))
+                {
+                    using value_type = typename E::value_type;
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        value_type v = static_cast<value_type>(i % 1000);
+                        x(i) = 0.5 + 0.001 * v;
+                        y(i) = 0.25 * v;
+                        z(i) = 0.27 - 0.002 * v;
+                    }
+                }
+
+                E x;
+                E y;
+                E z;
+                E res;
+            };
+
+            using tensor_state = ternary_state<xtensor<double, 1>>;
+            using array_state = ternary_state<xarray<double>>;
+
+            constexpr double alpha = 2.7;
+
+            /********
+             * axpy *
+             ********/
+
+            template <class S>
+            kernel axpy_expression(std::size_t n)
+            {
+                return make_kernel(S(n), [](S& s) {
+                    s.res = alpha * s.x + s.y;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel axpy_iteration(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    auto iterx = s.x.cbegin();
+                    auto itery = s.y.cbegin();
+                    for (auto iter = s.res.begin(); iter != s.res.end(); ++iter, ++iterx, ++itery)
+                    {
+                        *iter = alpha * (*iterx) + (*itery);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel axpy_xiteration(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    auto iterx = s.x.xbegin();
+                    auto itery = s.y.xbegin();
+                    for (auto iter = s.res.xbegin(); iter != s.res.xend(); ++iter, ++iterx, ++itery)
+                    {
+                        *iter = alpha * (*iterx) + (*itery);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel axpy_indexing(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    std::size_t size = s.x.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        s.res(i) = alpha * s.x(i) + s.y(i);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel axpy_loop(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    const double* x = s.x.data().data();
+                    const double* y = s.y.data().data();
+                    double* res = s.res.data().data();
+                    std::size_t size = s.x.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = alpha * x[i] + y[i];
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /**************
+             * expression *
+             **************/
+
+            template <class S>
+            kernel expression_expression(std::size_t n)
+            {
+                return make_kernel(S(n), [](S& s) {
+                    s.res = 3. * s.x - 2. * s.y * s.z;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel expression_loop(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    const double* x = s.x.data().data();
+                    const double* y = s.y.data().data();
+                    const double* z = s.z.data().data();
+                    double* res = s.res.data().data();
+                    std::size_t size = s.x.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = 3. * x[i] - 2. * y[i] * z[i];
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /******************
+             * transcendental *
+             ******************/
+
+            kernel transcendental_expression(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    s.res = exp(s.x) + sin(s.y);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel transcendental_loop(std::size_t n)
+            {
+                return make_kernel(tensor_state(n), [](tensor_state& s) {
+                    const double* x = s.x.data().data();
+                    const double* y = s.y.data().data();
+                    double* res = s.res.data().data();
+                    std::size_t size = s.x.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = std::exp(x[i]) + std::sin(y[i]);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+        }
+
+        void register_xfunction(registry& reg)
+        {
+            reg.add("xfunction/axpy", "xtensor", 24, axpy_expression<tensor_state>);
+            reg.add("xfunction/axpy", "xarray", 24, axpy_expression<array_state>);
+            reg.add("xfunction/axpy", "xtensor_iteration", 24, axpy_iteration);
+            reg.add("xfunction/axpy", "xtensor_xiteration", 24, axpy_xiteration);
+            reg.add("xfunction/axpy", "xtensor_indexing", 24, axpy_indexing);
+            reg.add("xfunction/axpy", "loop", 24, axpy_loop);
+
+            reg.add("xfunction/expression", "xtensor", 32, expression_expression<tensor_state>);
+            reg.add("xfunction/expression", "xarray", 32, expression_expression<array_state>);
+            reg.add("xfunction/expression", "loop", 32, expression_loop);
+
+            reg.add("xfunction/transcendental", "xtensor", 24, transcendental_expression);
+            reg.add("xfunction/transcendental", "loop", 24, transcendental_loop);
+        }
+    }
+}
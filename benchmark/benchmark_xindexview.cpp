@@ -0,0 +1,159 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xindexview.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape1_type = std::array<std::size_t, 1>;
+            // where, on which filter relies, builds indices of dynamic
+            // length, that only an xarray can be indexed with.
+            using matrix_type = xarray<double>;
+            using shape2_type = matrix_type::shape_type;
+            using indices_type = std::vector<xindex>;
+
+            // a rows x cols matrix, a mask selecting one element out of four
+            // and the indices of a quarter of its elements
+            struct index_state
+            {
+                explicit index_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols), m(shape2_type{rows, cols}),
+                      mask(shape2_type{rows, cols}), res(shape1_type{n / 4})
+                {
+                    for (std::size_t i = 0; i < m.size(); ++i)
+                    {
+                        m.data()[i] = 0.001 * static_cast<double>(i % 1000);
+                        mask.data()[i] = (i * 7) % 4 == 0 ? 1. : 0.;
+                    }
+                    indices.reserve(n / 4);
+                    for (std::size_t k = 0; k < n / 4; ++k)
+                    {
+                        indices.push_back({(k * 4) / cols, (k * 7) % cols});
+                    }
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                matrix_type m;
+                matrix_type mask;
+                xtensor<double, 1> res;
+                indices_type indices;
+            };
+
+            /**********
+             * gather *
+             **********/
+
+            // The view is built once, so that the copy of the indices it
+            // holds is not measured.
+            struct gather_state : index_state
+            {
+                using view_type = decltype(index_view(std::declval<matrix_type&>(), std::declval<indices_type>()));
+
+                explicit gather_state(std::size_t n)
+                    : index_state(n), view(index_view(m, indices))
+                {
+                }
+
+                gather_state(const gather_state& rhs)
+                    : index_state(rhs), view(index_view(m, indices))
+                {
+                }
+
+                gather_state(gather_state&& rhs)
+                    : index_state(std::move(rhs)), view(index_view(m, indices))
+                {
+                }
+
+                view_type view;
+            };
+
+            kernel gather_expression(std::size_t n)
+            {
+                return make_kernel(gather_state(n), [](gather_state& s) {
+                    s.res = s.view + 1.;
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel gather_loop(std::size_t n)
+            {
+                return make_kernel(index_state(n), [](index_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.res.data().data();
+                    std::size_t size = s.indices.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        const xindex& idx = s.indices[i];
+                        res[i] = m[idx[0] * s.cols + idx[1]] + 1.;
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /**********
+             * filter *
+             **********/
+
+            kernel filter_expression(std::size_t n)
+            {
+                return make_kernel(index_state(n), [](index_state& s) {
+                    filter(s.m, s.mask > 0.5) += 1.;
+                    do_not_optimize(s.m);
+                });
+            }
+
+            kernel filtration_expression(std::size_t n)
+            {
+                return make_kernel(index_state(n), [](index_state& s) {
+                    filtration(s.m, s.mask > 0.5) += 1.;
+                    do_not_optimize(s.m);
+                });
+            }
+
+            kernel filter_loop(std::size_t n)
+            {
+                return make_kernel(index_state(n), [](index_state& s) {
+                    const double* mask = s.mask.data().data();
+                    double* m = s.m.data().data();
+                    std::size_t size = s.m.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        if (mask[i] > 0.5)
+                        {
+                            m[i] += 1.;
+                        }
+                    }
+                    do_not_optimize(s.m);
+                });
+            }
+        }
+
+        void register_xindexview(registry& reg)
+        {
+            reg.add("xindexview/gather", "xtensor", 8, gather_expression);
+            reg.add("xindexview/gather", "loop", 8, gather_loop);
+            reg.add("xindexview/filter", "xtensor", 12, filter_expression);
+            reg.add("xindexview/filter", "xtensor_filtration", 12, filtration_expression);
+            reg.add("xindexview/filter", "loop", 12, filter_loop);
+        }
+    }
+}
@@ -0,0 +1,236 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <ios>
+#include <sstream>
+#include <string>
+
+#include "xtensor/xbinary.hpp"
+#include "xtensor/xcsv.hpp"
+#include "xtensor/xnpy.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape2_type = std::array<std::size_t, 2>;
+
+            // The files are read from and written to in-memory streams, so
+            // that the cost of the formats is measured rather than the one
+            // of the file system.
+            struct io_state
+            {
+                explicit io_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols), m(shape2_type{rows, cols}), res(shape2_type{rows, cols})
+                {
+                    for (std::size_t i = 0; i < m.size(); ++i)
+                    {
+                        m.data()[i] = 0.001 * static_cast<double>(i % 1000);
+                    }
+                }
+
+                std::ostream& output()
+                {
+                    out.str(std::string());
+                    out.clear();
+                    return out;
+                }
+
+                std::istream& input()
+                {
+                    in.clear();
+                    in.seekg(0);
+                    return in;
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                xtensor<double, 2> m;
+                xtensor<double, 2> res;
+                std::ostringstream out;
+                std::istringstream in;
+            };
+
+            void write_raw(std::ostream& stream, const xtensor<double, 2>& m)
+            {
+                stream.write(reinterpret_cast<const char*>(m.data().data()),
+                             static_cast<std::streamsize>(m.size() * sizeof(double)));
+            }
+
+            void read_raw(std::istream& stream, xtensor<double, 2>& m)
+            {
+                stream.read(reinterpret_cast<char*>(m.data().data()),
+                            static_cast<std::streamsize>(m.size() * sizeof(double)));
+            }
+
+            struct npy_state : io_state
+            {
+                explicit npy_state(std::size_t n)
+                    : io_state(n)
+                {
+                    std::ostringstream buffer;
+                    dump_npy(buffer, m);
+                    in.str(buffer.str());
+                }
+            };
+
+            struct binary_state : io_state
+            {
+                explicit binary_state(std::size_t n)
+                    : io_state(n)
+                {
+                    std::ostringstream buffer;
+                    dump_binary(buffer, m);
+                    in.str(buffer.str());
+                }
+            };
+
+            struct raw_state : io_state
+            {
+                explicit raw_state(std::size_t n)
+                    : io_state(n)
+                {
+                    std::ostringstream buffer;
+                    write_raw(buffer, m);
+                    in.str(buffer.str());
+                }
+            };
+
+            struct csv_state : io_state
+            {
+                explicit csv_state(std::size_t n)
+                    : io_state(n)
+                {
+                    std::ostringstream buffer;
+                    for (std::size_t i = 0; i < rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < cols; ++j)
+                        {
+                            buffer << (j == 0 ? "" : ",") << m(i, j);
+                        }
+                        buffer << '\n';
+                    }
+                    in.str(buffer.str());
+                }
+            };
+
+            /*******
+             * npy *
+             *******/
+
+            kernel npy_write(std::size_t n)
+            {
+                return make_kernel(npy_state(n), [](npy_state& s) {
+                    dump_npy(s.output(), s.m);
+                    do_not_optimize(s.out);
+                });
+            }
+
+            kernel npy_read(std::size_t n)
+            {
+                return make_kernel(npy_state(n), [](npy_state& s) {
+                    load_npy(s.input(), s.res);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /**********
+             * binary *
+             **********/
+
+            kernel binary_write(std::size_t n)
+            {
+                return make_kernel(binary_state(n), [](binary_state& s) {
+                    dump_binary(s.output(), s.m);
+                    do_not_optimize(s.out);
+                });
+            }
+
+            kernel binary_read(std::size_t n)
+            {
+                return make_kernel(binary_state(n), [](binary_state& s) {
+                    auto res = load_binary<double>(s.input());
+                    do_not_optimize(res);
+                });
+            }
+
+            /*******
+             * raw *
+             *******/
+
+            kernel raw_write(std::size_t n)
+            {
+                return make_kernel(raw_state(n), [](raw_state& s) {
+                    write_raw(s.output(), s.m);
+                    do_not_optimize(s.out);
+                });
+            }
+
+            kernel raw_read(std::size_t n)
+            {
+                return make_kernel(raw_state(n), [](raw_state& s) {
+                    read_raw(s.input(), s.res);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /*******
+             * csv *
+             *******/
+
+            kernel csv_read(std::size_t n)
+            {
+                return make_kernel(csv_state(n), [](csv_state& s) {
+                    load_csv(s.input(), s.res);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel csv_read_loop(std::size_t n)
+            {
+                return make_kernel(csv_state(n), [](csv_state& s) {
+                    std::ostringstream buffer;
+                    buffer << s.input().rdbuf();
+                    std::string text = buffer.str();
+                    const char* first = text.c_str();
+                    char* last = nullptr;
+                    double* res = s.res.data().data();
+                    std::size_t size = s.res.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = std::strtod(first, &last);
+                        first = last + 1;
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+        }
+
+        void register_xio(registry& reg)
+        {
+            reg.add("xio/npy_write", "xtensor", 16, npy_write);
+            reg.add("xio/npy_write", "loop", 16, raw_write);
+            reg.add("xio/npy_read", "xtensor", 16, npy_read);
+            reg.add("xio/npy_read", "loop", 16, raw_read);
+            reg.add("xio/binary_write", "xtensor", 16, binary_write);
+            reg.add("xio/binary_write", "loop", 16, raw_write);
+            reg.add("xio/binary_read", "xtensor", 16, binary_read);
+            reg.add("xio/binary_read", "loop", 16, raw_read);
+            reg.add("xio/csv_read", "xtensor", 8, csv_read);
+            reg.add("xio/csv_read", "loop", 8, csv_read_loop);
+        }
+    }
+}
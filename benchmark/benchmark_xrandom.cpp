@@ -0,0 +1,107 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <random>
+
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape1_type = std::array<std::size_t, 1>;
+
+            template <class E>
+            struct random_state
+            {
+                explicit random_state(std::size_t n)
+                    : shape({n}), res(shape), engine(42)
+                {
+                }
+
+                shape1_type shape;
+                xtensor<double, 1> res;
+                E engine;
+            };
+
+            using mt_state = random_state<std::mt19937>;
+            using philox_state = random_state<random::philox4x32>;
+
+            /***********
+             * uniform *
+             ***********/
+
+            template <class S>
+            kernel uniform_expression(std::size_t n)
+            {
+                return make_kernel(S(n), [](S& s) {
+                    s.res = random::rand<double>(s.shape, 0., 1., s.engine);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel uniform_loop(std::size_t n)
+            {
+                return make_kernel(mt_state(n), [](mt_state& s) {
+                    std::uniform_real_distribution<double> dist(0., 1.);
+                    double* res = s.res.data().data();
+                    std::size_t size = s.res.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = dist(s.engine);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+
+            /**********
+             * normal *
+             **********/
+
+            template <class S>
+            kernel normal_expression(std::size_t n)
+            {
+                return make_kernel(S(n), [](S& s) {
+                    s.res = random::randn<double>(s.shape, 0., 1., s.engine);
+                    do_not_optimize(s.res);
+                });
+            }
+
+            kernel normal_loop(std::size_t n)
+            {
+                return make_kernel(mt_state(n), [](mt_state& s) {
+                    std::normal_distribution<double> dist(0., 1.);
+                    double* res = s.res.data().data();
+                    std::size_t size = s.res.size();
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        res[i] = dist(s.engine);
+                    }
+                    do_not_optimize(s.res);
+                });
+            }
+        }
+
+        void register_xrandom(registry& reg)
+        {
+            reg.add("xrandom/uniform", "xtensor", 8, uniform_expression<mt_state>);
+            reg.add("xrandom/uniform", "xtensor_philox", 8, uniform_expression<philox_state>);
+            reg.add("xrandom/uniform", "loop", 8, uniform_loop);
+            reg.add("xrandom/normal", "xtensor", 8, normal_expression<mt_state>);
+            reg.add("xrandom/normal", "xtensor_philox", 8, normal_expression<philox_state>);
+            reg.add("xrandom/normal", "loop", 8, normal_loop);
+        }
+    }
+}
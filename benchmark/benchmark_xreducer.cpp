@@ -0,0 +1,179 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+
+#include "xtensor/xreducer.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape1_type = std::array<std::size_t, 1>;
+            using shape2_type = std::array<std::size_t, 2>;
+
+            struct reducer_state
+            {
+                explicit reducer_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols), m(shape2_type{rows, cols}),
+                      row_sums(shape1_type{rows}), col_sums(shape1_type{cols}), total(0.)
+                {
+                    for (std::size_t i = 0; i < m.size(); ++i)
+                    {
+                        m.data()[i] = 0.001 * static_cast<double>(i % 1000);
+                    }
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                xtensor<double, 2> m;
+                xtensor<double, 1> row_sums;
+                xtensor<double, 1> col_sums;
+                double total;
+            };
+
+            /*******
+             * all *
+             *******/
+
+            kernel all_expression(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    s.total = sum(s.m)();
+                    do_not_optimize(s.total);
+                });
+            }
+
+            kernel all_loop(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    const double* m = s.m.data().data();
+                    std::size_t size = s.m.size();
+                    double total = 0.;
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        total += m[i];
+                    }
+                    s.total = total;
+                    do_not_optimize(s.total);
+                });
+            }
+
+            /**************
+             * inner axis *
+             **************/
+
+            kernel inner_expression(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    s.row_sums = sum(s.m, {1});
+                    do_not_optimize(s.row_sums);
+                });
+            }
+
+            kernel inner_loop(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.row_sums.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        double acc = 0.;
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            acc += m[i * s.cols + j];
+                        }
+                        res[i] = acc;
+                    }
+                    do_not_optimize(s.row_sums);
+                });
+            }
+
+            /**************
+             * outer axis *
+             **************/
+
+            kernel outer_expression(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    s.col_sums = sum(s.m, {0});
+                    do_not_optimize(s.col_sums);
+                });
+            }
+
+            kernel outer_loop(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.col_sums.data().data();
+                    for (std::size_t j = 0; j < s.cols; ++j)
+                    {
+                        res[j] = 0.;
+                    }
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[j] += m[i * s.cols + j];
+                        }
+                    }
+                    do_not_optimize(s.col_sums);
+                });
+            }
+
+            /**************
+             * expression *
+             **************/
+
+            kernel expression_expression(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    s.row_sums = sum(s.m * s.m + 1., {1});
+                    do_not_optimize(s.row_sums);
+                });
+            }
+
+            kernel expression_loop(std::size_t n)
+            {
+                return make_kernel(reducer_state(n), [](reducer_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.row_sums.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        double acc = 0.;
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            double v = m[i * s.cols + j];
+                            acc += v * v + 1.;
+                        }
+                        res[i] = acc;
+                    }
+                    do_not_optimize(s.row_sums);
+                });
+            }
+        }
+
+        void register_xreducer(registry& reg)
+        {
+            reg.add("xreducer/sum_all", "xtensor", 8, all_expression);
+            reg.add("xreducer/sum_all", "loop", 8, all_loop);
+            reg.add("xreducer/sum_inner_axis", "xtensor", 8, inner_expression);
+            reg.add("xreducer/sum_inner_axis", "loop", 8, inner_loop);
+            reg.add("xreducer/sum_outer_axis", "xtensor", 8, outer_expression);
+            reg.add("xreducer/sum_outer_axis", "loop", 8, outer_loop);
+            reg.add("xreducer/sum_expression", "xtensor", 8, expression_expression);
+            reg.add("xreducer/sum_expression", "loop", 8, expression_loop);
+        }
+    }
+}
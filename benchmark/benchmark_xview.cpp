@@ -0,0 +1,208 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <array>
+#include <cstddef>
+
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xbenchmark.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+        namespace
+        {
+            using shape2_type = std::array<std::size_t, 2>;
+
+            // a rows x cols matrix and results of the shape of its views
+            struct view_state
+            {
+                explicit view_state(std::size_t n)
+                    : cols(matrix_cols(n)), rows(n / cols),
+                      m(shape2_type{rows, cols}), a(shape2_type{rows, cols}),
+                      half_rows(shape2_type{rows / 2, cols}), half_cols(shape2_type{rows, cols / 2})
+                {
+                    for (std::size_t i = 0; i < m.size(); ++i)
+                    {
+                        m.data()[i] = 0.001 * static_cast<double>(i % 1000);
+                        a.data()[i] = 0.002 * static_cast<double>(i % 500);
+                    }
+                }
+
+                std::size_t cols;
+                std::size_t rows;
+                xtensor<double, 2> m;
+                xtensor<double, 2> a;
+                xtensor<double, 2> half_rows;
+                xtensor<double, 2> half_cols;
+            };
+
+            /****************
+             * strided rows *
+             ****************/
+
+            kernel rows_expression(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    s.half_rows = view(s.m, range(std::size_t(0), s.rows, std::size_t(2)), all()) + 1.;
+                    do_not_optimize(s.half_rows);
+                });
+            }
+
+            kernel rows_loop(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.half_rows.data().data();
+                    for (std::size_t i = 0; i < s.rows / 2; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = m[2 * i * s.cols + j] + 1.;
+                        }
+                    }
+                    do_not_optimize(s.half_rows);
+                });
+            }
+
+            /*******************
+             * strided columns *
+             *******************/
+
+            kernel cols_expression(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    s.half_cols = view(s.m, all(), range(std::size_t(0), s.cols, std::size_t(2))) + 1.;
+                    do_not_optimize(s.half_cols);
+                });
+            }
+
+            kernel cols_loop(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.half_cols.data().data();
+                    std::size_t half = s.cols / 2;
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < half; ++j)
+                        {
+                            res[i * half + j] = m[i * s.cols + 2 * j] + 1.;
+                        }
+                    }
+                    do_not_optimize(s.half_cols);
+                });
+            }
+
+            /***************
+             * view assign *
+             ***************/
+
+            kernel assign_expression(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    view(s.m, range(std::size_t(1), s.rows - 1), all()) = 2. * view(s.a, range(std::size_t(1), s.rows - 1), all());
+                    do_not_optimize(s.m);
+                });
+            }
+
+            kernel assign_loop(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    const double* a = s.a.data().data();
+                    double* m = s.m.data().data();
+                    for (std::size_t i = 1; i < s.rows - 1; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            m[i * s.cols + j] = 2. * a[i * s.cols + j];
+                        }
+                    }
+                    do_not_optimize(s.m);
+                });
+            }
+
+            /**************
+             * single row *
+             **************/
+
+            kernel row_expression(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        view(s.m, i, all()) += view(s.a, i, all());
+                    }
+                    do_not_optimize(s.m);
+                });
+            }
+
+            kernel row_loop(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    const double* a = s.a.data().data();
+                    double* m = s.m.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            m[i * s.cols + j] += a[i * s.cols + j];
+                        }
+                    }
+                    do_not_optimize(s.m);
+                });
+            }
+
+            /********
+             * flip *
+             ********/
+
+            kernel flip_expression(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    s.a = flip(s.m, 0);
+                    do_not_optimize(s.a);
+                });
+            }
+
+            kernel flip_loop(std::size_t n)
+            {
+                return make_kernel(view_state(n), [](view_state& s) {
+                    const double* m = s.m.data().data();
+                    double* res = s.a.data().data();
+                    for (std::size_t i = 0; i < s.rows; ++i)
+                    {
+                        for (std::size_t j = 0; j < s.cols; ++j)
+                        {
+                            res[i * s.cols + j] = m[(s.rows - 1 - i) * s.cols + j];
+                        }
+                    }
+                    do_not_optimize(s.a);
+                });
+            }
+        }
+
+        void register_xview(registry& reg)
+        {
+            reg.add("xview/strided_rows", "xtensor", 8, rows_expression);
+            reg.add("xview/strided_rows", "loop", 8, rows_loop);
+            reg.add("xview/strided_cols", "xtensor", 8, cols_expression);
+            reg.add("xview/strided_cols", "loop", 8, cols_loop);
+            reg.add("xview/assign", "xtensor", 16, assign_expression);
+            reg.add("xview/assign", "loop", 16, assign_loop);
+            reg.add("xview/row", "xtensor", 24, row_expression);
+            reg.add("xview/row", "loop", 24, row_loop);
+            reg.add("xstrided_view/flip", "xtensor", 16, flip_expression);
+            reg.add("xstrided_view/flip", "loop", 16, flip_loop);
+        }
+    }
+}
@@ -1,204 +1,115 @@
-#include "xtensor/xarray.hpp"
-#include "xtensor/xtensor.hpp"
-
-#include <cstddef>
-#include <chrono>
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
-#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "xbenchmark.hpp"
 
-namespace xt
+namespace
 {
+    void usage(const char* name)
+    {
+        std::cerr << "usage: " << name << " [options]\n"
+                  << "  --filter=<text>        run the cases whose family/variant contains text\n"
+                  << "  --min-time=<seconds>   minimal duration of a measure (default 0.05)\n"
+                  << "  --repetitions=<n>      number of measures of each case (default 5)\n"
+                  << "  --max-size=<class>     largest size class, among L1, L2, L3 and DRAM (default DRAM)\n"
+                  << "  --out=<file>           write the JSON results to file instead of the standard output\n";
+    }
 
-    namespace axpy_1d
+    bool parse_option(const std::string& arg, const std::string& name, std::string& value)
     {
-        template <class E>
-        inline auto benchmark_iteration(const E& x, const E& y, E& res, typename E::value_type a, std::size_t number)
+        std::string prefix = "--" + name + "=";
+        if (arg.compare(0, prefix.size(), prefix) == 0)
         {
-            auto start = std::chrono::steady_clock::now();
-            for(std::size_t i = 0; i < number; ++i)
-            {
-                auto iterx = x.begin();
-                auto itery = y.begin();
-                for(auto iter = res.begin(); iter != res.end(); ++iter, ++iterx, ++itery)
-                {
-                    *iter = a * (*iterx) + (*itery);
-                }
-            }
-            auto end = std::chrono::steady_clock::now();
-            auto diff = end - start;
-            return diff;
+            value = arg.substr(prefix.size());
+            return true;
         }
+        return false;
+    }
 
-        template <class E>
-        inline auto benchmark_xiteration(const E& x, const E& y, E& res, typename E::value_type a, std::size_t number)
+    bool is_size_class(const std::string& name)
+    {
+        for (const auto& s : xt::bench::size_classes())
         {
-            auto start = std::chrono::steady_clock::now();
-            for(std::size_t i = 0; i < number; ++i)
+            if (s.name == name)
             {
-                auto iterx = x.xbegin();
-                auto itery = y.xbegin();
-                for(auto iter = res.xbegin(); iter != res.xend(); ++iter, ++iterx, ++itery)
-                {
-                    *iter = a * (*iterx) + (*itery);
-                }
+                return true;
             }
-            auto end = std::chrono::steady_clock::now();
-            auto diff = end - start;
-            return diff;
         }
+        return false;
+    }
+}
 
-        template <class E>
-        inline auto benchmark_indexing(const E& x, const E& y, E& res, typename E::value_type a, std::size_t number)
+int main(int argc, char* argv[])
+{
+    xt::bench::options opt;
+    std::string out;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string value;
+        if (parse_option(arg, "filter", value))
         {
-            using size_type = typename E::size_type;
-            auto start = std::chrono::steady_clock::now();
-            for(std::size_t i = 0; i < number; ++i)
-            {
-                size_type n = x.size();
-                for(size_type i = 0; i < n; ++i)
-                {
-                    res(i) = a * x(i) + y(i);
-                }
-            }
-            auto end = std::chrono::steady_clock::now();
-            auto diff = end - start;
-            return diff;
+            opt.filter = value;
         }
-
-        template <class E>
-        inline void init_benchmark(E& x, E& y, E& res, typename E::size_type size)
+        else if (parse_option(arg, "min-time", value))
         {
-            x.reshape({ size });
-            y.reshape({ size });
-            res.reshape({ size });
-
-            using value_type = typename E::value_type;
-            using size_type = typename E::size_type;
-            for(size_type i = 0; i < size; ++i)
-            {
-                x(i) = 0.5 + value_type(i);
-                y(i) = 0.25 * value_type(i);
-            }
+            opt.min_time = std::atof(value.c_str());
         }
-
-        void benchmark()
+        else if (parse_option(arg, "repetitions", value))
         {
-            using duration_type = std::chrono::duration<double, std::milli>;
-            using size_type = xarray<double>::size_type;
-            constexpr size_type size = 1000;
-            constexpr size_type number = 10000;
-            double a = 2.7;
-
-            xarray<double> ax, ay, ares;
-            init_benchmark(ax, ay, ares, size);
-
-            xtensor<double, 1> tx, ty, tres;
-            init_benchmark(tx, ty, tres, size);
-
-            benchmark_iteration(ax, ay, ares, a, 10);
-
-            duration_type aiter = benchmark_iteration(ax, ay, ares, a, number);
-            duration_type titer = benchmark_iteration(tx, ty, tres, a, number);
-            duration_type axiter = benchmark_xiteration(ax, ay, ares, a, number);
-            duration_type txiter = benchmark_xiteration(tx, ty, tres, a, number);
-            duration_type aindex = benchmark_indexing(ax, ay, ares, a, number);
-            duration_type tindex = benchmark_indexing(tx, ty, tres, a, number);
-
-            std::cout << "***************************" << std::endl;
-            std::cout << "*    AXPY 1D BENCHMARK    *" << std::endl;
-            std::cout << "***************************" << std::endl << std::endl;
-
-            std::cout << "xarray   iteration: " << aiter.count() << "ms" << std::endl;
-            std::cout << "xtensor  iteration: " << titer.count() << "ms" << std::endl;
-            std::cout << "xarray  xiteration: " << axiter.count() << "ms" << std::endl;
-            std::cout << "xtensor xiteration: " << txiter.count() << "ms" << std::endl;
-            std::cout << "xarray    indexing: " << aindex.count() << "ms" << std::endl;
-            std::cout << "xtensor   indexing: " << tindex.count() << "ms" << std::endl;
-            std::cout << std::endl;
+            opt.repetitions = static_cast<std::size_t>(std::atoi(value.c_str()));
         }
-    }
-
-    namespace func
-    {
-        template <class E>
-        inline auto benchmark_assign(const E& x, const E& y, const E& z, E& res, std::size_t number)
+        else if (parse_option(arg, "max-size", value) && is_size_class(value))
         {
-            auto start = std::chrono::steady_clock::now();
-            for(std::size_t i = 0; i < number; ++i)
-            {
-                res = 3 * x - 2 * y * z;
-            }
-            auto end = std::chrono::steady_clock::now();
-            auto diff = end - start;
-            return diff;
+            opt.max_size = value;
         }
-
-        template <class E>
-        inline void init_benchmark(E& x, E& y, E& z, E& res)
+        else if (parse_option(arg, "out", value))
         {
-            using value_type = typename E::value_type;
-            using size_type = typename E::size_type;
-            using shape_type = typename E::shape_type;
-
-            shape_type shape = { 4, 3, 5 };
-
-            x.reshape(shape);
-            y.reshape(shape);
-            z.reshape(shape);
-            res.reshape(shape);
-
-            for(size_type i = 0; i < shape[0]; ++i)
-            {
-                for(size_type j = 0; j < shape[1]; ++j)
-                {
-                    for(size_type k = 0; k < shape[2]; ++k)
-                    {
-                        x(i,j,k) = 0.25 * value_type(i) + 0.5 * value_type(j) - 0.01 * value_type(k);
-                        y(i,j,k) = 0.31 * value_type(i) - 0.2 * value_type(j) + 0.07 * value_type(k);
-                        z(i,j,k) = 0.27 * value_type(i) + 0.4 * value_type(j) - 0.03 * value_type(k);
-                    }
-                }
-            }
+            out = value;
         }
-
-        void benchmark()
+        else
         {
-            using duration_type = std::chrono::duration<double, std::milli>;
-            std::size_t number = 2000;
-
-            xarray<double> ax, ay, az, ares;
-            init_benchmark(ax, ay, az, ares);
-
-            xtensor<double, 3> tx, ty, tz, tres;
-            init_benchmark(tx, ty, tz, tres);
-
-            benchmark_assign(ax, ay, az, ares, 10);
-
-            duration_type aassign = benchmark_assign(ax, ay, az, ares, number);
-            duration_type tassign = benchmark_assign(tx, ty, tz, tres, number);
-
-            std::cout << "******************************" << std::endl;
-            std::cout << "* XFUNCTION ASSIGN BENCHMARK *" << std::endl;
-            std::cout << "******************************" << std::endl << std::endl;
-
-            std::cout << "xarray : " << aassign.count() << "ms" << std::endl;
-            std::cout << "xtensor: " << tassign.count() << "ms" << std::endl;
+            usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
         }
-
     }
 
-}
-
-int main(int argc, char* argv[])
-{
-    std::cout << "Using steady_clock" << std::endl;
-    std::cout << "period num: " << std::chrono::steady_clock::period::num << std::endl;
-    std::cout << "period den: " << std::chrono::steady_clock::period::den << std::endl;
-    std::cout << "steady = " << std::boolalpha << std::chrono::steady_clock::is_steady << std::endl;
-    std::cout << std::endl;
+    xt::bench::registry reg;
+    xt::bench::register_xfunction(reg);
+    xt::bench::register_xbroadcast(reg);
+    xt::bench::register_xview(reg);
+    xt::bench::register_xreducer(reg);
+    xt::bench::register_xbuilder(reg);
+    xt::bench::register_xrandom(reg);
+    xt::bench::register_xindexview(reg);
+    xt::bench::register_xio(reg);
 
-    //xt::axpy_1d::benchmark();
-    xt::func::benchmark();
+    std::vector<xt::bench::result> results = xt::bench::run(reg, opt, std::cerr);
 
+    if (out.empty())
+    {
+        xt::bench::write_json(std::cout, results, opt);
+    }
+    else
+    {
+        std::ofstream stream(out);
+        if (!stream)
+        {
+            std::cerr << "cannot open " << out << std::endl;
+            return 1;
+        }
+        xt::bench::write_json(stream, results, opt);
+    }
     return 0;
 }
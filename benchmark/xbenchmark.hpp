@@ -0,0 +1,323 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBENCHMARK_HPP
+#define XBENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xtensor_config.hpp"
+
+namespace xt
+{
+    namespace bench
+    {
+
+        /**************
+         * size_class *
+         **************/
+
+        // Number of elements of each operand of a benchmark, chosen so that
+        // the operands of the typical case fit in the named memory level.
+        struct size_class
+        {
+            std::string name;
+            std::size_t size;
+        };
+
+        inline const std::vector<size_class>& size_classes()
+        {
+            static const std::vector<size_class> sizes = {
+                {"L1", std::size_t(1) << 10},
+                {"L2", std::size_t(1) << 14},
+                {"L3", std::size_t(1) << 18},
+                {"DRAM", std::size_t(1) << 23}
+            };
+            return sizes;
+        }
+
+        // Number of columns of a 2-D operand of n elements, a power of two
+        // close to its square root.
+        inline std::size_t matrix_cols(std::size_t n)
+        {
+            std::size_t cols = 1;
+            while (cols * cols * 4 <= n)
+            {
+                cols *= 2;
+            }
+            return cols;
+        }
+
+        /************
+         * registry *
+         ************/
+
+        // A kernel runs one iteration of a benchmark; it is built, with its
+        // operands, by the factory of the case for a given size.
+        using kernel = std::function<void()>;
+        using kernel_factory = std::function<kernel(std::size_t)>;
+
+        struct benchmark_case
+        {
+            // "module/operation", e.g. "xfunction/axpy"
+            std::string family;
+            // "xtensor", "xarray", ... or "loop" for the hand-written baseline
+            std::string variant;
+            // bytes read and written per element, for the bandwidth
+            std::size_t bytes_per_element;
+            kernel_factory factory;
+        };
+
+        class registry
+        {
+
+        public:
+
+            void add(std::string family, std::string variant, std::size_t bytes_per_element, kernel_factory factory);
+
+            const std::vector<benchmark_case>& cases() const noexcept;
+
+        private:
+
+            std::vector<benchmark_case> m_cases;
+        };
+
+        inline void registry::add(std::string family, std::string variant, std::size_t bytes_per_element, kernel_factory factory)
+        {
+            m_cases.push_back({std::move(family), std::move(variant), bytes_per_element, std::move(factory)});
+        }
+
+        inline const std::vector<benchmark_case>& registry::cases() const noexcept
+        {
+            return m_cases;
+        }
+
+        // Builds a kernel owning the state its operands are stored in.
+        template <class S, class F>
+        inline kernel make_kernel(S&& state, F f)
+        {
+            auto p = std::make_shared<std::decay_t<S>>(std::forward<S>(state));
+            return [p, f]() { f(*p); };
+        }
+
+        // Prevents the compiler from optimizing away the computation of v.
+        template <class T>
+        inline void do_not_optimize(const T& v)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "g"(&v) : "memory");
+#else
+            static volatile const void* sink;
+            sink = &v;
+#endif
+        }
+
+        /**********
+         * runner *
+         **********/
+
+        struct options
+        {
+            // minimal duration of a measure, in seconds
+            double min_time = 0.05;
+            // number of measures of each case
+            std::size_t repetitions = 5;
+            // only the cases whose "family/variant" contains filter are run
+            std::string filter;
+            // largest size class run
+            std::string max_size = "DRAM";
+        };
+
+        struct result
+        {
+            std::string family;
+            std::string variant;
+            std::string size_class;
+            std::size_t size;
+            std::size_t bytes_per_element;
+            std::size_t iterations;
+            double min_ns;
+            double median_ns;
+        };
+
+        // Measures a case: the number of iterations is doubled until a
+        // measure lasts min_time, then the measure is repeated; the minimum
+        // and the median times per iteration are reported.
+        inline result run_case(const benchmark_case& c, const size_class& s, const options& opt)
+        {
+            using clock_type = std::chrono::steady_clock;
+            using duration_type = std::chrono::duration<double, std::nano>;
+
+            kernel k = c.factory(s.size);
+            auto measure = [&k](std::size_t iterations) {
+                auto start = clock_type::now();
+                for (std::size_t i = 0; i < iterations; ++i)
+                {
+                    k();
+                }
+                duration_type diff = clock_type::now() - start;
+                return diff.count();
+            };
+
+            measure(1);
+            std::size_t iterations = 1;
+            double min_ns = opt.min_time * 1e9;
+            while (measure(iterations) < min_ns && iterations < (std::size_t(1) << 30))
+            {
+                iterations *= 2;
+            }
+
+            std::vector<double> times(std::max(opt.repetitions, std::size_t(1)));
+            for (auto& t : times)
+            {
+                t = measure(iterations) / static_cast<double>(iterations);
+            }
+            std::sort(times.begin(), times.end());
+            return {c.family, c.variant, s.name, s.size, c.bytes_per_element, iterations,
+                    times.front(), times[times.size() / 2]};
+        }
+
+        inline std::vector<result> run(const registry& reg, const options& opt, std::ostream& log)
+        {
+            std::vector<result> results;
+            for (const auto& s : size_classes())
+            {
+                for (const auto& c : reg.cases())
+                {
+                    std::string name = c.family + "/" + c.variant;
+                    if (name.find(opt.filter) == std::string::npos)
+                    {
+                        continue;
+                    }
+                    result r = run_case(c, s, opt);
+                    log << std::left << std::setw(48) << name << std::setw(6) << s.name
+                        << std::right << std::setw(14) << std::fixed << std::setprecision(1) << r.median_ns << " ns"
+                        << std::endl;
+                    results.push_back(std::move(r));
+                }
+                if (s.name == opt.max_size)
+                {
+                    break;
+                }
+            }
+            return results;
+        }
+
+        /********
+         * json *
+         ********/
+
+        inline std::string json_string(const std::string& s)
+        {
+            std::string res = "\"";
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    res += '\\';
+                }
+                res += c;
+            }
+            return res + "\"";
+        }
+
+        inline std::string compiler_name()
+        {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        // Writes the results as a JSON document; the results of the
+        // variants compared to a hand-written loop hold the ratio of their
+        // median time to the median time of the loop.
+        inline void write_json(std::ostream& out, const std::vector<result>& results, const options& opt)
+        {
+            std::map<std::string, double> loops;
+            for (const auto& r : results)
+            {
+                if (r.variant == "loop")
+                {
+                    loops[r.family + "/" + r.size_class] = r.median_ns;
+                }
+            }
+
+            std::ostringstream version;
+            version << XTENSOR_VERSION_MAJOR << "." << XTENSOR_VERSION_MINOR << "." << XTENSOR_VERSION_PATCH;
+
+            out << std::setprecision(6) << std::defaultfloat;
+            out << "{\n";
+            out << "  \"context\": {\n";
+            out << "    \"library\": \"xtensor\",\n";
+            out << "    \"version\": " << json_string(version.str()) << ",\n";
+            out << "    \"compiler\": " << json_string(compiler_name()) << ",\n";
+            out << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n";
+            out << "    \"min_time_s\": " << opt.min_time << ",\n";
+            out << "    \"repetitions\": " << opt.repetitions << "\n";
+            out << "  },\n";
+            out << "  \"benchmarks\": [";
+            for (std::size_t i = 0; i < results.size(); ++i)
+            {
+                const result& r = results[i];
+                double bytes = static_cast<double>(r.bytes_per_element) * static_cast<double>(r.size);
+                out << (i == 0 ? "\n" : ",\n");
+                out << "    {";
+                out << "\"name\": " << json_string(r.family + "/" + r.variant + "/" + r.size_class) << ", ";
+                out << "\"family\": " << json_string(r.family) << ", ";
+                out << "\"variant\": " << json_string(r.variant) << ", ";
+                out << "\"size_class\": " << json_string(r.size_class) << ", ";
+                out << "\"size\": " << r.size << ", ";
+                out << "\"iterations\": " << r.iterations << ", ";
+                out << "\"min_ns\": " << r.min_ns << ", ";
+                out << "\"median_ns\": " << r.median_ns << ", ";
+                out << "\"bytes_per_second\": " << (r.median_ns > 0. ? bytes / r.median_ns * 1e9 : 0.);
+                auto loop = loops.find(r.family + "/" + r.size_class);
+                if (r.variant != "loop" && loop != loops.end() && loop->second > 0.)
+                {
+                    out << ", \"loop_ratio\": " << r.median_ns / loop->second;
+                }
+                out << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+        /***************************
+         * benchmark registrations *
+         ***************************/
+
+        void register_xfunction(registry& reg);
+        void register_xbroadcast(registry& reg);
+        void register_xview(registry& reg);
+        void register_xreducer(registry& reg);
+        void register_xbuilder(registry& reg);
+        void register_xrandom(registry& reg);
+        void register_xindexview(registry& reg);
+        void register_xio(registry& reg);
+    }
+}
+
+#endif
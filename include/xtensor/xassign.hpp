@@ -10,7 +10,13 @@
 #define XASSIGN_HPP
 
 #include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 #include "xtensor_forward.hpp"
+#include "xcost.hpp"
+#include "xexecutor.hpp"
 #include "xiterator.hpp"
 
 namespace xt
@@ -18,6 +24,18 @@ namespace xt
     template <class E>
     class xexpression;
 
+    template <class CT>
+    class xscalar;
+
+    template <class CT, class X>
+    class xbroadcast;
+
+    template <class CT, class I>
+    class xindexview;
+
+    template <class CT, class M, std::size_t I>
+    class xoffsetview;
+
     /********************
      * Assign functions *
      ********************/
@@ -25,12 +43,18 @@ namespace xt
     template <class E1, class E2>
     void assign_data(xexpression<E1>& e1, const xexpression<E2>& e2, bool trivial);
 
+    template <class E1, class E2>
+    void assign_data(xexpression<E1>& e1, const xexpression<E2>& e2, bool trivial, const executor& ex);
+
     template <class E1, class E2>
     bool reshape(xexpression<E1>& e1, const xexpression<E2>& e2);
 
     template <class E1, class E2>
     void assign_xexpression(xexpression<E1>& e1, const xexpression<E2>& e2);
 
+    template <class E1, class E2>
+    void assign_xexpression(xexpression<E1>& e1, const xexpression<E2>& e2, const executor& ex);
+
     template <class E1, class E2>
     void computed_assign(xexpression<E1>& e1, const xexpression<E2>& e2);
 
@@ -59,6 +83,7 @@ namespace xt
         data_assigner(E1& e1, const E2 & e2);
 
         void run();
+        void run(size_type first, size_type last);
 
         void step(size_type i);
         void reset(size_type i);
@@ -82,6 +107,86 @@ namespace xt
 
     namespace detail
     {
+        // Expressions able to compute their values in closed form (such
+        // as some xgenerators) provide an assign_to method writing them
+        // directly into the buffer of a row-major contiguous container.
+        template <class E1, class E2, class = void>
+        struct has_assign_to : std::false_type
+        {
+        };
+
+        template <class E1, class E2>
+        struct has_assign_to<E1, E2, void_t<decltype(std::declval<const E2&>().assign_to(std::declval<E1&>()))>>
+            : std::true_type
+        {
+        };
+
+        template <class E1, class E2>
+        using is_assignable_to = std::integral_constant<bool, is_container<E1>::value && has_assign_to<E1, E2>::value>;
+
+        template <class E1, class E2>
+        inline bool assign_to(E1& e1, const E2& e2, std::true_type)
+        {
+            bool same_shape = e1.dimension() == e2.dimension() &&
+                std::equal(e1.shape().cbegin(), e1.shape().cend(), e2.shape().cbegin());
+            if (same_shape && e1.is_contiguous())
+            {
+                e2.assign_to(e1);
+                return true;
+            }
+            return false;
+        }
+
+        template <class E1, class E2>
+        inline bool assign_to(E1&, const E2&, std::false_type)
+        {
+            return false;
+        }
+
+        // Expressions holding the same value everywhere; assigning them is
+        // a fill of the target.
+        template <class E>
+        struct is_constant_expression : std::false_type
+        {
+        };
+
+        template <class CT>
+        struct is_constant_expression<xscalar<CT>> : std::true_type
+        {
+        };
+
+        template <class CT, class X>
+        struct is_constant_expression<xbroadcast<CT, X>> : is_constant_expression<std::decay_t<CT>>
+        {
+        };
+
+        template <class E, class = void>
+        struct has_fill : std::false_type
+        {
+        };
+
+        template <class E>
+        struct has_fill<E, void_t<decltype(std::declval<E&>().fill(std::declval<const typename E::value_type&>()))>>
+            : std::true_type
+        {
+        };
+
+        template <class E1, class E2>
+        using is_fillable_with = std::integral_constant<bool, is_constant_expression<E2>::value && has_fill<E1>::value>;
+
+        template <class E1, class E2>
+        inline bool fill(E1& e1, const E2& e2, std::true_type)
+        {
+            e1.fill(e2());
+            return true;
+        }
+
+        template <class E1, class E2>
+        inline bool fill(E1&, const E2&, std::false_type)
+        {
+            return false;
+        }
+
         template <class E1, class E2>
         inline bool is_trivial_broadcast(const E1& e1, const E2& e2)
         {
@@ -93,23 +198,144 @@ namespace xt
         {
             return false;
         }
+
+        template <class CT, class I, class E2>
+        inline bool is_trivial_broadcast(const xindexview<CT, I>&, const E2&)
+        {
+            return false;
+        }
+
+        template <class CT, class M, std::size_t I, class E2>
+        inline bool is_trivial_broadcast(const xoffsetview<CT, M, I>&, const E2&)
+        {
+            return false;
+        }
+    }
+
+    namespace detail
+    {
+        template <class E1, class E2>
+        inline bool assign_shortcut(E1& e1, const E2& e2)
+        {
+            return detail::fill(e1, e2, is_fillable_with<E1, E2>()) ||
+                   detail::assign_to(e1, e2, is_assignable_to<E1, E2>());
+        }
+
+        // Estimated cost of the assignment; stepping through broadcast
+        // or strided operands adds about two operations per element.
+        template <class E1, class E2>
+        inline std::size_t assign_cost(const E1& e1, const E2& e2, bool linear)
+        {
+            return e1.size() * (element_cost(e2) + (linear ? 0 : 2));
+        }
+
+        template <class E1, class E2>
+        inline void assign_serial(E1& e1, const E2& e2, bool linear)
+        {
+            if(linear)
+            {
+                std::copy(e2.cbegin(), e2.cend(), e1.begin());
+            }
+            else
+            {
+                data_assigner<E1, E2> assigner(e1, e2);
+                assigner.run();
+            }
+        }
+
+        template <class E1, class E2>
+        inline void assign_block(E1& e1, const E2& e2, std::size_t first, std::size_t last, std::true_type)
+        {
+            using difference_type = typename E2::difference_type;
+            auto src = e2.cbegin();
+            src += static_cast<difference_type>(first);
+            auto dst = e1.begin() + static_cast<difference_type>(first);
+            for(std::size_t i = first; i < last; ++i, ++src, ++dst)
+            {
+                *dst = *src;
+            }
+        }
+
+        template <class E1, class E2>
+        inline void assign_block(E1& e1, const E2& e2, std::size_t first, std::size_t last, std::false_type)
+        {
+            data_assigner<E1, E2> assigner(e1, e2);
+            assigner.run(first, last);
+        }
+
+        template <class E>
+        using task_closure_t = std::conditional_t<is_shared_expression<E>::value, const E&, E>;
+
+        // Splits the elements of e1, in row-major order, in blocks assigned
+        // by the tasks of the executor. The blocks of linear assignments are
+        // contiguous loops; otherwise each task steps its own steppers to
+        // the beginning of its block.
+        template <class E1, class E2>
+        inline void assign_parallel(E1& e1, const E2& e2, bool linear, std::size_t cost,
+                                    std::size_t min_cost, const executor& ex)
+        {
+            std::size_t size = e1.size();
+            execution_plan plan = make_execution_plan(size, cost, min_cost, ex.concurrency());
+            if(plan.nb_tasks < 2 || !is_parallel_expression<E2>::value)
+            {
+                assign_serial(e1, e2, linear);
+                return;
+            }
+            using linear_type = std::integral_constant<bool, is_container<E1>::value && is_linear_expression<E2>::value>;
+            std::size_t grain = plan.grain;
+            parallel_for(ex, (size + grain - 1) / grain, [&e1, &e2, linear, size, grain](std::size_t k) {
+                task_closure_t<E2> e(e2);
+                std::size_t first = k * grain;
+                std::size_t last = std::min(size, first + grain);
+                if(linear && linear_type::value)
+                {
+                    assign_block(e1, e, first, last, linear_type());
+                }
+                else
+                {
+                    assign_block(e1, e, first, last, std::false_type());
+                }
+            });
+        }
     }
 
+    // Assignments run on the default executor when their estimated cost
+    // exceeds the default_parallel_cost threshold, which is the maximal
+    // value unless set otherwise: the calling thread evaluates them.
     template <class E1, class E2>
     inline void assign_data(xexpression<E1>& e1, const xexpression<E2>& e2, bool trivial)
     {
         E1& de1 = e1.derived_cast();
         const E2& de2 = e2.derived_cast();
-        bool trivial_broadcast = trivial && detail::is_trivial_broadcast(de1, de2);
-        if(trivial_broadcast)
+        if(detail::assign_shortcut(de1, de2))
+        {
+            return;
+        }
+        bool linear = trivial && detail::is_trivial_broadcast(de1, de2);
+        std::size_t cost = detail::assign_cost(de1, de2, linear);
+        std::size_t min_cost = get_execution_thresholds().default_parallel_cost;
+        if(cost >= min_cost && detail::is_parallel_expression<E2>::value)
         {
-            std::copy(de2.cbegin(), de2.cend(), de1.begin());
+            detail::assign_parallel(de1, de2, linear, cost, min_cost, default_executor());
         }
         else
         {
-            data_assigner<E1, E2> assigner(de1, de2);
-            assigner.run();
+            detail::assign_serial(de1, de2, linear);
+        }
+    }
+
+    template <class E1, class E2>
+    inline void assign_data(xexpression<E1>& e1, const xexpression<E2>& e2, bool trivial, const executor& ex)
+    {
+        E1& de1 = e1.derived_cast();
+        const E2& de2 = e2.derived_cast();
+        if(detail::assign_shortcut(de1, de2))
+        {
+            return;
         }
+        bool linear = trivial && detail::is_trivial_broadcast(de1, de2);
+        std::size_t cost = detail::assign_cost(de1, de2, linear);
+        detail::assign_parallel(de1, de2, linear, cost, get_execution_thresholds().parallel_cost, ex);
     }
 
     template <class E1, class E2>
@@ -132,6 +358,13 @@ namespace xt
         assign_data(e1, e2, trivial_broadcast);
     }
 
+    template <class E1, class E2>
+    inline void assign_xexpression(xexpression<E1>& e1, const xexpression<E2>& e2, const executor& ex)
+    {
+        bool trivial_broadcast = reshape(e1, e2);
+        assign_data(e1, e2, trivial_broadcast, ex);
+    }
+
     template <class E1, class E2>
     inline void computed_assign(xexpression<E1>& e1, const xexpression<E2>& e2)
     {
@@ -173,7 +406,11 @@ namespace xt
         const E1& de1 = e1.derived_cast();
         const E2& de2 = e2.derived_cast();
         size_type size = de2.dimension();
-        shape_type shape(size, size_type(1));
+        if(size > de1.dimension())
+        {
+            throw broadcast_error(de2.shape(), de1.shape());
+        }
+        shape_type shape = make_sequence<shape_type>(size, size_type(1));
         de2.broadcast_shape(shape);
         if(shape.size() > de1.shape().size() || shape > de1.shape())
         {
@@ -203,6 +440,28 @@ namespace xt
         }
     }
 
+    template <class E1, class E2>
+    inline void data_assigner<E1, E2>::run(size_type first, size_type last)
+    {
+        const auto& shape = m_e1.shape();
+        size_type r = first;
+        for(size_type i = shape.size(); i != 0; --i)
+        {
+            m_index[i - 1] = r % shape[i - 1];
+            r /= shape[i - 1];
+        }
+        for(size_type i = 0; i < shape.size(); ++i)
+        {
+            m_lhs.step(i, m_index[i]);
+            m_rhs.step(i, m_index[i]);
+        }
+        for(size_type k = first; k < last; ++k)
+        {
+            *m_lhs = *m_rhs;
+            increment_stepper(*this, m_index, shape);
+        }
+    }
+
     template <class E1, class E2>
     inline void data_assigner<E1, E2>::step(size_type i)
     {
@@ -0,0 +1,579 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBINARY_HPP
+#define XBINARY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xcontainer.hpp"
+#include "xexpression.hpp"
+#include "xnpy.hpp"
+#include "xstrides.hpp"
+
+namespace xt
+{
+
+    /*****************
+     * binary format *
+     *****************/
+
+    // A tensor in binary format is made of
+    //  - the magic string "XTBINARY";
+    //  - the offset and the size in bytes of the payload, the dimension,
+    //    the layout, and the npy descr of the value type padded to 8 bytes;
+    //  - the shape and the strides, in number of elements;
+    //  - the payload, aligned on 64 bytes from the beginning of the
+    //    buffer, holding the elements in row-major or column-major order.
+    // Integers are stored in the native byte order: the format is meant
+    // for the exchange of tensors between processes of the same host.
+
+    namespace detail
+    {
+        inline std::runtime_error binary_error(const std::string& msg)
+        {
+            return std::runtime_error("binary: " + msg);
+        }
+
+        constexpr std::size_t binary_alignment = 64;
+
+        struct binary_header
+        {
+            std::uint64_t payload_offset;
+            std::uint64_t payload_size;
+            std::uint64_t dimension;
+            std::uint64_t layout;
+            char descr[8];
+        };
+
+        inline std::size_t binary_payload_offset(std::size_t dimension) noexcept
+        {
+            std::size_t size = 8 + sizeof(binary_header) + 2 * dimension * sizeof(std::uint64_t);
+            return (size + binary_alignment - 1) / binary_alignment * binary_alignment;
+        }
+
+        // Writes the header at the beginning of buffer, which must hold
+        // binary_payload_offset(shape.size()) bytes.
+        template <class T, class S>
+        inline void write_binary_header(char* buffer, const S& shape, layout l)
+        {
+            std::string descr = npy_descr<T>();
+            binary_header header;
+            header.dimension = shape.size();
+            header.payload_offset = binary_payload_offset(shape.size());
+            header.payload_size = compute_size(shape) * sizeof(T);
+            header.layout = static_cast<std::uint64_t>(l);
+            std::memset(header.descr, 0, sizeof(header.descr));
+            std::memcpy(header.descr, descr.data(), std::min(descr.size(), sizeof(header.descr)));
+
+            std::vector<std::size_t> strides(shape.size());
+            compute_strides(shape, l, strides);
+
+            std::memset(buffer, 0, static_cast<std::size_t>(header.payload_offset));
+            std::memcpy(buffer, "XTBINARY", 8);
+            std::memcpy(buffer + 8, &header, sizeof(binary_header));
+            char* it = buffer + 8 + sizeof(binary_header);
+            for (std::size_t i = 0; i < shape.size(); ++i, it += sizeof(std::uint64_t))
+            {
+                const std::uint64_t s = shape[i];
+                std::memcpy(it, &s, sizeof(std::uint64_t));
+            }
+            for (std::size_t i = 0; i < shape.size(); ++i, it += sizeof(std::uint64_t))
+            {
+                const std::uint64_t s = strides[i];
+                std::memcpy(it, &s, sizeof(std::uint64_t));
+            }
+        }
+
+        // Reads and checks the header at the beginning of buffer.
+        template <class T>
+        inline binary_header read_binary_header(const char* buffer, std::size_t size,
+                                                std::vector<std::size_t>& shape, std::vector<std::size_t>& strides)
+        {
+            binary_header header;
+            if (size < 8 + sizeof(binary_header) || std::memcmp(buffer, "XTBINARY", 8) != 0)
+            {
+                throw binary_error("invalid header");
+            }
+            std::memcpy(&header, buffer + 8, sizeof(binary_header));
+            std::string descr(header.descr, std::find(header.descr, header.descr + sizeof(header.descr), '\0'));
+            if (descr != npy_descr<T>())
+            {
+                throw binary_error("the buffer holds elements of type " + descr);
+            }
+            std::size_t dim = static_cast<std::size_t>(header.dimension);
+            if (header.payload_offset < binary_payload_offset(dim) || header.payload_offset > size ||
+                header.payload_size > size - header.payload_offset || header.layout > 1)
+            {
+                throw binary_error("invalid header");
+            }
+
+            shape.resize(dim);
+            strides.resize(dim);
+            const char* it = buffer + 8 + sizeof(binary_header);
+            for (std::size_t i = 0; i < dim; ++i, it += sizeof(std::uint64_t))
+            {
+                std::uint64_t s;
+                std::memcpy(&s, it, sizeof(std::uint64_t));
+                shape[i] = static_cast<std::size_t>(s);
+            }
+            for (std::size_t i = 0; i < dim; ++i, it += sizeof(std::uint64_t))
+            {
+                std::uint64_t s;
+                std::memcpy(&s, it, sizeof(std::uint64_t));
+                strides[i] = static_cast<std::size_t>(s);
+            }
+
+            std::vector<std::size_t> expected(dim);
+            compute_strides(shape, static_cast<layout>(header.layout), expected);
+            if (expected != strides || compute_size(shape) * sizeof(T) != header.payload_size)
+            {
+                throw binary_error("inconsistent shape and strides");
+            }
+            return header;
+        }
+
+        // Container interface over a buffer owned by someone else, as
+        // required by xarray_adaptor. It cannot be resized.
+        template <class T>
+        class binary_buffer
+        {
+
+        public:
+
+            using value_type = T;
+            using reference = T&;
+            using const_reference = const T&;
+            using pointer = T*;
+            using const_pointer = const T*;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator = pointer;
+            using const_iterator = const_pointer;
+
+            binary_buffer(pointer data, size_type size) noexcept
+                : p_data(data), m_size(size)
+            {
+            }
+
+            size_type size() const noexcept
+            {
+                return m_size;
+            }
+
+            void resize(size_type size)
+            {
+                if (size != m_size)
+                {
+                    throw binary_error("the buffer cannot be resized");
+                }
+            }
+
+            reference operator[](size_type i)
+            {
+                return p_data[i];
+            }
+
+            const_reference operator[](size_type i) const
+            {
+                return p_data[i];
+            }
+
+            pointer data() noexcept
+            {
+                return p_data;
+            }
+
+            const_pointer data() const noexcept
+            {
+                return p_data;
+            }
+
+            iterator begin() noexcept
+            {
+                return p_data;
+            }
+
+            iterator end() noexcept
+            {
+                return p_data + m_size;
+            }
+
+            const_iterator begin() const noexcept
+            {
+                return p_data;
+            }
+
+            const_iterator end() const noexcept
+            {
+                return p_data + m_size;
+            }
+
+            const_iterator cbegin() const noexcept
+            {
+                return p_data;
+            }
+
+            const_iterator cend() const noexcept
+            {
+                return p_data + m_size;
+            }
+
+        private:
+
+            pointer p_data;
+            size_type m_size;
+        };
+
+        template <class E, class = void>
+        struct has_binary_data : std::false_type
+        {
+        };
+
+        template <class E>
+        struct has_binary_data<E, std::enable_if_t<is_container<E>::value>>
+            : has_raw_data<typename E::container_type>
+        {
+        };
+
+        // Layout of the payload written for e: the layout of its buffer if
+        // it is a contiguous container, row-major otherwise.
+        template <class E>
+        inline bool binary_raw_layout(const E& e, layout& l, std::true_type)
+        {
+            if (e.is_contiguous())
+            {
+                l = layout::row_major;
+                return true;
+            }
+            if (is_column_major(e.shape(), e.strides()))
+            {
+                l = layout::column_major;
+                return true;
+            }
+            l = layout::row_major;
+            return false;
+        }
+
+        template <class E>
+        inline bool binary_raw_layout(const E&, layout& l, std::false_type)
+        {
+            l = layout::row_major;
+            return false;
+        }
+
+        template <class E>
+        inline bool binary_raw_layout(const E& e, layout& l)
+        {
+            return binary_raw_layout(e, l, has_binary_data<E>());
+        }
+
+        template <class E>
+        inline const char* binary_raw_data(const E& e, std::true_type)
+        {
+            return reinterpret_cast<const char*>(e.data().data());
+        }
+
+        template <class E>
+        inline const char* binary_raw_data(const E&, std::false_type)
+        {
+            return nullptr;
+        }
+
+        template <class E>
+        inline const char* binary_raw_data(const E& e)
+        {
+            return binary_raw_data(e, has_binary_data<E>());
+        }
+    }
+
+    /*****************************
+     * xbinary_view declaration *
+     *****************************/
+
+    /**
+     * @class xbinary_view
+     * @brief Tensor in binary format held in an external buffer.
+     *
+     * The xbinary_view class gives access to a tensor in binary format
+     * through an xarray_adaptor over the payload of the buffer, without
+     * copying it. It can either read a tensor written by dump_binary, or
+     * write the header of a new tensor so that its elements are computed
+     * in place, for instance in a shared memory region. The buffer must
+     * outlive the view, and its payload must be suitably aligned for \c T.
+     *
+     * @tparam T the value type of the elements
+     */
+    template <class T>
+    class xbinary_view
+    {
+
+    public:
+
+        using buffer_type = detail::binary_buffer<T>;
+        using adaptor_type = xarray_adaptor<buffer_type>;
+        using shape_type = typename adaptor_type::shape_type;
+
+        xbinary_view(char* buffer, std::size_t size);
+        xbinary_view(char* buffer, std::size_t size, const shape_type& shape, layout l = layout::row_major);
+
+        xbinary_view(const xbinary_view&) = delete;
+        xbinary_view& operator=(const xbinary_view&) = delete;
+
+        adaptor_type& adaptor() noexcept;
+        const adaptor_type& adaptor() const noexcept;
+
+        std::size_t size() const noexcept;
+
+    private:
+
+        buffer_type make_buffer(char* buffer, std::size_t size);
+        buffer_type make_buffer(char* buffer, std::size_t size, const shape_type& shape, layout l);
+
+        shape_type m_shape;
+        shape_type m_strides;
+        std::size_t m_size;
+        buffer_type m_buffer;
+        adaptor_type m_adaptor;
+    };
+
+    /**************************
+     * dump and load binaries *
+     **************************/
+
+    /**
+     * @name Binary format
+     */
+    //@{
+    /**
+     * Returns the number of bytes of a tensor of the given shape in
+     * binary format.
+     * @tparam T the value type of the tensor
+     * @param shape the shape of the tensor
+     */
+    template <class T, class S>
+    inline std::size_t binary_size(const S& shape)
+    {
+        return detail::binary_payload_offset(shape.size()) + compute_size(shape) * sizeof(T);
+    }
+
+    /**
+     * Returns the number of bytes of an expression in binary format.
+     * @param e the expression
+     */
+    template <class E>
+    inline std::size_t binary_size(const xexpression<E>& e)
+    {
+        return binary_size<typename E::value_type>(e.derived_cast().shape());
+    }
+
+    /**
+     * Writes an expression in binary format into a buffer. The elements of
+     * contiguous containers are copied in a single block.
+     * @param buffer the buffer to write into
+     * @param size the size of the buffer, at least binary_size(e)
+     * @param e the expression to write
+     * @return the number of bytes written
+     */
+    template <class E>
+    inline std::size_t dump_binary(char* buffer, std::size_t size, const xexpression<E>& e)
+    {
+        using value_type = typename E::value_type;
+        const E& de = e.derived_cast();
+        std::size_t res = binary_size(e);
+        if (size < res)
+        {
+            throw detail::binary_error("the buffer is too small");
+        }
+        layout l;
+        bool raw = detail::binary_raw_layout(de, l);
+        detail::write_binary_header<value_type>(buffer, de.shape(), l);
+        char* out = buffer + detail::binary_payload_offset(de.dimension());
+        std::size_t nb_elements = compute_size(de.shape());
+        if (raw)
+        {
+            std::memcpy(out, detail::binary_raw_data(de), nb_elements * sizeof(value_type));
+        }
+        else
+        {
+            auto it = de.cxbegin();
+            for (std::size_t i = 0; i < nb_elements; ++i, ++it, out += sizeof(value_type))
+            {
+                const value_type v = *it;
+                std::memcpy(out, &v, sizeof(value_type));
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Writes an expression in binary format to a stream.
+     * @param stream the output stream, opened in binary mode
+     * @param e the expression to write
+     */
+    template <class E>
+    inline void dump_binary(std::ostream& stream, const xexpression<E>& e)
+    {
+        using value_type = typename E::value_type;
+        const E& de = e.derived_cast();
+        layout l;
+        bool raw = detail::binary_raw_layout(de, l);
+        std::vector<char> header(detail::binary_payload_offset(de.dimension()));
+        detail::write_binary_header<value_type>(header.data(), de.shape(), l);
+        stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+        std::size_t nb_elements = compute_size(de.shape());
+        if (raw)
+        {
+            stream.write(detail::binary_raw_data(de), static_cast<std::streamsize>(nb_elements * sizeof(value_type)));
+        }
+        else
+        {
+            detail::write_npy_elements(stream, de.cxbegin(), nb_elements);
+        }
+    }
+
+    /**
+     * Reads a tensor in binary format from a stream, and returns it as an
+     * xarray with the layout of the payload.
+     * @tparam T the value type of the tensor
+     * @param stream the input stream, opened in binary mode
+     */
+    template <class T>
+    inline xarray<T> load_binary(std::istream& stream)
+    {
+        std::vector<char> buffer(8 + sizeof(detail::binary_header));
+        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        detail::binary_header header;
+        if (!stream || std::memcmp(buffer.data(), "XTBINARY", 8) != 0)
+        {
+            throw detail::binary_error("invalid header");
+        }
+        std::memcpy(&header, buffer.data() + 8, sizeof(detail::binary_header));
+        if (header.payload_offset < buffer.size() || header.payload_offset > std::uint64_t(1) << 32)
+        {
+            throw detail::binary_error("invalid header");
+        }
+        buffer.resize(static_cast<std::size_t>(header.payload_offset));
+        stream.read(buffer.data() + 8 + sizeof(detail::binary_header),
+                    static_cast<std::streamsize>(buffer.size() - 8 - sizeof(detail::binary_header)));
+
+        std::vector<std::size_t> shape, strides;
+        header = detail::read_binary_header<T>(buffer.data(), buffer.size() + static_cast<std::size_t>(header.payload_size),
+                                               shape, strides);
+        xarray<T> res;
+        res.reshape(typename xarray<T>::shape_type(shape.cbegin(), shape.cend()), static_cast<layout>(header.layout));
+        stream.read(reinterpret_cast<char*>(res.data().data()), static_cast<std::streamsize>(header.payload_size));
+        if (!stream)
+        {
+            throw detail::binary_error("unexpected end of stream");
+        }
+        return res;
+    }
+    //@}
+
+    /*******************************
+     * xbinary_view implementation *
+     *******************************/
+
+    /**
+     * @name Constructors
+     */
+    //@{
+    /**
+     * Opens a tensor in binary format held in a buffer.
+     * @param buffer the buffer holding the tensor
+     * @param size the size of the buffer
+     */
+    template <class T>
+    inline xbinary_view<T>::xbinary_view(char* buffer, std::size_t size)
+        : m_buffer(make_buffer(buffer, size)), m_adaptor(m_buffer, m_shape, m_strides)
+    {
+    }
+
+    /**
+     * Writes the header of a tensor in binary format into a buffer. The
+     * elements are left uninitialized, to be assigned through the adaptor.
+     * @param buffer the buffer to write into
+     * @param size the size of the buffer, at least binary_size<T>(shape)
+     * @param shape the shape of the tensor
+     * @param l the layout of the elements
+     */
+    template <class T>
+    inline xbinary_view<T>::xbinary_view(char* buffer, std::size_t size, const shape_type& shape, layout l)
+        : m_buffer(make_buffer(buffer, size, shape, l)), m_adaptor(m_buffer, m_shape, m_strides)
+    {
+    }
+    //@}
+
+    /**
+     * Returns the adaptor over the elements of the tensor.
+     */
+    template <class T>
+    inline auto xbinary_view<T>::adaptor() noexcept -> adaptor_type&
+    {
+        return m_adaptor;
+    }
+
+    /**
+     * Returns the adaptor over the elements of the tensor.
+     */
+    template <class T>
+    inline auto xbinary_view<T>::adaptor() const noexcept -> const adaptor_type&
+    {
+        return m_adaptor;
+    }
+
+    /**
+     * Returns the number of bytes of the tensor in binary format.
+     */
+    template <class T>
+    inline std::size_t xbinary_view<T>::size() const noexcept
+    {
+        return m_size;
+    }
+
+    template <class T>
+    inline auto xbinary_view<T>::make_buffer(char* buffer, std::size_t size) -> buffer_type
+    {
+        std::vector<std::size_t> shape, strides;
+        detail::binary_header header = detail::read_binary_header<T>(buffer, size, shape, strides);
+        char* payload = buffer + header.payload_offset;
+        if (reinterpret_cast<std::uintptr_t>(payload) % alignof(T) != 0)
+        {
+            throw detail::binary_error("the payload is not aligned");
+        }
+        m_shape.assign(shape.cbegin(), shape.cend());
+        m_strides.assign(strides.cbegin(), strides.cend());
+        m_size = static_cast<std::size_t>(header.payload_offset + header.payload_size);
+        return buffer_type(reinterpret_cast<T*>(payload), compute_size(m_shape));
+    }
+
+    template <class T>
+    inline auto xbinary_view<T>::make_buffer(char* buffer, std::size_t size, const shape_type& shape, layout l) -> buffer_type
+    {
+        m_size = binary_size<T>(shape);
+        if (size < m_size)
+        {
+            throw detail::binary_error("the buffer is too small");
+        }
+        detail::write_binary_header<T>(buffer, shape, l);
+        return make_buffer(buffer, size);
+    }
+}
+
+#endif
@@ -0,0 +1,529 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_HPP
+#define XBLAS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "xexecutor.hpp"
+
+#ifdef XTENSOR_USE_BLAS
+extern "C"
+{
+    void sgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                const float* alpha, const float* a, const int* lda, const float* b, const int* ldb,
+                const float* beta, float* c, const int* ldc);
+
+    void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                const double* alpha, const double* a, const int* lda, const double* b, const int* ldb,
+                const double* beta, double* c, const int* ldc);
+}
+#endif
+
+namespace xt
+{
+
+    /******************
+     * gemm internals *
+     ******************/
+
+    namespace detail
+    {
+        // Register block of the micro-kernel: gemm_mr rows of A times
+        // gemm_nr<T>() columns of B. A row of the block spans 64 bytes,
+        // or 128 bytes for types narrower than double, which keeps enough
+        // independent accumulators in flight once vectorized.
+        constexpr std::size_t gemm_mr = 4;
+
+        template <class T>
+        constexpr std::size_t gemm_nr() noexcept
+        {
+            return sizeof(T) < 8 ? 128 / sizeof(T) : (sizeof(T) < 64 ? 64 / sizeof(T) : 1);
+        }
+
+        // Cache blocks: a kc x nr panel of B stays in L1, an mc x kc block
+        // of A in L2 and a kc x nc block of B in L3.
+        constexpr std::size_t gemm_kc = 256;
+        constexpr std::size_t gemm_mc = 96;
+        constexpr std::size_t gemm_nc = 2048;
+
+        // Number of multiply-adds below which gemm runs on a single thread.
+        constexpr std::size_t gemm_parallel_threshold = std::size_t(1) << 21;
+
+        template <class T>
+        struct gemm_matrix
+        {
+            const T* data;
+            std::ptrdiff_t row_stride;
+            std::ptrdiff_t col_stride;
+
+            const T& operator()(std::size_t i, std::size_t j) const noexcept
+            {
+                return data[static_cast<std::ptrdiff_t>(i) * row_stride + static_cast<std::ptrdiff_t>(j) * col_stride];
+            }
+        };
+
+        // Packs the mc x kc block of a starting at (i0, p0) in panels of
+        // gemm_mr rows, each panel being stored column by column. The last
+        // panel is padded with zeros.
+        template <class T>
+        inline void gemm_pack_a(const gemm_matrix<T>& a, std::size_t i0, std::size_t p0,
+                                std::size_t mc, std::size_t kc, T* buffer)
+        {
+            constexpr std::size_t mr = gemm_mr;
+            for (std::size_t i = 0; i < mc; i += mr)
+            {
+                std::size_t rows = std::min(mr, mc - i);
+                for (std::size_t p = 0; p < kc; ++p)
+                {
+                    std::size_t r = 0;
+                    for (; r < rows; ++r)
+                    {
+                        buffer[r] = a(i0 + i + r, p0 + p);
+                    }
+                    for (; r < mr; ++r)
+                    {
+                        buffer[r] = T(0);
+                    }
+                    buffer += mr;
+                }
+            }
+        }
+
+        // Packs the kc x nc block of b starting at (p0, j0) in panels of
+        // gemm_nr columns, each panel being stored row by row. The last
+        // panel is padded with zeros.
+        template <class T>
+        inline void gemm_pack_b(const gemm_matrix<T>& b, std::size_t p0, std::size_t j0,
+                                std::size_t kc, std::size_t nc, T* buffer)
+        {
+            constexpr std::size_t nr = gemm_nr<T>();
+            for (std::size_t j = 0; j < nc; j += nr)
+            {
+                std::size_t cols = std::min(nr, nc - j);
+                for (std::size_t p = 0; p < kc; ++p)
+                {
+                    std::size_t c = 0;
+                    for (; c < cols; ++c)
+                    {
+                        buffer[c] = b(p0 + p, j0 + j + c);
+                    }
+                    for (; c < nr; ++c)
+                    {
+                        buffer[c] = T(0);
+                    }
+                    buffer += nr;
+                }
+            }
+        }
+
+        // Accumulates the product of a packed panel of A and a packed panel
+        // of B into the rows x cols block of C at c. The accumulators have
+        // a fixed size so that the compiler keeps them in vector registers.
+        template <class T>
+        inline void gemm_kernel(std::size_t kc, const T* a, const T* b,
+                                T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc,
+                                std::size_t rows, std::size_t cols)
+        {
+            constexpr std::size_t mr = gemm_mr;
+            constexpr std::size_t nr = gemm_nr<T>();
+            T acc[mr][nr] = {};
+            for (std::size_t p = 0; p < kc; ++p)
+            {
+                for (std::size_t r = 0; r < mr; ++r)
+                {
+                    const T ar = a[r];
+                    for (std::size_t j = 0; j < nr; ++j)
+                    {
+                        acc[r][j] += ar * b[j];
+                    }
+                }
+                a += mr;
+                b += nr;
+            }
+            for (std::size_t r = 0; r < rows; ++r)
+            {
+                T* row = c + static_cast<std::ptrdiff_t>(r) * rsc;
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    row[static_cast<std::ptrdiff_t>(j) * csc] += acc[r][j];
+                }
+            }
+        }
+
+        // C += A * B on a single thread, with A m x k, B k x n and C m x n.
+        template <class T>
+        inline void gemm_serial(std::size_t m, std::size_t n, std::size_t k,
+                                const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                                T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            constexpr std::size_t mr = gemm_mr;
+            constexpr std::size_t nr = gemm_nr<T>();
+            std::size_t kc_max = std::min(gemm_kc, k);
+            std::size_t mc_max = std::min(gemm_mc, (m + mr - 1) / mr * mr);
+            std::size_t nc_max = std::min(gemm_nc, (n + nr - 1) / nr * nr);
+            std::vector<T> a_buffer(mc_max * kc_max);
+            std::vector<T> b_buffer(kc_max * nc_max);
+
+            for (std::size_t jc = 0; jc < n; jc += gemm_nc)
+            {
+                std::size_t nc = std::min(gemm_nc, n - jc);
+                for (std::size_t pc = 0; pc < k; pc += gemm_kc)
+                {
+                    std::size_t kc = std::min(gemm_kc, k - pc);
+                    gemm_pack_b(b, pc, jc, kc, nc, b_buffer.data());
+                    for (std::size_t ic = 0; ic < m; ic += gemm_mc)
+                    {
+                        std::size_t mc = std::min(gemm_mc, m - ic);
+                        gemm_pack_a(a, ic, pc, mc, kc, a_buffer.data());
+                        for (std::size_t jr = 0; jr < nc; jr += nr)
+                        {
+                            const T* bp = b_buffer.data() + jr * kc;
+                            for (std::size_t ir = 0; ir < mc; ir += mr)
+                            {
+                                const T* ap = a_buffer.data() + ir * kc;
+                                T* cp = c + static_cast<std::ptrdiff_t>(ic + ir) * rsc
+                                          + static_cast<std::ptrdiff_t>(jc + jr) * csc;
+                                gemm_kernel(kc, ap, bp, cp, rsc, csc,
+                                            std::min(mr, mc - ir), std::min(nr, nc - jr));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Products below this number of multiply-adds skip packing.
+        constexpr std::size_t gemm_small_threshold = std::size_t(1) << 15;
+
+        // Product of matrices of sizes known at compile time: the operands
+        // are copied to local arrays, A being transposed, so that all the
+        // loops have constant bounds and the update of each row of C by a
+        // row of B is unrolled and vectorized by the compiler.
+        template <std::size_t M, std::size_t N, std::size_t K, class T>
+        inline void gemm_fixed(const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                               T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            T la[K][M];
+            T lb[K][N];
+            T acc[M][N] = {};
+            for (std::size_t i = 0; i < M; ++i)
+            {
+                for (std::size_t p = 0; p < K; ++p)
+                {
+                    la[p][i] = a(i, p);
+                }
+            }
+            for (std::size_t p = 0; p < K; ++p)
+            {
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    lb[p][j] = b(p, j);
+                }
+            }
+            for (std::size_t p = 0; p < K; ++p)
+            {
+                for (std::size_t i = 0; i < M; ++i)
+                {
+                    const T aip = la[p][i];
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        acc[i][j] += aip * lb[p][j];
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < M; ++i)
+            {
+                T* row = c + static_cast<std::ptrdiff_t>(i) * rsc;
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    row[static_cast<std::ptrdiff_t>(j) * csc] += acc[i][j];
+                }
+            }
+        }
+
+        // Unpacked product for small operands, accumulating rows of B into
+        // rows of C.
+        template <class T>
+        inline void gemm_small(std::size_t m, std::size_t n, std::size_t k,
+                               const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                               T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                T* row = c + static_cast<std::ptrdiff_t>(i) * rsc;
+                for (std::size_t p = 0; p < k; ++p)
+                {
+                    const T aip = a(i, p);
+                    const T* brow = b.data + static_cast<std::ptrdiff_t>(p) * b.row_stride;
+                    for (std::size_t j = 0; j < n; ++j)
+                    {
+                        row[static_cast<std::ptrdiff_t>(j) * csc] += aip * brow[static_cast<std::ptrdiff_t>(j) * b.col_stride];
+                    }
+                }
+            }
+        }
+
+        // C += A * B on the calling thread, with dedicated kernels for
+        // square products of size 4, 8 and 16 and no packing for small
+        // operands.
+        template <class T>
+        inline void gemm_block(std::size_t m, std::size_t n, std::size_t k,
+                               const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                               T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            if (m == n && n == k)
+            {
+                switch (m)
+                {
+                case 4:
+                    gemm_fixed<4, 4, 4>(a, b, c, rsc, csc);
+                    return;
+                case 8:
+                    gemm_fixed<8, 8, 8>(a, b, c, rsc, csc);
+                    return;
+                case 16:
+                    gemm_fixed<16, 16, 16>(a, b, c, rsc, csc);
+                    return;
+                default:
+                    break;
+                }
+            }
+            if (m * n * k < gemm_small_threshold)
+            {
+                gemm_small(m, n, k, a, b, c, rsc, csc);
+            }
+            else
+            {
+                gemm_serial(m, n, k, a, b, c, rsc, csc);
+            }
+        }
+
+        // Splits C in blocks of rows (or of columns when C is wide) computed
+        // concurrently; each task packs its own operands.
+        template <class T>
+        inline void gemm_parallel(std::size_t m, std::size_t n, std::size_t k,
+                                  const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                                  T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            std::size_t work = m * n * k;
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(ex.concurrency(), work / gemm_parallel_threshold + 1);
+            bool by_rows = m >= n;
+            std::size_t unit = by_rows ? gemm_mr : gemm_nr<T>();
+            std::size_t extent = by_rows ? m : n;
+            std::size_t block = ((extent + nb_tasks - 1) / nb_tasks + unit - 1) / unit * unit;
+            if (nb_tasks < 2 || block >= extent)
+            {
+                gemm_serial(m, n, k, a, b, c, rsc, csc);
+                return;
+            }
+
+            auto task = [&](std::size_t first) {
+                std::size_t size = std::min(block, extent - first);
+                std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(first);
+                if (by_rows)
+                {
+                    gemm_matrix<T> sub_a = {a.data + offset * a.row_stride, a.row_stride, a.col_stride};
+                    gemm_serial(size, n, k, sub_a, b, c + offset * rsc, rsc, csc);
+                }
+                else
+                {
+                    gemm_matrix<T> sub_b = {b.data + offset * b.col_stride, b.row_stride, b.col_stride};
+                    gemm_serial(m, size, k, a, sub_b, c + offset * csc, rsc, csc);
+                }
+            };
+
+            parallel_for(ex, (extent + block - 1) / block, [&](std::size_t t) { task(t * block); });
+        }
+
+#ifdef XTENSOR_USE_BLAS
+        // Describes a rows x cols matrix with the given strides as a
+        // column-major BLAS operand holding its transpose; returns false
+        // if no leading dimension fits.
+        inline bool blas_transposed_operand(std::size_t rows, std::size_t cols,
+                                            std::ptrdiff_t rs, std::ptrdiff_t cs,
+                                            char& trans, int& ld)
+        {
+            constexpr auto int_max = static_cast<std::ptrdiff_t>(std::numeric_limits<int>::max());
+            std::ptrdiff_t r = static_cast<std::ptrdiff_t>(rows);
+            std::ptrdiff_t c = static_cast<std::ptrdiff_t>(cols);
+            // strides along axes of length one are irrelevant
+            if (c == 1)
+            {
+                cs = 1;
+            }
+            if (r == 1)
+            {
+                rs = std::max(c, std::ptrdiff_t(1));
+            }
+            if (cs == 1 && rs >= std::max(c, std::ptrdiff_t(1)) && rs <= int_max)
+            {
+                trans = 'N';
+                ld = static_cast<int>(rs);
+                return true;
+            }
+            if (rs == 1 && cs >= std::max(r, std::ptrdiff_t(1)) && cs <= int_max)
+            {
+                trans = 'T';
+                ld = static_cast<int>(cs);
+                return true;
+            }
+            return false;
+        }
+
+        inline void blas_gemm(const char* ta, const char* tb, const int* m, const int* n, const int* k,
+                              const float* a, const int* lda, const float* b, const int* ldb,
+                              float* c, const int* ldc)
+        {
+            const float one = 1.f;
+            sgemm_(ta, tb, m, n, k, &one, a, lda, b, ldb, &one, c, ldc);
+        }
+
+        inline void blas_gemm(const char* ta, const char* tb, const int* m, const int* n, const int* k,
+                              const double* a, const int* lda, const double* b, const int* ldb,
+                              double* c, const int* ldc)
+        {
+            const double one = 1.;
+            dgemm_(ta, tb, m, n, k, &one, a, lda, b, ldb, &one, c, ldc);
+        }
+
+        // The row-major product C = A * B is computed by BLAS as the
+        // column-major product C^T = B^T * A^T.
+        template <class T>
+        inline bool gemm_blas(std::size_t m, std::size_t n, std::size_t k,
+                              const gemm_matrix<T>& a, const gemm_matrix<T>& b,
+                              T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc, std::true_type)
+        {
+            constexpr auto int_max = static_cast<std::size_t>(std::numeric_limits<int>::max());
+            if (m > int_max || n > int_max || k > int_max ||
+                !(csc == 1 && (m == 1 || rsc == static_cast<std::ptrdiff_t>(n))))
+            {
+                return false;
+            }
+            char ta, tb;
+            int lda, ldb;
+            if (!blas_transposed_operand(k, n, b.row_stride, b.col_stride, ta, lda) ||
+                !blas_transposed_operand(m, k, a.row_stride, a.col_stride, tb, ldb))
+            {
+                return false;
+            }
+            int bm = static_cast<int>(n);
+            int bn = static_cast<int>(m);
+            int bk = static_cast<int>(k);
+            int ldc = std::max(bm, 1);
+            blas_gemm(&ta, &tb, &bm, &bn, &bk, b.data, &lda, a.data, &ldb, c, &ldc);
+            return true;
+        }
+#endif
+
+        template <class T>
+        inline bool gemm_blas(std::size_t, std::size_t, std::size_t,
+                              const gemm_matrix<T>&, const gemm_matrix<T>&,
+                              T*, std::ptrdiff_t, std::ptrdiff_t, std::false_type)
+        {
+            return false;
+        }
+
+        template <class T>
+        using gemm_has_blas = std::integral_constant<bool,
+#ifdef XTENSOR_USE_BLAS
+                                                     std::is_same<T, float>::value || std::is_same<T, double>::value
+#else
+                                                     false
+#endif
+                                                     >;
+
+        /**
+         * Accumulates the product of the m x k matrix A and the k x n
+         * matrix B into the m x n matrix C. Each matrix is described by a
+         * pointer to its first element and signed row and column strides.
+         * When XTENSOR_USE_BLAS is defined, float and double products whose
+         * operands have a unit stride are forwarded to the installed BLAS.
+         */
+        template <class T>
+        inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+                         const T* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                         const T* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                         T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            if (m == 0 || n == 0 || k == 0)
+            {
+                return;
+            }
+            gemm_matrix<T> ma = {a, rsa, csa};
+            gemm_matrix<T> mb = {b, rsb, csb};
+            if (gemm_blas(m, n, k, ma, mb, c, rsc, csc, gemm_has_blas<T>()))
+            {
+                return;
+            }
+            if (m * n * k < gemm_parallel_threshold)
+            {
+                gemm_block(m, n, k, ma, mb, c, rsc, csc);
+            }
+            else
+            {
+                gemm_parallel(m, n, k, ma, mb, c, rsc, csc);
+            }
+        }
+
+        /**
+         * Computes nb products of m x k and k x n matrices. The i-th product
+         * reads A at a + offsets_a[i] and B at b + offsets_b[i], and is
+         * accumulated into the i-th m x n row-major block of c. Small
+         * products are distributed over several threads, large ones are
+         * computed one after the other by gemm.
+         */
+        template <class T>
+        inline void gemm_batch(std::size_t nb, std::size_t m, std::size_t n, std::size_t k,
+                               const T* a, const std::ptrdiff_t* offsets_a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                               const T* b, const std::ptrdiff_t* offsets_b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                               T* c)
+        {
+            std::size_t work = m * n * k;
+            if (nb == 0 || work == 0)
+            {
+                return;
+            }
+            std::ptrdiff_t c_size = static_cast<std::ptrdiff_t>(m * n);
+            std::ptrdiff_t rsc = static_cast<std::ptrdiff_t>(n);
+            if (nb == 1 || work >= gemm_parallel_threshold)
+            {
+                for (std::size_t i = 0; i < nb; ++i)
+                {
+                    gemm(m, n, k, a + offsets_a[i], rsa, csa, b + offsets_b[i], rsb, csb,
+                         c + static_cast<std::ptrdiff_t>(i) * c_size, rsc, std::ptrdiff_t(1));
+                }
+                return;
+            }
+
+            auto task = [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    gemm_matrix<T> ma = {a + offsets_a[i], rsa, csa};
+                    gemm_matrix<T> mb = {b + offsets_b[i], rsb, csb};
+                    gemm_block(m, n, k, ma, mb, c + static_cast<std::ptrdiff_t>(i) * c_size, rsc, std::ptrdiff_t(1));
+                }
+            };
+
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(std::min(ex.concurrency(), nb), nb * work / gemm_parallel_threshold + 1);
+            std::size_t block = (nb + nb_tasks - 1) / nb_tasks;
+            parallel_for(ex, (nb + block - 1) / block, [&](std::size_t t) {
+                task(t * block, std::min((t + 1) * block, nb));
+            });
+        }
+    }
+}
+
+#endif
@@ -110,6 +110,7 @@ namespace xt
         size_type size() const noexcept;
         size_type dimension() const noexcept;
         const inner_shape_type& shape() const noexcept;
+        const xexpression_type& expression() const noexcept;
 
         template <class... Args>
         const_reference operator()(Args... args) const;
@@ -229,6 +230,15 @@ namespace xt
     {
         return m_shape;
     }
+
+    /**
+     * Returns the broadcast expression.
+     */
+    template <class CT, class X>
+    inline auto xbroadcast<CT, X>::expression() const noexcept -> const xexpression_type&
+    {
+        return m_e;
+    }
     //@}
 
     /**
@@ -13,13 +13,20 @@
 #ifndef XBUILDER_HPP
 #define XBUILDER_HPP
 
+#include <algorithm>
 #include <utility>
 #include <functional>
 #include <cmath>
+#include <iterator>
+#include <numeric>
 
+#include "xtensor_forward.hpp"
 #include "xfunction.hpp"
 #include "xbroadcast.hpp"
+#include "xexecutor.hpp"
 #include "xgenerator.hpp"
+#include "xview.hpp"
+#include "xstrided_view.hpp"
 
 #ifdef X_OLD_CLANG
     #include <initializer_list>
@@ -111,6 +118,17 @@ namespace xt
                 return m_start + m_step * T(*first);
             }
 
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                auto& data = e.data();
+                std::size_t size = e.size();
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    data[i] = m_start + m_step * T(i);
+                }
+            }
+
         private:
             value_type m_start;
             value_type m_stop;
@@ -151,6 +169,12 @@ namespace xt
                 return access_impl(first, last);
             }
 
+            template <class E, class FF = F, class = decltype(std::declval<const FF&>().assign_to(std::declval<E&>()))>
+            inline void assign_to(E& e) const
+            {
+                m_ft.assign_to(e);
+            }
+
         private:
             F m_ft;
             template <class It>
@@ -175,9 +199,76 @@ namespace xt
                 return *(end - 1) == *(end - 2) + m_k ? T(1) : T(0);
             }
 
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                auto& data = e.data();
+                std::fill(data.begin(), data.end(), T(0));
+
+                const auto& shape = e.shape();
+                std::size_t nb_rows = shape[shape.size() - 2];
+                std::size_t nb_cols = shape[shape.size() - 1];
+                std::size_t matrix_size = nb_rows * nb_cols;
+                std::size_t first_row = m_k < 0 ? std::size_t(-m_k) : 0;
+                std::size_t first_col = m_k > 0 ? std::size_t(m_k) : 0;
+                if (matrix_size == 0 || first_row >= nb_rows || first_col >= nb_cols)
+                {
+                    return;
+                }
+
+                std::size_t nb_matrices = e.size() / matrix_size;
+                std::size_t diag_size = std::min(nb_rows - first_row, nb_cols - first_col);
+                for (std::size_t m = 0; m < nb_matrices; ++m)
+                {
+                    std::size_t offset = m * matrix_size + first_row * nb_cols + first_col;
+                    for (std::size_t i = 0; i < diag_size; ++i, offset += nb_cols + 1)
+                    {
+                        data[offset] = T(1);
+                    }
+                }
+            }
+
         private:
             int m_k;
         };
+
+        template <class T>
+        struct logspace_impl
+        {
+            using value_type = decltype(std::pow(std::declval<T>(), std::declval<T>()));
+
+            logspace_impl(T start, T stop, T step, T base)
+                : m_linspace(start, stop, step), m_base(base)
+            {
+            }
+
+            template <class... Args>
+            inline value_type operator()(Args... args) const
+            {
+                return std::pow(m_base, m_linspace(args...));
+            }
+
+            template <class It>
+            inline value_type element(It first, It last) const
+            {
+                return std::pow(m_base, m_linspace.element(first, last));
+            }
+
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                auto& data = e.data();
+                std::size_t size = e.size();
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    data[i] = std::pow(m_base, m_linspace(i));
+                }
+            }
+
+        private:
+            arange_impl<T> m_linspace;
+            T m_base;
+        };
     }
 
     /**
@@ -267,11 +358,107 @@ namespace xt
     template <class T>
     inline auto logspace(T start, T stop, std::size_t num_samples, T base = 10, bool endpoint = true) noexcept
     {
-        return pow(std::forward<T>(base), linspace(start, stop, num_samples, endpoint));
+        T step = (stop - start) / T(num_samples - (endpoint ? 1 : 0));
+        return detail::make_xgenerator(detail::logspace_impl<T>(start, stop, step, base), {num_samples});
     }
 
     namespace detail
     {
+        template <class It, class O>
+        inline It copy_slab(It first, std::size_t n, O d_first, std::random_access_iterator_tag)
+        {
+            std::copy(first, first + n, d_first);
+            return first + n;
+        }
+
+        template <class It, class O, class Tag>
+        inline It copy_slab(It first, std::size_t n, O d_first, Tag)
+        {
+            for (std::size_t i = 0; i < n; ++i, ++first, ++d_first)
+            {
+                *d_first = *first;
+            }
+            return first;
+        }
+
+        // Number of copied elements above which the slabs are copied by several threads.
+        constexpr std::size_t slab_parallel_threshold = std::size_t(1) << 20;
+
+        template <class It, class O, class Tag>
+        inline void copy_slabs(It first, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride, Tag tag)
+        {
+            for (std::size_t i = 0; i < nb_slabs; ++i)
+            {
+                first = copy_slab(first, block, d_first + i * stride, tag);
+            }
+        }
+
+        // Random access sources are split in ranges of slabs copied in parallel.
+        template <class It, class O>
+        inline void copy_slabs(It first, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride,
+                               std::random_access_iterator_tag)
+        {
+            std::size_t size = nb_slabs * block;
+            if (size < slab_parallel_threshold)
+            {
+                for (std::size_t i = 0; i < nb_slabs; ++i)
+                {
+                    std::copy(first + i * block, first + (i + 1) * block, d_first + i * stride);
+                }
+                return;
+            }
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(std::min(ex.concurrency(), nb_slabs), size / slab_parallel_threshold + 1);
+            std::size_t grain = (nb_slabs + nb_tasks - 1) / nb_tasks;
+            parallel_for(ex, (nb_slabs + grain - 1) / grain, [&](std::size_t t) {
+                std::size_t last = std::min((t + 1) * grain, nb_slabs);
+                for (std::size_t i = t * grain; i < last; ++i)
+                {
+                    std::copy(first + i * block, first + (i + 1) * block, d_first + i * stride);
+                }
+            });
+        }
+
+        // Copies the elements in [first, first + nb_slabs * block) into nb_slabs
+        // blocks of contiguous elements, the i-th block starting at d_first + i * stride.
+        template <class It, class O>
+        inline void copy_slabs(It first, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride)
+        {
+            using category = typename std::iterator_traits<It>::iterator_category;
+            copy_slabs(first, d_first, nb_slabs, block, stride, category());
+        }
+
+        template <class E, class O>
+        inline void assign_slabs(const E& e, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride, std::true_type)
+        {
+            if (e.is_contiguous())
+            {
+                copy_slabs(e.data().cbegin(), d_first, nb_slabs, block, stride);
+            }
+            else
+            {
+                copy_slabs(e.cxbegin(), d_first, nb_slabs, block, stride);
+            }
+        }
+
+        template <class E, class O>
+        inline void assign_slabs(const E& e, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride, std::false_type)
+        {
+            copy_slabs(e.cxbegin(), d_first, nb_slabs, block, stride);
+        }
+
+        template <class E, class O>
+        inline void assign_slabs(const E& e, O d_first, std::size_t nb_slabs, std::size_t block, std::size_t stride)
+        {
+            assign_slabs(e, d_first, nb_slabs, block, stride, is_container<E>());
+        }
+
+        template <class S>
+        inline std::size_t shape_product(const S& shape, std::size_t first, std::size_t last)
+        {
+            return std::accumulate(shape.cbegin() + first, shape.cbegin() + last, std::size_t(1), std::multiplies<std::size_t>());
+        }
+
         template <class... CT>
         struct concatenate_impl
         {
@@ -297,6 +484,25 @@ namespace xt
                 return access_impl(xindex(first, last));
             }
 
+            // Copies each input as nb_slabs contiguous blocks of
+            // shape[axis] * inner elements.
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                const auto& shape = e.shape();
+                size_type nb_slabs = shape_product(shape, 0, m_axis);
+                size_type inner = shape_product(shape, m_axis + 1, shape.size());
+                size_type stride = shape[m_axis] * inner;
+                auto d_first = e.data().begin();
+                size_type offset = 0;
+                auto assign_input = [&](const auto& arr) {
+                    size_type block = arr.shape()[m_axis] * inner;
+                    assign_slabs(arr, d_first + offset, nb_slabs, block, stride);
+                    offset += block;
+                };
+                for_each(assign_input, m_t);
+            }
+
         private:
 
             inline value_type access_impl(xindex idx) const
@@ -356,6 +562,24 @@ namespace xt
                 return access_impl(xindex(first, last));
             }
 
+            // Each input is copied as nb_slabs contiguous blocks, the blocks
+            // of the different inputs being interleaved in the result.
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                const auto& shape = e.shape();
+                size_type nb_slabs = shape_product(shape, 0, m_axis);
+                size_type block = shape_product(shape, m_axis + 1, shape.size());
+                size_type stride = sizeof...(CT) * block;
+                auto d_first = e.data().begin();
+                size_type offset = 0;
+                auto assign_input = [&](const auto& arr) {
+                    assign_slabs(arr, d_first + offset, nb_slabs, block, stride);
+                    offset += block;
+                };
+                for_each(assign_input, m_t);
+            }
+
         private:
 
             inline value_type access_impl(xindex idx) const
@@ -372,37 +596,6 @@ namespace xt
             const std::tuple<CT...> m_t;
             const size_type m_axis;
         };
-
-        template <class CT>
-        struct repeat_impl
-        {
-            using xexpression_type = std::decay_t<CT>;
-            using size_type = typename xexpression_type::size_type;
-            using value_type = typename xexpression_type::value_type;
-
-            repeat_impl(CT source, size_type axis) :
-                m_source(source), m_axis(axis)
-            {
-            }
-
-            template <class... Args>
-            value_type operator()(Args... args) const
-            {
-                std::array<size_type, sizeof...(Args)> args_arr({static_cast<size_type>(args)...});
-                return m_source(args_arr[m_axis]);
-            }
-
-            template <class It>
-            inline value_type element(It first, It) const
-            {
-                return m_source(*(first + m_axis));
-            }
-
-        private:
-
-            CT m_source;
-            size_type m_axis;
-        };
     }
 
     /**
@@ -491,26 +684,31 @@ namespace xt
 
     namespace detail
     {
+        template <std::size_t I>
+        inline auto make_newaxis() noexcept
+        {
+            return newaxis();
+        }
+
+        // view of the 1-D expression e with N trailing new axes, i.e. of
+        // shape (n, 1, ..., 1)
+        template <class E, std::size_t... J>
+        inline auto make_meshgrid_view(E&& e, std::index_sequence<J...>) noexcept
+        {
+            return view(std::forward<E>(e), all(), make_newaxis<J>()...);
+        }
+
+        template <std::size_t N, std::size_t I, class E, class S>
+        inline auto make_meshgrid_axis(E&& e, const S& shape) noexcept
+        {
+            return broadcast(make_meshgrid_view(std::forward<E>(e), std::make_index_sequence<N - I - 1>()), shape);
+        }
 
         template <std::size_t... I, class... E>
         inline auto meshgrid_impl(std::index_sequence<I...>, E&&... e) noexcept
         {
-#if defined X_OLD_CLANG || defined _MSC_VER
-            const std::array<std::size_t, sizeof...(E)> shape { e.shape()[0]... };
-            return std::make_tuple(
-                detail::make_xgenerator(
-                    detail::repeat_impl<xclosure_t<E>>(std::forward<E>(e), I),
-                    shape
-                )...
-            );
-#else
-            return std::make_tuple(
-                detail::make_xgenerator(
-                    detail::repeat_impl<xclosure_t<E>>(std::forward<E>(e), I),
-                    { e.shape()[0]... }
-                )...
-            );
-#endif
+            const std::array<std::size_t, sizeof...(E)> shape = {{e.shape()[0]...}};
+            return std::make_tuple(make_meshgrid_axis<sizeof...(E), I>(std::forward<E>(e), shape)...);
         }
     }
 
@@ -519,8 +717,11 @@ namespace xt
      *        Make N-D coordinate tensor expressions for vectorized evaluations of N-D scalar/vector
      *        fields over N-D grids, given one-dimensional coordinate arrays x1, x2,..., xn.
      *
+     * The k-th returned expression broadcasts a view of the k-th input, so
+     * no element of the grid is computed or stored.
+     *
      * @param e xexpressions to concatenate
-     * @returns tuple of xgenerator expressions.
+     * @returns tuple of xbroadcast expressions.
      */
     template <class... E>
     inline auto meshgrid(E&&... e) noexcept
@@ -596,6 +797,22 @@ namespace xt
                 }
             }
 
+            // Zero-fills e and writes the source on its k-th diagonal.
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                using size_type = typename E::size_type;
+                auto d_first = e.data().begin();
+                std::fill(d_first, e.data().end(), value_type(0));
+                size_type nb_cols = e.shape()[1];
+                size_type first = m_k > 0 ? size_type(m_k) : size_type(-m_k) * nb_cols;
+                size_type n = m_source.shape()[0];
+                for (size_type i = 0; i < n; ++i)
+                {
+                    d_first[first + i * (nb_cols + 1)] = m_source(i);
+                }
+            }
+
         private:
             CT m_source;
             const int m_k;
@@ -642,6 +859,18 @@ namespace xt
             const size_type m_shape_at_axis;
         };
 
+        // Range of the columns kept in the row whose shifted index is
+        // rk = row + k: [0, rk] for tril and [rk, nb_cols) for triu.
+        inline std::pair<long int, long int> trilu_columns(std::greater_equal<long int>, long int rk, long int nb_cols)
+        {
+            return std::make_pair(0l, std::max(0l, std::min(rk + 1, nb_cols)));
+        }
+
+        inline std::pair<long int, long int> trilu_columns(std::less_equal<long int>, long int rk, long int nb_cols)
+        {
+            return std::make_pair(std::max(0l, std::min(rk, nb_cols)), nb_cols);
+        }
+
         template <class CT, class Comp>
         struct trilu_fn
         {
@@ -661,11 +890,161 @@ namespace xt
                 return m_comp(signed_idx_type(*begin) + m_k, signed_idx_type(*(begin + 1))) ? m_source.element(begin, end) : value_type(0);
             }
 
+            // For each row of the matrix spanned by the first two axes, copies
+            // the kept columns as one block and zero-fills the others.
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                assign_rows(e, is_container<xexpression_type>());
+            }
+
         private:
+
+            template <class E>
+            inline void assign_rows(E& e, std::true_type) const
+            {
+                if (m_source.is_contiguous())
+                {
+                    assign_rows(e, m_source.data().cbegin());
+                }
+                else
+                {
+                    assign_rows(e, m_source.cxbegin());
+                }
+            }
+
+            template <class E>
+            inline void assign_rows(E& e, std::false_type) const
+            {
+                assign_rows(e, m_source.cxbegin());
+            }
+
+            template <class E, class It>
+            inline void assign_rows(E& e, It first) const
+            {
+                using size_type = typename E::size_type;
+                using category = typename std::iterator_traits<It>::iterator_category;
+                const auto& shape = e.shape();
+                size_type nb_rows = shape[0];
+                size_type nb_cols = shape.size() > 1 ? shape[1] : 1;
+                size_type inner = shape_product(shape, std::min(shape.size(), size_type(2)), shape.size());
+                auto d_first = e.data().begin();
+                for (size_type r = 0; r < nb_rows; ++r)
+                {
+                    auto range = trilu_columns(m_comp, signed_idx_type(r) + m_k, signed_idx_type(nb_cols));
+                    size_type head = size_type(range.first) * inner;
+                    size_type block = size_type(range.second - range.first) * inner;
+                    size_type tail = nb_cols * inner - head - block;
+                    std::fill(d_first, d_first + head, value_type(0));
+                    std::advance(first, head);
+                    first = copy_slab(first, block, d_first + head, category());
+                    std::fill(d_first + head + block, d_first + head + block + tail, value_type(0));
+                    std::advance(first, tail);
+                    d_first += nb_cols * inner;
+                }
+            }
+
             CT m_source;
             const signed_idx_type m_k;
             const Comp m_comp;
         };
+
+        // the following shape calculation code is an almost verbatim adaptation of numpy:
+        // https://github.com/numpy/numpy/blob/2aabeafb97bea4e1bfa29d946fbf31e1104e7ae0/numpy/core/src/multiarray/item_selection.c#L1799
+        template <class S>
+        inline std::vector<std::size_t> diagonal_shape(const S& shape, int offset, std::size_t axis_1, std::size_t axis_2)
+        {
+            std::size_t n_dim = shape.size();
+            auto ret_shape = std::vector<std::size_t>(n_dim);
+
+            long int dim_1 = static_cast<long int>(shape[axis_1]);
+            long int dim_2 = static_cast<long int>(shape[axis_2]);
+
+            offset >= 0 ? dim_2 -= offset : dim_1 += offset;
+
+            long int diag_size = std::max(0l, std::min(dim_1, dim_2));
+
+            std::size_t i = 0;
+            for (std::size_t idim = 0; idim < n_dim; ++idim)
+            {
+                if (idim != axis_1 && idim != axis_2)
+                {
+                    ret_shape[i++] = shape[idim];
+                }
+            }
+
+            ret_shape[n_dim - 2] = static_cast<std::size_t>(diag_size);
+            ret_shape.pop_back();
+            return ret_shape;
+        }
+
+        // The diagonal of a container is a strided view whose last stride
+        // is the sum of the strides of axis_1 and axis_2.
+        template <class E>
+        inline auto make_diagonal(E&& arr, int offset, std::size_t axis_1, std::size_t axis_2, std::true_type)
+        {
+            using view_type = xstrided_view<xclosure_t<E>>;
+            using difference_type = typename view_type::difference_type;
+            auto ret_shape = diagonal_shape(arr.shape(), offset, axis_1, axis_2);
+            const auto& e_strides = arr.strides();
+            difference_type stride_1 = static_cast<difference_type>(e_strides[axis_1]);
+            difference_type stride_2 = static_cast<difference_type>(e_strides[axis_2]);
+
+            typename view_type::strides_type strides;
+            strides.reserve(ret_shape.size());
+            for (std::size_t idim = 0; idim < e_strides.size(); ++idim)
+            {
+                if (idim != axis_1 && idim != axis_2)
+                {
+                    strides.push_back(static_cast<difference_type>(e_strides[idim]));
+                }
+            }
+            strides.push_back(stride_1 + stride_2);
+
+            difference_type start = 0;
+            if (ret_shape.back() != 0)
+            {
+                start = offset >= 0 ? offset * stride_2 : -offset * stride_1;
+            }
+            return view_type(std::forward<E>(arr), std::move(ret_shape), std::move(strides), start);
+        }
+
+        template <class E>
+        inline auto make_diagonal(E&& arr, int offset, std::size_t axis_1, std::size_t axis_2, std::false_type)
+        {
+            using CT = xclosure_t<E>;
+            auto ret_shape = diagonal_shape(arr.shape(), offset, axis_1, axis_2);
+            return make_xgenerator(fn_impl<diagonal_fn<CT>>(diagonal_fn<CT>(std::forward<E>(arr), offset, axis_1, axis_2)),
+                                   ret_shape);
+        }
+
+        // The flip of a container is a strided view starting at the last
+        // element along axis, with the stride of axis negated.
+        template <class E>
+        inline auto make_flip(E&& arr, std::size_t axis, std::true_type)
+        {
+            using view_type = xstrided_view<xclosure_t<E>>;
+            using difference_type = typename view_type::difference_type;
+            const auto& shape = arr.shape();
+            typename view_type::shape_type ret_shape(shape.cbegin(), shape.cend());
+            typename view_type::strides_type strides(arr.strides().cbegin(), arr.strides().cend());
+
+            difference_type start = 0;
+            if (shape[axis] != 0)
+            {
+                start = strides[axis] * static_cast<difference_type>(shape[axis] - 1);
+            }
+            strides[axis] = -strides[axis];
+            return view_type(std::forward<E>(arr), std::move(ret_shape), std::move(strides), start);
+        }
+
+        template <class E>
+        inline auto make_flip(E&& arr, std::size_t axis, std::false_type)
+        {
+            using CT = xclosure_t<E>;
+            auto shape = arr.shape();
+            return make_xgenerator(flip_impl<CT>(std::forward<E>(arr), axis), shape);
+        }
     }
 
     /**
@@ -675,6 +1054,8 @@ namespace xt
      * diagonal is returned. The shape of the resulting array can be 
      * determined by removing axis1 and axis2 and appending an index 
      * to the right equal to the size of the resulting diagonals.
+     * When arr is a container, the result is an \ref xstrided_view on
+     * its buffer, so the diagonal can be assigned to.
      *
      * @param arr the input array
      * @param offset offset of the diagonal from the main diagonal. Can
@@ -695,41 +1076,7 @@ namespace xt
     template <class E>
     inline auto diagonal(E&& arr, int offset = 0, std::size_t axis_1 = 0, std::size_t axis_2 = 1)
     {
-        using CT = xclosure_t<E>;
-        auto shape = arr.shape();
-
-        // the following shape calculation code is an almost verbatim adaptation of numpy:
-        // https://github.com/numpy/numpy/blob/2aabeafb97bea4e1bfa29d946fbf31e1104e7ae0/numpy/core/src/multiarray/item_selection.c#L1799
-
-        auto ret_shape = std::vector<std::size_t>(arr.dimension());
-
-        std::size_t dim_1 = shape[axis_1];
-        std::size_t dim_2 = shape[axis_2];
-
-        std::size_t n_dim = arr.dimension();
-
-        offset >= 0 ? dim_2 -= offset : dim_1 += offset;
-
-        auto diag_size = dim_2 < dim_1 ? dim_2 : dim_1;
-        if (diag_size < 0)
-        {
-            diag_size = 0;
-        }
-
-        std::size_t i = 0;
-        for (std::size_t idim = 0; idim < n_dim; ++idim)
-        {
-            if (idim != axis_1 && idim != axis_2)
-            {
-                ret_shape[i++] = shape[idim];
-            }
-        }
-
-        ret_shape[n_dim - 2] = diag_size;
-        ret_shape.pop_back();
-
-        return detail::make_xgenerator(detail::fn_impl<detail::diagonal_fn<CT>>(detail::diagonal_fn<CT>(std::forward<E>(arr), offset, axis_1, axis_2)),
-                                       ret_shape);
+        return detail::make_diagonal(std::forward<E>(arr), offset, axis_1, axis_2, detail::is_container<std::decay_t<E>>());
     }
 
     /**
@@ -758,7 +1105,9 @@ namespace xt
      * @brief Reverse the order of elements in an xexpression along the given axis.
      * Note: A NumPy/Matlab style `flipud(arr)` is equivalent to `xt::flip(arr, 0)`,
      * `fliplr(arr)` to `xt::flip(arr, 1)`.
-     * 
+     * When arr is a container, the result is an \ref xstrided_view on its
+     * buffer with a negative stride along axis.
+     *
      * @param arr the input xexpression
      * @param axis the axis along which elements should be reversed
      *
@@ -767,10 +1116,7 @@ namespace xt
     template <class E>
     inline auto flip(E&& arr, std::size_t axis)
     {
-        using CT = xclosure_t<E>;
-        auto shape = arr.shape();
-        return detail::make_xgenerator(detail::flip_impl<CT>(std::forward<E>(arr), axis),
-                                       shape);
+        return detail::make_flip(std::forward<E>(arr), axis, detail::is_container<std::decay_t<E>>());
     }
 
     /**
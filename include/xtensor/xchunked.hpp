@@ -0,0 +1,1109 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XCHUNKED_HPP
+#define XCHUNKED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xexecutor.hpp"
+#include "xexpression.hpp"
+#include "xgenerator.hpp"
+#include "xnpy.hpp"
+#include "xstrides.hpp"
+
+namespace xt
+{
+    /**
+     * Compression applied to the chunks of a chunked file. With
+     * \c rle, the bytes of the elements of a chunk are shuffled so that
+     * the k-th bytes of all elements are contiguous, then run-length
+     * encoded. Chunks that do not shrink are stored uncompressed.
+     */
+    enum class chunk_compression : std::uint8_t
+    {
+        none = 0,
+        rle = 1
+    };
+
+    template <class T>
+    class xchunked_writer;
+
+    template <class T>
+    class xchunked_reader;
+
+    template <class T>
+    auto load_chunked(const std::string& filename, std::size_t cache_size = 0);
+
+    /**************************
+     * chunked file internals *
+     **************************/
+
+    // A chunked file is made of
+    //  - a header: the magic string "XTCHUNK1", the npy descr of the
+    //    value type, the compression, the dimension, the shape and the
+    //    chunk shape;
+    //  - the chunks, in row-major order of the chunk grid, each one
+    //    holding its elements in row-major order;
+    //  - the chunk index: the number of chunks, and the offset, stored
+    //    size and compression flag of each chunk;
+    //  - a trailer: the offset of the chunk index and the magic string
+    //    "XTCINDEX".
+    // Integers are stored as 64-bit little-endian values. Only the first
+    // axis can grow, so appending rewrites the index and the header only.
+
+    namespace detail
+    {
+        inline std::runtime_error chunked_error(const std::string& msg)
+        {
+            return std::runtime_error("chunked file: " + msg);
+        }
+
+        inline void write_u64(std::ostream& stream, std::uint64_t value)
+        {
+            char bytes[8];
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+            }
+            stream.write(bytes, 8);
+        }
+
+        inline std::uint64_t read_u64(std::istream& stream)
+        {
+            unsigned char bytes[8];
+            stream.read(reinterpret_cast<char*>(bytes), 8);
+            if (!stream)
+            {
+                throw chunked_error("unexpected end of file");
+            }
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                value |= std::uint64_t(bytes[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        struct chunk_entry
+        {
+            std::uint64_t offset;
+            std::uint64_t size;
+            bool compressed;
+        };
+
+        struct chunked_header
+        {
+            std::string descr;
+            chunk_compression compression;
+            std::vector<std::size_t> shape;
+            std::vector<std::size_t> chunk_shape;
+        };
+
+        inline void write_chunked_header(std::ostream& stream, const chunked_header& header)
+        {
+            stream.write("XTCHUNK1", 8);
+            stream.put(static_cast<char>(header.descr.size()));
+            stream.write(header.descr.data(), static_cast<std::streamsize>(header.descr.size()));
+            stream.put(static_cast<char>(header.compression));
+            write_u64(stream, header.shape.size());
+            for (auto s : header.shape)
+            {
+                write_u64(stream, s);
+            }
+            for (auto s : header.chunk_shape)
+            {
+                write_u64(stream, s);
+            }
+        }
+
+        inline chunked_header read_chunked_header(std::istream& stream)
+        {
+            chunked_header header;
+            char magic[8];
+            stream.read(magic, 8);
+            if (!stream || std::memcmp(magic, "XTCHUNK1", 8) != 0)
+            {
+                throw chunked_error("invalid header");
+            }
+            header.descr.resize(static_cast<std::size_t>(stream.get()));
+            stream.read(&header.descr[0], static_cast<std::streamsize>(header.descr.size()));
+            header.compression = static_cast<chunk_compression>(stream.get());
+            std::size_t dim = static_cast<std::size_t>(read_u64(stream));
+            header.shape.resize(dim);
+            header.chunk_shape.resize(dim);
+            for (auto& s : header.shape)
+            {
+                s = static_cast<std::size_t>(read_u64(stream));
+            }
+            for (auto& s : header.chunk_shape)
+            {
+                s = static_cast<std::size_t>(read_u64(stream));
+            }
+            return header;
+        }
+
+        inline void write_chunk_index(std::ostream& stream, const std::vector<chunk_entry>& index, std::uint64_t index_offset)
+        {
+            write_u64(stream, index.size());
+            for (const auto& entry : index)
+            {
+                write_u64(stream, entry.offset);
+                write_u64(stream, entry.size);
+                stream.put(entry.compressed ? 1 : 0);
+            }
+            write_u64(stream, index_offset);
+            stream.write("XTCINDEX", 8);
+        }
+
+        inline std::vector<chunk_entry> read_chunk_index(std::istream& stream, std::uint64_t& index_offset)
+        {
+            stream.seekg(-16, std::ios::end);
+            index_offset = read_u64(stream);
+            char magic[8];
+            stream.read(magic, 8);
+            if (!stream || std::memcmp(magic, "XTCINDEX", 8) != 0)
+            {
+                throw chunked_error("missing chunk index");
+            }
+            stream.seekg(static_cast<std::streamoff>(index_offset));
+            std::vector<chunk_entry> index(static_cast<std::size_t>(read_u64(stream)));
+            for (auto& entry : index)
+            {
+                entry.offset = read_u64(stream);
+                entry.size = read_u64(stream);
+                entry.compressed = stream.get() != 0;
+            }
+            return index;
+        }
+
+        // Byte shuffle followed by a PackBits run-length encoding: a
+        // control byte h in [0, 127] is followed by h + 1 literal bytes,
+        // a control byte h in [-127, -1] by one byte repeated 1 - h times.
+        inline std::vector<char> rle_compress(const char* src, std::size_t size, std::size_t word_size)
+        {
+            std::size_t count = size / word_size;
+            std::vector<char> shuffled(size);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                for (std::size_t b = 0; b < word_size; ++b)
+                {
+                    shuffled[b * count + i] = src[i * word_size + b];
+                }
+            }
+
+            std::vector<char> res;
+            res.reserve(size / 2);
+            std::size_t i = 0;
+            while (i < size)
+            {
+                std::size_t run = 1;
+                while (i + run < size && run < 128 && shuffled[i + run] == shuffled[i])
+                {
+                    ++run;
+                }
+                if (run >= 3)
+                {
+                    res.push_back(static_cast<char>(1 - static_cast<int>(run)));
+                    res.push_back(shuffled[i]);
+                    i += run;
+                }
+                else
+                {
+                    std::size_t first = i;
+                    while (i < size && i - first < 128 &&
+                           !(i + 2 < size && shuffled[i] == shuffled[i + 1] && shuffled[i] == shuffled[i + 2]))
+                    {
+                        ++i;
+                    }
+                    res.push_back(static_cast<char>(i - first - 1));
+                    res.insert(res.end(), shuffled.cbegin() + static_cast<std::ptrdiff_t>(first),
+                               shuffled.cbegin() + static_cast<std::ptrdiff_t>(i));
+                }
+            }
+            return res;
+        }
+
+        inline void rle_decompress(const char* src, std::size_t src_size, std::size_t word_size, char* dst, std::size_t size)
+        {
+            std::vector<char> shuffled;
+            shuffled.reserve(size);
+            std::size_t i = 0;
+            while (i < src_size)
+            {
+                int h = static_cast<signed char>(src[i++]);
+                if (h >= 0)
+                {
+                    std::size_t n = static_cast<std::size_t>(h) + 1;
+                    if (i + n > src_size)
+                    {
+                        throw chunked_error("corrupted chunk");
+                    }
+                    shuffled.insert(shuffled.end(), src + i, src + i + n);
+                    i += n;
+                }
+                else if (i < src_size)
+                {
+                    shuffled.insert(shuffled.end(), static_cast<std::size_t>(1 - h), src[i++]);
+                }
+            }
+            if (shuffled.size() != size)
+            {
+                throw chunked_error("corrupted chunk");
+            }
+
+            std::size_t count = size / word_size;
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                for (std::size_t b = 0; b < word_size; ++b)
+                {
+                    dst[k * word_size + b] = shuffled[b * count + k];
+                }
+            }
+        }
+
+        inline std::vector<std::size_t> chunk_grid(const std::vector<std::size_t>& shape,
+                                                   const std::vector<std::size_t>& chunk_shape)
+        {
+            std::vector<std::size_t> grid(shape.size());
+            for (std::size_t d = 0; d < shape.size(); ++d)
+            {
+                grid[d] = (shape[d] + chunk_shape[d] - 1) / chunk_shape[d];
+            }
+            return grid;
+        }
+
+        // Position in the chunk grid of the k-th chunk, and the origin and
+        // the extent of its elements, chunks on the edges being truncated.
+        inline void chunk_bounds(std::size_t k, const std::vector<std::size_t>& shape,
+                                 const std::vector<std::size_t>& chunk_shape,
+                                 std::vector<std::size_t>& origin, std::vector<std::size_t>& extent)
+        {
+            std::vector<std::size_t> grid = chunk_grid(shape, chunk_shape);
+            origin.resize(shape.size());
+            extent.resize(shape.size());
+            for (std::size_t d = shape.size(); d != 0; --d)
+            {
+                std::size_t g = k % grid[d - 1];
+                k /= grid[d - 1];
+                origin[d - 1] = g * chunk_shape[d - 1];
+                extent[d - 1] = std::min(chunk_shape[d - 1], shape[d - 1] - origin[d - 1]);
+            }
+        }
+
+        // Copies the elements of a row-major block of the given extent
+        // between a packed buffer and a strided buffer. Both are byte
+        // buffers and the strides are in bytes.
+        inline void copy_block(const char* packed, char* strided, const std::vector<std::size_t>& extent,
+                               const std::vector<std::ptrdiff_t>& strides, std::size_t word_size, bool scatter)
+        {
+            auto copy_row = [&packed, word_size, scatter](char* row, std::ptrdiff_t size, std::ptrdiff_t stride) {
+                std::size_t n = static_cast<std::size_t>(size) * word_size;
+                if (stride == static_cast<std::ptrdiff_t>(word_size))
+                {
+                    scatter ? std::memcpy(row, packed, n) : std::memcpy(const_cast<char*>(packed), row, n);
+                }
+                else
+                {
+                    for (std::ptrdiff_t i = 0; i < size; ++i)
+                    {
+                        char* elem = row + i * stride;
+                        char* p = const_cast<char*>(packed) + static_cast<std::size_t>(i) * word_size;
+                        scatter ? std::memcpy(elem, p, word_size) : std::memcpy(p, elem, word_size);
+                    }
+                }
+                packed += n;
+            };
+            strided_loop(strided, extent, strides, copy_row);
+        }
+
+        inline std::vector<std::ptrdiff_t> byte_strides(const std::vector<std::size_t>& shape, std::size_t word_size)
+        {
+            std::vector<std::ptrdiff_t> strides(shape.size());
+            std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(word_size);
+            for (std::size_t d = shape.size(); d != 0; --d)
+            {
+                strides[d - 1] = stride;
+                stride *= static_cast<std::ptrdiff_t>(shape[d - 1]);
+            }
+            return strides;
+        }
+    }
+
+    /******************************
+     * xchunked_writer declaration *
+     ******************************/
+
+    /**
+     * @class xchunked_writer
+     * @brief Writer of chunked files.
+     *
+     * The xchunked_writer class writes expressions to a chunked file, by
+     * appending them along the first axis. The file can be reopened to
+     * append more data. Chunks are written as soon as enough rows are
+     * available; the last chunks, which may be incomplete, are written
+     * with the index when the writer is closed.
+     *
+     * @tparam T the value type of the elements of the file
+     */
+    template <class T>
+    class xchunked_writer
+    {
+
+    public:
+
+        using value_type = T;
+        using shape_type = std::vector<std::size_t>;
+
+        xchunked_writer(const std::string& filename, const shape_type& chunk_shape,
+                        chunk_compression compression = chunk_compression::none);
+        explicit xchunked_writer(const std::string& filename);
+        ~xchunked_writer();
+
+        xchunked_writer(const xchunked_writer&) = delete;
+        xchunked_writer& operator=(const xchunked_writer&) = delete;
+
+        template <class E>
+        void append(const xexpression<E>& e);
+
+        void close();
+
+        shape_type shape() const;
+        const shape_type& chunk_shape() const noexcept;
+
+    private:
+
+        void flush_rows(std::size_t nb_rows);
+        void write_chunk(const char* data, std::size_t size);
+        std::size_t row_size() const;
+
+        std::fstream m_stream;
+        detail::chunked_header m_header;
+        std::vector<detail::chunk_entry> m_index;
+        std::vector<char> m_pending;
+        std::size_t m_pending_rows;
+        std::uint64_t m_position;
+        bool m_open;
+    };
+
+    /******************************
+     * xchunked_reader declaration *
+     ******************************/
+
+    /**
+     * @class xchunked_reader
+     * @brief Reader of chunked files.
+     *
+     * The xchunked_reader class gives access to the elements of a chunked
+     * file. Chunks are loaded on demand and kept in a small LRU cache,
+     * which holds by default a full row of chunks so that traversing the
+     * file in row-major order loads every chunk once. Iterating over all
+     * the chunks reads the next chunk in the background while the current
+     * one is processed.
+     *
+     * The stream and the cache are shared by all the calls and guarded by
+     * a mutex, so that element and chunk can be called concurrently. The
+     * buffer returned by raw_chunk is only valid until another chunk is
+     * loaded, which another thread may do at any time; it must not be
+     * used concurrently with other accesses.
+     *
+     * @tparam T the value type of the elements of the file
+     */
+    template <class T>
+    class xchunked_reader
+    {
+
+    public:
+
+        using value_type = T;
+        using shape_type = std::vector<std::size_t>;
+
+        explicit xchunked_reader(const std::string& filename, std::size_t cache_size = 0);
+
+        const shape_type& shape() const noexcept;
+        const shape_type& chunk_shape() const noexcept;
+        std::size_t nb_chunks() const noexcept;
+        chunk_compression compression() const noexcept;
+
+        template <class It>
+        value_type element(It first, It last) const;
+
+        xarray<value_type> chunk(std::size_t k) const;
+        const std::vector<char>& raw_chunk(std::size_t k) const;
+
+        template <class F>
+        void for_each_chunk(F&& f) const;
+
+        template <class F>
+        void for_each_raw_chunk(F&& f) const;
+
+    private:
+
+        void read_chunk(std::istream& stream, std::size_t k, std::vector<char>& buffer) const;
+        const std::vector<char>& cached_chunk(std::size_t k) const;
+
+        std::string m_filename;
+        detail::chunked_header m_header;
+        std::vector<detail::chunk_entry> m_index;
+        shape_type m_grid;
+        std::size_t m_cache_size;
+        mutable std::ifstream m_stream;
+        mutable std::list<std::pair<std::size_t, std::vector<char>>> m_cache;
+        mutable std::mutex m_mutex;
+    };
+
+    /**********************************
+     * xchunked_writer implementation *
+     **********************************/
+
+    /**
+     * @name Constructors
+     */
+    //@{
+    /**
+     * Creates a chunked file, replacing any existing file. The file holds
+     * no element until an expression is appended.
+     * @param filename the name of the file
+     * @param chunk_shape the shape of the chunks
+     * @param compression the compression of the chunks
+     */
+    template <class T>
+    inline xchunked_writer<T>::xchunked_writer(const std::string& filename, const shape_type& chunk_shape,
+                                               chunk_compression compression)
+        : m_stream(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc),
+          m_pending_rows(0), m_open(true)
+    {
+        if (!m_stream)
+        {
+            throw detail::chunked_error("cannot create " + filename);
+        }
+        if (chunk_shape.empty() || std::find(chunk_shape.cbegin(), chunk_shape.cend(), 0) != chunk_shape.cend())
+        {
+            throw detail::chunked_error("invalid chunk shape");
+        }
+        m_header.descr = detail::npy_descr<T>();
+        m_header.compression = compression;
+        m_header.shape = shape_type(chunk_shape.size(), 0);
+        m_header.chunk_shape = chunk_shape;
+        detail::write_chunked_header(m_stream, m_header);
+        m_position = static_cast<std::uint64_t>(m_stream.tellp());
+    }
+
+    /**
+     * Opens an existing chunked file to append data to it. Incomplete
+     * chunks at the end of the file are read back and completed by the
+     * next appended rows.
+     * @param filename the name of the file
+     */
+    template <class T>
+    inline xchunked_writer<T>::xchunked_writer(const std::string& filename)
+        : m_stream(filename, std::ios::in | std::ios::out | std::ios::binary),
+          m_pending_rows(0), m_open(true)
+    {
+        if (!m_stream)
+        {
+            throw detail::chunked_error("cannot open " + filename);
+        }
+        m_header = detail::read_chunked_header(m_stream);
+        if (m_header.descr != detail::npy_descr<T>())
+        {
+            throw detail::chunked_error("the file holds elements of type " + m_header.descr);
+        }
+        m_index = detail::read_chunk_index(m_stream, m_position);
+
+        std::size_t tail_rows = m_header.shape[0] % m_header.chunk_shape[0];
+        if (tail_rows != 0)
+        {
+            // the last row of chunks is incomplete: it is moved back to the
+            // pending rows, and will be rewritten in place
+            xchunked_reader<T> reader(filename, 1);
+            shape_type grid = detail::chunk_grid(m_header.shape, m_header.chunk_shape);
+            std::size_t nb_cols = compute_size(grid) / grid[0];
+            std::size_t first = m_index.size() - nb_cols;
+
+            shape_type pending_shape = m_header.shape;
+            pending_shape[0] = tail_rows;
+            std::vector<std::ptrdiff_t> strides = detail::byte_strides(pending_shape, sizeof(T));
+            m_pending.resize(compute_size(pending_shape) * sizeof(T));
+
+            shape_type origin, extent;
+            for (std::size_t k = first; k < m_index.size(); ++k)
+            {
+                detail::chunk_bounds(k, m_header.shape, m_header.chunk_shape, origin, extent);
+                origin[0] = 0;
+                std::ptrdiff_t offset = std::inner_product(origin.cbegin(), origin.cend(), strides.cbegin(), std::ptrdiff_t(0));
+                detail::copy_block(reader.raw_chunk(k).data(), m_pending.data() + offset, extent, strides, sizeof(T), true);
+            }
+
+            m_pending_rows = tail_rows;
+            m_position = m_index[first].offset;
+            m_index.resize(first);
+            m_header.shape[0] -= tail_rows;
+        }
+    }
+    //@}
+
+    /**
+     * Closes the writer if it has not been closed.
+     */
+    template <class T>
+    inline xchunked_writer<T>::~xchunked_writer()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /**
+     * Appends an expression along the first axis. All the dimensions
+     * but the first one must match those of the file, they are set by
+     * the first append on a new file.
+     * @param e the expression to append
+     */
+    template <class T>
+    template <class E>
+    inline void xchunked_writer<T>::append(const xexpression<E>& e)
+    {
+        const E& de = e.derived_cast();
+        if (!m_open)
+        {
+            throw detail::chunked_error("the writer is closed");
+        }
+        if (de.dimension() != m_header.shape.size())
+        {
+            throw detail::chunked_error("dimension mismatch");
+        }
+        bool is_empty = m_header.shape[0] == 0 && m_pending_rows == 0 && m_index.empty();
+        for (std::size_t d = 1; d < m_header.shape.size(); ++d)
+        {
+            if (is_empty)
+            {
+                m_header.shape[d] = de.shape()[d];
+            }
+            else if (m_header.shape[d] != de.shape()[d])
+            {
+                throw broadcast_error(shape(), de.shape());
+            }
+        }
+
+        std::size_t row_bytes = row_size() * sizeof(T);
+        std::size_t chunk_rows = m_header.chunk_shape[0];
+        m_pending.resize(chunk_rows * row_bytes);
+        char* out = m_pending.data() + m_pending_rows * row_bytes;
+        std::size_t nb_rows = de.shape()[0];
+        auto it = de.cbegin();
+        for (std::size_t r = 0; r < nb_rows; ++r)
+        {
+            for (std::size_t i = 0; i < row_bytes; i += sizeof(T), ++it)
+            {
+                const T value = static_cast<T>(*it);
+                std::memcpy(out + i, &value, sizeof(T));
+            }
+            out += row_bytes;
+            if (++m_pending_rows == chunk_rows)
+            {
+                flush_rows(chunk_rows);
+                out = m_pending.data();
+            }
+        }
+    }
+
+    /**
+     * Writes the pending rows, the chunk index and the final header. The
+     * writer cannot be used after it has been closed.
+     */
+    template <class T>
+    inline void xchunked_writer<T>::close()
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        m_open = false;
+        if (m_pending_rows != 0)
+        {
+            flush_rows(m_pending_rows);
+        }
+        m_stream.seekp(static_cast<std::streamoff>(m_position));
+        detail::write_chunk_index(m_stream, m_index, m_position);
+        m_stream.seekp(0);
+        detail::write_chunked_header(m_stream, m_header);
+        m_stream.close();
+    }
+
+    /**
+     * Returns the shape of the data appended so far, including the rows
+     * that have not been written yet.
+     */
+    template <class T>
+    inline auto xchunked_writer<T>::shape() const -> shape_type
+    {
+        shape_type res = m_header.shape;
+        res[0] += m_pending_rows;
+        return res;
+    }
+
+    /**
+     * Returns the shape of the chunks.
+     */
+    template <class T>
+    inline auto xchunked_writer<T>::chunk_shape() const noexcept -> const shape_type&
+    {
+        return m_header.chunk_shape;
+    }
+
+    template <class T>
+    inline void xchunked_writer<T>::flush_rows(std::size_t nb_rows)
+    {
+        shape_type pending_shape = m_header.shape;
+        pending_shape[0] = nb_rows;
+        std::vector<std::ptrdiff_t> strides = detail::byte_strides(pending_shape, sizeof(T));
+
+        // the chunks of a row are laid out along the trailing axes
+        shape_type block_shape = m_header.chunk_shape;
+        block_shape[0] = nb_rows;
+        shape_type grid = detail::chunk_grid(pending_shape, block_shape);
+        std::size_t nb_cols = compute_size(grid);
+        shape_type origin, extent;
+        std::vector<char> block;
+        for (std::size_t k = 0; k < nb_cols; ++k)
+        {
+            detail::chunk_bounds(k, pending_shape, block_shape, origin, extent);
+            std::ptrdiff_t offset = std::inner_product(origin.cbegin(), origin.cend(), strides.cbegin(), std::ptrdiff_t(0));
+            block.resize(compute_size(extent) * sizeof(T));
+            detail::copy_block(block.data(), m_pending.data() + offset, extent, strides, sizeof(T), false);
+            write_chunk(block.data(), block.size());
+        }
+        m_header.shape[0] += nb_rows;
+        m_pending_rows = 0;
+    }
+
+    template <class T>
+    inline void xchunked_writer<T>::write_chunk(const char* data, std::size_t size)
+    {
+        detail::chunk_entry entry = {m_position, size, false};
+        m_stream.seekp(static_cast<std::streamoff>(m_position));
+        if (m_header.compression == chunk_compression::rle)
+        {
+            std::vector<char> packed = detail::rle_compress(data, size, sizeof(T));
+            if (packed.size() < size)
+            {
+                entry.size = packed.size();
+                entry.compressed = true;
+                m_stream.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+            }
+        }
+        if (!entry.compressed)
+        {
+            m_stream.write(data, static_cast<std::streamsize>(size));
+        }
+        if (!m_stream)
+        {
+            throw detail::chunked_error("write failure");
+        }
+        m_position += entry.size;
+        m_index.push_back(entry);
+    }
+
+    template <class T>
+    inline std::size_t xchunked_writer<T>::row_size() const
+    {
+        return std::accumulate(m_header.shape.cbegin() + 1, m_header.shape.cend(),
+                               std::size_t(1), std::multiplies<std::size_t>());
+    }
+
+    /**********************************
+     * xchunked_reader implementation *
+     **********************************/
+
+    /**
+     * Opens a chunked file for reading.
+     * @param filename the name of the file
+     * @param cache_size the number of chunks kept in memory. 0 (default)
+     *        selects a full row of chunks.
+     */
+    template <class T>
+    inline xchunked_reader<T>::xchunked_reader(const std::string& filename, std::size_t cache_size)
+        : m_filename(filename), m_stream(filename, std::ios::in | std::ios::binary)
+    {
+        if (!m_stream)
+        {
+            throw detail::chunked_error("cannot open " + filename);
+        }
+        m_header = detail::read_chunked_header(m_stream);
+        if (m_header.descr != detail::npy_descr<T>())
+        {
+            throw detail::chunked_error("the file holds elements of type " + m_header.descr);
+        }
+        std::uint64_t index_offset;
+        m_index = detail::read_chunk_index(m_stream, index_offset);
+        m_grid = detail::chunk_grid(m_header.shape, m_header.chunk_shape);
+        if (m_index.size() != compute_size(m_grid))
+        {
+            throw detail::chunked_error("inconsistent chunk index");
+        }
+        std::size_t row_chunks = m_grid.size() > 1 ?
+            std::accumulate(m_grid.cbegin() + 1, m_grid.cend(), std::size_t(1), std::multiplies<std::size_t>()) : 1;
+        m_cache_size = cache_size != 0 ? cache_size : row_chunks;
+    }
+
+    /**
+     * Returns the shape of the file.
+     */
+    template <class T>
+    inline auto xchunked_reader<T>::shape() const noexcept -> const shape_type&
+    {
+        return m_header.shape;
+    }
+
+    /**
+     * Returns the shape of the chunks.
+     */
+    template <class T>
+    inline auto xchunked_reader<T>::chunk_shape() const noexcept -> const shape_type&
+    {
+        return m_header.chunk_shape;
+    }
+
+    /**
+     * Returns the number of chunks.
+     */
+    template <class T>
+    inline std::size_t xchunked_reader<T>::nb_chunks() const noexcept
+    {
+        return m_index.size();
+    }
+
+    /**
+     * Returns the compression of the chunks.
+     */
+    template <class T>
+    inline chunk_compression xchunked_reader<T>::compression() const noexcept
+    {
+        return m_header.compression;
+    }
+
+    /**
+     * Returns the element at the specified position. The chunk holding
+     * the element is loaded if it is not in the cache.
+     * @param first iterator starting the sequence of indices
+     * @param last iterator ending the sequence of indices
+     */
+    template <class T>
+    template <class It>
+    inline auto xchunked_reader<T>::element(It first, It last) const -> value_type
+    {
+        const shape_type& shape = m_header.shape;
+        const shape_type& chunk_shape = m_header.chunk_shape;
+        first = last;
+        first -= static_cast<typename std::iterator_traits<It>::difference_type>(shape.size());
+        std::size_t k = 0;
+        std::size_t offset = 0;
+        for (std::size_t d = 0; d < shape.size(); ++d, ++first)
+        {
+            std::size_t i = static_cast<std::size_t>(*first);
+            std::size_t g = i / chunk_shape[d];
+            std::size_t extent = std::min(chunk_shape[d], shape[d] - g * chunk_shape[d]);
+            k = k * m_grid[d] + g;
+            offset = offset * extent + i % chunk_shape[d];
+        }
+        value_type res;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::memcpy(&res, cached_chunk(k).data() + offset * sizeof(T), sizeof(T));
+        return res;
+    }
+
+    /**
+     * Returns the k-th chunk, in row-major order of the chunk grid.
+     */
+    template <class T>
+    inline auto xchunked_reader<T>::chunk(std::size_t k) const -> xarray<value_type>
+    {
+        shape_type origin, extent;
+        detail::chunk_bounds(k, m_header.shape, m_header.chunk_shape, origin, extent);
+        xarray<value_type> res(extent);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::vector<char>& buffer = cached_chunk(k);
+        auto it = res.data().begin();
+        for (std::size_t i = 0; i < buffer.size(); i += sizeof(T), ++it)
+        {
+            value_type value;
+            std::memcpy(&value, buffer.data() + i, sizeof(T));
+            *it = value;
+        }
+        return res;
+    }
+
+    /**
+     * Calls \c f(origin, chunk) on every chunk in row-major order of the
+     * chunk grid, where \c origin is the position of the first element of
+     * the chunk in the file, and \c chunk an xarray holding its elements.
+     * The next chunk is read while \c f processes the current one.
+     * @param f the function to apply
+     */
+    template <class T>
+    template <class F>
+    inline void xchunked_reader<T>::for_each_chunk(F&& f) const
+    {
+        shape_type origin, extent;
+        for_each_raw_chunk([&](std::size_t k, const std::vector<char>& buffer) {
+            detail::chunk_bounds(k, m_header.shape, m_header.chunk_shape, origin, extent);
+            xarray<value_type> chunk(extent);
+            auto it = chunk.data().begin();
+            for (std::size_t i = 0; i < buffer.size(); i += sizeof(T), ++it)
+            {
+                value_type value;
+                std::memcpy(&value, buffer.data() + i, sizeof(T));
+                *it = value;
+            }
+            f(static_cast<const shape_type&>(origin), static_cast<const xarray<value_type>&>(chunk));
+        });
+    }
+
+    /**
+     * Calls \c f(k, buffer) on every chunk in row-major order of the chunk
+     * grid, where \c buffer holds the bytes of the elements of the k-th
+     * chunk. The next chunk is read in the background, through its own
+     * stream, while \c f processes the current one.
+     * @param f the function to apply
+     */
+    template <class T>
+    template <class F>
+    inline void xchunked_reader<T>::for_each_raw_chunk(F&& f) const
+    {
+        std::size_t n = nb_chunks();
+        if (n == 0)
+        {
+            return;
+        }
+        std::ifstream stream(m_filename, std::ios::in | std::ios::binary);
+        auto load = [this, &stream](std::size_t k) {
+            std::vector<char> buffer;
+            read_chunk(stream, k, buffer);
+            return buffer;
+        };
+        // the next chunk is read by the default executor while f runs
+        executor ex = default_executor();
+        xfuture<std::vector<char>> next = submit(ex, [&load]() { return load(0); });
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            std::vector<char> buffer = next.get();
+            if (k + 1 < n)
+            {
+                next = submit(ex, [&load, k]() { return load(k + 1); });
+            }
+            try
+            {
+                f(k, static_cast<const std::vector<char>&>(buffer));
+            }
+            catch (...)
+            {
+                // the pending read refers to the stream
+                if (next.valid())
+                {
+                    next.wait();
+                }
+                throw;
+            }
+        }
+    }
+
+    template <class T>
+    inline void xchunked_reader<T>::read_chunk(std::istream& stream, std::size_t k, std::vector<char>& buffer) const
+    {
+        shape_type origin, extent;
+        detail::chunk_bounds(k, m_header.shape, m_header.chunk_shape, origin, extent);
+        std::size_t size = compute_size(extent) * sizeof(T);
+        const detail::chunk_entry& entry = m_index[k];
+        std::size_t stored_size = static_cast<std::size_t>(entry.size);
+        buffer.resize(size);
+        stream.seekg(static_cast<std::streamoff>(entry.offset));
+        if (entry.compressed)
+        {
+            std::vector<char> packed(stored_size);
+            stream.read(packed.data(), static_cast<std::streamsize>(stored_size));
+            if (!stream)
+            {
+                throw detail::chunked_error("truncated chunk");
+            }
+            detail::rle_decompress(packed.data(), stored_size, sizeof(T), buffer.data(), size);
+        }
+        else
+        {
+            if (stored_size != size)
+            {
+                throw detail::chunked_error("corrupted chunk");
+            }
+            stream.read(buffer.data(), static_cast<std::streamsize>(size));
+            if (!stream)
+            {
+                throw detail::chunked_error("truncated chunk");
+            }
+        }
+    }
+
+    /**
+     * Returns the bytes of the elements of the k-th chunk, in row-major
+     * order. The returned buffer is valid until another chunk is loaded.
+     */
+    template <class T>
+    inline auto xchunked_reader<T>::raw_chunk(std::size_t k) const -> const std::vector<char>&
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return cached_chunk(k);
+    }
+
+    // Loads the k-th chunk in the cache if needed; m_mutex must be held.
+    template <class T>
+    inline auto xchunked_reader<T>::cached_chunk(std::size_t k) const -> const std::vector<char>&
+    {
+        if (!m_cache.empty() && m_cache.front().first == k)
+        {
+            return m_cache.front().second;
+        }
+        auto it = std::find_if(m_cache.begin(), m_cache.end(), [k](const auto& c) { return c.first == k; });
+        if (it != m_cache.end())
+        {
+            m_cache.splice(m_cache.begin(), m_cache, it);
+        }
+        else
+        {
+            if (m_cache.size() >= m_cache_size)
+            {
+                m_cache.pop_back();
+            }
+            m_cache.emplace_front(k, std::vector<char>());
+            read_chunk(m_stream, k, m_cache.front().second);
+        }
+        return m_cache.front().second;
+    }
+
+    /****************
+     * load_chunked *
+     ****************/
+
+    namespace detail
+    {
+        template <class T>
+        struct chunked_fn
+        {
+            using value_type = T;
+            using size_type = std::size_t;
+
+            explicit chunked_fn(std::shared_ptr<const xchunked_reader<T>> reader)
+                : p_reader(std::move(reader))
+            {
+            }
+
+            template <class... Args>
+            inline value_type operator()(Args... args) const
+            {
+                size_type idx[sizeof...(Args)] = {static_cast<size_type>(args)...};
+                return p_reader->element(std::begin(idx), std::end(idx));
+            }
+
+            template <class It>
+            inline value_type element(It first, It last) const
+            {
+                return p_reader->element(first, last);
+            }
+
+            // Streams the chunks into the buffer of e, with read-ahead.
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                assign_to(e, std::is_same<typename E::value_type, T>());
+            }
+
+        private:
+
+            // The elements of the chunks are copied as bytes.
+            template <class E>
+            inline void assign_to(E& e, std::true_type) const
+            {
+                const auto& shape = p_reader->shape();
+                std::vector<std::ptrdiff_t> strides = byte_strides(std::vector<std::size_t>(shape.cbegin(), shape.cend()),
+                                                                   sizeof(T));
+                char* data = reinterpret_cast<char*>(e.data().data());
+                std::vector<std::size_t> origin, extent;
+                p_reader->for_each_raw_chunk([&](std::size_t k, const std::vector<char>& buffer) {
+                    chunk_bounds(k, shape, p_reader->chunk_shape(), origin, extent);
+                    std::ptrdiff_t offset = std::inner_product(origin.cbegin(), origin.cend(), strides.cbegin(), std::ptrdiff_t(0));
+                    copy_block(buffer.data(), data + offset, extent, strides, sizeof(T), true);
+                });
+            }
+
+            // The elements of the chunks are converted to the value type
+            // of e one by one.
+            template <class E>
+            inline void assign_to(E& e, std::false_type) const
+            {
+                using result_type = typename E::value_type;
+                const auto& shape = p_reader->shape();
+                // strides in elements
+                std::vector<std::ptrdiff_t> strides = byte_strides(std::vector<std::size_t>(shape.cbegin(), shape.cend()),
+                                                                   std::size_t(1));
+                result_type* data = e.data().data();
+                std::vector<std::size_t> origin, extent;
+                p_reader->for_each_raw_chunk([&](std::size_t k, const std::vector<char>& buffer) {
+                    chunk_bounds(k, shape, p_reader->chunk_shape(), origin, extent);
+                    std::ptrdiff_t offset = std::inner_product(origin.cbegin(), origin.cend(), strides.cbegin(), std::ptrdiff_t(0));
+                    const char* packed = buffer.data();
+                    strided_loop(data + offset, extent, strides, [&packed](result_type* row, std::ptrdiff_t size, std::ptrdiff_t stride) {
+                        for (std::ptrdiff_t i = 0; i < size; ++i)
+                        {
+                            T value;
+                            std::memcpy(&value, packed, sizeof(T));
+                            row[i * stride] = static_cast<result_type>(value);
+                            packed += sizeof(T);
+                        }
+                    });
+                });
+            }
+
+            std::shared_ptr<const xchunked_reader<T>> p_reader;
+        };
+    }
+
+    /**
+     * Opens a chunked file as an expression. Elements are loaded lazily
+     * through an xchunked_reader; assigning the expression to a container
+     * streams the chunks directly into the buffer of the container.
+     * @tparam T the value type of the elements of the file
+     * @param filename the name of the file
+     * @param cache_size the number of chunks kept in memory. 0 (default)
+     *        selects a full row of chunks.
+     */
+    template <class T>
+    inline auto load_chunked(const std::string& filename, std::size_t cache_size)
+    {
+        auto reader = std::make_shared<const xchunked_reader<T>>(filename, cache_size);
+        std::vector<std::size_t> shape = reader->shape();
+        return detail::make_xgenerator(detail::chunked_fn<T>(std::move(reader)), shape);
+    }
+}
+
+#endif
@@ -9,8 +9,12 @@
 #ifndef XCONTAINER_HPP
 #define XCONTAINER_HPP
 
-#include <numeric>
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 
 #include "xstrides.hpp"
 #include "xiterable.hpp"
@@ -18,9 +22,49 @@
 #include "xoperation.hpp"
 #include "xmath.hpp"
 #include "xtensor_forward.hpp"
+#include "xutils.hpp"
 
 namespace xt
 {
+    namespace detail
+    {
+        template <class C, class = void>
+        struct has_raw_data : std::false_type
+        {
+        };
+
+        template <class C>
+        struct has_raw_data<C, void_t<decltype(std::declval<C&>().data())>>
+            : std::is_same<decltype(std::declval<C&>().data()), typename C::value_type*>
+        {
+        };
+
+        template <class C>
+        using is_memsettable = std::integral_constant<bool, has_raw_data<C>::value &&
+                                                            std::is_arithmetic<typename C::value_type>::value>;
+
+        template <class C, class T>
+        inline void fill_data(C& data, const T& value, std::true_type)
+        {
+            using value_type = typename C::value_type;
+            const value_type v = static_cast<value_type>(value);
+            const value_type zero = value_type(0);
+            if (std::memcmp(&v, &zero, sizeof(value_type)) == 0)
+            {
+                std::memset(data.data(), 0, data.size() * sizeof(value_type));
+            }
+            else
+            {
+                std::fill(data.begin(), data.end(), v);
+            }
+        }
+
+        template <class C, class T>
+        inline void fill_data(C& data, const T& value, std::false_type)
+        {
+            std::fill(data.begin(), data.end(), value);
+        }
+    }
 
     namespace check_policy
     {
@@ -95,6 +139,8 @@ namespace xt
         const inner_strides_type& strides() const noexcept;
         const inner_strides_type& backstrides() const noexcept;
 
+        bool is_contiguous() const;
+
         void transpose();
 
         template <class S, class Tag = check_policy::none>
@@ -127,6 +173,9 @@ namespace xt
         container_type& data() noexcept;
         const container_type& data() const noexcept;
 
+        template <class T>
+        void fill(const T& value);
+
         template <class S>
         bool broadcast_shape(S& shape) const;
 
@@ -323,6 +372,20 @@ namespace xt
         return derived_cast().backstrides_impl();
     }
 
+    /**
+     * Checks whether the elements of the container are stored contiguously
+     * in row-major order, i.e. whether the underlying buffer can be traversed
+     * linearly to visit the elements in the order of their indices.
+     */
+    template <class D>
+    inline bool xcontainer<D>::is_contiguous() const
+    {
+        strides_type row_major_strides;
+        resize_container(row_major_strides, dimension());
+        compute_strides(shape(), layout::row_major, row_major_strides);
+        return std::equal(row_major_strides.cbegin(), row_major_strides.cend(), strides().cbegin());
+    }
+
     /**
      * Transposes the container inplace by reversing the dimensions.
      */
@@ -533,6 +596,18 @@ namespace xt
     {
         return derived_cast().data_impl();
     }
+
+    /**
+     * Fills the container with the given value. When the buffer is a plain
+     * array of arithmetic values and \c value is zero, this is a memset.
+     * @param value the value to fill the container with
+     */
+    template <class D>
+    template <class T>
+    inline void xcontainer<D>::fill(const T& value)
+    {
+        detail::fill_data(data(), value, detail::is_memsettable<container_type>());
+    }
     //@}
 
     /**
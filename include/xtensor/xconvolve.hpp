@@ -0,0 +1,664 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XCONVOLVE_HPP
+#define XCONVOLVE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xblas.hpp"
+#include "xexecutor.hpp"
+#include "xlinalg.hpp"
+#include "xstrides.hpp"
+
+namespace xt
+{
+    /**
+     * @enum convolve_mode
+     * @brief Size of the result of a convolution or a correlation.
+     *
+     * - full: every position where the kernel overlaps the input
+     * - same: the size of the larger operand, centered with respect to full
+     * - valid: the positions where the smaller operand lies entirely in
+     *   the larger one
+     *
+     * The sizes are those of numpy.convolve and numpy.correlate, in each
+     * dimension: a kernel larger than the input gives the result of the
+     * swapped operands, reversed for a correlation.
+     */
+    enum class convolve_mode
+    {
+        full,
+        same,
+        valid
+    };
+
+    template <class E1, class E2>
+    auto convolve(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                  convolve_mode mode = convolve_mode::full, const std::vector<std::size_t>& strides = {})
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+    template <class E1, class E2>
+    auto convolve(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                  const std::vector<std::size_t>& padding, const std::vector<std::size_t>& strides = {})
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+    template <class E1, class E2>
+    auto correlate(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                   convolve_mode mode = convolve_mode::valid, const std::vector<std::size_t>& strides = {})
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+    template <class E1, class E2>
+    auto correlate(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                   const std::vector<std::size_t>& padding, const std::vector<std::size_t>& strides = {})
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+    /**********************
+     * convolve internals *
+     **********************/
+
+    namespace detail
+    {
+        inline std::runtime_error convolve_error(const std::string& fn, const std::string& msg)
+        {
+            return std::runtime_error(fn + ": " + msg);
+        }
+
+        // Number of outputs of a row computed at once; a segment of the
+        // output row stays in the L1 cache while the taps are applied.
+        constexpr std::size_t conv_segment = 1024;
+        // Number of outputs per tile.
+        constexpr std::size_t conv_tile = std::size_t(1) << 14;
+        // Kernels are computed as matrix products when their rows, or
+        // the chunks of their rows, give products deep enough and with
+        // enough rows to fill the register blocks of gemm. Smaller ones
+        // are faster with the direct kernel.
+        constexpr std::size_t conv_gemm_min_depth = 32;
+        constexpr std::size_t conv_gemm_min_rows = 2 * gemm_mr;
+        // Maximal depth of the matrix products: longer kernel rows are
+        // split in chunks.
+        constexpr std::size_t conv_chunk = 64;
+        // Number of multiply-adds above which tiles are computed by
+        // several threads.
+        constexpr std::size_t conv_parallel_threshold = std::size_t(1) << 21;
+
+        // A correlation of a padded row-major input with a row-major
+        // kernel, of rank at least 2: one dimensional problems are given
+        // a leading dimension of size 1.
+        template <class T>
+        struct conv_problem
+        {
+            const T* input;
+            std::vector<std::size_t> input_shape;
+            std::vector<std::ptrdiff_t> input_strides;
+            const T* kernel;
+            std::vector<std::size_t> kernel_shape;
+            std::vector<std::size_t> strides;
+            T* output;
+            std::vector<std::size_t> output_shape;
+        };
+
+        inline std::vector<std::ptrdiff_t> conv_row_major_strides(const std::vector<std::size_t>& shape)
+        {
+            std::vector<std::ptrdiff_t> res(shape.size());
+            std::ptrdiff_t stride = 1;
+            for (std::size_t i = shape.size(); i-- > 0;)
+            {
+                res[i] = stride;
+                stride *= static_cast<std::ptrdiff_t>(shape[i]);
+            }
+            return res;
+        }
+
+        // Offsets of the elements of an array of the given shape, in
+        // row-major order, when dimension d advances by factors[d].
+        inline std::vector<std::ptrdiff_t> conv_offsets(const std::vector<std::size_t>& shape,
+                                                        const std::vector<std::ptrdiff_t>& factors)
+        {
+            std::size_t size = std::accumulate(shape.cbegin(), shape.cend(), std::size_t(1), std::multiplies<std::size_t>());
+            std::vector<std::ptrdiff_t> res(size, 0);
+            std::size_t block = size;
+            for (std::size_t d = 0; d < shape.size(); ++d)
+            {
+                block /= shape[d];
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    res[i] += static_cast<std::ptrdiff_t>((i / block) % shape[d]) * factors[d];
+                }
+            }
+            return res;
+        }
+
+        // y[i] += alpha * x[i * incx], for i in [0, n)
+        template <class T>
+        inline void conv_axpy(std::size_t n, T alpha, const T* x, std::ptrdiff_t incx, T* y)
+        {
+            if (incx == 1)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    y[i] += alpha * x[i];
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    y[i] += alpha * x[static_cast<std::ptrdiff_t>(i) * incx];
+                }
+            }
+        }
+
+        // Computes the output rows [o0, o1) of the first dimension, and the
+        // elements [i0, i1) of these rows, by applying each tap of the kernel
+        // to a segment of output.
+        template <class T>
+        inline void conv_direct(const conv_problem<T>& p, std::size_t o0, std::size_t o1, std::size_t i0, std::size_t i1)
+        {
+            std::size_t rank = p.output_shape.size();
+            std::size_t width = p.output_shape.back();
+            std::size_t kw = p.kernel_shape.back();
+            std::ptrdiff_t s = static_cast<std::ptrdiff_t>(p.strides.back());
+
+            std::vector<std::size_t> tap_shape(p.kernel_shape.cbegin(), p.kernel_shape.cend() - 1);
+            std::vector<std::ptrdiff_t> taps = conv_offsets(tap_shape, p.input_strides);
+            std::vector<std::size_t> line_shape(p.output_shape.cbegin() + 1, p.output_shape.cend() - 1);
+            std::vector<std::ptrdiff_t> line_factors(rank - 2);
+            for (std::size_t d = 1; d + 1 < rank; ++d)
+            {
+                line_factors[d - 1] = static_cast<std::ptrdiff_t>(p.strides[d]) * p.input_strides[d];
+            }
+            std::vector<std::ptrdiff_t> lines = conv_offsets(line_shape, line_factors);
+
+            std::ptrdiff_t s0 = static_cast<std::ptrdiff_t>(p.strides[0]) * p.input_strides[0];
+            for (std::size_t o = o0; o < o1; ++o)
+            {
+                for (std::size_t l = 0; l < lines.size(); ++l)
+                {
+                    T* out = p.output + (o * lines.size() + l) * width + i0;
+                    const T* in = p.input + static_cast<std::ptrdiff_t>(o) * s0 + lines[l] +
+                                  static_cast<std::ptrdiff_t>(i0) * s;
+                    for (std::size_t a = 0; a < taps.size(); ++a)
+                    {
+                        const T* row = in + taps[a];
+                        const T* w = p.kernel + a * kw;
+                        for (std::size_t j = 0; j < kw; ++j)
+                        {
+                            conv_axpy(i1 - i0, w[j], row + j, s, out);
+                        }
+                    }
+                }
+            }
+        }
+
+        // The kernel as a matrix with one row per chunk of kernel row: the
+        // rows of the kernel longer than conv_chunk are split in chunks,
+        // the last one being shifted back so that it ends with the row.
+        // Row a * chunks + t holds the chunk t of the kernel row a, which
+        // starts at starts[t] in the kernel row.
+        template <class T>
+        struct conv_gemm_kernel
+        {
+            std::size_t depth;
+            std::size_t chunks;
+            std::size_t rows;
+            std::vector<std::size_t> starts;
+            std::vector<T> data;
+        };
+
+        template <class T>
+        inline conv_gemm_kernel<T> make_conv_gemm_kernel(const conv_problem<T>& p)
+        {
+            conv_gemm_kernel<T> res;
+            std::size_t kw = p.kernel_shape.back();
+            res.chunks = (kw + conv_chunk - 1) / conv_chunk;
+            res.depth = (kw + res.chunks - 1) / res.chunks;
+            res.starts.resize(res.chunks);
+            for (std::size_t t = 0; t < res.chunks; ++t)
+            {
+                res.starts[t] = std::min(t * res.depth, kw - res.depth);
+            }
+            std::size_t kernel_rows = std::accumulate(p.kernel_shape.cbegin(), p.kernel_shape.cend() - 1,
+                                                      std::size_t(1), std::multiplies<std::size_t>());
+            res.rows = kernel_rows * res.chunks;
+            res.data.assign(res.rows * res.depth, T(0));
+            for (std::size_t a = 0; a < kernel_rows; ++a)
+            {
+                for (std::size_t t = 0; t < res.chunks; ++t)
+                {
+                    // elements shared with the previous chunk are left to it
+                    std::size_t first = t * res.depth;
+                    std::size_t last = std::min(first + res.depth, kw);
+                    T* dst = res.data.data() + (a * res.chunks + t) * res.depth - res.starts[t];
+                    std::copy(p.kernel + a * kw + first, p.kernel + a * kw + last, dst + first);
+                }
+            }
+            return res;
+        }
+
+        // Same as conv_direct, with unit strides, as matrix products: the
+        // elements of an input row read by the kernel form a Hankel matrix,
+        // whose product with the kernel rows applied to this input row
+        // gives their contributions to every output row at once.
+        template <class T>
+        inline void conv_gemm(const conv_problem<T>& p, const conv_gemm_kernel<T>& k,
+                              std::size_t o0, std::size_t o1, std::size_t i0, std::size_t i1)
+        {
+            std::size_t rank = p.output_shape.size();
+            std::size_t width = p.output_shape.back();
+            std::size_t k0 = p.kernel_shape[0];
+            std::size_t n = i1 - i0 + k.starts.back();
+
+            // input lines, kernel rows and output lines for a given
+            // index in the first dimension
+            std::vector<std::size_t> mid_shape(p.input_shape.cbegin() + 1, p.input_shape.cend() - 1);
+            std::vector<std::ptrdiff_t> mid_factors(p.input_strides.cbegin() + 1, p.input_strides.cend() - 1);
+            std::vector<std::ptrdiff_t> mid_lines = conv_offsets(mid_shape, mid_factors);
+            std::vector<std::size_t> mid_out(p.output_shape.cbegin() + 1, p.output_shape.cend() - 1);
+            std::vector<std::size_t> mid_kernel(p.kernel_shape.cbegin() + 1, p.kernel_shape.cend() - 1);
+            std::size_t mid_rows = k.rows / k0;
+            std::size_t nb_mid_out = std::accumulate(mid_out.cbegin(), mid_out.cend(), std::size_t(1), std::multiplies<std::size_t>());
+
+            std::vector<T> product;
+            std::vector<std::size_t> line(rank - 2), tap(rank - 2);
+            for (std::size_t r0 = o0; r0 + 1 < o1 + k0; ++r0)
+            {
+                // kernel rows reaching an output row of the band
+                std::size_t a_first = r0 + 1 > o1 ? r0 + 1 - o1 : std::size_t(0);
+                std::size_t a_last = std::min(k0, r0 - o0 + 1);
+                std::size_t row_first = a_first * mid_rows;
+                std::size_t m = (a_last - a_first) * mid_rows;
+                product.resize(m * n);
+
+                for (std::size_t l = 0; l < mid_lines.size(); ++l)
+                {
+                    const T* in = p.input + static_cast<std::ptrdiff_t>(r0) * p.input_strides[0] + mid_lines[l] +
+                                  static_cast<std::ptrdiff_t>(i0);
+                    std::fill(product.begin(), product.end(), T(0));
+                    gemm_matrix<T> ma = {k.data.data() + row_first * k.depth, static_cast<std::ptrdiff_t>(k.depth), std::ptrdiff_t(1)};
+                    gemm_matrix<T> mb = {in, std::ptrdiff_t(1), std::ptrdiff_t(1)};
+                    gemm_block(m, n, k.depth, ma, mb, product.data(), static_cast<std::ptrdiff_t>(n), std::ptrdiff_t(1));
+
+                    // index of the input line in the inner leading dimensions
+                    for (std::size_t d = rank - 2, rem = l; d-- > 0;)
+                    {
+                        line[d] = rem % mid_shape[d];
+                        rem /= mid_shape[d];
+                    }
+                    for (std::size_t row = 0; row < m; ++row)
+                    {
+                        std::size_t a = (row_first + row) / k.chunks;
+                        std::size_t t = (row_first + row) % k.chunks;
+                        std::size_t o = r0 - a / (mid_rows / k.chunks);
+                        std::size_t out_line = 0;
+                        bool inside = true;
+                        for (std::size_t d = rank - 2, rem = a % (mid_rows / k.chunks); d-- > 0;)
+                        {
+                            tap[d] = rem % mid_kernel[d];
+                            rem /= mid_kernel[d];
+                        }
+                        for (std::size_t d = 0; d + 2 < rank && inside; ++d)
+                        {
+                            inside = line[d] >= tap[d] && line[d] - tap[d] < mid_out[d];
+                            out_line = out_line * mid_out[d] + (line[d] - tap[d]);
+                        }
+                        if (inside)
+                        {
+                            T* out = p.output + (o * nb_mid_out + out_line) * width + i0;
+                            conv_axpy(i1 - i0, T(1), product.data() + row * n + k.starts[t], std::ptrdiff_t(1), out);
+                        }
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        inline void conv_run(const conv_problem<T>& p)
+        {
+            std::size_t out0 = p.output_shape[0];
+            std::size_t width = p.output_shape.back();
+            std::size_t nb_lines = std::accumulate(p.output_shape.cbegin() + 1, p.output_shape.cend() - 1,
+                                                   std::size_t(1), std::multiplies<std::size_t>());
+            std::size_t kernel_size = std::accumulate(p.kernel_shape.cbegin(), p.kernel_shape.cend(),
+                                                      std::size_t(1), std::multiplies<std::size_t>());
+            std::size_t work = out0 * nb_lines * width * kernel_size;
+            if (work == 0)
+            {
+                return;
+            }
+
+            conv_gemm_kernel<T> k;
+            bool unit_strides = std::all_of(p.strides.cbegin(), p.strides.cend(), [](std::size_t s) { return s == 1; });
+            bool use_gemm = false;
+            if (unit_strides && p.kernel_shape.back() >= conv_gemm_min_depth)
+            {
+                k = make_conv_gemm_kernel(p);
+                use_gemm = k.rows >= conv_gemm_min_rows;
+            }
+
+            // the products of a segment also read the kernel width beyond
+            // it, segments are made long enough to amortize it
+            std::size_t segment = use_gemm ? std::max(conv_segment, 8 * p.kernel_shape.back()) : conv_segment;
+            segment = std::min(width, segment);
+            std::size_t band = std::max(std::size_t(1), conv_tile / (segment * nb_lines));
+            band = std::min(band, out0);
+            std::size_t nb_bands = (out0 + band - 1) / band;
+            std::size_t nb_segments = (width + segment - 1) / segment;
+            std::size_t nb_tiles = nb_bands * nb_segments;
+
+            auto task = [&](std::size_t first, std::size_t last) {
+                for (std::size_t tile = first; tile < last; ++tile)
+                {
+                    std::size_t o0 = (tile / nb_segments) * band;
+                    std::size_t i0 = (tile % nb_segments) * segment;
+                    std::size_t o1 = std::min(o0 + band, out0);
+                    std::size_t i1 = std::min(i0 + segment, width);
+                    if (use_gemm)
+                    {
+                        conv_gemm(p, k, o0, o1, i0, i1);
+                    }
+                    else
+                    {
+                        conv_direct(p, o0, o1, i0, i1);
+                    }
+                }
+            };
+
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(std::min(ex.concurrency(), nb_tiles), work / conv_parallel_threshold + 1);
+            std::size_t block = (nb_tiles + nb_tasks - 1) / nb_tasks;
+            parallel_for(ex, (nb_tiles + block - 1) / block, [&](std::size_t t) {
+                task(t * block, std::min((t + 1) * block, nb_tiles));
+            });
+        }
+
+        // Padding before and after each dimension of the input, such that
+        // the result has the size required by mode when the operands have
+        // the given shapes. As in numpy, the size of the result does not
+        // depend on the order of the operands: a kernel larger than the
+        // input gives the same result as the swapped operands, reversed
+        // for a correlation.
+        inline void conv_mode_padding(convolve_mode mode, const std::vector<std::size_t>& shape,
+                                      const std::vector<std::size_t>& kernel_shape, bool flip,
+                                      std::vector<std::size_t>& before, std::vector<std::size_t>& after)
+        {
+            std::size_t rank = kernel_shape.size();
+            before.assign(rank, 0);
+            after.assign(rank, 0);
+            for (std::size_t d = 0; d < rank; ++d)
+            {
+                std::size_t n = shape[d];
+                std::size_t k = kernel_shape[d];
+                std::size_t m = std::min(n, k);
+                switch (mode)
+                {
+                case convolve_mode::full:
+                    before[d] = k - 1;
+                    after[d] = k - 1;
+                    break;
+                case convolve_mode::same:
+                {
+                    // offset of the result in the full one, whose reversal
+                    // shifts the center for even sizes
+                    std::size_t first = !flip && k > n ? m / 2 : m - 1 - m / 2;
+                    before[d] = k - 1 - first;
+                    after[d] = std::max(n, k) + k - 1 - n - before[d];
+                    break;
+                }
+                case convolve_mode::valid:
+                    before[d] = k - m;
+                    after[d] = k - m;
+                    break;
+                }
+            }
+        }
+
+        // Evaluates a correlation of e with kernel, flipped beforehand for
+        // a convolution. The input is copied to a zero-padded buffer, unless
+        // it is a row-major container and no padding is required.
+        template <class T, class E1, class E2>
+        inline xarray<T> conv_impl(const std::string& fn, const E1& e, const E2& kernel, bool flip,
+                                   const std::vector<std::size_t>* padding, convolve_mode mode,
+                                   const std::vector<std::size_t>& strides)
+        {
+            std::size_t rank = e.dimension();
+            if (rank == 0 || kernel.dimension() != rank)
+            {
+                throw convolve_error(fn, "operands must have the same number of dimensions, at least 1");
+            }
+            if (e.size() == 0 || kernel.size() == 0)
+            {
+                throw convolve_error(fn, "empty operand");
+            }
+            if ((padding != nullptr && padding->size() != rank) || (!strides.empty() && strides.size() != rank))
+            {
+                throw convolve_error(fn, "padding and strides must have one element per dimension");
+            }
+            if (std::find(strides.cbegin(), strides.cend(), std::size_t(0)) != strides.cend())
+            {
+                throw convolve_error(fn, "strides must be positive");
+            }
+
+            // a convolution is commutative: a kernel larger than the input
+            // in every dimension is cheaper applied the other way round
+            if (flip && padding == nullptr && kernel.size() > e.size() &&
+                std::equal(e.shape().cbegin(), e.shape().cend(), kernel.shape().cbegin(), std::less_equal<std::size_t>()))
+            {
+                return conv_impl<T>(fn, kernel, e, flip, padding, mode, strides);
+            }
+
+            // one dimensional problems get a leading dimension of size 1
+            std::size_t offset = rank == 1 ? 1 : 0;
+            std::size_t prank = rank + offset;
+
+            xarray<T> tmp_k;
+            auto op_k = linalg_data(kernel, tmp_k);
+            std::vector<std::size_t> kernel_shape(prank, 1);
+            std::copy(kernel.shape().cbegin(), kernel.shape().cend(), kernel_shape.begin() + offset);
+            const T* kdata = op_k.data;
+            std::vector<std::ptrdiff_t> kstrides(op_k.strides);
+            if (flip)
+            {
+                for (std::size_t d = 0; d < rank; ++d)
+                {
+                    kdata += static_cast<std::ptrdiff_t>(kernel_shape[d + offset] - 1) * kstrides[d];
+                    kstrides[d] = -kstrides[d];
+                }
+            }
+            xarray<T> w(typename xarray<T>::shape_type(kernel_shape.cbegin(), kernel_shape.cend()));
+            strided_copy(kdata, kernel.shape(), kstrides, w.data().begin());
+
+            std::vector<std::size_t> shape(prank, 1);
+            std::copy(e.shape().cbegin(), e.shape().cend(), shape.begin() + offset);
+            std::vector<std::size_t> before, after;
+            if (padding != nullptr)
+            {
+                before.assign(prank, 0);
+                std::copy(padding->cbegin(), padding->cend(), before.begin() + offset);
+                after = before;
+            }
+            else
+            {
+                conv_mode_padding(mode, shape, kernel_shape, flip, before, after);
+            }
+
+            conv_problem<T> p;
+            p.kernel = w.data().data();
+            p.kernel_shape = kernel_shape;
+            p.strides.assign(prank, 1);
+            std::copy(strides.cbegin(), strides.cend(), p.strides.begin() + offset);
+            p.input_shape.resize(prank);
+            p.output_shape.resize(prank);
+            for (std::size_t d = 0; d < prank; ++d)
+            {
+                p.input_shape[d] = shape[d] + before[d] + after[d];
+                if (p.input_shape[d] < kernel_shape[d])
+                {
+                    throw convolve_error(fn, "kernel larger than the padded input");
+                }
+                p.output_shape[d] = (p.input_shape[d] - kernel_shape[d]) / p.strides[d] + 1;
+            }
+            p.input_strides = conv_row_major_strides(p.input_shape);
+
+            xarray<T> tmp_e;
+            auto op_e = linalg_data(e, tmp_e);
+            std::vector<std::ptrdiff_t> estrides(prank, 0);
+            std::copy(op_e.strides.cbegin(), op_e.strides.cend(), estrides.begin() + offset);
+            bool padded = std::any_of(before.cbegin(), before.cend(), [](std::size_t i) { return i != 0; }) ||
+                          std::any_of(after.cbegin(), after.cend(), [](std::size_t i) { return i != 0; });
+            bool row_major = true;
+            for (std::size_t d = 0; d < prank; ++d)
+            {
+                row_major = row_major && (shape[d] == 1 || estrides[d] == p.input_strides[d]);
+            }
+
+            xarray<T> input;
+            if (!padded && row_major)
+            {
+                p.input = op_e.data;
+            }
+            else
+            {
+                input = xarray<T>(typename xarray<T>::shape_type(p.input_shape.cbegin(), p.input_shape.cend()), T(0));
+                std::vector<std::size_t> row_shape(shape.cbegin(), shape.cend() - 1);
+                std::vector<std::ptrdiff_t> src_factors(estrides.cbegin(), estrides.cend() - 1);
+                std::vector<std::ptrdiff_t> dst_factors(p.input_strides.cbegin(), p.input_strides.cend() - 1);
+                std::vector<std::ptrdiff_t> src_rows = conv_offsets(row_shape, src_factors);
+                std::vector<std::ptrdiff_t> dst_rows = conv_offsets(row_shape, dst_factors);
+                std::ptrdiff_t origin = std::inner_product(before.cbegin(), before.cend(), p.input_strides.cbegin(),
+                                                           std::ptrdiff_t(0),
+                                                           std::plus<std::ptrdiff_t>(),
+                                                           [](std::size_t b, std::ptrdiff_t s) { return static_cast<std::ptrdiff_t>(b) * s; });
+                std::array<std::size_t, 1> last_shape = {shape.back()};
+                std::array<std::ptrdiff_t, 1> last_stride = {estrides.back()};
+                T* dst = input.data().data() + origin;
+                for (std::size_t r = 0; r < src_rows.size(); ++r)
+                {
+                    strided_copy(op_e.data + src_rows[r], last_shape, last_stride, dst + dst_rows[r]);
+                }
+                p.input = input.data().data();
+            }
+
+            xarray<T> res(typename xarray<T>::shape_type(p.output_shape.cbegin() + static_cast<std::ptrdiff_t>(offset),
+                                                         p.output_shape.cend()),
+                          T(0));
+            p.output = res.data().data();
+            conv_run(p);
+            return res;
+        }
+    }
+
+    /*****************************************
+     * convolve and correlate implementation *
+     *****************************************/
+
+    /**
+     * @brief Convolution of two expressions.
+     *
+     * Computes the discrete convolution of \a e with \a kernel, two
+     * expressions of the same dimension. The elements outside of \a e
+     * are taken as zeros. Like \c dot, convolve is not lazy and returns
+     * an xarray.
+     *
+     * Small kernels are applied directly, tap by tap. Kernels with long
+     * rows are computed with matrix products of the kernel rows by the
+     * input rows, when the strides are 1. In both cases the result is
+     * split in tiles computed concurrently.
+     * @param e the input expression
+     * @param kernel the convolution kernel
+     * @param mode the size of the result, as in numpy.convolve
+     * @param strides the step between two consecutive outputs in each
+     * dimension, 1 when empty
+     * @return an xarray holding the result
+     */
+    template <class E1, class E2>
+    inline auto convolve(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                         convolve_mode mode, const std::vector<std::size_t>& strides)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        return detail::conv_impl<value_type>("convolve", e.derived_cast(), kernel.derived_cast(), true, nullptr, mode, strides);
+    }
+
+    /**
+     * @brief Convolution of two expressions.
+     *
+     * Same as above, the input being padded with \a padding[i] zeros on
+     * both sides of the dimension i, and the result holding every position
+     * where the kernel lies entirely in the padded input.
+     * @param e the input expression
+     * @param kernel the convolution kernel
+     * @param padding the number of zeros added on each side of each dimension
+     * @param strides the step between two consecutive outputs in each
+     * dimension, 1 when empty
+     * @return an xarray holding the result
+     */
+    template <class E1, class E2>
+    inline auto convolve(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                         const std::vector<std::size_t>& padding, const std::vector<std::size_t>& strides)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        return detail::conv_impl<value_type>("convolve", e.derived_cast(), kernel.derived_cast(), true, &padding,
+                                             convolve_mode::valid, strides);
+    }
+
+    /**
+     * @brief Cross-correlation of two expressions.
+     *
+     * Computes the cross-correlation of \a e with \a kernel, that is the
+     * convolution of \a e with \a kernel flipped in every dimension. As
+     * in numpy.correlate, the default mode is valid.
+     * @param e the input expression
+     * @param kernel the correlation kernel
+     * @param mode the size of the result
+     * @param strides the step between two consecutive outputs in each
+     * dimension, 1 when empty
+     * @return an xarray holding the result
+     */
+    template <class E1, class E2>
+    inline auto correlate(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                          convolve_mode mode, const std::vector<std::size_t>& strides)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        return detail::conv_impl<value_type>("correlate", e.derived_cast(), kernel.derived_cast(), false, nullptr, mode, strides);
+    }
+
+    /**
+     * @brief Cross-correlation of two expressions.
+     *
+     * Same as above, with an explicit zero padding of the input.
+     * @param e the input expression
+     * @param kernel the correlation kernel
+     * @param padding the number of zeros added on each side of each dimension
+     * @param strides the step between two consecutive outputs in each
+     * dimension, 1 when empty
+     * @return an xarray holding the result
+     */
+    template <class E1, class E2>
+    inline auto correlate(const xexpression<E1>& e, const xexpression<E2>& kernel,
+                          const std::vector<std::size_t>& padding, const std::vector<std::size_t>& strides)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        return detail::conv_impl<value_type>("correlate", e.derived_cast(), kernel.derived_cast(), false, &padding,
+                                             convolve_mode::valid, strides);
+    }
+}
+
+#endif
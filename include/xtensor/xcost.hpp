@@ -0,0 +1,540 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+/**
+ * @brief cost model selecting how expressions are evaluated
+ */
+
+#ifndef XCOST_HPP
+#define XCOST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include "xtensor_forward.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+    template <class CT>
+    class xscalar;
+
+    template <class F, class R, class... CT>
+    class xfunction;
+
+    template <class CT, class X>
+    class xbroadcast;
+
+    template <class CT>
+    class xstrided_view;
+
+    template <class CT, class I>
+    class xindexview;
+
+    template <class CT, class M, std::size_t I>
+    class xoffsetview;
+
+    template <class F, class CT, class X>
+    class xreducer;
+
+    template <class F, class R, class S>
+    class xgenerator;
+
+    template <class CT1, class CT2>
+    class xouter;
+
+    namespace detail
+    {
+        template <class T>
+        struct arange_impl;
+
+        template <class T>
+        struct logspace_impl;
+
+        template <class F>
+        struct fn_impl;
+
+        template <class T>
+        struct eye_fn;
+
+        template <class T, class D>
+        struct counter_random_impl;
+    }
+
+    /************************
+     * execution_thresholds *
+     ************************/
+
+    /**
+     * @class execution_thresholds
+     * @brief Thresholds of the cost model, in units of an arithmetic
+     * operation on an element.
+     *
+     * The cost of an assignment is estimated as the number of elements
+     * times the cost of an element, given by \ref element_cost. Below
+     * the threshold that applies, the assignment runs on the calling
+     * thread; above it, it is split in tasks of at least \c task_cost.
+     * Assignments without executor, such as <tt>res = f(a)</tt>, are only
+     * split once \c default_parallel_cost has been lowered: the functors
+     * of the expression, such as the function given to vectorize, must
+     * then be safe to call concurrently.
+     * The tasks split the elements of the result: a full reduction, which
+     * has a single element, always runs serially.
+     *
+     * @sa get_execution_thresholds, set_execution_thresholds
+     */
+    struct execution_thresholds
+    {
+        /// Minimal cost of an assignment split over the executor given to assign or eval.
+        std::size_t parallel_cost = std::size_t(1) << 17;
+        /// Minimal cost of an assignment without executor run on the default
+        /// executor. Such assignments run on the calling thread by default.
+        std::size_t default_parallel_cost = std::numeric_limits<std::size_t>::max();
+        /// Minimal cost of a task.
+        std::size_t task_cost = std::size_t(1) << 15;
+    };
+
+    execution_thresholds get_execution_thresholds();
+    void set_execution_thresholds(const execution_thresholds& thresholds);
+
+    /****************
+     * functor_cost *
+     ****************/
+
+    /**
+     * @class functor_cost
+     * @brief Cost of a call to a functor of type \c F.
+     *
+     * Arithmetic and comparison operators cost one operation and
+     * divisions four. Functions called through a pointer, such as the
+     * mathematical functions, are assumed to be transcendental and cost
+     * sixteen operations; other functors cost four. Specialize this
+     * structure to describe the cost of your own functors.
+     */
+    template <class F, class = void>
+    struct functor_cost : std::integral_constant<std::size_t, 4>
+    {
+    };
+
+    template <class F>
+    struct functor_cost<F, std::enable_if_t<std::is_pointer<F>::value>>
+        : std::integral_constant<std::size_t, 16>
+    {
+    };
+
+#define XTENSOR_FUNCTOR_COST(NAME, COST)                                          \
+    template <class T>                                                            \
+    struct functor_cost<NAME<T>> : std::integral_constant<std::size_t, COST>      \
+    {                                                                             \
+    };
+
+    XTENSOR_FUNCTOR_COST(std::plus, 1)
+    XTENSOR_FUNCTOR_COST(std::minus, 1)
+    XTENSOR_FUNCTOR_COST(std::multiplies, 1)
+    XTENSOR_FUNCTOR_COST(std::negate, 1)
+    XTENSOR_FUNCTOR_COST(std::divides, 4)
+    XTENSOR_FUNCTOR_COST(std::modulus, 4)
+    XTENSOR_FUNCTOR_COST(std::logical_and, 1)
+    XTENSOR_FUNCTOR_COST(std::logical_or, 1)
+    XTENSOR_FUNCTOR_COST(std::logical_not, 1)
+    XTENSOR_FUNCTOR_COST(std::equal_to, 1)
+    XTENSOR_FUNCTOR_COST(std::not_equal_to, 1)
+    XTENSOR_FUNCTOR_COST(std::less, 1)
+    XTENSOR_FUNCTOR_COST(std::less_equal, 1)
+    XTENSOR_FUNCTOR_COST(std::greater, 1)
+    XTENSOR_FUNCTOR_COST(std::greater_equal, 1)
+
+#undef XTENSOR_FUNCTOR_COST
+
+    // Drawing from a counter-based engine runs the ten rounds of the
+    // Philox bijection.
+    template <class T, class D>
+    struct functor_cost<detail::counter_random_impl<T, D>> : std::integral_constant<std::size_t, 32>
+    {
+    };
+
+    /***********************
+     * is_parallel_functor *
+     ***********************/
+
+    /**
+     * @class is_parallel_functor
+     * @brief Whether the functor \c F of a generator may compute elements
+     * from concurrent tasks.
+     *
+     * Generators may hold state, such as a random engine or the cache of
+     * a file, and are therefore evaluated on a single thread by default.
+     * Specialize this structure to \c std::true_type for the functors
+     * whose calls are independent, so that the expressions using them can
+     * be split over several tasks.
+     */
+    template <class F>
+    struct is_parallel_functor : std::false_type
+    {
+    };
+
+    template <class T>
+    struct is_parallel_functor<detail::arange_impl<T>> : std::true_type
+    {
+    };
+
+    template <class T>
+    struct is_parallel_functor<detail::logspace_impl<T>> : std::true_type
+    {
+    };
+
+    template <class T>
+    struct is_parallel_functor<detail::fn_impl<detail::eye_fn<T>>> : std::true_type
+    {
+    };
+
+    // Elements of counter-based random generators only depend on their
+    // position.
+    template <class T, class D>
+    struct is_parallel_functor<detail::counter_random_impl<T, D>> : std::true_type
+    {
+    };
+
+    /********************
+     * xexpression_cost *
+     ********************/
+
+    namespace detail
+    {
+        // Sub-expressions evaluated by an element of an expression
+        template <class E>
+        struct xoperands
+        {
+            using type = std::tuple<>;
+        };
+
+        template <class F, class R, class... CT>
+        struct xoperands<xfunction<F, R, CT...>>
+        {
+            using type = std::tuple<std::decay_t<CT>...>;
+        };
+
+        template <class CT, class X>
+        struct xoperands<xbroadcast<CT, X>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class CT, class... S>
+        struct xoperands<xview<CT, S...>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class CT>
+        struct xoperands<xstrided_view<CT>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class CT, class I>
+        struct xoperands<xindexview<CT, I>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class CT, class M, std::size_t I>
+        struct xoperands<xoffsetview<CT, M, I>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class F, class CT, class X>
+        struct xoperands<xreducer<F, CT, X>>
+        {
+            using type = std::tuple<std::decay_t<CT>>;
+        };
+
+        template <class CT1, class CT2>
+        struct xoperands<xouter<CT1, CT2>>
+        {
+            using type = std::tuple<std::decay_t<CT1>, std::decay_t<CT2>>;
+        };
+
+        // Cost of an element, excluding its operands
+        template <class E>
+        struct xnode_cost : std::integral_constant<std::size_t, 1>
+        {
+        };
+
+        template <class CT>
+        struct xnode_cost<xscalar<CT>> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <class CT, class X>
+        struct xnode_cost<xbroadcast<CT, X>> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <class F, class R, class... CT>
+        struct xnode_cost<xfunction<F, R, CT...>> : functor_cost<F>
+        {
+        };
+
+        template <class F, class CT, class X>
+        struct xnode_cost<xreducer<F, CT, X>> : functor_cost<std::decay_t<F>>
+        {
+        };
+
+        template <class F, class R, class S>
+        struct xnode_cost<xgenerator<F, R, S>> : functor_cost<F>
+        {
+        };
+
+        // Expressions whose elements may be computed by concurrent tasks;
+        // generators only if their functor declares it.
+        template <class E>
+        struct is_parallel_node : std::true_type
+        {
+        };
+
+        template <class F, class R, class S>
+        struct is_parallel_node<xgenerator<F, R, S>> : is_parallel_functor<F>
+        {
+        };
+
+        // Expressions whose elements may be computed concurrently from the
+        // same instance; reducers hold the index of the element being
+        // reduced, concurrent tasks evaluate their own copy.
+        template <class E>
+        struct is_shared_node : std::true_type
+        {
+        };
+
+        template <class F, class CT, class X>
+        struct is_shared_node<xreducer<F, CT, X>> : std::false_type
+        {
+        };
+
+        template <class T>
+        struct sum_cost;
+
+        template <template <class> class P, class T>
+        struct all_operands;
+
+        template <template <class> class P, class E>
+        struct all_nodes : std::integral_constant<bool, P<E>::value &&
+                                                        all_operands<P, typename xoperands<E>::type>::value>
+        {
+        };
+
+        template <template <class> class P, class... E>
+        struct all_operands<P, std::tuple<E...>> : and_<all_nodes<P, E>...>
+        {
+        };
+    }
+
+    /**
+     * @class xexpression_cost
+     * @brief Compile-time estimate of the cost of an element of an
+     * expression of type \c E.
+     *
+     * The cost is the sum of the costs of the functors and of the loads of
+     * the expression tree; the reductions count as a single element of the
+     * reduced expression.
+     *
+     * @sa element_cost
+     */
+    template <class E>
+    struct xexpression_cost
+        : std::integral_constant<std::size_t, detail::xnode_cost<E>::value +
+                                              detail::sum_cost<typename detail::xoperands<E>::type>::value>
+    {
+    };
+
+    namespace detail
+    {
+        template <>
+        struct sum_cost<std::tuple<>> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <class E, class... R>
+        struct sum_cost<std::tuple<E, R...>>
+            : std::integral_constant<std::size_t, xexpression_cost<E>::value + sum_cost<std::tuple<R...>>::value>
+        {
+        };
+
+        template <class E>
+        using is_parallel_expression = all_nodes<is_parallel_node, E>;
+
+        template <class E>
+        using is_shared_expression = all_nodes<is_shared_node, E>;
+
+        // Expressions whose const_iterator can be advanced in constant time,
+        // allowing to assign blocks of elements linearly.
+        template <class E>
+        struct is_linear_expression : is_container<E>
+        {
+        };
+
+        template <class CT>
+        struct is_linear_expression<xscalar<CT>> : std::true_type
+        {
+        };
+
+        template <class F, class R, class... CT>
+        struct is_linear_expression<xfunction<F, R, CT...>> : and_<is_linear_expression<std::decay_t<CT>>...>
+        {
+        };
+    }
+
+    /****************
+     * element_cost *
+     ****************/
+
+    template <class E>
+    std::size_t element_cost(const E& e) noexcept;
+
+    template <class F, class R, class... CT>
+    std::size_t element_cost(const xfunction<F, R, CT...>& e) noexcept;
+
+    template <class F, class CT, class X>
+    std::size_t element_cost(const xreducer<F, CT, X>& e) noexcept;
+
+    /******************
+     * execution_plan *
+     ******************/
+
+    /**
+     * @class execution_plan
+     * @brief Evaluation strategy of an assignment.
+     */
+    struct execution_plan
+    {
+        /// Number of tasks; the assignment runs on the calling thread when it is 1.
+        std::size_t nb_tasks;
+        /// Number of elements assigned by a task.
+        std::size_t grain;
+    };
+
+    namespace detail
+    {
+        execution_plan make_execution_plan(std::size_t size, std::size_t cost,
+                                           std::size_t min_cost, std::size_t concurrency);
+    }
+
+    /***************************************
+     * execution_thresholds implementation *
+     ***************************************/
+
+    namespace detail
+    {
+        struct execution_thresholds_storage
+        {
+            std::atomic<std::size_t> m_parallel_cost{execution_thresholds().parallel_cost};
+            std::atomic<std::size_t> m_default_parallel_cost{execution_thresholds().default_parallel_cost};
+            std::atomic<std::size_t> m_task_cost{execution_thresholds().task_cost};
+        };
+
+        inline execution_thresholds_storage& get_execution_thresholds_storage()
+        {
+            static execution_thresholds_storage storage;
+            return storage;
+        }
+    }
+
+    /**
+     * Returns the thresholds of the cost model.
+     */
+    inline execution_thresholds get_execution_thresholds()
+    {
+        const auto& storage = detail::get_execution_thresholds_storage();
+        execution_thresholds res;
+        res.parallel_cost = storage.m_parallel_cost.load(std::memory_order_relaxed);
+        res.default_parallel_cost = storage.m_default_parallel_cost.load(std::memory_order_relaxed);
+        res.task_cost = storage.m_task_cost.load(std::memory_order_relaxed);
+        return res;
+    }
+
+    /**
+     * Replaces the thresholds of the cost model for all threads. Setting a
+     * parallel threshold to its maximal value disables the corresponding
+     * parallel evaluation.
+     *
+     * @code{.cpp}
+     * xt::execution_thresholds th = xt::get_execution_thresholds();
+     * th.default_parallel_cost = std::size_t(1) << 20;
+     * xt::set_execution_thresholds(th);
+     * @endcode
+     */
+    inline void set_execution_thresholds(const execution_thresholds& thresholds)
+    {
+        auto& storage = detail::get_execution_thresholds_storage();
+        storage.m_parallel_cost.store(thresholds.parallel_cost, std::memory_order_relaxed);
+        storage.m_default_parallel_cost.store(thresholds.default_parallel_cost, std::memory_order_relaxed);
+        storage.m_task_cost.store(std::max(thresholds.task_cost, std::size_t(1)), std::memory_order_relaxed);
+    }
+
+    /*******************************
+     * element_cost implementation *
+     *******************************/
+
+    /**
+     * Returns the estimated cost of an element of the expression \c e, in
+     * units of an arithmetic operation. Contrary to \ref xexpression_cost,
+     * it accounts for the number of elements reduced by the reducers.
+     */
+    template <class E>
+    inline std::size_t element_cost(const E&) noexcept
+    {
+        return xexpression_cost<E>::value;
+    }
+
+    template <class F, class R, class... CT>
+    inline std::size_t element_cost(const xfunction<F, R, CT...>& e) noexcept
+    {
+        auto f = [](std::size_t c, const auto& arg) noexcept { return c + element_cost(arg); };
+        return accumulate(f, std::size_t(functor_cost<F>::value), e.arguments());
+    }
+
+    template <class F, class CT, class X>
+    inline std::size_t element_cost(const xreducer<F, CT, X>& e) noexcept
+    {
+        std::size_t size = e.size();
+        std::size_t reduced = size == 0 ? 0 : e.expression().size() / size;
+        return reduced * (element_cost(e.expression()) + functor_cost<std::decay_t<F>>::value);
+    }
+
+    /*********************************
+     * execution_plan implementation *
+     *********************************/
+
+    namespace detail
+    {
+        // Splits an assignment of the given size and cost in tasks of at
+        // least task_cost, and at most four per thread of the executor,
+        // unless its cost is below min_cost.
+        inline execution_plan make_execution_plan(std::size_t size, std::size_t cost,
+                                                  std::size_t min_cost, std::size_t concurrency)
+        {
+            std::size_t nb_tasks = 1;
+            if (concurrency > 1 && cost >= min_cost)
+            {
+                std::size_t task_cost = get_execution_thresholds().task_cost;
+                nb_tasks = std::min(std::min(cost / task_cost, 4 * concurrency), size);
+                nb_tasks = std::max(nb_tasks, std::size_t(1));
+            }
+            std::size_t grain = nb_tasks == 1 ? size : (size + nb_tasks - 1) / nb_tasks;
+            return {nb_tasks, grain};
+        }
+    }
+}
+
+#endif
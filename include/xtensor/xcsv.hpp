@@ -0,0 +1,547 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XCSV_HPP
+#define XCSV_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xexecutor.hpp"
+#include "xnpy.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+    template <class T>
+    xarray<T> load_csv(std::istream& stream, char delimiter = ',', std::size_t skip_rows = 0);
+
+    template <class T>
+    xarray<T> load_csv(const std::string& filename, char delimiter = ',', std::size_t skip_rows = 0);
+
+    template <class E>
+    void load_csv(std::istream& stream, E& e, char delimiter = ',', std::size_t skip_rows = 0);
+
+    template <class E>
+    void load_csv(const std::string& filename, E& e, char delimiter = ',', std::size_t skip_rows = 0);
+
+    template <class T, class F>
+    void load_csv_blocks(std::istream& stream, std::size_t block_rows, F&& f,
+                         char delimiter = ',', std::size_t skip_rows = 0);
+
+    /*****************
+     * csv internals *
+     *****************/
+
+    namespace detail
+    {
+        inline std::runtime_error csv_error(const std::string& msg)
+        {
+            return std::runtime_error("csv: " + msg);
+        }
+
+        // Minimal amount of text parsed by a task.
+        constexpr std::size_t csv_min_chunk_size = std::size_t(1) << 20;
+
+        inline bool is_csv_digit(char c) noexcept
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        inline void skip_csv_spaces(const char*& first, const char* last, char delimiter) noexcept
+        {
+            while (first != last && (*first == ' ' || *first == '\t') && *first != delimiter)
+            {
+                ++first;
+            }
+        }
+
+        inline double exact_csv_power(int n) noexcept
+        {
+            static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            return powers[n];
+        }
+
+        // Parses a floating point value with strtod. Used for the values
+        // that cannot be converted exactly by parse_csv_float.
+        inline bool parse_csv_strtod(const char*& first, const char* last, double& value)
+        {
+            const char* end = std::find_if(first, last, [](char c) {
+                return !(std::isalnum(static_cast<unsigned char>(c)) || c == '+' || c == '-' || c == '.');
+            });
+            std::string token(first, end);
+            char* token_end = nullptr;
+            value = std::strtod(token.c_str(), &token_end);
+            if (token_end == token.c_str())
+            {
+                return false;
+            }
+            first += token_end - token.c_str();
+            return true;
+        }
+
+        // Parses a decimal floating point value. When the significand has
+        // at most 19 digits and fits in a double, and the power of ten is
+        // exactly representable, a single multiplication or division gives
+        // the correctly rounded value; strtod is used otherwise.
+        inline bool parse_csv_float(const char*& first, const char* last, double& value)
+        {
+            const char* it = first;
+            bool negative = false;
+            if (it != last && (*it == '-' || *it == '+'))
+            {
+                negative = *it == '-';
+                ++it;
+            }
+
+            std::uint64_t significand = 0;
+            int exponent = 0;
+            int nb_digits = 0;
+            bool has_digits = false;
+            bool exact = true;
+            auto accumulate = [&](char c, int shift) {
+                has_digits = true;
+                if (significand == 0 && c == '0')
+                {
+                    exponent += shift;
+                }
+                else if (nb_digits < 19)
+                {
+                    significand = significand * 10 + std::uint64_t(c - '0');
+                    ++nb_digits;
+                    exponent += shift;
+                }
+                else
+                {
+                    exact = false;
+                }
+            };
+            for (; it != last && is_csv_digit(*it); ++it)
+            {
+                accumulate(*it, 0);
+            }
+            if (it != last && *it == '.')
+            {
+                for (++it; it != last && is_csv_digit(*it); ++it)
+                {
+                    accumulate(*it, -1);
+                }
+            }
+            if (!has_digits)
+            {
+                // nan, inf
+                return parse_csv_strtod(first, last, value);
+            }
+            if (it != last && (*it == 'e' || *it == 'E'))
+            {
+                const char* exp_it = it + 1;
+                bool exp_negative = false;
+                if (exp_it != last && (*exp_it == '-' || *exp_it == '+'))
+                {
+                    exp_negative = *exp_it == '-';
+                    ++exp_it;
+                }
+                if (exp_it != last && is_csv_digit(*exp_it))
+                {
+                    int exp_value = 0;
+                    for (; exp_it != last && is_csv_digit(*exp_it); ++exp_it)
+                    {
+                        exp_value = std::min(exp_value * 10 + (*exp_it - '0'), 100000);
+                    }
+                    exponent += exp_negative ? -exp_value : exp_value;
+                    it = exp_it;
+                }
+            }
+
+            if (!exact || significand > (std::uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+            {
+                return parse_csv_strtod(first, last, value);
+            }
+            value = static_cast<double>(significand);
+            value = exponent < 0 ? value / exact_csv_power(-exponent) : value * exact_csv_power(exponent);
+            value = negative ? -value : value;
+            first = it;
+            return true;
+        }
+
+        template <class T>
+        inline bool parse_csv_integer(const char*& first, const char* last, T& value)
+        {
+            using unsigned_type = std::make_unsigned_t<T>;
+            const char* it = first;
+            bool negative = false;
+            if (it != last && (*it == '-' || *it == '+'))
+            {
+                negative = *it == '-';
+                ++it;
+            }
+            if (it == last || !is_csv_digit(*it))
+            {
+                return false;
+            }
+            unsigned_type limit = negative ? unsigned_type(unsigned_type(0) - static_cast<unsigned_type>(std::numeric_limits<T>::min())) :
+                                             static_cast<unsigned_type>(std::numeric_limits<T>::max());
+            unsigned_type res = 0;
+            for (; it != last && is_csv_digit(*it); ++it)
+            {
+                unsigned_type digit = static_cast<unsigned_type>(*it - '0');
+                if (digit > limit || res > (limit - digit) / 10)
+                {
+                    return false;
+                }
+                res = static_cast<unsigned_type>(res * 10 + digit);
+            }
+            value = negative ? static_cast<T>(unsigned_type(0) - res) : static_cast<T>(res);
+            first = it;
+            return true;
+        }
+
+        template <class T>
+        inline bool parse_csv_value(const char*& first, const char* last, T& value, std::true_type)
+        {
+            double res;
+            bool ok = parse_csv_float(first, last, res);
+            value = static_cast<T>(res);
+            return ok;
+        }
+
+        template <class T>
+        inline bool parse_csv_value(const char*& first, const char* last, T& value, std::false_type)
+        {
+            return parse_csv_integer(first, last, value);
+        }
+
+        inline bool parse_csv_value(const char*& first, const char* last, bool& value, std::false_type)
+        {
+            unsigned int res;
+            bool ok = parse_csv_integer(first, last, res);
+            value = res != 0;
+            return ok;
+        }
+
+        inline const char* csv_line_end(const char* first, const char* last) noexcept
+        {
+            const void* p = std::memchr(first, '\n', static_cast<std::size_t>(last - first));
+            return p != nullptr ? static_cast<const char*>(p) : last;
+        }
+
+        inline const char* next_csv_line(const char* line_end, const char* last) noexcept
+        {
+            return line_end == last ? last : line_end + 1;
+        }
+
+        inline bool is_blank_csv_line(const char* first, const char* last) noexcept
+        {
+            return std::all_of(first, last, [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+        }
+
+        inline std::size_t count_csv_rows(const char* first, const char* last) noexcept
+        {
+            std::size_t res = 0;
+            while (first != last)
+            {
+                const char* line_end = csv_line_end(first, last);
+                if (!is_blank_csv_line(first, line_end))
+                {
+                    ++res;
+                }
+                first = next_csv_line(line_end, last);
+            }
+            return res;
+        }
+
+        inline std::size_t count_csv_columns(const char* first, const char* last, char delimiter) noexcept
+        {
+            while (first != last)
+            {
+                const char* line_end = csv_line_end(first, last);
+                if (!is_blank_csv_line(first, line_end))
+                {
+                    return static_cast<std::size_t>(std::count(first, line_end, delimiter)) + 1;
+                }
+                first = next_csv_line(line_end, last);
+            }
+            return 0;
+        }
+
+        // Parses the rows of [first, last) into out, in row-major order.
+        // row is the index of the first row, for error messages.
+        template <class T>
+        inline void parse_csv_rows(const char* first, const char* last, T* out, std::size_t nb_columns,
+                                   char delimiter, std::size_t row)
+        {
+            while (first != last)
+            {
+                const char* line_end = csv_line_end(first, last);
+                if (!is_blank_csv_line(first, line_end))
+                {
+                    const char* it = first;
+                    for (std::size_t c = 0; c < nb_columns; ++c, ++out)
+                    {
+                        skip_csv_spaces(it, line_end, delimiter);
+                        if (!parse_csv_value(it, line_end, *out, std::is_floating_point<T>()))
+                        {
+                            throw csv_error("invalid value in row " + std::to_string(row) +
+                                            ", column " + std::to_string(c));
+                        }
+                        skip_csv_spaces(it, line_end, delimiter);
+                        if (c + 1 != nb_columns)
+                        {
+                            if (it == line_end || *it != delimiter)
+                            {
+                                throw csv_error("row " + std::to_string(row) + " has less than " +
+                                                std::to_string(nb_columns) + " columns");
+                            }
+                            ++it;
+                        }
+                    }
+                    if (!is_blank_csv_line(it, line_end))
+                    {
+                        throw csv_error("row " + std::to_string(row) + " has more than " +
+                                        std::to_string(nb_columns) + " columns");
+                    }
+                    ++row;
+                }
+                first = next_csv_line(line_end, last);
+            }
+        }
+
+        // Runs f(0), ..., f(n - 1) on the default executor; exceptions are
+        // propagated.
+        template <class F>
+        inline void run_csv_tasks(std::size_t n, F&& f)
+        {
+            parallel_for(default_executor(), n, std::forward<F>(f));
+        }
+
+        // Splits [first, last) in at most n ranges starting at line beginnings.
+        inline std::vector<const char*> split_csv(const char* first, const char* last)
+        {
+            std::size_t size = static_cast<std::size_t>(last - first);
+            std::size_t n = default_executor().concurrency();
+            n = std::min(n, size / csv_min_chunk_size + 1);
+            std::vector<const char*> bounds(1, first);
+            for (std::size_t k = 1; k < n; ++k)
+            {
+                const char* it = first + size / n * k;
+                if (it > bounds.back())
+                {
+                    it = next_csv_line(csv_line_end(it, last), last);
+                    if (it != last && it > bounds.back())
+                    {
+                        bounds.push_back(it);
+                    }
+                }
+            }
+            bounds.push_back(last);
+            return bounds;
+        }
+
+        inline const char* skip_csv_rows(const char* first, const char* last, std::size_t skip_rows) noexcept
+        {
+            for (std::size_t i = 0; i < skip_rows && first != last; ++i)
+            {
+                first = next_csv_line(csv_line_end(first, last), last);
+            }
+            return first;
+        }
+
+        // Parses [first, last) into e: rows are counted in parallel, e is
+        // reshaped, then each range is parsed in parallel into its rows.
+        template <class E>
+        inline void load_csv_buffer(const char* first, const char* last, E& e, char delimiter, std::size_t row = 0)
+        {
+            using value_type = typename E::value_type;
+            using shape_type = typename E::shape_type;
+
+            std::vector<const char*> bounds = split_csv(first, last);
+            std::size_t n = bounds.size() - 1;
+            std::vector<std::size_t> offsets(n + 1, 0);
+            run_csv_tasks(n, [&bounds, &offsets](std::size_t k) {
+                offsets[k + 1] = count_csv_rows(bounds[k], bounds[k + 1]);
+            });
+            std::partial_sum(offsets.cbegin(), offsets.cend(), offsets.begin());
+
+            std::size_t nb_columns = count_csv_columns(first, last, delimiter);
+            shape_type shape = make_sequence<shape_type>(2, 0);
+            if (shape.size() != 2)
+            {
+                throw csv_error("the container must have two dimensions");
+            }
+            shape[0] = offsets.back();
+            shape[1] = nb_columns;
+            e.reshape(shape, layout::row_major);
+
+            value_type* out = e.data().data();
+            run_csv_tasks(n, [&](std::size_t k) {
+                parse_csv_rows(bounds[k], bounds[k + 1], out + offsets[k] * nb_columns,
+                               nb_columns, delimiter, row + offsets[k]);
+            });
+        }
+    }
+
+    /***************************
+     * load_csv implementation *
+     ***************************/
+
+    /**
+     * @name CSV files
+     */
+    //@{
+    /**
+     * Reads delimited text into a two-dimensional container. Each
+     * non-blank line is a row; all the rows must have the same number of
+     * fields. The text is split in ranges of lines that are parsed in
+     * parallel, directly into the buffer of the container.
+     * @param stream the input stream
+     * @param e the container to read into
+     * @param delimiter the field delimiter
+     * @param skip_rows the number of lines to skip at the beginning, such as headers
+     */
+    template <class E>
+    inline void load_csv(std::istream& stream, E& e, char delimiter, std::size_t skip_rows)
+    {
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        std::string text = buffer.str();
+        const char* last = text.data() + text.size();
+        detail::load_csv_buffer(detail::skip_csv_rows(text.data(), last, skip_rows), last, e, delimiter);
+    }
+
+    /**
+     * Reads a delimited text file into a two-dimensional container. The
+     * file is mapped in memory when the platform supports it.
+     * @param filename the name of the file
+     * @param e the container to read into
+     * @param delimiter the field delimiter
+     * @param skip_rows the number of lines to skip at the beginning, such as headers
+     */
+    template <class E>
+    inline void load_csv(const std::string& filename, E& e, char delimiter, std::size_t skip_rows)
+    {
+        std::ifstream stream(filename, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!stream)
+        {
+            throw detail::csv_error("cannot open " + filename);
+        }
+        if (stream.tellg() == std::streampos(0))
+        {
+            detail::load_csv_buffer(nullptr, nullptr, e, delimiter);
+            return;
+        }
+        stream.close();
+        detail::npy_file_mapping mapping(filename);
+        const char* last = mapping.data() + mapping.size();
+        detail::load_csv_buffer(detail::skip_csv_rows(mapping.data(), last, skip_rows), last, e, delimiter);
+    }
+
+    /**
+     * Reads delimited text and returns it as an xarray.
+     * @tparam T the value type of the returned array
+     * @param stream the input stream
+     * @param delimiter the field delimiter
+     * @param skip_rows the number of lines to skip at the beginning, such as headers
+     */
+    template <class T>
+    inline xarray<T> load_csv(std::istream& stream, char delimiter, std::size_t skip_rows)
+    {
+        xarray<T> res;
+        load_csv(stream, res, delimiter, skip_rows);
+        return res;
+    }
+
+    /**
+     * Reads a delimited text file and returns it as an xarray.
+     * @tparam T the value type of the returned array
+     * @param filename the name of the file
+     * @param delimiter the field delimiter
+     * @param skip_rows the number of lines to skip at the beginning, such as headers
+     */
+    template <class T>
+    inline xarray<T> load_csv(const std::string& filename, char delimiter, std::size_t skip_rows)
+    {
+        xarray<T> res;
+        load_csv(filename, res, delimiter, skip_rows);
+        return res;
+    }
+
+    /**
+     * Reads delimited text by blocks of rows, and calls \c f on each block
+     * as a two-dimensional xarray. Only one block is held in memory; the
+     * rows of a block are parsed in parallel.
+     * @tparam T the value type of the blocks
+     * @param stream the input stream
+     * @param block_rows the number of rows of a block; the last block
+     *        may be smaller
+     * @param f the function to call on each block
+     * @param delimiter the field delimiter
+     * @param skip_rows the number of lines to skip at the beginning, such as headers
+     */
+    template <class T, class F>
+    inline void load_csv_blocks(std::istream& stream, std::size_t block_rows, F&& f,
+                                char delimiter, std::size_t skip_rows)
+    {
+        std::string line;
+        for (std::size_t i = 0; i < skip_rows && std::getline(stream, line); ++i)
+        {
+        }
+
+        std::string text;
+        std::size_t nb_rows = 0;
+        std::size_t row = 0;
+        std::size_t nb_columns = 0;
+        xarray<T> block;
+        auto flush = [&]() {
+            detail::load_csv_buffer(text.data(), text.data() + text.size(), block, delimiter, row);
+            if (row != 0 && block.shape()[1] != nb_columns)
+            {
+                throw detail::csv_error("row " + std::to_string(row) + " has " + std::to_string(block.shape()[1]) +
+                                        " columns instead of " + std::to_string(nb_columns));
+            }
+            nb_columns = block.shape()[1];
+            row += nb_rows;
+            f(static_cast<const xarray<T>&>(block));
+            text.clear();
+            nb_rows = 0;
+        };
+        while (std::getline(stream, line))
+        {
+            if (!detail::is_blank_csv_line(line.data(), line.data() + line.size()))
+            {
+                text += line;
+                text += '\n';
+                if (++nb_rows == block_rows)
+                {
+                    flush();
+                }
+            }
+        }
+        if (nb_rows != 0)
+        {
+            flush();
+        }
+    }
+    //@}
+}
+
+#endif
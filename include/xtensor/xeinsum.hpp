@@ -0,0 +1,585 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XEINSUM_HPP
+#define XEINSUM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xblas.hpp"
+#include "xlinalg.hpp"
+#include "xmath.hpp"
+#include "xstrides.hpp"
+
+namespace xt
+{
+    template <class... E>
+    auto einsum(const std::string& subscripts, const xexpression<E>&... e)
+        -> xarray<std::common_type_t<typename E::value_type...>>;
+
+    /********************
+     * einsum internals *
+     ********************/
+
+    namespace detail
+    {
+        inline std::runtime_error einsum_error(const std::string& msg)
+        {
+            return std::runtime_error("einsum: " + msg);
+        }
+
+        // Number of operands up to which the contraction order is found
+        // by an exhaustive search; a greedy search is used beyond.
+        constexpr std::size_t einsum_optimal_limit = 6;
+
+        struct einsum_subscripts
+        {
+            std::vector<std::string> inputs;
+            std::string output;
+        };
+
+        inline einsum_subscripts parse_einsum(const std::string& subscripts, std::size_t nb_operands)
+        {
+            std::string s;
+            std::remove_copy_if(subscripts.cbegin(), subscripts.cend(), std::back_inserter(s),
+                                [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; });
+            if (s.find("...") != std::string::npos)
+            {
+                throw einsum_error("ellipsis is not supported");
+            }
+
+            einsum_subscripts res;
+            std::size_t arrow = s.find("->");
+            std::string lhs = s.substr(0, arrow);
+            std::size_t first = 0;
+            while (true)
+            {
+                std::size_t comma = lhs.find(',', first);
+                res.inputs.push_back(lhs.substr(first, comma - first));
+                if (comma == std::string::npos)
+                {
+                    break;
+                }
+                first = comma + 1;
+            }
+            if (res.inputs.size() != nb_operands)
+            {
+                throw einsum_error("expected " + std::to_string(res.inputs.size()) +
+                                   " operands, got " + std::to_string(nb_operands));
+            }
+
+            std::array<std::size_t, 256> count = {};
+            for (const auto& input : res.inputs)
+            {
+                for (char c : input)
+                {
+                    if (!std::isalpha(static_cast<unsigned char>(c)))
+                    {
+                        throw einsum_error(std::string("invalid subscript '") + c + "'");
+                    }
+                    ++count[static_cast<unsigned char>(c)];
+                }
+            }
+
+            if (arrow == std::string::npos)
+            {
+                // implicit output: labels appearing once, in alphabetical order
+                for (std::size_t c = 0; c < count.size(); ++c)
+                {
+                    if (count[c] == 1)
+                    {
+                        res.output.push_back(static_cast<char>(c));
+                    }
+                }
+            }
+            else
+            {
+                res.output = s.substr(arrow + 2);
+                for (std::size_t i = 0; i < res.output.size(); ++i)
+                {
+                    char c = res.output[i];
+                    if (count[static_cast<unsigned char>(c)] == 0 || res.output.find(c, i + 1) != std::string::npos)
+                    {
+                        throw einsum_error(std::string("invalid output subscript '") + c + "'");
+                    }
+                }
+            }
+            return res;
+        }
+
+        // An operand or an intermediate result of the contraction, with
+        // one label per dimension. Intermediates own their elements.
+        template <class T>
+        struct einsum_operand
+        {
+            const T* data;
+            std::string labels;
+            std::vector<std::size_t> shape;
+            std::vector<std::ptrdiff_t> strides;
+            xarray<T> storage;
+        };
+
+        template <class T>
+        inline einsum_operand<T> make_einsum_operand(std::string labels, xarray<T>&& storage)
+        {
+            einsum_operand<T> res;
+            res.storage = std::move(storage);
+            res.data = res.storage.data().data();
+            res.labels = std::move(labels);
+            res.shape.assign(res.storage.shape().cbegin(), res.storage.shape().cend());
+            res.strides.assign(res.storage.strides().cbegin(), res.storage.strides().cend());
+            return res;
+        }
+
+        // Merges the dimensions of repeated labels into their diagonal.
+        template <class T>
+        inline void einsum_diagonal(einsum_operand<T>& op)
+        {
+            std::string labels;
+            std::vector<std::size_t> shape;
+            std::vector<std::ptrdiff_t> strides;
+            for (std::size_t i = 0; i < op.labels.size(); ++i)
+            {
+                std::size_t pos = labels.find(op.labels[i]);
+                if (pos == std::string::npos)
+                {
+                    labels.push_back(op.labels[i]);
+                    shape.push_back(op.shape[i]);
+                    strides.push_back(op.strides[i]);
+                }
+                else
+                {
+                    strides[pos] += op.strides[i];
+                }
+            }
+            op.labels = std::move(labels);
+            op.shape = std::move(shape);
+            op.strides = std::move(strides);
+        }
+
+        inline bool einsum_contains(const std::string& labels, char c) noexcept
+        {
+            return labels.find(c) != std::string::npos;
+        }
+
+        // Copies the elements of op, with its dimensions ordered as in
+        // labels, to a row-major buffer.
+        template <class T>
+        inline xarray<T> einsum_gather(const einsum_operand<T>& op, const std::string& labels)
+        {
+            std::vector<std::size_t> shape(labels.size());
+            std::vector<std::ptrdiff_t> strides(labels.size());
+            for (std::size_t i = 0; i < labels.size(); ++i)
+            {
+                std::size_t pos = op.labels.find(labels[i]);
+                shape[i] = op.shape[pos];
+                strides[i] = op.strides[pos];
+            }
+            xarray<T> res(typename xarray<T>::shape_type(shape.cbegin(), shape.cend()));
+            strided_copy(op.data, shape, strides, res.data().begin());
+            return res;
+        }
+
+        // Returns a pointer to the elements of op ordered as in labels,
+        // gathering them in tmp unless they already are row-major.
+        template <class T>
+        inline const T* einsum_data(const einsum_operand<T>& op, const std::string& labels, xarray<T>& tmp)
+        {
+            std::ptrdiff_t stride = 1;
+            bool contiguous = true;
+            for (std::size_t i = labels.size(); i-- > 0 && contiguous;)
+            {
+                std::size_t pos = op.labels.find(labels[i]);
+                contiguous = op.shape[pos] == 1 || op.strides[pos] == stride;
+                stride *= static_cast<std::ptrdiff_t>(op.shape[pos]);
+            }
+            if (contiguous)
+            {
+                return op.data;
+            }
+            tmp = einsum_gather(op, labels);
+            return tmp.data().data();
+        }
+
+        // Sums op over the labels not in keep, with a reducer.
+        template <class T>
+        inline einsum_operand<T> einsum_reduce(einsum_operand<T>&& op, const std::string& keep)
+        {
+            std::string kept;
+            std::vector<std::size_t> axes;
+            for (std::size_t i = 0; i < op.labels.size(); ++i)
+            {
+                if (einsum_contains(keep, op.labels[i]))
+                {
+                    kept.push_back(op.labels[i]);
+                }
+                else
+                {
+                    axes.push_back(i);
+                }
+            }
+            if (axes.empty())
+            {
+                return std::move(op);
+            }
+            xarray<T> gathered = einsum_gather(op, op.labels);
+            if (kept.empty())
+            {
+                // 0-D reducers are evaluated as a scalar
+                xarray<T> res(typename xarray<T>::shape_type(), T(sum(gathered, axes)()));
+                return make_einsum_operand(std::move(kept), std::move(res));
+            }
+            xarray<T> res = sum(gathered, axes);
+            return make_einsum_operand(std::move(kept), std::move(res));
+        }
+
+        // Contracts a and b over their common labels that are not in keep.
+        // Both operands are laid out as stacks of matrices, common labels
+        // in keep indexing the stack, and multiplied by gemm.
+        template <class T>
+        inline einsum_operand<T> einsum_contract(const einsum_operand<T>& a, const einsum_operand<T>& b,
+                                                 const std::string& keep)
+        {
+            std::string batch, left, right, inner;
+            std::size_t nb = 1, m = 1, n = 1, k = 1;
+            for (std::size_t i = 0; i < a.labels.size(); ++i)
+            {
+                char c = a.labels[i];
+                if (!einsum_contains(b.labels, c))
+                {
+                    left.push_back(c);
+                    m *= a.shape[i];
+                }
+                else if (einsum_contains(keep, c))
+                {
+                    batch.push_back(c);
+                    nb *= a.shape[i];
+                }
+                else
+                {
+                    inner.push_back(c);
+                    k *= a.shape[i];
+                }
+            }
+            for (std::size_t i = 0; i < b.labels.size(); ++i)
+            {
+                if (!einsum_contains(a.labels, b.labels[i]))
+                {
+                    right.push_back(b.labels[i]);
+                    n *= b.shape[i];
+                }
+            }
+
+            xarray<T> tmp_a, tmp_b;
+            const T* pa = einsum_data(a, batch + left + inner, tmp_a);
+            const T* pb = einsum_data(b, batch + inner + right, tmp_b);
+
+            std::string labels = batch + left + right;
+            typename xarray<T>::shape_type shape;
+            for (char c : labels)
+            {
+                std::size_t pos = a.labels.find(c);
+                shape.push_back(pos != std::string::npos ? a.shape[pos] : b.shape[b.labels.find(c)]);
+            }
+            xarray<T> res(shape, T(0));
+
+            std::vector<std::ptrdiff_t> offsets_a(nb), offsets_b(nb);
+            for (std::size_t i = 0; i < nb; ++i)
+            {
+                offsets_a[i] = static_cast<std::ptrdiff_t>(i * m * k);
+                offsets_b[i] = static_cast<std::ptrdiff_t>(i * k * n);
+            }
+            gemm_batch(nb, m, n, k,
+                       pa, offsets_a.data(), static_cast<std::ptrdiff_t>(k), std::ptrdiff_t(1),
+                       pb, offsets_b.data(), static_cast<std::ptrdiff_t>(n), std::ptrdiff_t(1),
+                       res.data().data());
+            return make_einsum_operand(std::move(labels), std::move(res));
+        }
+
+        /*******************
+         * path evaluation *
+         *******************/
+
+        using einsum_path = std::vector<std::pair<std::size_t, std::size_t>>;
+
+        // Labels of operands other than i and j, and of the output.
+        inline std::string einsum_kept(const std::vector<std::string>& labels, std::size_t i, std::size_t j,
+                                       const std::string& output)
+        {
+            std::string res = output;
+            for (std::size_t l = 0; l < labels.size(); ++l)
+            {
+                if (l != i && l != j)
+                {
+                    res += labels[l];
+                }
+            }
+            return res;
+        }
+
+        // Number of multiply-adds of the contraction of labels a and b,
+        // and labels of the result.
+        inline double einsum_cost(const std::string& a, const std::string& b, const std::string& keep,
+                                  const std::array<std::size_t, 256>& sizes, std::string& result)
+        {
+            double cost = 1.;
+            result.clear();
+            std::string all = a;
+            for (char c : b)
+            {
+                if (!einsum_contains(a, c))
+                {
+                    all.push_back(c);
+                }
+            }
+            for (char c : all)
+            {
+                cost *= static_cast<double>(sizes[static_cast<unsigned char>(c)]);
+                if (einsum_contains(keep, c))
+                {
+                    result.push_back(c);
+                }
+            }
+            return cost;
+        }
+
+        inline double einsum_size(const std::string& labels, const std::array<std::size_t, 256>& sizes)
+        {
+            double size = 1.;
+            for (char c : labels)
+            {
+                size *= static_cast<double>(sizes[static_cast<unsigned char>(c)]);
+            }
+            return size;
+        }
+
+        // Depth-first search of the pairwise contraction order with the
+        // smallest number of multiply-adds; ties are broken by the size
+        // of the largest intermediate.
+        inline void einsum_search(std::vector<std::string>& labels, const std::string& output,
+                                  const std::array<std::size_t, 256>& sizes,
+                                  double cost, double peak, einsum_path& path,
+                                  double& best_cost, double& best_peak, einsum_path& best_path)
+        {
+            if (labels.size() == 1)
+            {
+                if (cost < best_cost || (cost == best_cost && peak < best_peak))
+                {
+                    best_cost = cost;
+                    best_peak = peak;
+                    best_path = path;
+                }
+                return;
+            }
+            for (std::size_t i = 0; i < labels.size(); ++i)
+            {
+                for (std::size_t j = i + 1; j < labels.size(); ++j)
+                {
+                    std::string result;
+                    double step = einsum_cost(labels[i], labels[j], einsum_kept(labels, i, j, output), sizes, result);
+                    if (cost + step > best_cost)
+                    {
+                        continue;
+                    }
+                    std::vector<std::string> next;
+                    next.reserve(labels.size() - 1);
+                    for (std::size_t l = 0; l < labels.size(); ++l)
+                    {
+                        if (l != i && l != j)
+                        {
+                            next.push_back(labels[l]);
+                        }
+                    }
+                    next.push_back(result);
+                    path.emplace_back(i, j);
+                    einsum_search(next, output, sizes, cost + step, std::max(peak, einsum_size(result, sizes)),
+                                  path, best_cost, best_peak, best_path);
+                    path.pop_back();
+                }
+            }
+        }
+
+        // At each step, contracts the pair of operands with the cheapest
+        // contraction, preferring the smallest intermediate on ties.
+        inline einsum_path einsum_greedy(std::vector<std::string> labels, const std::string& output,
+                                         const std::array<std::size_t, 256>& sizes)
+        {
+            einsum_path path;
+            while (labels.size() > 1)
+            {
+                double best_cost = std::numeric_limits<double>::infinity();
+                double best_size = best_cost;
+                std::size_t bi = 0, bj = 1;
+                std::string best_result;
+                for (std::size_t i = 0; i < labels.size(); ++i)
+                {
+                    for (std::size_t j = i + 1; j < labels.size(); ++j)
+                    {
+                        std::string result;
+                        double cost = einsum_cost(labels[i], labels[j], einsum_kept(labels, i, j, output), sizes, result);
+                        double size = einsum_size(result, sizes);
+                        if (cost < best_cost || (cost == best_cost && size < best_size))
+                        {
+                            best_cost = cost;
+                            best_size = size;
+                            bi = i;
+                            bj = j;
+                            best_result = result;
+                        }
+                    }
+                }
+                labels.erase(labels.begin() + static_cast<std::ptrdiff_t>(bj));
+                labels.erase(labels.begin() + static_cast<std::ptrdiff_t>(bi));
+                labels.push_back(best_result);
+                path.emplace_back(bi, bj);
+            }
+            return path;
+        }
+
+        /**
+         * Returns the order in which the operands with the given labels
+         * are contracted pairwise. Each step contracts the operands i < j
+         * of the current list, which are removed from the list, and appends
+         * the result at the end of the list.
+         */
+        inline einsum_path einsum_plan(const std::vector<std::string>& labels, const std::string& output,
+                                       const std::array<std::size_t, 256>& sizes)
+        {
+            if (labels.size() > einsum_optimal_limit)
+            {
+                return einsum_greedy(labels, output, sizes);
+            }
+            std::vector<std::string> current = labels;
+            einsum_path path, best_path;
+            double best_cost = std::numeric_limits<double>::infinity();
+            double best_peak = best_cost;
+            einsum_search(current, output, sizes, 0., 0., path, best_cost, best_peak, best_path);
+            return best_path;
+        }
+
+        template <class T>
+        inline xarray<T> einsum_impl(const std::string& subscripts, std::vector<einsum_operand<T>>& ops)
+        {
+            einsum_subscripts sub = parse_einsum(subscripts, ops.size());
+
+            std::array<std::size_t, 256> sizes;
+            sizes.fill(std::numeric_limits<std::size_t>::max());
+            for (std::size_t i = 0; i < ops.size(); ++i)
+            {
+                einsum_operand<T>& op = ops[i];
+                op.labels = sub.inputs[i];
+                if (op.labels.size() != op.shape.size())
+                {
+                    throw einsum_error("operand " + std::to_string(i) + " has " + std::to_string(op.shape.size()) +
+                                       " dimensions but " + std::to_string(op.labels.size()) + " subscripts");
+                }
+                for (std::size_t d = 0; d < op.shape.size(); ++d)
+                {
+                    std::size_t& size = sizes[static_cast<unsigned char>(op.labels[d])];
+                    if (size != std::numeric_limits<std::size_t>::max() && size != op.shape[d])
+                    {
+                        throw einsum_error(std::string("inconsistent size for subscript '") + op.labels[d] + "'");
+                    }
+                    size = op.shape[d];
+                }
+                einsum_diagonal(op);
+            }
+
+            // labels that appear in a single operand and not in the output
+            // are summed first
+            for (std::size_t i = 0; i < ops.size(); ++i)
+            {
+                ops[i] = einsum_reduce(std::move(ops[i]), einsum_kept(sub.inputs, i, i, sub.output));
+            }
+
+            std::vector<std::string> labels;
+            for (const auto& op : ops)
+            {
+                labels.push_back(op.labels);
+            }
+            for (const auto& step : einsum_plan(labels, sub.output, sizes))
+            {
+                std::vector<std::string> current;
+                for (const auto& op : ops)
+                {
+                    current.push_back(op.labels);
+                }
+                std::string keep = einsum_kept(current, step.first, step.second, sub.output);
+                einsum_operand<T> res = einsum_contract(ops[step.first], ops[step.second], keep);
+                ops.erase(ops.begin() + static_cast<std::ptrdiff_t>(step.second));
+                ops.erase(ops.begin() + static_cast<std::ptrdiff_t>(step.first));
+                ops.push_back(std::move(res));
+            }
+
+            einsum_operand<T> res = einsum_reduce(std::move(ops.front()), sub.output);
+            return einsum_gather(res, sub.output);
+        }
+
+        template <class T, class E>
+        inline einsum_operand<T> make_einsum_operand(const E& e)
+        {
+            einsum_operand<T> res;
+            auto op = linalg_data(e, res.storage);
+            res.data = op.data;
+            res.shape.assign(e.shape().cbegin(), e.shape().cend());
+            res.strides = std::move(op.strides);
+            return res;
+        }
+    }
+
+    /*************************
+     * einsum implementation *
+     *************************/
+
+    /**
+     * @brief Einstein summation of expressions.
+     *
+     * Evaluates the sum of products described by \em subscripts with the
+     * syntax of NumPy's einsum, for instance <tt>"bij,bjk->bik"</tt> for a
+     * batched matrix product, <tt>"ii"</tt> for a trace or <tt>"ij->ji"</tt>
+     * for a transposition. Without an explicit output, the result holds
+     * the subscripts appearing only once, in alphabetical order. Ellipses
+     * are not supported.
+     *
+     * The operands are contracted two at a time, in the order that
+     * minimizes the number of multiply-adds (an exhaustive search is used
+     * for up to 6 operands, a greedy one beyond). Each contraction lays
+     * its operands out as stacks of matrices multiplied by the gemm kernel
+     * of \ref dot, and subscripts that appear in a single operand are
+     * summed by a reducer beforehand.
+     * @param subscripts the subscripts of the operands and of the result
+     * @param e the operands
+     * @return an xarray holding the result
+     */
+    template <class... E>
+    inline auto einsum(const std::string& subscripts, const xexpression<E>&... e)
+        -> xarray<std::common_type_t<typename E::value_type...>>
+    {
+        using value_type = std::common_type_t<typename E::value_type...>;
+        std::vector<detail::einsum_operand<value_type>> ops;
+        ops.reserve(sizeof...(E));
+        // the operands are moved in the vector: the buffers of evaluated
+        // expressions are not reallocated
+        auto dummy = {(ops.push_back(detail::make_einsum_operand<value_type>(e.derived_cast())), 0)...};
+        (void)dummy;
+        return detail::einsum_impl(subscripts, ops);
+    }
+}
+
+#endif
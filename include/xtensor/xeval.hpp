@@ -9,17 +9,15 @@
 #ifndef XEVAL_HPP
 #define XEVAL_HPP
 
+#include <type_traits>
+#include <utility>
+
 #include "xtensor.hpp"
 #include "xarray.hpp"
+#include "xexecutor.hpp"
 
 namespace xt
 {
-    namespace detail
-    {
-        template <class T>
-        using is_container = std::is_base_of<xcontainer<std::remove_const_t<T>>, T>;
-    }
-
     /**
      * Force evaluation of xexpression.
      * @return xarray or xtensor depending on shape type
@@ -50,6 +48,159 @@ namespace xt
     {
         return xarray<typename I::value_type>(std::forward<T>(t));
     }
+
+    /**
+     * Force evaluation of xexpression, splitting the work over the tasks
+     * of the executor \c ex.
+     * @return xarray or xtensor depending on shape type
+     *
+     * \code{.cpp}
+     * xt::thread_pool pool(4);
+     * xarray<double> a = xt::random::rand<double>({1000, 1000});
+     * auto&& b = xt::eval(xt::sum(a * a, {1}), pool);
+     * \endcode
+     */
+    template <class T>
+    inline auto eval(T&& t, const executor&)
+        -> std::enable_if_t<detail::is_container<std::decay_t<T>>::value, T&&>
+    {
+        return t;
+    }
+
+    template <class T, class I = std::decay_t<T>>
+    inline auto eval(T&& t, const executor& ex)
+        -> std::enable_if_t<!detail::is_container<I>::value && detail::is_array<typename I::shape_type>::value, xtensor<typename I::value_type, std::tuple_size<typename I::shape_type>::value>>
+    {
+        xtensor<typename I::value_type, std::tuple_size<typename I::shape_type>::value> res;
+        res.assign(t, ex);
+        return res;
+    }
+
+    template <class T, class I = std::decay_t<T>>
+    inline auto eval(T&& t, const executor& ex)
+        -> std::enable_if_t<!detail::is_container<I>::value && !detail::is_array<typename I::shape_type>::value, xt::xarray<typename I::value_type>>
+    {
+        xarray<typename I::value_type> res;
+        res.assign(t, ex);
+        return res;
+    }
+
+    /**************
+     * eval_async *
+     **************/
+
+    namespace detail
+    {
+        template <class E, class = void>
+        struct eval_type
+        {
+            using type = xarray<typename E::value_type>;
+        };
+
+        template <class E>
+        struct eval_type<E, std::enable_if_t<!is_container<E>::value && is_array<typename E::shape_type>::value>>
+        {
+            using type = xtensor<typename E::value_type, std::tuple_size<typename E::shape_type>::value>;
+        };
+
+        template <class E>
+        struct eval_type<E, std::enable_if_t<is_container<E>::value>>
+        {
+            using type = E;
+        };
+
+        template <class E>
+        using eval_type_t = typename eval_type<std::decay_t<E>>::type;
+
+        template <class CT, class R>
+        struct async_evaluator
+        {
+            R operator()() const
+            {
+                R res;
+                res.assign(m_e, m_ex);
+                return res;
+            }
+
+            CT m_e;
+            executor m_ex;
+        };
+
+        template <class CT1, class CT2>
+        struct async_assigner
+        {
+            void operator()()
+            {
+                m_lhs.assign(m_e, m_ex);
+            }
+
+            CT1 m_lhs;
+            CT2 m_e;
+            executor m_ex;
+        };
+    }
+
+    /**
+     * Starts the evaluation of the expression \c t on the executor \c ex
+     * and returns the future holding the result, an xarray or an xtensor
+     * depending on the shape type. The evaluation is itself split over the
+     * tasks of the executor. The temporary expressions are moved into the
+     * task, but the containers and the expressions passed as lvalues are
+     * referenced: they must not be modified or destroyed before the result
+     * is ready.
+     *
+     * \code{.cpp}
+     * xt::thread_pool pool(4);
+     * auto f = xt::eval_async(a * b + c, pool);
+     * auto next = load_next_chunk(); // overlaps with the computation
+     * xt::xarray<double> res = f.get();
+     * \endcode
+     *
+     * @sa assign_async, submit
+     */
+    template <class T>
+    inline auto eval_async(T&& t, const executor& ex) -> xfuture<detail::eval_type_t<T>>
+    {
+        using evaluator_type = detail::async_evaluator<const_closure_t<T>, detail::eval_type_t<T>>;
+        return submit(ex, evaluator_type{std::forward<T>(t), ex});
+    }
+
+    /**
+     * Starts the evaluation of the expression \c t on the default executor.
+     * @sa default_executor
+     */
+    template <class T>
+    inline auto eval_async(T&& t) -> xfuture<detail::eval_type_t<T>>
+    {
+        return eval_async(std::forward<T>(t), default_executor());
+    }
+
+    /**
+     * Starts the assignment of the expression \c e to \c lhs on the executor
+     * \c ex, and returns the future signaling its completion. As with
+     * the assign method, no temporary is used: \c e must not alias \c lhs.
+     * \c lhs and the operands of \c e must not be accessed before the
+     * assignment has completed.
+     *
+     * @sa eval_async
+     */
+    template <class E1, class E2>
+    inline xfuture<void> assign_async(E1&& lhs, E2&& e, const executor& ex)
+    {
+        using assigner_type = detail::async_assigner<closure_t<E1>, const_closure_t<E2>>;
+        return submit(ex, assigner_type{std::forward<E1>(lhs), std::forward<E2>(e), ex});
+    }
+
+    /**
+     * Starts the assignment of the expression \c e to \c lhs on the default
+     * executor.
+     * @sa default_executor
+     */
+    template <class E1, class E2>
+    inline xfuture<void> assign_async(E1&& lhs, E2&& e)
+    {
+        return assign_async(std::forward<E1>(lhs), std::forward<E2>(e), default_executor());
+    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,970 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+/**
+ * @brief executors running the parallel parts of xtensor
+ */
+
+#ifndef XEXECUTOR_HPP
+#define XEXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "xutils.hpp"
+
+namespace xt
+{
+
+    /************
+     * executor *
+     ************/
+
+    /*
+     * An executor is any type providing:
+     *  - std::size_t concurrency() const: the number of tasks it may run
+     *    at the same time;
+     *  - void execute(std::function<void()> task): runs the task, on any
+     *    thread, possibly before returning.
+     */
+
+    namespace detail
+    {
+        template <class E, class = void>
+        struct is_executor_impl : std::false_type
+        {
+        };
+
+        template <class E>
+        struct is_executor_impl<E, void_t<decltype(std::size_t(std::declval<const E&>().concurrency())),
+                                          decltype(std::declval<E&>().execute(std::declval<std::function<void()>>()))>>
+            : std::true_type
+        {
+        };
+    }
+
+    template <class E>
+    using is_executor = detail::is_executor_impl<std::decay_t<E>>;
+
+    /**
+     * @class executor
+     * @brief Type-erased handle on an executor.
+     *
+     * The executor class holds any object satisfying the executor
+     * requirements. An lvalue is referenced, and must outlive the handle and
+     * its copies; an rvalue is moved into the handle and shared by its
+     * copies. This allows to plug the thread pool of an application in
+     * xtensor:
+     *
+     * @code{.cpp}
+     * struct app_executor
+     * {
+     *     std::size_t concurrency() const { return pool.size(); }
+     *     void execute(std::function<void()> task) { pool.post(std::move(task)); }
+     *     app_pool& pool;
+     * };
+     *
+     * xt::set_default_executor(app_executor{pool});
+     * @endcode
+     *
+     * @sa thread_pool, serial_executor, default_executor
+     */
+    class executor
+    {
+
+    public:
+
+        template <class E, class = std::enable_if_t<is_executor<E>::value &&
+                                                    !std::is_same<std::decay_t<E>, executor>::value>>
+        executor(E&& e);
+
+        std::size_t concurrency() const;
+        void execute(std::function<void()> task) const;
+
+    private:
+
+        struct executor_base
+        {
+            virtual ~executor_base() = default;
+            virtual std::size_t concurrency() const = 0;
+            virtual void execute(std::function<void()> task) = 0;
+        };
+
+        template <class E>
+        struct executor_model : executor_base
+        {
+            template <class T>
+            explicit executor_model(T&& e)
+                : m_e(std::forward<T>(e))
+            {
+            }
+
+            std::size_t concurrency() const override
+            {
+                return std::max(std::size_t(m_e.concurrency()), std::size_t(1));
+            }
+
+            void execute(std::function<void()> task) override
+            {
+                m_e.execute(std::move(task));
+            }
+
+            E m_e;
+        };
+
+        std::shared_ptr<executor_base> p_impl;
+    };
+
+    /*******************
+     * serial_executor *
+     *******************/
+
+    /**
+     * @class serial_executor
+     * @brief Executor running the tasks on the calling thread.
+     *
+     * With this executor, the parallel algorithms of xtensor run on the
+     * calling thread only.
+     */
+    class serial_executor
+    {
+
+    public:
+
+        std::size_t concurrency() const noexcept;
+        void execute(std::function<void()> task) const;
+    };
+
+    /***************
+     * thread_pool *
+     ***************/
+
+    namespace detail
+    {
+        using executor_task = std::function<void()>;
+
+        // Chase-Lev deque: the owner pushes and pops at the bottom, other
+        // threads steal at the top without locking.
+        class work_stealing_deque
+        {
+
+        public:
+
+            work_stealing_deque();
+
+            work_stealing_deque(const work_stealing_deque&) = delete;
+            work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+            void push(executor_task* task);
+            executor_task* pop();
+            executor_task* steal();
+
+        private:
+
+            struct ring
+            {
+                explicit ring(std::ptrdiff_t capacity);
+
+                executor_task* get(std::ptrdiff_t i) const noexcept;
+                void put(std::ptrdiff_t i, executor_task* task) noexcept;
+
+                std::ptrdiff_t m_capacity;
+                std::unique_ptr<std::atomic<executor_task*>[]> m_buffer;
+            };
+
+            ring* grow(ring* r, std::ptrdiff_t top, std::ptrdiff_t bottom);
+
+            std::atomic<std::ptrdiff_t> m_top;
+            std::atomic<std::ptrdiff_t> m_bottom;
+            std::atomic<ring*> m_ring;
+            // rings are only released with the deque, since a thief may
+            // still read a ring that has been replaced
+            std::vector<std::unique_ptr<ring>> m_rings;
+        };
+    }
+
+    /**
+     * @class thread_pool
+     * @brief Work-stealing thread pool.
+     *
+     * Each worker thread of the pool owns a deque of tasks. A task executed
+     * by a worker is pushed on its own deque, other tasks are pushed on a
+     * shared queue. Idle workers pop the tasks of their own deque first, then
+     * steal the oldest tasks of the other ones, then pick the tasks of the
+     * shared queue.
+     *
+     * Parallel algorithms also run tasks on the thread calling them, so
+     * that they complete even when all the workers are busy.
+     */
+    class thread_pool
+    {
+
+    public:
+
+        explicit thread_pool(std::size_t nb_threads = 0, bool pin_threads = false);
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        std::size_t size() const noexcept;
+        std::size_t concurrency() const noexcept;
+        void execute(std::function<void()> task);
+
+    private:
+
+        struct worker_id
+        {
+            const thread_pool* pool;
+            std::size_t index;
+        };
+
+        static worker_id& current_worker() noexcept;
+
+        void run_worker(std::size_t index);
+        detail::executor_task* find_task(std::size_t index, std::uint32_t& seed);
+        void notify();
+        void pin(std::size_t index);
+
+        std::vector<std::unique_ptr<detail::work_stealing_deque>> m_deques;
+        std::vector<std::thread> m_threads;
+        std::deque<detail::executor_task*> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic<std::size_t> m_epoch;
+        std::atomic<std::size_t> m_sleeping;
+        std::atomic<bool> m_stop;
+    };
+
+    /********************
+     * default executor *
+     ********************/
+
+    executor default_executor();
+    void set_default_executor(executor ex);
+
+    /**
+     * @class executor_scope
+     * @brief Replaces the default executor on the current thread.
+     *
+     * While an executor_scope object is alive, \ref default_executor returns
+     * its executor on the thread that created it. This is how the executor
+     * of the functions without executor parameter (dot, fft, convolve, norms,
+     * concatenate and stack assignments, load_csv, xchunked_reader) is chosen.
+     */
+    class executor_scope
+    {
+
+    public:
+
+        explicit executor_scope(executor ex);
+        ~executor_scope();
+
+        executor_scope(const executor_scope&) = delete;
+        executor_scope& operator=(const executor_scope&) = delete;
+
+    private:
+
+        executor m_executor;
+        const executor* p_previous;
+    };
+
+    /************************
+     * parallel_for, submit *
+     ************************/
+
+    template <class F>
+    void parallel_for(const executor& ex, std::size_t n, F&& f);
+
+    template <class R>
+    class xfuture;
+
+    template <class F>
+    auto submit(const executor& ex, F&& f) -> xfuture<decltype(f())>;
+
+    /***************************
+     * executor implementation *
+     ***************************/
+
+    /**
+     * Builds a handle on the executor \c e.
+     */
+    template <class E, class>
+    inline executor::executor(E&& e)
+        : p_impl(std::make_shared<executor_model<std::conditional_t<std::is_lvalue_reference<E>::value,
+                                                                    E, std::decay_t<E>>>>(std::forward<E>(e)))
+    {
+    }
+
+    /**
+     * Returns the number of tasks the executor may run at the same time.
+     */
+    inline std::size_t executor::concurrency() const
+    {
+        return p_impl->concurrency();
+    }
+
+    /**
+     * Runs the task with the executor.
+     */
+    inline void executor::execute(std::function<void()> task) const
+    {
+        p_impl->execute(std::move(task));
+    }
+
+    /**********************************
+     * serial_executor implementation *
+     **********************************/
+
+    inline std::size_t serial_executor::concurrency() const noexcept
+    {
+        return 1;
+    }
+
+    inline void serial_executor::execute(std::function<void()> task) const
+    {
+        task();
+    }
+
+    /**************************************
+     * work_stealing_deque implementation *
+     **************************************/
+
+    namespace detail
+    {
+        inline work_stealing_deque::ring::ring(std::ptrdiff_t capacity)
+            : m_capacity(capacity), m_buffer(new std::atomic<executor_task*>[static_cast<std::size_t>(capacity)])
+        {
+        }
+
+        inline executor_task* work_stealing_deque::ring::get(std::ptrdiff_t i) const noexcept
+        {
+            return m_buffer[static_cast<std::size_t>(i & (m_capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        inline void work_stealing_deque::ring::put(std::ptrdiff_t i, executor_task* task) noexcept
+        {
+            m_buffer[static_cast<std::size_t>(i & (m_capacity - 1))].store(task, std::memory_order_relaxed);
+        }
+
+        inline work_stealing_deque::work_stealing_deque()
+            : m_top(0), m_bottom(0)
+        {
+            m_rings.emplace_back(new ring(64));
+            m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+        }
+
+        inline void work_stealing_deque::push(executor_task* task)
+        {
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_relaxed);
+            std::ptrdiff_t top = m_top.load(std::memory_order_acquire);
+            ring* r = m_ring.load(std::memory_order_relaxed);
+            if (bottom - top > r->m_capacity - 1)
+            {
+                r = grow(r, top, bottom);
+            }
+            r->put(bottom, task);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        inline executor_task* work_stealing_deque::pop()
+        {
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            ring* r = m_ring.load(std::memory_order_relaxed);
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::ptrdiff_t top = m_top.load(std::memory_order_relaxed);
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            executor_task* task = r->get(bottom);
+            if (top == bottom)
+            {
+                // last task, raced against thieves
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    task = nullptr;
+                }
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        inline executor_task* work_stealing_deque::steal()
+        {
+            std::ptrdiff_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::ptrdiff_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+            {
+                return nullptr;
+            }
+            ring* r = m_ring.load(std::memory_order_acquire);
+            executor_task* task = r->get(top);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return task;
+        }
+
+        inline auto work_stealing_deque::grow(ring* r, std::ptrdiff_t top, std::ptrdiff_t bottom) -> ring*
+        {
+            std::unique_ptr<ring> res(new ring(r->m_capacity * 2));
+            for (std::ptrdiff_t i = top; i < bottom; ++i)
+            {
+                res->put(i, r->get(i));
+            }
+            ring* p = res.get();
+            m_rings.push_back(std::move(res));
+            m_ring.store(p, std::memory_order_release);
+            return p;
+        }
+    }
+
+    /******************************
+     * thread_pool implementation *
+     ******************************/
+
+    /**
+     * Starts a pool of \c nb_threads worker threads; 0 stands for the number
+     * of hardware threads. When \c pin_threads is true, worker \c i is bound
+     * to the CPU <tt>i % hardware_concurrency</tt>; this is only supported on
+     * Linux and ignored elsewhere.
+     */
+    inline thread_pool::thread_pool(std::size_t nb_threads, bool pin_threads)
+        : m_epoch(0), m_sleeping(0), m_stop(false)
+    {
+        if (nb_threads == 0)
+        {
+            nb_threads = std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+        }
+        for (std::size_t i = 0; i < nb_threads; ++i)
+        {
+            m_deques.emplace_back(new detail::work_stealing_deque());
+        }
+        m_threads.reserve(nb_threads);
+        for (std::size_t i = 0; i < nb_threads; ++i)
+        {
+            m_threads.emplace_back([this, i]() { run_worker(i); });
+            if (pin_threads)
+            {
+                pin(i);
+            }
+        }
+    }
+
+    /**
+     * Runs the remaining tasks and joins the worker threads.
+     */
+    inline thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop.store(true);
+        }
+        m_condition.notify_all();
+        for (auto& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    /**
+     * Returns the number of worker threads.
+     */
+    inline std::size_t thread_pool::size() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    /**
+     * Returns the number of worker threads.
+     */
+    inline std::size_t thread_pool::concurrency() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    /**
+     * Schedules the task on the pool.
+     */
+    inline void thread_pool::execute(std::function<void()> task)
+    {
+        auto* t = new detail::executor_task(std::move(task));
+        const worker_id& id = current_worker();
+        if (id.pool == this)
+        {
+            m_deques[id.index]->push(t);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(t);
+        }
+        notify();
+    }
+
+    inline auto thread_pool::current_worker() noexcept -> worker_id&
+    {
+        static thread_local worker_id id = {nullptr, 0};
+        return id;
+    }
+
+    inline void thread_pool::run_worker(std::size_t index)
+    {
+        current_worker() = {this, index};
+        std::uint32_t seed = static_cast<std::uint32_t>(index) * 2654435761u + 1u;
+        while (true)
+        {
+            std::size_t epoch = m_epoch.load();
+            detail::executor_task* task = find_task(index, seed);
+            if (task != nullptr)
+            {
+                (*task)();
+                delete task;
+                continue;
+            }
+
+            // a task scheduled after the epoch was read wakes the worker up
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop.load())
+            {
+                return;
+            }
+            ++m_sleeping;
+            m_condition.wait(lock, [this, epoch]() { return m_stop.load() || m_epoch.load() != epoch; });
+            --m_sleeping;
+        }
+    }
+
+    inline detail::executor_task* thread_pool::find_task(std::size_t index, std::uint32_t& seed)
+    {
+        detail::executor_task* task = m_deques[index]->pop();
+        if (task != nullptr)
+        {
+            return task;
+        }
+
+        std::size_t n = m_deques.size();
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        std::size_t first = seed % n;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            std::size_t victim = (first + k) % n;
+            if (victim != index && (task = m_deques[victim]->steal()) != nullptr)
+            {
+                return task;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_queue.empty())
+        {
+            task = m_queue.front();
+            m_queue.pop_front();
+        }
+        return task;
+    }
+
+    inline void thread_pool::notify()
+    {
+        ++m_epoch;
+        if (m_sleeping.load() != 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_condition.notify_one();
+        }
+    }
+
+    inline void thread_pool::pin(std::size_t index)
+    {
+#if defined(__linux__)
+        std::size_t nb_cpus = std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % nb_cpus, &set);
+        pthread_setaffinity_np(m_threads[index].native_handle(), sizeof(cpu_set_t), &set);
+#else
+        (void)index;
+#endif
+    }
+
+    /***********************************
+     * default executor implementation *
+     ***********************************/
+
+    namespace detail
+    {
+        struct default_executor_storage
+        {
+            std::mutex m_mutex;
+            std::unique_ptr<executor> p_executor;
+        };
+
+        inline default_executor_storage& get_default_executor_storage()
+        {
+            static default_executor_storage storage;
+            return storage;
+        }
+
+        inline const executor*& scoped_executor()
+        {
+            static thread_local const executor* p = nullptr;
+            return p;
+        }
+    }
+
+    /**
+     * Returns the executor used by the parallel algorithms of xtensor: the
+     * executor of the innermost \ref executor_scope of the current thread,
+     * or the one given to \ref set_default_executor. When none has been set,
+     * a \ref thread_pool with a thread per hardware thread is started on the
+     * first call; an application setting its own executor first never
+     * starts it.
+     */
+    inline executor default_executor()
+    {
+        const executor* scoped = detail::scoped_executor();
+        if (scoped != nullptr)
+        {
+            return *scoped;
+        }
+        auto& storage = detail::get_default_executor_storage();
+        std::lock_guard<std::mutex> lock(storage.m_mutex);
+        if (storage.p_executor == nullptr)
+        {
+            static thread_pool pool;
+            storage.p_executor.reset(new executor(pool));
+        }
+        return *storage.p_executor;
+    }
+
+    /**
+     * Replaces the default executor of all threads.
+     */
+    inline void set_default_executor(executor ex)
+    {
+        auto& storage = detail::get_default_executor_storage();
+        std::lock_guard<std::mutex> lock(storage.m_mutex);
+        storage.p_executor.reset(new executor(std::move(ex)));
+    }
+
+    /*********************************
+     * executor_scope implementation *
+     *********************************/
+
+    inline executor_scope::executor_scope(executor ex)
+        : m_executor(std::move(ex)), p_previous(detail::scoped_executor())
+    {
+        detail::scoped_executor() = &m_executor;
+    }
+
+    inline executor_scope::~executor_scope()
+    {
+        detail::scoped_executor() = p_previous;
+    }
+
+    /*******************************
+     * parallel_for implementation *
+     *******************************/
+
+    namespace detail
+    {
+        struct parallel_for_state
+        {
+            std::atomic<std::size_t> m_next;
+            std::atomic<std::size_t> m_done;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::exception_ptr m_error;
+        };
+
+        template <class F>
+        inline void run_parallel_for(parallel_for_state& state, std::size_t n, F* f)
+        {
+            std::size_t i;
+            while ((i = state.m_next++) < n)
+            {
+                try
+                {
+                    (*f)(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state.m_mutex);
+                    if (!state.m_error)
+                    {
+                        state.m_error = std::current_exception();
+                    }
+                }
+                if (++state.m_done == n)
+                {
+                    std::lock_guard<std::mutex> lock(state.m_mutex);
+                    state.m_condition.notify_all();
+                }
+            }
+        }
+    }
+
+    /**
+     * Calls <tt>f(i)</tt> for each \c i in <tt>[0, n)</tt>, with at most
+     * <tt>ex.concurrency()</tt> concurrent calls, and returns when all the
+     * calls have completed. The calling thread takes part in the loop, so
+     * that it completes even if the executor doesn't run the tasks it is
+     * given in time, for instance when parallel_for is called from a task
+     * of the executor. The first exception thrown by \c f is rethrown.
+     * @param ex the executor running the calls
+     * @param n the number of calls
+     * @param f the function to call
+     */
+    template <class F>
+    inline void parallel_for(const executor& ex, std::size_t n, F&& f)
+    {
+        std::size_t nb_tasks = std::min(ex.concurrency(), n);
+        if (nb_tasks < 2)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                f(i);
+            }
+            return;
+        }
+
+        auto state = std::make_shared<detail::parallel_for_state>();
+        state->m_next = 0;
+        state->m_done = 0;
+        // tasks started after the loop has completed find no index left and
+        // don't access f
+        auto* pf = &f;
+        for (std::size_t t = 1; t < nb_tasks; ++t)
+        {
+            ex.execute([state, n, pf]() { detail::run_parallel_for(*state, n, pf); });
+        }
+        detail::run_parallel_for(*state, n, pf);
+        std::unique_lock<std::mutex> lock(state->m_mutex);
+        state->m_condition.wait(lock, [&state, n]() { return state->m_done.load() == n; });
+        if (state->m_error)
+        {
+            std::rethrow_exception(state->m_error);
+        }
+    }
+
+    /***********
+     * xfuture *
+     ***********/
+
+    namespace detail
+    {
+        template <class R>
+        struct future_value
+        {
+            template <class F>
+            void set(F& f)
+            {
+                p_value.reset(new R(f()));
+            }
+
+            R get()
+            {
+                return std::move(*p_value);
+            }
+
+            std::unique_ptr<R> p_value;
+        };
+
+        template <>
+        struct future_value<void>
+        {
+            template <class F>
+            void set(F& f)
+            {
+                f();
+            }
+
+            void get()
+            {
+            }
+        };
+
+        template <class R>
+        struct future_state
+        {
+            // runs the task unless it has already been started
+            void run();
+
+            std::function<R()> m_task;
+            std::atomic<bool> m_started;
+            bool m_ready;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            future_value<R> m_value;
+            std::exception_ptr m_error;
+        };
+
+        template <class R>
+        inline void future_state<R>::run()
+        {
+            if (m_started.exchange(true))
+            {
+                return;
+            }
+            try
+            {
+                m_value.set(m_task);
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+            m_task = nullptr;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready = true;
+            m_condition.notify_all();
+        }
+    }
+
+    /**
+     * @class xfuture
+     * @brief Result of a task submitted to an executor.
+     *
+     * Waiting on an xfuture whose task has not been started yet runs the
+     * task on the waiting thread, so that waiting never blocks on a busy
+     * executor.
+     *
+     * @tparam R the type of the result
+     *
+     * @sa submit
+     */
+    template <class R>
+    class xfuture
+    {
+
+    public:
+
+        using value_type = R;
+
+        xfuture() = default;
+
+        bool valid() const noexcept;
+        bool is_ready() const;
+        void wait() const;
+        R get();
+
+    private:
+
+        using state_type = detail::future_state<R>;
+
+        explicit xfuture(std::shared_ptr<state_type> state);
+
+        std::shared_ptr<state_type> p_state;
+
+        template <class F>
+        friend auto submit(const executor& ex, F&& f) -> xfuture<decltype(f())>;
+    };
+
+    /**
+     * Runs <tt>f()</tt> with the executor and returns the future holding its
+     * result.
+     */
+    template <class F>
+    inline auto submit(const executor& ex, F&& f) -> xfuture<decltype(f())>
+    {
+        using result_type = decltype(f());
+        using state_type = detail::future_state<result_type>;
+        auto state = std::make_shared<state_type>();
+        state->m_task = std::forward<F>(f);
+        state->m_started = false;
+        state->m_ready = false;
+        ex.execute([state]() { state->run(); });
+        return xfuture<result_type>(state);
+    }
+
+    /**************************
+     * xfuture implementation *
+     **************************/
+
+    template <class R>
+    inline xfuture<R>::xfuture(std::shared_ptr<state_type> state)
+        : p_state(std::move(state))
+    {
+    }
+
+    /**
+     * Returns true if the future refers to a task whose result has not
+     * been retrieved.
+     */
+    template <class R>
+    inline bool xfuture<R>::valid() const noexcept
+    {
+        return p_state != nullptr;
+    }
+
+    /**
+     * Returns true if the task has completed.
+     */
+    template <class R>
+    inline bool xfuture<R>::is_ready() const
+    {
+        std::lock_guard<std::mutex> lock(p_state->m_mutex);
+        return p_state->m_ready;
+    }
+
+    /**
+     * Waits for the completion of the task, running it on the calling
+     * thread if it has not been started yet.
+     */
+    template <class R>
+    inline void xfuture<R>::wait() const
+    {
+        p_state->run();
+        std::unique_lock<std::mutex> lock(p_state->m_mutex);
+        p_state->m_condition.wait(lock, [this]() { return p_state->m_ready; });
+    }
+
+    /**
+     * Waits for the completion of the task and returns its result, or
+     * rethrows the exception it has thrown. The future is no longer valid
+     * afterwards.
+     */
+    template <class R>
+    inline R xfuture<R>::get()
+    {
+        wait();
+        std::shared_ptr<state_type> state = std::move(p_state);
+        if (state->m_error)
+        {
+            std::rethrow_exception(state->m_error);
+        }
+        return state->m_value.get();
+    }
+}
+
+#endif
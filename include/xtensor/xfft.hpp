@@ -0,0 +1,1028 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+/**
+ * @brief discrete Fourier transforms of xexpressions
+ */
+
+#ifndef XFFT_HPP
+#define XFFT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xexecutor.hpp"
+#include "xlinalg.hpp"
+#include "xstrides.hpp"
+
+namespace xt
+{
+    namespace detail
+    {
+        template <class T>
+        struct fft_real_type
+        {
+            using type = std::conditional_t<std::is_floating_point<T>::value, T, double>;
+        };
+
+        template <class T>
+        struct fft_real_type<std::complex<T>>
+        {
+            using type = T;
+        };
+
+        template <class T>
+        using fft_real_t = typename fft_real_type<T>::type;
+
+        template <class T>
+        using fft_complex_t = std::complex<fft_real_t<T>>;
+    }
+
+    namespace fft
+    {
+        template <class E>
+        auto fft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto fft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto ifft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto ifft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto rfft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto rfft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto irfft(const xexpression<E>& e) -> xarray<detail::fft_real_t<typename E::value_type>>;
+
+        template <class E>
+        auto irfft(const xexpression<E>& e, std::size_t n, std::size_t axis) -> xarray<detail::fft_real_t<typename E::value_type>>;
+
+        template <class E>
+        auto fftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto ifftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto rfftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>;
+
+        template <class E>
+        auto irfftn(const xexpression<E>& e) -> xarray<detail::fft_real_t<typename E::value_type>>;
+    }
+
+    /*****************
+     * fft internals *
+     *****************/
+
+    namespace detail
+    {
+        inline std::runtime_error fft_error(const std::string& msg)
+        {
+            return std::runtime_error("fft: " + msg);
+        }
+
+        // Prime factors up to this radix are handled by butterflies, larger
+        // ones by Bluestein's algorithm.
+        constexpr std::size_t fft_max_radix = 31;
+        // Number of butterfly operations above which the lanes of a transform
+        // are distributed over several threads.
+        constexpr std::size_t fft_parallel_threshold = std::size_t(1) << 20;
+
+        // std::complex multiplication checks for infinities and NaNs and is
+        // not inlined without -ffast-math.
+        template <class T>
+        inline std::complex<T> fft_mul(const std::complex<T>& a, const std::complex<T>& b) noexcept
+        {
+            return std::complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                                   a.real() * b.imag() + a.imag() * b.real());
+        }
+
+        // exp(-2 i pi k / n), computed in long double
+        template <class T>
+        inline std::complex<T> fft_twiddle(std::size_t k, std::size_t n) noexcept
+        {
+            const long double pi = 3.141592653589793238462643383279502884L;
+            long double phase = -2.L * pi * static_cast<long double>(k) / static_cast<long double>(n);
+            return std::complex<T>(static_cast<T>(std::cos(phase)), static_cast<T>(std::sin(phase)));
+        }
+
+        /**
+         * Forward transform of a given size. The size is factored in radices
+         * 4, 2, 3, 5 and larger odd numbers, computed by a recursive
+         * decimation in time. Sizes with a prime factor larger than
+         * fft_max_radix are computed with Bluestein's algorithm, as a
+         * convolution of power of two size.
+         */
+        template <class T>
+        class fft_plan
+        {
+        public:
+
+            using complex_type = std::complex<T>;
+
+            explicit fft_plan(std::size_t n);
+
+            std::size_t size() const noexcept;
+            std::size_t work_size() const noexcept;
+
+            void forward(const complex_type* in, complex_type* out, complex_type* work) const;
+
+        private:
+
+            void radix(complex_type* out, const complex_type* in, std::size_t fstride,
+                       const std::size_t* factors, complex_type* work) const;
+            void butterfly2(complex_type* out, std::size_t fstride, std::size_t m) const;
+            void butterfly3(complex_type* out, std::size_t fstride, std::size_t m) const;
+            void butterfly4(complex_type* out, std::size_t fstride, std::size_t m) const;
+            void butterfly5(complex_type* out, std::size_t fstride, std::size_t m) const;
+            void butterfly(complex_type* out, std::size_t fstride, std::size_t m, std::size_t p,
+                           complex_type* work) const;
+            void bluestein(const complex_type* in, complex_type* out, complex_type* work) const;
+
+            std::size_t m_size;
+            std::size_t m_work_size;
+            std::vector<std::size_t> m_factors;
+            std::vector<complex_type> m_twiddles;
+            std::shared_ptr<const fft_plan> p_convolution;
+            std::vector<complex_type> m_chirp;
+            std::vector<complex_type> m_filter;
+        };
+
+        // Returns the plan of the given size, building it on first use. Plans
+        // are shared by all threads; they are built outside of the lock since
+        // Bluestein plans request the plan of their convolution.
+        template <class T>
+        inline std::shared_ptr<const fft_plan<T>> get_fft_plan(std::size_t n)
+        {
+            static std::mutex mutex;
+            static std::map<std::size_t, std::shared_ptr<const fft_plan<T>>> cache;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = cache.find(n);
+                if (it != cache.end())
+                {
+                    return it->second;
+                }
+            }
+            auto plan = std::make_shared<const fft_plan<T>>(n);
+            std::lock_guard<std::mutex> lock(mutex);
+            return cache.emplace(n, std::move(plan)).first->second;
+        }
+
+        template <class T>
+        inline fft_plan<T>::fft_plan(std::size_t n)
+            : m_size(n), m_work_size(0)
+        {
+            std::size_t max_factor = 1;
+            std::size_t p = 4;
+            std::size_t floor_sqrt = static_cast<std::size_t>(std::floor(std::sqrt(static_cast<double>(n))));
+            while (n > 1)
+            {
+                while (n % p != 0)
+                {
+                    p = p == 4 ? 2 : (p == 2 ? 3 : p + 2);
+                    if (p > floor_sqrt)
+                    {
+                        p = n;
+                    }
+                }
+                n /= p;
+                m_factors.push_back(p);
+                m_factors.push_back(n);
+                max_factor = std::max(max_factor, p);
+            }
+
+            if (max_factor > fft_max_radix)
+            {
+                // x * chirp convolved with conj(chirp), chirp[k] = exp(-i pi k^2 / n)
+                std::size_t size = 1;
+                while (size < 2 * m_size - 1)
+                {
+                    size *= 2;
+                }
+                p_convolution = get_fft_plan<T>(size);
+                m_chirp.resize(m_size);
+                for (std::size_t k = 0; k < m_size; ++k)
+                {
+                    m_chirp[k] = fft_twiddle<T>((k * k) % (2 * m_size), 2 * m_size);
+                }
+                std::vector<complex_type> filter(size, complex_type(0));
+                filter[0] = std::conj(m_chirp[0]);
+                for (std::size_t k = 1; k < m_size; ++k)
+                {
+                    filter[k] = std::conj(m_chirp[k]);
+                    filter[size - k] = std::conj(m_chirp[k]);
+                }
+                m_filter.resize(size);
+                p_convolution->forward(filter.data(), m_filter.data(), nullptr);
+                // the inverse transform of the convolution is scaled here
+                for (auto& f : m_filter)
+                {
+                    f /= static_cast<T>(size);
+                }
+                m_work_size = 2 * size;
+                m_factors.clear();
+            }
+            else
+            {
+                m_twiddles.resize(m_size);
+                for (std::size_t k = 0; k < m_size; ++k)
+                {
+                    m_twiddles[k] = fft_twiddle<T>(k, m_size);
+                }
+                m_work_size = max_factor > 5 ? max_factor : 0;
+            }
+        }
+
+        template <class T>
+        inline std::size_t fft_plan<T>::size() const noexcept
+        {
+            return m_size;
+        }
+
+        // Size of the buffer required by forward.
+        template <class T>
+        inline std::size_t fft_plan<T>::work_size() const noexcept
+        {
+            return m_work_size;
+        }
+
+        // Transforms the m_size elements of in to out, which must not overlap.
+        template <class T>
+        inline void fft_plan<T>::forward(const complex_type* in, complex_type* out, complex_type* work) const
+        {
+            if (p_convolution)
+            {
+                bluestein(in, out, work);
+            }
+            else if (m_factors.empty())
+            {
+                out[0] = in[0];
+            }
+            else
+            {
+                radix(out, in, 1, m_factors.data(), work);
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::radix(complex_type* out, const complex_type* in, std::size_t fstride,
+                                       const std::size_t* factors, complex_type* work) const
+        {
+            std::size_t p = factors[0];
+            std::size_t m = factors[1];
+            complex_type* first = out;
+            complex_type* last = out + p * m;
+            if (m == 1)
+            {
+                for (; out != last; ++out, in += fstride)
+                {
+                    *out = *in;
+                }
+            }
+            else
+            {
+                for (; out != last; out += m, in += fstride)
+                {
+                    radix(out, in, fstride * p, factors + 2, work);
+                }
+            }
+
+            switch (p)
+            {
+            case 2:
+                butterfly2(first, fstride, m);
+                break;
+            case 3:
+                butterfly3(first, fstride, m);
+                break;
+            case 4:
+                butterfly4(first, fstride, m);
+                break;
+            case 5:
+                butterfly5(first, fstride, m);
+                break;
+            default:
+                butterfly(first, fstride, m, p, work);
+                break;
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::butterfly2(complex_type* out, std::size_t fstride, std::size_t m) const
+        {
+            const complex_type* tw = m_twiddles.data();
+            complex_type* out2 = out + m;
+            for (std::size_t k = 0; k < m; ++k, tw += fstride)
+            {
+                complex_type t = fft_mul(out2[k], *tw);
+                out2[k] = out[k] - t;
+                out[k] += t;
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::butterfly3(complex_type* out, std::size_t fstride, std::size_t m) const
+        {
+            const complex_type* tw = m_twiddles.data();
+            T epi3 = m_twiddles[fstride * m].imag();
+            for (std::size_t k = 0; k < m; ++k)
+            {
+                complex_type s1 = fft_mul(out[k + m], tw[k * fstride]);
+                complex_type s2 = fft_mul(out[k + 2 * m], tw[2 * k * fstride]);
+                complex_type s3 = s1 + s2;
+                complex_type s0 = (s1 - s2) * epi3;
+                complex_type mid = out[k] - s3 * T(0.5);
+                out[k] += s3;
+                out[k + m] = complex_type(mid.real() - s0.imag(), mid.imag() + s0.real());
+                out[k + 2 * m] = complex_type(mid.real() + s0.imag(), mid.imag() - s0.real());
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::butterfly4(complex_type* out, std::size_t fstride, std::size_t m) const
+        {
+            const complex_type* tw = m_twiddles.data();
+            for (std::size_t k = 0; k < m; ++k)
+            {
+                complex_type s0 = fft_mul(out[k + m], tw[k * fstride]);
+                complex_type s1 = fft_mul(out[k + 2 * m], tw[2 * k * fstride]);
+                complex_type s2 = fft_mul(out[k + 3 * m], tw[3 * k * fstride]);
+                complex_type s5 = out[k] - s1;
+                complex_type s4 = s0 - s2;
+                complex_type s3 = s0 + s2;
+                complex_type s6 = out[k] + s1;
+                out[k + 2 * m] = s6 - s3;
+                out[k] = s6 + s3;
+                out[k + m] = complex_type(s5.real() + s4.imag(), s5.imag() - s4.real());
+                out[k + 3 * m] = complex_type(s5.real() - s4.imag(), s5.imag() + s4.real());
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::butterfly5(complex_type* out, std::size_t fstride, std::size_t m) const
+        {
+            const complex_type* tw = m_twiddles.data();
+            complex_type ya = m_twiddles[fstride * m];
+            complex_type yb = m_twiddles[2 * fstride * m];
+            for (std::size_t k = 0; k < m; ++k)
+            {
+                complex_type s0 = out[k];
+                complex_type s1 = fft_mul(out[k + m], tw[k * fstride]);
+                complex_type s2 = fft_mul(out[k + 2 * m], tw[2 * k * fstride]);
+                complex_type s3 = fft_mul(out[k + 3 * m], tw[3 * k * fstride]);
+                complex_type s4 = fft_mul(out[k + 4 * m], tw[4 * k * fstride]);
+                complex_type s7 = s1 + s4;
+                complex_type s10 = s1 - s4;
+                complex_type s8 = s2 + s3;
+                complex_type s9 = s2 - s3;
+
+                out[k] = s0 + s7 + s8;
+                complex_type s5(s0.real() + s7.real() * ya.real() + s8.real() * yb.real(),
+                                s0.imag() + s7.imag() * ya.real() + s8.imag() * yb.real());
+                complex_type s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                                -s10.real() * ya.imag() - s9.real() * yb.imag());
+                out[k + m] = s5 - s6;
+                out[k + 4 * m] = s5 + s6;
+                complex_type s11(s0.real() + s7.real() * yb.real() + s8.real() * ya.real(),
+                                 s0.imag() + s7.imag() * yb.real() + s8.imag() * ya.real());
+                complex_type s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                                 s10.real() * yb.imag() - s9.real() * ya.imag());
+                out[k + 2 * m] = s11 + s12;
+                out[k + 3 * m] = s11 - s12;
+            }
+        }
+
+        // Butterfly of any radix p, in O(p^2) operations.
+        template <class T>
+        inline void fft_plan<T>::butterfly(complex_type* out, std::size_t fstride, std::size_t m, std::size_t p,
+                                           complex_type* work) const
+        {
+            for (std::size_t u = 0; u < m; ++u)
+            {
+                for (std::size_t q = 0; q < p; ++q)
+                {
+                    work[q] = out[u + q * m];
+                }
+                for (std::size_t q1 = 0; q1 < p; ++q1)
+                {
+                    std::size_t k = u + q1 * m;
+                    std::size_t step = fstride * k % m_size;
+                    std::size_t index = 0;
+                    complex_type acc = work[0];
+                    for (std::size_t q = 1; q < p; ++q)
+                    {
+                        index += step;
+                        if (index >= m_size)
+                        {
+                            index -= m_size;
+                        }
+                        acc += fft_mul(work[q], m_twiddles[index]);
+                    }
+                    out[k] = acc;
+                }
+            }
+        }
+
+        template <class T>
+        inline void fft_plan<T>::bluestein(const complex_type* in, complex_type* out, complex_type* work) const
+        {
+            std::size_t size = m_filter.size();
+            complex_type* a = work;
+            complex_type* b = work + size;
+            for (std::size_t k = 0; k < m_size; ++k)
+            {
+                a[k] = fft_mul(in[k], m_chirp[k]);
+            }
+            std::fill(a + m_size, a + size, complex_type(0));
+            p_convolution->forward(a, b, nullptr);
+            // inverse transform, as the conjugate of the forward transform
+            // of the conjugate
+            for (std::size_t k = 0; k < size; ++k)
+            {
+                b[k] = std::conj(fft_mul(b[k], m_filter[k]));
+            }
+            p_convolution->forward(b, a, nullptr);
+            for (std::size_t k = 0; k < m_size; ++k)
+            {
+                out[k] = fft_mul(std::conj(a[k]), m_chirp[k]);
+            }
+        }
+
+        /*************
+         * fft lanes *
+         *************/
+
+        // Offsets of the first elements of the lanes along axis.
+        template <class S, class ST>
+        inline std::vector<std::ptrdiff_t> fft_lane_offsets(const S& shape, const ST& strides, std::size_t axis)
+        {
+            std::vector<std::ptrdiff_t> res(1, 0);
+            for (std::size_t d = 0; d < shape.size(); ++d)
+            {
+                if (d == axis)
+                {
+                    continue;
+                }
+                std::vector<std::ptrdiff_t> next;
+                next.reserve(res.size() * shape[d]);
+                for (std::ptrdiff_t offset : res)
+                {
+                    for (std::size_t i = 0; i < shape[d]; ++i)
+                    {
+                        next.push_back(offset + static_cast<std::ptrdiff_t>(i) * static_cast<std::ptrdiff_t>(strides[d]));
+                    }
+                }
+                res.swap(next);
+            }
+            return res;
+        }
+
+        // Calls f(src, dst, scratch) for every lane, the lanes being
+        // distributed over several threads for large transforms. Each
+        // thread owns a scratch buffer of scratch_size elements.
+        template <class I, class O, class C, class F>
+        inline void fft_for_each_lane(const I* src, const std::vector<std::ptrdiff_t>& src_lanes,
+                                      O* dst, const std::vector<std::ptrdiff_t>& dst_lanes,
+                                      std::size_t work, std::size_t scratch_size, F&& f)
+        {
+            std::size_t nb_lanes = src_lanes.size();
+            if (nb_lanes == 0)
+            {
+                return;
+            }
+            auto task = [&](std::size_t first, std::size_t last) {
+                std::vector<C> scratch(scratch_size);
+                for (std::size_t l = first; l < last; ++l)
+                {
+                    f(src + src_lanes[l], dst + dst_lanes[l], scratch.data());
+                }
+            };
+
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(std::min(ex.concurrency(), nb_lanes), nb_lanes * work / fft_parallel_threshold + 1);
+            std::size_t block = (nb_lanes + nb_tasks - 1) / nb_tasks;
+            parallel_for(ex, (nb_lanes + block - 1) / block, [&](std::size_t t) {
+                task(t * block, std::min((t + 1) * block, nb_lanes));
+            });
+        }
+
+        template <class T, class V>
+        inline std::complex<T> fft_cast(const V& v) noexcept
+        {
+            return std::complex<T>(static_cast<T>(std::real(v)), static_cast<T>(std::imag(v)));
+        }
+
+        inline std::size_t fft_log2(std::size_t n) noexcept
+        {
+            std::size_t res = 1;
+            while (n >>= 1)
+            {
+                ++res;
+            }
+            return res;
+        }
+
+        // Element type used to read an expression: its own value type when
+        // it is a floating point or complex type, double otherwise.
+        template <class V>
+        using fft_input_t = std::conditional_t<std::is_arithmetic<V>::value && !std::is_floating_point<V>::value,
+                                               fft_real_t<V>, V>;
+
+        template <class E>
+        inline std::size_t fft_check_axis(const E& e, std::size_t axis)
+        {
+            if (axis >= e.dimension())
+            {
+                throw fft_error("axis " + std::to_string(axis) + " out of range");
+            }
+            if (e.shape()[axis] == 0)
+            {
+                throw fft_error("empty axis");
+            }
+            return axis;
+        }
+
+        template <class E>
+        inline std::size_t fft_last_axis(const E& e)
+        {
+            if (e.dimension() == 0)
+            {
+                throw fft_error("0-D expression");
+            }
+            return e.dimension() - 1;
+        }
+
+        // Complex transform along axis of the n elements of each lane of
+        // src, written to the lanes of dst. The inverse transform is
+        // computed as the conjugate of the transform of the conjugate.
+        template <class T, class I>
+        inline void fft_complex_lanes(const I* src, const std::vector<std::ptrdiff_t>& src_lanes, std::ptrdiff_t src_stride,
+                                      std::complex<T>* dst, const std::vector<std::ptrdiff_t>& dst_lanes, std::ptrdiff_t dst_stride,
+                                      std::size_t n, bool inverse)
+        {
+            using complex_type = std::complex<T>;
+            auto plan = get_fft_plan<T>(n);
+            T scale = inverse ? T(1) / static_cast<T>(n) : T(1);
+            auto f = [&](const I* in, complex_type* out, complex_type* scratch) {
+                complex_type* a = scratch;
+                complex_type* b = scratch + n;
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    complex_type v = fft_cast<T>(in[static_cast<std::ptrdiff_t>(k) * src_stride]);
+                    a[k] = inverse ? std::conj(v) : v;
+                }
+                plan->forward(a, b, scratch + 2 * n);
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    out[static_cast<std::ptrdiff_t>(k) * dst_stride] = inverse ? std::conj(b[k]) * scale : b[k];
+                }
+            };
+            fft_for_each_lane<I, complex_type, complex_type>(src, src_lanes, dst, dst_lanes, n * fft_log2(n),
+                                                             2 * n + plan->work_size(), f);
+        }
+
+        // Transforms of the real lanes of src, of size n, writing the n / 2 + 1
+        // first coefficients to dst. Even sizes are computed with a complex
+        // transform of size n / 2 on the even and odd elements.
+        template <class T, class I>
+        inline void fft_real_lanes(const I* src, const std::vector<std::ptrdiff_t>& src_lanes, std::ptrdiff_t src_stride,
+                                   std::complex<T>* dst, const std::vector<std::ptrdiff_t>& dst_lanes, std::ptrdiff_t dst_stride,
+                                   std::size_t n)
+        {
+            using complex_type = std::complex<T>;
+            if (n % 2 != 0)
+            {
+                std::size_t m = n / 2 + 1;
+                auto plan = get_fft_plan<T>(n);
+                auto f = [&](const I* in, complex_type* out, complex_type* scratch) {
+                    complex_type* a = scratch;
+                    complex_type* b = scratch + n;
+                    for (std::size_t k = 0; k < n; ++k)
+                    {
+                        a[k] = complex_type(static_cast<T>(in[static_cast<std::ptrdiff_t>(k) * src_stride]));
+                    }
+                    plan->forward(a, b, scratch + 2 * n);
+                    for (std::size_t k = 0; k < m; ++k)
+                    {
+                        out[static_cast<std::ptrdiff_t>(k) * dst_stride] = b[k];
+                    }
+                };
+                fft_for_each_lane<I, complex_type, complex_type>(src, src_lanes, dst, dst_lanes, n * fft_log2(n),
+                                                                 2 * n + plan->work_size(), f);
+                return;
+            }
+
+            std::size_t h = n / 2;
+            auto plan = get_fft_plan<T>(h);
+            std::vector<complex_type> tw(h);
+            for (std::size_t k = 0; k < h; ++k)
+            {
+                tw[k] = fft_twiddle<T>(k, n);
+            }
+            auto f = [&](const I* in, complex_type* out, complex_type* scratch) {
+                complex_type* a = scratch;
+                complex_type* b = scratch + h;
+                for (std::size_t k = 0; k < h; ++k)
+                {
+                    a[k] = complex_type(static_cast<T>(in[static_cast<std::ptrdiff_t>(2 * k) * src_stride]),
+                                        static_cast<T>(in[static_cast<std::ptrdiff_t>(2 * k + 1) * src_stride]));
+                }
+                plan->forward(a, b, scratch + 2 * h);
+                // b holds E + i O, E and O being the transforms of the even
+                // and odd elements; X[k] = E[k] + tw[k] O[k]
+                out[0] = complex_type(b[0].real() + b[0].imag());
+                out[static_cast<std::ptrdiff_t>(h) * dst_stride] = complex_type(b[0].real() - b[0].imag());
+                for (std::size_t k = 1; k < h; ++k)
+                {
+                    complex_type z = b[k];
+                    complex_type zc = std::conj(b[h - k]);
+                    complex_type even = (z + zc) * T(0.5);
+                    complex_type diff = (z - zc) * T(0.5);
+                    complex_type odd(diff.imag(), -diff.real());
+                    out[static_cast<std::ptrdiff_t>(k) * dst_stride] = even + fft_mul(tw[k], odd);
+                }
+            };
+            fft_for_each_lane<I, complex_type, complex_type>(src, src_lanes, dst, dst_lanes, h * fft_log2(h),
+                                                             2 * h + plan->work_size(), f);
+        }
+
+        // Inverse of fft_real_lanes: the lanes of src hold m coefficients,
+        // the first n / 2 + 1 being used and missing ones taken as zeros.
+        template <class T, class I>
+        inline void fft_real_inverse_lanes(const I* src, const std::vector<std::ptrdiff_t>& src_lanes, std::ptrdiff_t src_stride,
+                                           std::size_t m, T* dst, const std::vector<std::ptrdiff_t>& dst_lanes,
+                                           std::ptrdiff_t dst_stride, std::size_t n)
+        {
+            using complex_type = std::complex<T>;
+            std::size_t used = std::min(m, n / 2 + 1);
+            auto coefficient = [&](const I* in, std::size_t k) {
+                return k < used ? fft_cast<T>(in[static_cast<std::ptrdiff_t>(k) * src_stride]) : complex_type(0);
+            };
+
+            if (n % 2 != 0)
+            {
+                auto plan = get_fft_plan<T>(n);
+                T scale = T(1) / static_cast<T>(n);
+                auto f = [&](const I* in, T* out, complex_type* scratch) {
+                    complex_type* a = scratch;
+                    complex_type* b = scratch + n;
+                    // conjugate of the hermitian spectrum
+                    a[0] = complex_type(coefficient(in, 0).real());
+                    for (std::size_t k = 1; k <= n / 2; ++k)
+                    {
+                        complex_type c = coefficient(in, k);
+                        a[k] = std::conj(c);
+                        a[n - k] = c;
+                    }
+                    plan->forward(a, b, scratch + 2 * n);
+                    for (std::size_t k = 0; k < n; ++k)
+                    {
+                        out[static_cast<std::ptrdiff_t>(k) * dst_stride] = b[k].real() * scale;
+                    }
+                };
+                fft_for_each_lane<I, T, complex_type>(src, src_lanes, dst, dst_lanes, n * fft_log2(n),
+                                                      2 * n + plan->work_size(), f);
+                return;
+            }
+
+            std::size_t h = n / 2;
+            auto plan = get_fft_plan<T>(h);
+            std::vector<complex_type> tw(h);
+            for (std::size_t k = 0; k < h; ++k)
+            {
+                tw[k] = std::conj(fft_twiddle<T>(k, n));
+            }
+            T scale = T(1) / static_cast<T>(h);
+            auto f = [&](const I* in, T* out, complex_type* scratch) {
+                complex_type* a = scratch;
+                complex_type* b = scratch + h;
+                T first = coefficient(in, 0).real();
+                T last = coefficient(in, h).real();
+                // conjugate of Z = E + i O, E[k] = (X[k] + conj(X[h - k])) / 2
+                // and O[k] = (X[k] - conj(X[h - k])) conj(tw[k]) / 2
+                a[0] = complex_type((first + last) * T(0.5), -(first - last) * T(0.5));
+                for (std::size_t k = 1; k < h; ++k)
+                {
+                    complex_type x = coefficient(in, k);
+                    complex_type xc = std::conj(coefficient(in, h - k));
+                    complex_type even = (x + xc) * T(0.5);
+                    complex_type odd = fft_mul((x - xc) * T(0.5), tw[k]);
+                    a[k] = std::conj(even + complex_type(-odd.imag(), odd.real()));
+                }
+                plan->forward(a, b, scratch + 2 * h);
+                for (std::size_t k = 0; k < h; ++k)
+                {
+                    out[static_cast<std::ptrdiff_t>(2 * k) * dst_stride] = b[k].real() * scale;
+                    out[static_cast<std::ptrdiff_t>(2 * k + 1) * dst_stride] = -b[k].imag() * scale;
+                }
+            };
+            fft_for_each_lane<I, T, complex_type>(src, src_lanes, dst, dst_lanes, h * fft_log2(h),
+                                                  2 * h + plan->work_size(), f);
+        }
+
+        // Shape of the result R of a transform of an expression of the
+        // given shape, with n points along axis.
+        template <class R, class S>
+        inline typename R::shape_type fft_shape(const S& shape, std::size_t axis, std::size_t n)
+        {
+            typename R::shape_type res(shape.cbegin(), shape.cend());
+            res[axis] = n;
+            return res;
+        }
+
+        template <class T, class E>
+        inline xarray<std::complex<T>> fft_complex(const E& e, std::size_t axis, bool inverse)
+        {
+            using input_type = fft_input_t<typename E::value_type>;
+            xarray<input_type> tmp;
+            auto op = linalg_data(e, tmp);
+            std::size_t n = e.shape()[axis];
+            xarray<std::complex<T>> res(fft_shape<xarray<std::complex<T>>>(e.shape(), axis, n));
+            fft_complex_lanes<T>(op.data, fft_lane_offsets(e.shape(), op.strides, axis), op.strides[axis],
+                                 res.data().data(), fft_lane_offsets(res.shape(), res.strides(), axis),
+                                 static_cast<std::ptrdiff_t>(res.strides()[axis]), n, inverse);
+            return res;
+        }
+
+        // In place complex transform of res along axis.
+        template <class T>
+        inline void fft_complex_inplace(xarray<std::complex<T>>& res, std::size_t axis, bool inverse)
+        {
+            auto lanes = fft_lane_offsets(res.shape(), res.strides(), axis);
+            std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(res.strides()[axis]);
+            fft_complex_lanes<T>(res.data().data(), lanes, stride, res.data().data(), lanes, stride,
+                                 res.shape()[axis], inverse);
+        }
+
+        template <class T, class E>
+        inline xarray<std::complex<T>> fft_real(const E& e, std::size_t axis)
+        {
+            using input_type = fft_input_t<typename E::value_type>;
+            static_assert(std::is_arithmetic<input_type>::value, "rfft: the expression must be real");
+            xarray<input_type> tmp;
+            auto op = linalg_data(e, tmp);
+            std::size_t n = e.shape()[axis];
+            xarray<std::complex<T>> res(fft_shape<xarray<std::complex<T>>>(e.shape(), axis, n / 2 + 1));
+            fft_real_lanes<T>(op.data, fft_lane_offsets(e.shape(), op.strides, axis), op.strides[axis],
+                              res.data().data(), fft_lane_offsets(res.shape(), res.strides(), axis),
+                              static_cast<std::ptrdiff_t>(res.strides()[axis]), n);
+            return res;
+        }
+
+        template <class T, class E>
+        inline xarray<T> fft_real_inverse(const E& e, std::size_t n, std::size_t axis)
+        {
+            using input_type = fft_input_t<typename E::value_type>;
+            if (n == 0)
+            {
+                throw fft_error("invalid number of points");
+            }
+            xarray<input_type> tmp;
+            auto op = linalg_data(e, tmp);
+            xarray<T> res(fft_shape<xarray<T>>(e.shape(), axis, n));
+            fft_real_inverse_lanes<T>(op.data, fft_lane_offsets(e.shape(), op.strides, axis), op.strides[axis],
+                                      e.shape()[axis], res.data().data(), fft_lane_offsets(res.shape(), res.strides(), axis),
+                                      static_cast<std::ptrdiff_t>(res.strides()[axis]), n);
+            return res;
+        }
+    }
+
+    /**********************
+     * fft implementation *
+     **********************/
+
+    namespace fft
+    {
+        /**
+         * @brief Discrete Fourier transform along the last axis.
+         *
+         * Computes the one dimensional transform of every lane of \a e
+         * along its last axis, for any size. Like numpy.fft.fft, the
+         * forward transform is not scaled. The transform is not lazy and
+         * returns an xarray of complex numbers.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto fft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            return fft(e, detail::fft_last_axis(e.derived_cast()));
+        }
+
+        /**
+         * @brief Discrete Fourier transform along an axis.
+         *
+         * Plans of each size are computed once and shared; the lanes
+         * of large expressions are transformed by several threads.
+         * @param e the input expression
+         * @param axis the axis of the transform
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto fft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            detail::fft_check_axis(de, axis);
+            return detail::fft_complex<detail::fft_real_t<typename E::value_type>>(de, axis, false);
+        }
+
+        /**
+         * @brief Inverse discrete Fourier transform along the last axis.
+         *
+         * The inverse transform is scaled by the inverse of the number of
+         * points, so that ifft(fft(e)) is e.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto ifft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            return ifft(e, detail::fft_last_axis(e.derived_cast()));
+        }
+
+        /**
+         * @brief Inverse discrete Fourier transform along an axis.
+         * @param e the input expression
+         * @param axis the axis of the transform
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto ifft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            detail::fft_check_axis(de, axis);
+            return detail::fft_complex<detail::fft_real_t<typename E::value_type>>(de, axis, true);
+        }
+
+        /**
+         * @brief Discrete Fourier transform of a real expression along
+         * the last axis.
+         *
+         * Returns the n / 2 + 1 non-negative frequency terms of the
+         * transform of the lanes of n points, the other ones being their
+         * conjugates. Even sizes are computed with a complex transform of
+         * half size.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto rfft(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            return rfft(e, detail::fft_last_axis(e.derived_cast()));
+        }
+
+        /**
+         * @brief Discrete Fourier transform of a real expression along
+         * an axis.
+         * @param e the input expression
+         * @param axis the axis of the transform
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto rfft(const xexpression<E>& e, std::size_t axis) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            detail::fft_check_axis(de, axis);
+            return detail::fft_real<detail::fft_real_t<typename E::value_type>>(de, axis);
+        }
+
+        /**
+         * @brief Inverse of rfft along the last axis.
+         *
+         * The lanes of \a e hold m coefficients; the result has 2 (m - 1)
+         * points.
+         * @param e the input expression
+         * @return an xarray holding the real transform
+         */
+        template <class E>
+        inline auto irfft(const xexpression<E>& e) -> xarray<detail::fft_real_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            std::size_t axis = detail::fft_last_axis(de);
+            detail::fft_check_axis(de, axis);
+            std::size_t m = de.shape()[axis];
+            return irfft(e, m > 1 ? 2 * (m - 1) : std::size_t(1), axis);
+        }
+
+        /**
+         * @brief Inverse of rfft along an axis.
+         *
+         * Computes n real points from the first n / 2 + 1 coefficients of
+         * the lanes of \a e, missing coefficients being taken as zeros.
+         * @param e the input expression
+         * @param n the number of points of the result
+         * @param axis the axis of the transform
+         * @return an xarray holding the real transform
+         */
+        template <class E>
+        inline auto irfft(const xexpression<E>& e, std::size_t n, std::size_t axis) -> xarray<detail::fft_real_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            detail::fft_check_axis(de, axis);
+            return detail::fft_real_inverse<detail::fft_real_t<typename E::value_type>>(de, n, axis);
+        }
+
+        /**
+         * @brief N-dimensional discrete Fourier transform.
+         *
+         * Transforms \a e along each of its axes.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto fftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            auto res = fft(e, detail::fft_check_axis(de, 0));
+            for (std::size_t axis = 1; axis < de.dimension(); ++axis)
+            {
+                detail::fft_complex_inplace(res, detail::fft_check_axis(de, axis), false);
+            }
+            return res;
+        }
+
+        /**
+         * @brief N-dimensional inverse discrete Fourier transform.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto ifftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            auto res = ifft(e, detail::fft_check_axis(de, 0));
+            for (std::size_t axis = 1; axis < de.dimension(); ++axis)
+            {
+                detail::fft_complex_inplace(res, detail::fft_check_axis(de, axis), true);
+            }
+            return res;
+        }
+
+        /**
+         * @brief N-dimensional discrete Fourier transform of a real
+         * expression.
+         *
+         * The last axis is transformed by rfft, the other ones by fft.
+         * @param e the input expression
+         * @return an xarray holding the transform
+         */
+        template <class E>
+        inline auto rfftn(const xexpression<E>& e) -> xarray<detail::fft_complex_t<typename E::value_type>>
+        {
+            const E& de = e.derived_cast();
+            auto res = rfft(e);
+            for (std::size_t axis = 0; axis + 1 < de.dimension(); ++axis)
+            {
+                detail::fft_complex_inplace(res, detail::fft_check_axis(de, axis), false);
+            }
+            return res;
+        }
+
+        /**
+         * @brief Inverse of rfftn.
+         *
+         * The last axis of the result has 2 (m - 1) points, m being the
+         * last dimension of \a e.
+         * @param e the input expression
+         * @return an xarray holding the real transform
+         */
+        template <class E>
+        inline auto irfftn(const xexpression<E>& e) -> xarray<detail::fft_real_t<typename E::value_type>>
+        {
+            using value_type = detail::fft_complex_t<typename E::value_type>;
+            const E& de = e.derived_cast();
+            std::size_t last = detail::fft_last_axis(de);
+            xarray<value_type> tmp = de;
+            for (std::size_t axis = 0; axis < last; ++axis)
+            {
+                detail::fft_complex_inplace(tmp, detail::fft_check_axis(de, axis), true);
+            }
+            return irfft(tmp);
+        }
+    }
+}
+
+#endif
@@ -134,6 +134,7 @@ namespace xt
         size_type size() const noexcept;
         size_type dimension() const noexcept;
         const shape_type& shape() const;
+        const std::tuple<CT...>& arguments() const noexcept;
 
         template <class... Args>
         const_reference operator()(Args... args) const;
@@ -224,6 +225,7 @@ namespace xt
 
         self_type& operator++();
         self_type operator++(int);
+        self_type& operator+=(difference_type n);
 
         reference operator*() const;
 
@@ -359,6 +361,15 @@ namespace xt
         }
         return m_shape;
     }
+
+    /**
+     * Returns the arguments of the xfunction.
+     */
+    template <class F, class R, class... CT>
+    inline auto xfunction<F, R, CT...>::arguments() const noexcept -> const std::tuple<CT...>&
+    {
+        return m_e;
+    }
     //@}
 
     /**
@@ -652,6 +663,16 @@ namespace xt
         return tmp;
     }
 
+    // Only valid when the iterators of all the arguments provide
+    // operator+=, e.g. for functions of containers and scalars.
+    template <class F, class R, class... CT>
+    inline auto xfunction_iterator<F, R, CT...>::operator+=(difference_type n) -> self_type&
+    {
+        auto f = [n](auto& it) { it += n; };
+        for_each(f, m_it);
+        return *this;
+    }
+
     template <class F, class R, class... CT>
     inline auto xfunction_iterator<F, R, CT...>::operator*() const -> reference
     {
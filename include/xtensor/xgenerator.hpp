@@ -112,6 +112,9 @@ namespace xt
         template <class O>
         const_stepper stepper_end(const O& shape) const noexcept;
 
+        template <class E, class FE = functor_type, class = decltype(std::declval<const FE&>().assign_to(std::declval<E&>()))>
+        void assign_to(E& e) const;
+
     private:
 
         functor_type m_f;
@@ -260,7 +263,22 @@ namespace xt
         return const_stepper(this, offset, true);
     }
 
-     namespace detail
+    /**
+     * Writes the values of the generator into the specified container.
+     * This method is only available when the underlying function provides
+     * a closed-form evaluation, and is called by the assignment functions
+     * when \c e is a row-major contiguous container with the same shape
+     * as the generator.
+     * @param e the container to fill
+     */
+    template <class F, class R, class S>
+    template <class E, class FE, class>
+    inline void xgenerator<F, R, S>::assign_to(E& e) const
+    {
+        m_f.assign_to(e);
+    }
+
+    namespace detail
     {
 #ifdef X_OLD_CLANG
         template <class Functor, class I>
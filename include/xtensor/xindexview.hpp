@@ -18,6 +18,7 @@
 #include "xexpression.hpp"
 #include "xstrides.hpp"
 #include "xiterable.hpp"
+#include "xscalar.hpp"
 #include "xutils.hpp"
 
 namespace xt
@@ -260,6 +261,10 @@ namespace xt
     template <class E>
     inline auto xindexview<CT, I>::operator=(const E& e) -> disable_xexpression<E, self_type>&
     {
+        if (detail::record_assign(*this, xscalar<E>(e)))
+        {
+            return *this;
+        }
         std::fill(this->begin(), this->end(), e);
         return *this;
     }
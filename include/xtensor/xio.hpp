@@ -9,13 +9,19 @@
 #ifndef XIO_HPP
 #define XIO_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdio>
 #include <complex>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <limits>
 #include <numeric>
+#include <type_traits>
+#include <vector>
 
 #include "xexpression.hpp"
 #include "xmath.hpp"
@@ -100,126 +106,400 @@ namespace xt
 
     namespace detail
     {
-        template <std::size_t I>
-        struct xout
+        // Size of the blocks in which the formatted text is written to the
+        // output stream.
+        constexpr std::size_t print_block_size = std::size_t(1) << 16;
+
+        // Upper bound of the width of the printed elements; wider elements
+        // are printed without padding.
+        constexpr precision_type max_print_width = 64;
+
+        inline void print_float(std::string& buf, double val, char conversion, precision_type width, precision_type precision)
         {
-            template <class E, class F>
-            static std::ostream& output(std::ostream& out, const E& e, F& printer, std::size_t blanks,
-                                        std::size_t element_width, std::size_t edge_items, std::size_t line_width)
+            const char format[] = {'%', '*', '.', '*', conversion, '\0'};
+            std::size_t pos = buf.size();
+            std::size_t capacity = 32;
+            while (true)
             {
-                using size_type = typename E::size_type;
+                buf.resize(pos + capacity + 1);
+                int n = std::snprintf(&buf[pos], capacity + 1, format, static_cast<int>(width), static_cast<int>(precision), val);
+                if (n < 0)
+                {
+                    n = 0;
+                }
+                if (static_cast<std::size_t>(n) <= capacity)
+                {
+                    buf.resize(pos + static_cast<std::size_t>(n));
+                    return;
+                }
+                capacity = static_cast<std::size_t>(n);
+            }
+        }
 
-                if (e.dimension() == 0)
+        inline void print_float(std::string& buf, long double val, char conversion, precision_type width, precision_type precision)
+        {
+            const char format[] = {'%', '*', '.', '*', 'L', conversion, '\0'};
+            std::size_t pos = buf.size();
+            std::size_t capacity = 32;
+            while (true)
+            {
+                buf.resize(pos + capacity + 1);
+                int n = std::snprintf(&buf[pos], capacity + 1, format, static_cast<int>(width), static_cast<int>(precision), val);
+                if (n < 0)
                 {
-                    printer.print_next(out);
+                    n = 0;
                 }
-                else
+                if (static_cast<std::size_t>(n) <= capacity)
                 {
-                    std::string indents(blanks, ' ');
-                    
-                    size_type i = 0;
-                    size_type elems_on_line = 0;
-                    size_type line_lim = (size_type) std::floor(line_width / (element_width + 2));
-                    
-                    out << '{';
-                    for (;i != e.shape()[0] - 1; ++i)
-                    {
-                        if (edge_items && e.shape()[0] > (edge_items * 2) && i == edge_items)
-                        {
-                            out << "..., ";
-                            if (e.dimension() > 1)
-                            {
-                                elems_on_line = 0;
-                                out << std::endl << indents;
-                            }
-                            i = e.shape()[0] - edge_items;
-                        }
-                        if (e.dimension() == 1 && line_lim != 0 && elems_on_line >= line_lim)
-                        {
-                            out << std::endl << indents;
-                            elems_on_line = 0;
-                        }
+                    buf.resize(pos + static_cast<std::size_t>(n));
+                    return;
+                }
+                capacity = static_cast<std::size_t>(n);
+            }
+        }
 
-                        xout<I - 1>::output(out, view(e, i), printer, blanks + 1, element_width, edge_items, line_width) << ',';
+        inline void print_float(std::string& buf, float val, char conversion, precision_type width, precision_type precision)
+        {
+            print_float(buf, static_cast<double>(val), conversion, width, precision);
+        }
 
-                        elems_on_line++;
+        // Fixed notation without snprintf: the value is scaled and rounded to
+        // an integer, which gives the same digits as printf unless the scaled
+        // value is too large or too close to a rounding tie to be rounded
+        // reliably; snprintf is used in that case.
+        // Powers of ten that are exactly representable as doubles
+        inline double exact_power_of_ten(int n)
+        {
+            static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            return powers[n];
+        }
 
-                        if (I == 1 || e.dimension() == 1)
-                        {
-                             out << ' ';
-                        }
-                        else
-                        {
-                             out << std::endl << indents;
-                        }
-                    }
-                    if (e.dimension() == 1 && line_lim != 0 && elems_on_line >= line_lim)
-                    {
-                        out << std::endl << indents;
-                    }
-                    xout<I - 1>::output(out, view(e, i), printer, blanks + 1, element_width, edge_items, line_width) << '}';
-                }
-                return out;
+        inline void print_fixed(std::string& buf, double val, precision_type width, precision_type precision)
+        {
+            if (precision < 0 || precision > 15 || !std::isfinite(val))
+            {
+                print_float(buf, val, 'f', width, precision);
+                return;
             }
-        };
+            double scaled = std::fabs(val) * exact_power_of_ten(static_cast<int>(precision));
+            double integral = std::floor(scaled);
+            double fraction = scaled - integral;
+            if (scaled >= 1e15 || std::fabs(fraction - 0.5) <= scaled * std::numeric_limits<double>::epsilon())
+            {
+                print_float(buf, val, 'f', width, precision);
+                return;
+            }
+            unsigned long long r = static_cast<unsigned long long>(integral) + (fraction > 0.5 ? 1 : 0);
 
-        template <>
-        struct xout<0>
+            char digits[40];
+            char* last = digits + sizeof(digits);
+            char* first = last;
+            for (precision_type i = 0; i < precision; ++i)
+            {
+                *--first = static_cast<char>('0' + r % 10);
+                r /= 10;
+            }
+            if (precision > 0)
+            {
+                *--first = '.';
+            }
+            do
+            {
+                *--first = static_cast<char>('0' + r % 10);
+                r /= 10;
+            } while (r != 0);
+            if (std::signbit(val))
+            {
+                *--first = '-';
+            }
+            precision_type size = static_cast<precision_type>(last - first);
+            if (width > size)
+            {
+                buf.append(static_cast<std::size_t>(width - size), ' ');
+            }
+            buf.append(first, last);
+        }
+
+        inline void print_fixed(std::string& buf, float val, precision_type width, precision_type precision)
         {
-            template <class E, class F>
-            static std::ostream& output(std::ostream& out, const E& e, F& printer, 
-                                        std::size_t, std::size_t, std::size_t, std::size_t)
+            print_fixed(buf, static_cast<double>(val), width, precision);
+        }
+
+        inline void print_fixed(std::string& buf, long double val, precision_type width, precision_type precision)
+        {
+            print_float(buf, val, 'f', width, precision);
+        }
+
+        // Scientific notation without snprintf, with the same fallback as
+        // print_fixed. The scaling factor must be an exact power of ten.
+        inline void print_scientific(std::string& buf, double val, precision_type width, precision_type precision)
+        {
+            if (precision < 0 || precision > 15 || val == 0 || !std::isfinite(val))
             {
-                if (e.dimension() == 0)
+                print_float(buf, val, 'e', width, precision);
+                return;
+            }
+            double abs_val = std::fabs(val);
+            int exponent = static_cast<int>(std::floor(std::log10(abs_val)));
+            double lower = exact_power_of_ten(static_cast<int>(precision));
+            unsigned long long r = 0;
+            bool reliable = false;
+            for (int attempt = 0; attempt < 2; ++attempt)
+            {
+                int shift = static_cast<int>(precision) - exponent;
+                if (shift > 22 || shift < -22)
+                {
+                    break;
+                }
+                double scaled = shift >= 0 ? abs_val * exact_power_of_ten(shift) : abs_val / exact_power_of_ten(-shift);
+                double integral = std::floor(scaled);
+                double fraction = scaled - integral;
+                if (std::fabs(fraction - 0.5) <= scaled * std::numeric_limits<double>::epsilon())
+                {
+                    break;
+                }
+                double rounded = integral + (fraction > 0.5 ? 1. : 0.);
+                if (rounded >= lower * 10.)
+                {
+                    ++exponent;
+                }
+                else if (rounded < lower)
                 {
-                    return printer.print_next(out);
+                    --exponent;
                 }
                 else
                 {
-                    return out << "{...}";
+                    r = static_cast<unsigned long long>(rounded);
+                    reliable = true;
+                    break;
                 }
             }
-        };
+            if (!reliable)
+            {
+                print_float(buf, val, 'e', width, precision);
+                return;
+            }
+
+            char digits[48];
+            char* last = digits + sizeof(digits);
+            char* first = last;
+            unsigned int abs_exponent = static_cast<unsigned int>(exponent < 0 ? -exponent : exponent);
+            do
+            {
+                *--first = static_cast<char>('0' + abs_exponent % 10);
+                abs_exponent /= 10;
+            } while (abs_exponent != 0);
+            if (last - first < 2)
+            {
+                *--first = '0';
+            }
+            *--first = exponent < 0 ? '-' : '+';
+            *--first = 'e';
+            for (precision_type i = 0; i < precision; ++i)
+            {
+                *--first = static_cast<char>('0' + r % 10);
+                r /= 10;
+            }
+            if (precision > 0)
+            {
+                *--first = '.';
+            }
+            *--first = static_cast<char>('0' + r);
+            if (std::signbit(val))
+            {
+                *--first = '-';
+            }
+            precision_type size = static_cast<precision_type>(last - first);
+            if (width > size)
+            {
+                buf.append(static_cast<std::size_t>(width - size), ' ');
+            }
+            buf.append(first, last);
+        }
+
+        inline void print_scientific(std::string& buf, float val, precision_type width, precision_type precision)
+        {
+            print_scientific(buf, static_cast<double>(val), width, precision);
+        }
+
+        inline void print_scientific(std::string& buf, long double val, precision_type width, precision_type precision)
+        {
+            print_float(buf, val, 'e', width, precision);
+        }
+
+        template <class T>
+        inline void print_integer(std::string& buf, T val, precision_type width)
+        {
+            using unsigned_type = std::make_unsigned_t<T>;
+            char digits[std::numeric_limits<unsigned_type>::digits10 + 2];
+            char* last = digits + sizeof(digits);
+            char* first = last;
+            bool negative = val < T(0);
+            unsigned_type u = negative ? unsigned_type(unsigned_type(0) - static_cast<unsigned_type>(val)) : static_cast<unsigned_type>(val);
+            do
+            {
+                *--first = static_cast<char>('0' + u % 10);
+                u = static_cast<unsigned_type>(u / 10);
+            } while (u != 0);
+            if (negative)
+            {
+                *--first = '-';
+            }
+            precision_type size = static_cast<precision_type>(last - first);
+            if (width > size)
+            {
+                buf.append(static_cast<std::size_t>(width - size), ' ');
+            }
+            buf.append(first, last);
+        }
 
-        template <std::size_t I>
-        struct recurser
+        inline void print_newline(std::string& buf, std::size_t indents)
         {
-            template <class F, class E>
-            static void run(F& fn, const E& e, std::size_t lim = 0)
+            buf += '\n';
+            buf.append(indents, ' ');
+        }
+
+        inline void print_flush(std::ostream& out, std::string& buf)
+        {
+            if (buf.size() >= print_block_size)
+            {
+                out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                buf.clear();
+            }
+        }
+
+        // Visits the elements that are printed, in row-major order. The
+        // middle of the axes longer than 2 * edge_items is skipped; elements
+        // of expressions with more than depth dimensions are not printed.
+        template <class E, class F>
+        void visit_printed(const E& e, F& fn, xindex& index, std::size_t axis, std::size_t edge_items)
+        {
+            if (axis == e.dimension())
+            {
+                fn.update(e.element(index.cbegin(), index.cend()));
+                return;
+            }
+            std::size_t n = e.shape()[axis];
+            for (std::size_t i = 0; i != n; ++i)
             {
-                using size_type = typename E::size_type;
-                if (e.dimension() == 0)
+                if (edge_items && n > (edge_items * 2) && i == edge_items)
                 {
-                    fn.update(e());
+                    i = n - edge_items;
                 }
-                else
+                index[axis] = i;
+                visit_printed(e, fn, index, axis + 1, edge_items);
+            }
+        }
+
+        template <class E, class F>
+        void visit_printed(const E& e, F& fn, std::size_t edge_items, std::size_t depth)
+        {
+            if (e.dimension() == 0)
+            {
+                fn.update(e());
+            }
+            else if (e.dimension() <= depth)
+            {
+                if (edge_items == 0)
                 {
-                    size_type i = 0;
-                    for (;i != e.shape()[0] - 1; ++i)
+                    // cbegin follows the storage order of containers,
+                    // cxbegin is always row-major
+                    for (auto it = e.cxbegin(); it != e.cxend(); ++it)
                     {
-                        if (lim && e.shape()[0] > (lim * 2) && i == lim)
-                        {
-                            i = e.shape()[0] - lim;
-                        }
-                        recurser<I - 1>::run(fn, view(e, i), lim);
+                        fn.update(*it);
                     }
-                    recurser<I - 1>::run(fn, view(e, i), lim);
+                }
+                else
+                {
+                    xindex index(e.dimension(), 0);
+                    visit_printed(e, fn, index, 0, edge_items);
                 }
             }
+        }
+
+        struct print_layout
+        {
+            std::size_t depth;
+            std::size_t element_width;
+            std::size_t edge_items;
+            std::size_t line_width;
         };
 
-        template <>
-        struct recurser<0>
+        // Formats the sub-expression along the given axis from the values
+        // cached in the printer, in the order of visit_printed.
+        template <class S, class F>
+        void print_axis(std::ostream& out, std::string& buf, const S& shape, std::size_t axis,
+                        F& printer, const print_layout& layout)
         {
-            template <class F, class E>
-            static void run(F& fn, const E& e, std::size_t)
+            if (axis == shape.size())
             {
-                if (e.dimension() == 0)
+                printer.print_next(buf);
+                print_flush(out, buf);
+                return;
+            }
+            if (axis == layout.depth)
+            {
+                buf += "{...}";
+                return;
+            }
+
+            std::size_t n = shape[axis];
+            std::size_t dim = shape.size() - axis;
+            std::size_t indents = axis + 1;
+            std::size_t elems_on_line = 0;
+            std::size_t line_lim = layout.line_width / (layout.element_width + 2);
+            std::size_t edge_items = layout.edge_items;
+
+            buf += '{';
+            if (n == 0)
+            {
+                buf += '}';
+                return;
+            }
+            for (std::size_t i = 0; i != n - 1; ++i)
+            {
+                if (edge_items && n > (edge_items * 2) && i == edge_items)
                 {
-                    fn.update(e());
+                    buf += "..., ";
+                    if (dim > 1)
+                    {
+                        elems_on_line = 0;
+                        print_newline(buf, indents);
+                    }
+                    i = n - edge_items;
+                    if (i == n - 1)
+                    {
+                        break;
+                    }
+                }
+                if (dim == 1 && line_lim != 0 && elems_on_line >= line_lim)
+                {
+                    print_newline(buf, indents);
+                    elems_on_line = 0;
+                }
+
+                print_axis(out, buf, shape, axis + 1, printer, layout);
+                buf += ',';
+
+                elems_on_line++;
+
+                if (layout.depth - axis == 1 || dim == 1)
+                {
+                    buf += ' ';
+                }
+                else
+                {
+                    print_newline(buf, indents);
                 }
             }
-        };
+            if (dim == 1 && line_lim != 0 && elems_on_line >= line_lim)
+            {
+                print_newline(buf, indents);
+            }
+            print_axis(out, buf, shape, axis + 1, printer, layout);
+            buf += '}';
+        }
 
         template <class T, class E = void>
         struct printer;
@@ -251,56 +531,44 @@ namespace xt
                 }
                 else
                 {
-                    // 3 => sign and dot and + 1 (from calculation for exponent)
-                    m_width = 3 + (precision_type) std::log10(std::floor(m_max)) + m_precision;
+                    // 3 => sign and dot and + 1 (from calculation for exponent);
+                    // values below 1, and expressions without any finite
+                    // nonzero value, have a single integral digit
+                    precision_type exponent = m_max < 1 ? 0 : (precision_type) std::log10(std::floor(m_max));
+                    m_width = 3 + exponent + m_precision;
                 }
                 if (!m_required_precision)
                 {
                     --m_width;
                 }
+                m_width = std::min(m_width, max_print_width);
             }
 
-            std::ostream& print_next(std::ostream& out)
+            void print_next(std::string& buf)
             {
+                std::size_t pos = buf.size();
                 if (!m_scientific)
                 {
-                    std::stringstream buf;
-                    buf << std::setw(m_width) << std::fixed << std::setprecision(m_precision) << (*m_it);
+                    print_fixed(buf, *m_it, m_width, m_precision);
                     if (!m_required_precision)
                     {
-                        buf << '.';
+                        buf += '.';
                     }
-                    std::string res = buf.str();
-                    auto sit = res.rbegin();
-                    while (*sit == '0')
+                    for (std::size_t i = buf.size(); i != pos && buf[i - 1] == '0'; --i)
                     {
-                        *sit = ' ';
-                        ++sit;
+                        buf[i - 1] = ' ';
                     }
-                    out << res;
                 }
                 else
                 {
-                    if (!m_large_exponent)
+                    print_scientific(buf, *m_it, m_width, m_precision);
+                    if (m_large_exponent && buf.size() - pos >= 4 && buf[buf.size() - 4] == 'e')
                     {
-                        out << std::scientific << std::setw(m_width) << (*m_it);
-                    }
-                    else
-                    {
-                        std::stringstream buf;
-                        buf << std::setw(m_width) << std::scientific << std::setprecision(m_precision) << (*m_it);
-                        std::string res = buf.str();
-
-                        if (res[res.size() - 4] == 'e')
-                        {
-                            res.erase(0, 1);
-                            res.insert(res.size() - 2, "0");
-                        }
-                        out << res;
+                        buf.erase(pos, 1);
+                        buf.insert(buf.size() - 2, 1, '0');
                     }
                 }
                 ++m_it;
-                return out;
             }
 
             void update(const value_type& val)
@@ -324,12 +592,12 @@ namespace xt
                     {
                         m_max = std::abs(val);
                     }
-                    if (m_required_precision < m_precision)
+                    // digits beyond m_precision are never printed, the
+                    // search stops there
+                    while (m_required_precision < m_precision &&
+                           std::floor(val * std::pow(10, m_required_precision)) != val * std::pow(10, m_required_precision))
                     {
-                        while (std::floor(val * std::pow(10, m_required_precision)) != val * std::pow(10, m_required_precision))
-                        {
-                            m_required_precision++;
-                        }
+                        m_required_precision++;
                     }
                 }
                 m_cache.push_back(val);
@@ -366,16 +634,14 @@ namespace xt
             void init()
             {
                 m_it = m_cache.cbegin();
-                m_width = 1 + (precision_type) std::log10(m_max) + m_sign;
+                m_width = 1 + (m_max != 0 ? (precision_type) std::log10(m_max) : 0) + m_sign;
             }
 
-            std::ostream& print_next(std::ostream& out)
+            void print_next(std::string& buf)
             {
-                // + enables printing of chars etc. as numbers
-                // TODO should chars be printed as numbers?
-                out << std::setw(m_width) << +(*m_it);
+                // chars are printed as numbers
+                print_integer(buf, *m_it, m_width);
                 ++m_it;
-                return out;
             }
 
             void update(const value_type& val)
@@ -421,20 +687,10 @@ namespace xt
                 m_it = m_cache.cbegin();
             }
 
-            std::ostream& print_next(std::ostream& out)
+            void print_next(std::string& buf)
             {
-                if (*m_it)
-                {
-                    out << " true";
-                }
-                else
-                {
-                    out << "false";
-                }
-                // the following std::setw(5) isn't working correctly on OSX.
-                // out << std::boolalpha << std::setw(m_width) << (*m_it);
+                buf += *m_it ? " true" : "false";
                 ++m_it;
-                return out;
             }
 
             void update(const value_type& val)
@@ -472,27 +728,17 @@ namespace xt
                 m_it = m_signs.cbegin();
             }
 
-            std::ostream& print_next(std::ostream& out)
+            void print_next(std::string& buf)
             {
-                real_printer.print_next(out);
-                if (*m_it)
-                {
-                    out << "-";
-                }
-                else
-                {
-                    out << "+";
-                }
-                std::stringstream buf;
-                imag_printer.print_next(buf);
-                std::string s = buf.str();
-                s.erase(0, 1); // erase space for +/-
-                // insert j at end of number
-                std::size_t idx = s.find_last_not_of(" ");
-                s.insert(idx + 1, "j");
-                out << s;
+                real_printer.print_next(buf);
+                buf += *m_it ? '-' : '+';
+                m_imag.clear();
+                imag_printer.print_next(m_imag);
+                // erase space for +/- and insert j at end of number
+                std::size_t idx = m_imag.find_last_not_of(' ');
+                m_imag.insert(idx + 1, 1, 'j');
+                buf.append(m_imag, 1, std::string::npos);
                 ++m_it;
-                return out;
             }
 
             void update(const value_type& val)
@@ -511,6 +757,7 @@ namespace xt
                 printer<value_type> real_printer, imag_printer;
                 cache_type m_signs;
                 cache_iterator m_it;
+                std::string m_imag;
         };
 
         template <class T>
@@ -533,23 +780,26 @@ namespace xt
                 }
             }
 
-            std::ostream& print_next(std::ostream& out)
+            void print_next(std::string& buf)
             {
-                out << std::setw(m_width) << *m_it;
+                if (m_width > precision_type(m_it->size()))
+                {
+                    buf.append(static_cast<std::size_t>(m_width) - m_it->size(), ' ');
+                }
+                buf += *m_it;
                 ++m_it;
-                return out;
             }
 
             void update(const value_type& val)
             {
-                std::stringstream buf;
-                buf << val;
-                std::string s = buf.str();
+                m_buf.str(std::string());
+                m_buf << val;
+                std::string s = m_buf.str();
                 if(int(s.size()) > m_width)
                 {
                     m_width = int(s.size());
                 }
-                m_cache.push_back(s);
+                m_cache.push_back(std::move(s));
             }
 
             precision_type width()
@@ -561,6 +811,7 @@ namespace xt
                 precision_type m_width = 0;                
                 cache_type m_cache;
                 cache_iterator m_it;
+                std::ostringstream m_buf;
         };
 
         template <class E>
@@ -618,22 +869,26 @@ namespace xt
             lim = print_options::print_options().edge_items;
         }
 
-        precision_type temp_precision = (precision_type) out.precision();
-        precision_type precision = temp_precision;
+        precision_type precision = (precision_type) out.precision();
         if (print_options::print_options().precision != -1)
         {
-            out << std::setprecision(print_options::print_options().precision);
             precision = print_options::print_options().precision;
         }
 
         detail::printer<E> p(precision);
- 
+
         constexpr std::size_t depth = detail::recursion_depth<typename E::shape_type>::value;
-        detail::recurser<depth>::run(p, d, lim);
+        detail::visit_printed(d, p, lim, depth);
         p.init();
-        detail::xout<depth>::output(out, d, p, 1, p.width(), lim, print_options::print_options().line_width);
 
-        out << std::setprecision(temp_precision); // restore precision
+        // the text is formatted in a buffer that is written to the stream
+        // by blocks, so that printing large expressions does not build the
+        // whole text in memory
+        std::string buf;
+        buf.reserve(detail::print_block_size + 256);
+        detail::print_layout layout = {depth, static_cast<std::size_t>(p.width()), lim, print_options::print_options().line_width};
+        detail::print_axis(out, buf, d.shape(), 0, p, layout);
+        out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
 
         return out;
     }
@@ -0,0 +1,1447 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_HPP
+#define XLINALG_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xblas.hpp"
+#include "xcontainer.hpp"
+#include "xexception.hpp"
+#include "xexecutor.hpp"
+#include "xstrides.hpp"
+#include "xstrided_view.hpp"
+#include "xtensor.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+    template <class E1, class E2>
+    auto dot(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+    namespace detail
+    {
+        template <class E1, class E2, class = void>
+        struct matmul_result;
+    }
+
+    template <class E1, class E2>
+    auto matmul(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> typename detail::matmul_result<E1, E2>::type;
+
+    namespace detail
+    {
+        template <class T>
+        using linalg_float_t = std::conditional_t<std::is_floating_point<T>::value, T, double>;
+
+        template <class... E>
+        using linalg_value_t = linalg_float_t<std::common_type_t<typename E::value_type...>>;
+    }
+
+    namespace linalg
+    {
+        template <class E>
+        std::vector<std::size_t> lu_factor(E& a);
+
+        template <class E1, class E2>
+        auto lu_solve(const xexpression<E1>& lu, const std::vector<std::size_t>& piv, const xexpression<E2>& b)
+            -> xarray<detail::linalg_value_t<E1, E2>>;
+
+        template <class E>
+        auto lu(const xexpression<E>& e) -> std::tuple<xarray<detail::linalg_value_t<E>>,
+                                                       xarray<detail::linalg_value_t<E>>,
+                                                       xarray<detail::linalg_value_t<E>>>;
+
+        template <class E>
+        void cho_factor(E& a);
+
+        template <class E1, class E2>
+        auto cho_solve(const xexpression<E1>& c, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>;
+
+        template <class E>
+        auto cholesky(const xexpression<E>& e) -> xarray<detail::linalg_value_t<E>>;
+
+        template <class E>
+        auto qr(const xexpression<E>& e) -> std::tuple<xarray<detail::linalg_value_t<E>>,
+                                                       xarray<detail::linalg_value_t<E>>>;
+
+        template <class E1, class E2>
+        auto solve_triangular(const xexpression<E1>& a, const xexpression<E2>& b, bool lower = true)
+            -> xarray<detail::linalg_value_t<E1, E2>>;
+
+        template <class E1, class E2>
+        auto solve(const xexpression<E1>& a, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>;
+
+        template <class E>
+        auto inv(const xexpression<E>& e) -> xarray<detail::linalg_value_t<E>>;
+
+        template <class E>
+        auto det(const xexpression<E>& e) -> detail::linalg_value_t<E>;
+
+        template <class E1, class E2>
+        auto lstsq(const xexpression<E1>& a, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>;
+    }
+
+    /********************
+     * linalg internals *
+     ********************/
+
+    namespace detail
+    {
+        inline std::runtime_error linalg_error(const std::string& fn, const std::string& msg)
+        {
+            return std::runtime_error(fn + ": " + msg);
+        }
+
+        template <class E>
+        struct is_strided_view : std::false_type
+        {
+        };
+
+        template <class CT>
+        struct is_strided_view<xstrided_view<CT>> : std::true_type
+        {
+        };
+
+        // Expressions whose elements of type T can be read in place
+        // through a pointer and strides.
+        template <class E, class T, class = void>
+        struct has_linalg_data : std::false_type
+        {
+        };
+
+        template <class E, class T>
+        struct has_linalg_data<E, T, std::enable_if_t<is_container<E>::value || is_strided_view<E>::value>>
+            : std::integral_constant<bool, std::is_same<typename E::value_type, T>::value &&
+                                           has_raw_data<std::remove_const_t<typename E::container_type>>::value>
+        {
+        };
+
+        template <class T>
+        struct linalg_operand
+        {
+            const T* data;
+            std::vector<std::ptrdiff_t> strides;
+        };
+
+        template <class T, class S>
+        inline linalg_operand<T> make_linalg_operand(const T* data, const S& strides)
+        {
+            return {data, std::vector<std::ptrdiff_t>(strides.cbegin(), strides.cend())};
+        }
+
+        template <class E>
+        inline std::ptrdiff_t linalg_offset(const E& e, std::true_type)
+        {
+            return static_cast<std::ptrdiff_t>(e.offset());
+        }
+
+        template <class E>
+        inline std::ptrdiff_t linalg_offset(const E&, std::false_type)
+        {
+            return 0;
+        }
+
+        template <class T, class E>
+        inline linalg_operand<T> linalg_data(const E& e, xarray<T>&, std::true_type)
+        {
+            return make_linalg_operand(e.data().data() + linalg_offset(e, is_strided_view<E>()), e.strides());
+        }
+
+        template <class T, class E>
+        inline linalg_operand<T> linalg_data(const E& e, xarray<T>& tmp, std::false_type)
+        {
+            tmp = e;
+            return make_linalg_operand<T>(tmp.data().data(), tmp.strides());
+        }
+
+        // Returns a pointer to the first element of e and its strides,
+        // evaluating e into tmp when its elements are not stored in a
+        // buffer of T.
+        template <class T, class E>
+        inline linalg_operand<T> linalg_data(const E& e, xarray<T>& tmp)
+        {
+            return linalg_data(e, tmp, has_linalg_data<E, T>());
+        }
+
+        // The result of matmul is an xtensor when the ranks of both operands
+        // are known at compile time, an xarray otherwise.
+        template <class E1, class E2, class>
+        struct matmul_result
+        {
+            using type = xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+        };
+
+        template <class E1, class E2>
+        struct matmul_result<E1, E2, std::enable_if_t<is_array<typename E1::shape_type>::value &&
+                                                      is_array<typename E2::shape_type>::value>>
+        {
+            static constexpr std::size_t dim_a = std::tuple_size<typename E1::shape_type>::value;
+            static constexpr std::size_t dim_b = std::tuple_size<typename E2::shape_type>::value;
+            static constexpr std::size_t rank = dim_a == 0 || dim_b == 0 ? 0 :
+                                                dim_a == 1 ? dim_b - 1 :
+                                                dim_b == 1 ? dim_a - 1 :
+                                                (dim_a > dim_b ? dim_a : dim_b);
+            using type = xtensor<std::common_type_t<typename E1::value_type, typename E2::value_type>, rank>;
+        };
+    }
+
+    /******************
+     * matrix product *
+     ******************/
+
+    /**
+     * @brief Matrix product of two expressions.
+     *
+     * Returns the product of \em e1 and \em e2, which must be 1-D or 2-D
+     * expressions. Following NumPy, a 1-D left operand is treated as a row
+     * vector and a 1-D right operand as a column vector; the corresponding
+     * dimension is removed from the result, so that the dot product of
+     * two vectors is a 0-D array.
+     *
+     * Containers and strided views are read in place, other expressions
+     * are evaluated first. The product is computed by a cache-blocked
+     * kernel that runs on several threads for large operands; when
+     * XTENSOR_USE_BLAS is defined, float and double products are forwarded
+     * to the installed BLAS library where the strides allow it.
+     * @param e1 the left operand
+     * @param e2 the right operand
+     * @return an xarray holding the product
+     */
+    template <class E1, class E2>
+    inline auto dot(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> xarray<std::common_type_t<typename E1::value_type, typename E2::value_type>>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        using result_type = xarray<value_type>;
+        const E1& a = e1.derived_cast();
+        const E2& b = e2.derived_cast();
+
+        std::size_t dim_a = a.dimension();
+        std::size_t dim_b = b.dimension();
+        if (dim_a == 0 || dim_a > 2 || dim_b == 0 || dim_b > 2)
+        {
+            throw detail::linalg_error("dot", "operands must be 1-D or 2-D");
+        }
+        std::size_t m = dim_a == 2 ? a.shape()[0] : 1;
+        std::size_t k = a.shape()[dim_a - 1];
+        std::size_t n = dim_b == 2 ? b.shape()[1] : 1;
+        if (b.shape()[0] != k)
+        {
+            throw detail::linalg_error("dot", "shapes not aligned: " + std::to_string(k) +
+                                              " != " + std::to_string(b.shape()[0]));
+        }
+
+        typename result_type::shape_type shape;
+        if (dim_a == 2)
+        {
+            shape.push_back(m);
+        }
+        if (dim_b == 2)
+        {
+            shape.push_back(n);
+        }
+        result_type res(shape, value_type(0));
+
+        xarray<value_type> tmp_a, tmp_b;
+        auto op_a = detail::linalg_data(a, tmp_a);
+        auto op_b = detail::linalg_data(b, tmp_b);
+        std::ptrdiff_t rsa = dim_a == 2 ? op_a.strides[0] : 0;
+        std::ptrdiff_t csb = dim_b == 2 ? op_b.strides[1] : 0;
+        detail::gemm(m, n, k, op_a.data, rsa, op_a.strides[dim_a - 1],
+                     op_b.data, op_b.strides[0], csb,
+                     res.data().data(), static_cast<std::ptrdiff_t>(n), std::ptrdiff_t(1));
+        return res;
+    }
+
+    /**
+     * @brief Matrix product with broadcasting of the leading dimensions.
+     *
+     * Computes the product of \em e1 and \em e2 with the semantics of
+     * NumPy's matmul: the last two dimensions of each operand hold the
+     * matrices, and the leading dimensions are broadcast against each
+     * other and index a stack of products. A 1-D left (resp. right)
+     * operand is promoted to a row (resp. column) vector and the
+     * corresponding dimension is removed from the result.
+     *
+     * Products of 4x4, 8x8 and 16x16 matrices use kernels whose sizes are
+     * known at compile time, and small products are distributed over
+     * several threads. When the ranks of both operands are known at compile
+     * time, the result is an xtensor; it is an xarray otherwise.
+     * @param e1 the left operand
+     * @param e2 the right operand
+     * @return a container holding the products
+     */
+    template <class E1, class E2>
+    inline auto matmul(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> typename detail::matmul_result<E1, E2>::type
+    {
+        using result_type = typename detail::matmul_result<E1, E2>::type;
+        using value_type = typename result_type::value_type;
+        const E1& a = e1.derived_cast();
+        const E2& b = e2.derived_cast();
+
+        std::size_t dim_a = a.dimension();
+        std::size_t dim_b = b.dimension();
+        if (dim_a == 0 || dim_b == 0)
+        {
+            throw detail::linalg_error("matmul", "operands must be at least 1-D");
+        }
+
+        xarray<value_type> tmp_a, tmp_b;
+        auto op_a = detail::linalg_data(a, tmp_a);
+        auto op_b = detail::linalg_data(b, tmp_b);
+
+        // promote vectors to matrices
+        std::vector<std::size_t> shape_a(a.shape().cbegin(), a.shape().cend());
+        std::vector<std::size_t> shape_b(b.shape().cbegin(), b.shape().cend());
+        std::vector<std::ptrdiff_t>& strides_a = op_a.strides;
+        std::vector<std::ptrdiff_t>& strides_b = op_b.strides;
+        if (dim_a == 1)
+        {
+            shape_a.insert(shape_a.begin(), std::size_t(1));
+            strides_a.insert(strides_a.begin(), std::ptrdiff_t(0));
+        }
+        if (dim_b == 1)
+        {
+            shape_b.push_back(std::size_t(1));
+            strides_b.push_back(std::ptrdiff_t(0));
+        }
+        std::size_t m = shape_a[shape_a.size() - 2];
+        std::size_t k = shape_a.back();
+        std::size_t n = shape_b.back();
+        if (shape_b[shape_b.size() - 2] != k)
+        {
+            throw detail::linalg_error("matmul", "shapes not aligned: " + std::to_string(k) +
+                                                 " != " + std::to_string(shape_b[shape_b.size() - 2]));
+        }
+
+        // broadcast the leading dimensions
+        std::size_t lead_a = shape_a.size() - 2;
+        std::size_t lead_b = shape_b.size() - 2;
+        std::size_t batch_dim = std::max(lead_a, lead_b);
+        std::vector<std::size_t> shape(batch_dim, std::size_t(1));
+        std::vector<std::ptrdiff_t> batch_strides_a(batch_dim, std::ptrdiff_t(0));
+        std::vector<std::ptrdiff_t> batch_strides_b(batch_dim, std::ptrdiff_t(0));
+        for (std::size_t d = 0; d < lead_a; ++d)
+        {
+            std::size_t i = batch_dim - lead_a + d;
+            shape[i] = shape_a[d];
+            batch_strides_a[i] = shape_a[d] == 1 ? 0 : strides_a[d];
+        }
+        for (std::size_t d = 0; d < lead_b; ++d)
+        {
+            std::size_t i = batch_dim - lead_b + d;
+            if (shape_b[d] != 1)
+            {
+                if (shape[i] != 1 && shape[i] != shape_b[d])
+                {
+                    throw broadcast_error(a.shape(), b.shape());
+                }
+                shape[i] = shape_b[d];
+                batch_strides_b[i] = strides_b[d];
+            }
+        }
+
+        // offsets of the operands of each product
+        std::size_t nb = compute_size(shape);
+        std::vector<std::ptrdiff_t> offsets_a(nb), offsets_b(nb);
+        std::vector<std::size_t> index(batch_dim, std::size_t(0));
+        std::ptrdiff_t offset_a = 0, offset_b = 0;
+        for (std::size_t i = 0; i < nb; ++i)
+        {
+            offsets_a[i] = offset_a;
+            offsets_b[i] = offset_b;
+            for (std::size_t d = batch_dim; d-- > 0;)
+            {
+                offset_a += batch_strides_a[d];
+                offset_b += batch_strides_b[d];
+                if (++index[d] != shape[d])
+                {
+                    break;
+                }
+                index[d] = 0;
+                offset_a -= batch_strides_a[d] * static_cast<std::ptrdiff_t>(shape[d]);
+                offset_b -= batch_strides_b[d] * static_cast<std::ptrdiff_t>(shape[d]);
+            }
+        }
+
+        if (dim_a != 1)
+        {
+            shape.push_back(m);
+        }
+        if (dim_b != 1)
+        {
+            shape.push_back(n);
+        }
+        result_type res(forward_sequence<typename result_type::shape_type>(shape), value_type(0));
+        detail::gemm_batch(nb, m, n, k,
+                           op_a.data, offsets_a.data(), strides_a[lead_a], strides_a[lead_a + 1],
+                           op_b.data, offsets_b.data(), strides_b[lead_b], strides_b[lead_b + 1],
+                           res.data().data());
+        return res;
+    }
+
+    /***************************
+     * factorization internals *
+     ***************************/
+
+    namespace detail
+    {
+        // Factorizations process panels of linalg_block columns with vector
+        // operations and update the trailing matrix with gemm, which runs on
+        // several threads for large matrices.
+        constexpr std::size_t linalg_block = 32;
+
+        // Matrix of T, possibly const, described by a pointer to its first
+        // element, its shape and its strides.
+        template <class T>
+        struct linalg_matrix
+        {
+            T* data;
+            std::size_t rows;
+            std::size_t cols;
+            std::ptrdiff_t row_stride;
+            std::ptrdiff_t col_stride;
+
+            T& operator()(std::size_t i, std::size_t j) const noexcept
+            {
+                return data[static_cast<std::ptrdiff_t>(i) * row_stride + static_cast<std::ptrdiff_t>(j) * col_stride];
+            }
+
+            linalg_matrix block(std::size_t i, std::size_t j, std::size_t r, std::size_t c) const noexcept
+            {
+                return {&(*this)(i, j), r, c, row_stride, col_stride};
+            }
+
+            linalg_matrix transpose() const noexcept
+            {
+                return {data, cols, rows, col_stride, row_stride};
+            }
+        };
+
+        template <class T>
+        inline linalg_matrix<T> make_linalg_matrix(T* data, std::size_t rows, std::size_t cols) noexcept
+        {
+            return {data, rows, cols, static_cast<std::ptrdiff_t>(cols), std::ptrdiff_t(1)};
+        }
+
+        // Matrix holding the elements of a 2-D container or strided view,
+        // modified in place by the factorizations.
+        template <class E>
+        inline linalg_matrix<typename E::value_type> linalg_inplace_matrix(E& e, const std::string& fn)
+        {
+            using value_type = typename E::value_type;
+            static_assert(has_linalg_data<E, value_type>::value,
+                          "in place factorizations require a container or a strided view");
+            static_assert(std::is_floating_point<value_type>::value,
+                          "in place factorizations require floating point values");
+            if (e.dimension() != 2)
+            {
+                throw linalg_error(fn, "expected a 2-D expression");
+            }
+            return {e.data().data() + linalg_offset(e, is_strided_view<E>()), e.shape()[0], e.shape()[1],
+                    static_cast<std::ptrdiff_t>(e.strides()[0]), static_cast<std::ptrdiff_t>(e.strides()[1])};
+        }
+
+        // Reads a 2-D expression in place when possible.
+        template <class T, class E>
+        inline linalg_matrix<const T> linalg_input_matrix(const E& e, xarray<T>& tmp)
+        {
+            auto op = linalg_data(e, tmp);
+            return {op.data, e.shape()[0], e.shape()[1], op.strides[0], op.strides[1]};
+        }
+
+        template <class E>
+        inline void linalg_check_square(const E& e, const std::string& fn)
+        {
+            if (e.dimension() < 2 || e.shape()[e.dimension() - 1] != e.shape()[e.dimension() - 2])
+            {
+                throw linalg_error(fn, "expected a square matrix");
+            }
+        }
+
+        template <class E>
+        inline void linalg_check_matrix(const E& e, const std::string& fn)
+        {
+            if (e.dimension() != 2)
+            {
+                throw linalg_error(fn, "expected a 2-D expression");
+            }
+        }
+
+        // Right-hand sides are 1-D or 2-D expressions with n rows.
+        template <class E>
+        inline void linalg_check_rhs(const E& b, std::size_t n, const std::string& fn)
+        {
+            if (b.dimension() == 0 || b.dimension() > 2 || b.shape()[0] != n)
+            {
+                throw linalg_error(fn, "right-hand side must be a 1-D or 2-D expression of " +
+                                       std::to_string(n) + " rows");
+            }
+        }
+
+        // Row-major matrix holding the right-hand side stored in res.
+        template <class T>
+        inline linalg_matrix<T> linalg_rhs_matrix(xarray<T>& res)
+        {
+            std::size_t nrhs = res.dimension() == 2 ? res.shape()[1] : 1;
+            return make_linalg_matrix(res.data().data(), res.shape()[0], nrhs);
+        }
+
+        template <class T>
+        inline void linalg_swap_rows(const linalg_matrix<T>& a, std::size_t i, std::size_t j) noexcept
+        {
+            for (std::size_t c = 0; c < a.cols; ++c)
+            {
+                std::swap(a(i, c), a(j, c));
+            }
+        }
+
+        // y += alpha x for n elements, with a unit stride path that the
+        // compiler vectorizes.
+        template <class T>
+        inline void linalg_axpy(std::size_t n, T alpha, const T* x, std::ptrdiff_t incx, T* y, std::ptrdiff_t incy) noexcept
+        {
+            if (incx == 1 && incy == 1)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    y[j] += alpha * x[j];
+                }
+            }
+            else
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    y[static_cast<std::ptrdiff_t>(j) * incy] += alpha * x[static_cast<std::ptrdiff_t>(j) * incx];
+                }
+            }
+        }
+
+        // C -= A * B; A is copied with the opposite sign into buffer since
+        // gemm accumulates the product.
+        template <class TA, class TB, class T>
+        inline void linalg_gemm_sub(const linalg_matrix<TA>& a, const linalg_matrix<TB>& b,
+                                    const linalg_matrix<T>& c, std::vector<T>& buffer)
+        {
+            if (c.rows == 0 || c.cols == 0 || a.cols == 0)
+            {
+                return;
+            }
+            buffer.resize(a.rows * a.cols);
+            for (std::size_t i = 0; i < a.rows; ++i)
+            {
+                for (std::size_t j = 0; j < a.cols; ++j)
+                {
+                    buffer[i * a.cols + j] = -a(i, j);
+                }
+            }
+            gemm(c.rows, c.cols, a.cols, buffer.data(), static_cast<std::ptrdiff_t>(a.cols), std::ptrdiff_t(1),
+                 static_cast<const T*>(b.data), b.row_stride, b.col_stride, c.data, c.row_stride, c.col_stride);
+        }
+
+        // Solves the rows i0 to i0 + ib of the triangular system, the other
+        // rows being already eliminated.
+        template <class TA, class T>
+        inline void linalg_trsm_block(const linalg_matrix<TA>& a, const linalg_matrix<T>& b,
+                                      std::size_t i0, std::size_t ib, bool lower, bool unit)
+        {
+            for (std::size_t s = 0; s < ib; ++s)
+            {
+                std::size_t i = lower ? i0 + s : i0 + ib - 1 - s;
+                std::size_t first = lower ? i0 : i + 1;
+                std::size_t last = lower ? i : i0 + ib;
+                for (std::size_t p = first; p < last; ++p)
+                {
+                    linalg_axpy(b.cols, -a(i, p), &b(p, 0), b.col_stride, &b(i, 0), b.col_stride);
+                }
+                if (!unit)
+                {
+                    const T d = T(1) / a(i, i);
+                    for (std::size_t j = 0; j < b.cols; ++j)
+                    {
+                        b(i, j) *= d;
+                    }
+                }
+            }
+        }
+
+        // Solves A X = B in place of B, A being a lower or upper triangular
+        // matrix. Blocks of rows are solved with row operations and
+        // eliminated from the remaining rows with gemm.
+        template <class TA, class T>
+        inline void linalg_trsm(const linalg_matrix<TA>& a, const linalg_matrix<T>& b, bool lower, bool unit)
+        {
+            std::size_t n = a.rows;
+            std::vector<T> buffer;
+            for (std::size_t s = 0; s < n; s += linalg_block)
+            {
+                std::size_t ib = std::min(linalg_block, n - s);
+                std::size_t i0 = lower ? s : n - s - ib;
+                linalg_trsm_block(a, b, i0, ib, lower, unit);
+                if (lower && i0 + ib < n)
+                {
+                    std::size_t r0 = i0 + ib;
+                    linalg_gemm_sub(a.block(r0, i0, n - r0, ib), b.block(i0, 0, ib, b.cols),
+                                    b.block(r0, 0, n - r0, b.cols), buffer);
+                }
+                else if (!lower && i0 > 0)
+                {
+                    linalg_gemm_sub(a.block(0, i0, i0, ib), b.block(i0, 0, ib, b.cols),
+                                    b.block(0, 0, i0, b.cols), buffer);
+                }
+            }
+        }
+
+        template <class T>
+        inline bool linalg_has_zero_diagonal(const linalg_matrix<T>& a) noexcept
+        {
+            std::size_t k = std::min(a.rows, a.cols);
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                if (a(i, i) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Factors the columns j0 to j0 + jb of the rows j0 to m, swapping
+        // whole rows of a.
+        template <class T>
+        inline void linalg_getrf_panel(const linalg_matrix<T>& a, std::size_t j0, std::size_t jb, std::size_t* piv)
+        {
+            std::size_t m = a.rows;
+            std::size_t end = j0 + jb;
+            for (std::size_t c = j0; c < end; ++c)
+            {
+                std::size_t p = c;
+                T max = std::abs(a(c, c));
+                for (std::size_t i = c + 1; i < m; ++i)
+                {
+                    T v = std::abs(a(i, c));
+                    if (v > max)
+                    {
+                        max = v;
+                        p = i;
+                    }
+                }
+                piv[c] = p;
+                if (p != c)
+                {
+                    linalg_swap_rows(a, c, p);
+                }
+                const T pivot = a(c, c);
+                if (pivot == T(0))
+                {
+                    continue;
+                }
+                const T inv = T(1) / pivot;
+                for (std::size_t i = c + 1; i < m; ++i)
+                {
+                    const T l = a(i, c) *= inv;
+                    linalg_axpy(end - c - 1, -l, &a(c, c) + a.col_stride, a.col_stride, &a(i, c) + a.col_stride, a.col_stride);
+                }
+            }
+        }
+
+        /**
+         * LU factorization with partial pivoting of the m x n matrix a, in
+         * place: a is overwritten by the unit lower triangular factor L and
+         * the upper triangular factor U of P A = L U. Row i was swapped
+         * with row piv[i] at step i. Zero pivots are left in U.
+         */
+        template <class T>
+        inline void linalg_getrf(const linalg_matrix<T>& a, std::size_t* piv)
+        {
+            std::size_t m = a.rows;
+            std::size_t n = a.cols;
+            std::size_t k = std::min(m, n);
+            std::vector<T> buffer;
+            for (std::size_t j0 = 0; j0 < k; j0 += linalg_block)
+            {
+                std::size_t jb = std::min(linalg_block, k - j0);
+                std::size_t j1 = j0 + jb;
+                linalg_getrf_panel(a, j0, jb, piv);
+                if (j1 < n)
+                {
+                    // U12 = L11^-1 A12, A22 -= L21 U12
+                    auto u12 = a.block(j0, j1, jb, n - j1);
+                    linalg_trsm(a.block(j0, j0, jb, jb), u12, true, true);
+                    if (j1 < m)
+                    {
+                        linalg_gemm_sub(a.block(j1, j0, m - j1, jb), u12, a.block(j1, j1, m - j1, n - j1), buffer);
+                    }
+                }
+            }
+        }
+
+        // Solves A X = B in place of B, given the LU factorization of A.
+        template <class TA, class T>
+        inline void linalg_getrs(const linalg_matrix<TA>& lu, const std::size_t* piv, const linalg_matrix<T>& b)
+        {
+            for (std::size_t i = 0; i < lu.rows; ++i)
+            {
+                if (piv[i] != i)
+                {
+                    linalg_swap_rows(b, i, piv[i]);
+                }
+            }
+            linalg_trsm(lu, b, true, true);
+            linalg_trsm(lu, b, false, false);
+        }
+
+        /**
+         * Cholesky factorization A = L L^T of the symmetric positive definite
+         * matrix a, in place: the lower triangle of a is overwritten by L
+         * and its strict upper triangle is set to zero.
+         */
+        template <class T>
+        inline void linalg_potrf(const linalg_matrix<T>& a, const std::string& fn)
+        {
+            std::size_t n = a.rows;
+            std::vector<T> buffer;
+            for (std::size_t j0 = 0; j0 < n; j0 += linalg_block)
+            {
+                std::size_t jb = std::min(linalg_block, n - j0);
+                std::size_t j1 = j0 + jb;
+                for (std::size_t c = j0; c < j1; ++c)
+                {
+                    T d = a(c, c);
+                    if (!(d > T(0)))
+                    {
+                        throw linalg_error(fn, "matrix is not positive definite");
+                    }
+                    d = std::sqrt(d);
+                    a(c, c) = d;
+                    for (std::size_t i = c + 1; i < j1; ++i)
+                    {
+                        a(i, c) /= d;
+                    }
+                    for (std::size_t i = c + 1; i < j1; ++i)
+                    {
+                        const T l = a(i, c);
+                        for (std::size_t q = c + 1; q <= i; ++q)
+                        {
+                            a(i, q) -= l * a(q, c);
+                        }
+                    }
+                }
+                if (j1 == n)
+                {
+                    break;
+                }
+                // A21 = A21 L11^-T
+                for (std::size_t r = j1; r < n; ++r)
+                {
+                    for (std::size_t c = j0; c < j1; ++c)
+                    {
+                        T x = a(r, c);
+                        for (std::size_t p = j0; p < c; ++p)
+                        {
+                            x -= a(r, p) * a(c, p);
+                        }
+                        a(r, c) = x / a(c, c);
+                    }
+                }
+                // lower part of A22 -= A21 A21^T, by blocks of rows
+                auto l21 = a.block(j1, j0, n - j1, jb);
+                for (std::size_t r0 = j1; r0 < n; r0 += linalg_block)
+                {
+                    std::size_t rb = std::min(linalg_block, n - r0);
+                    std::size_t cols = r0 + rb - j1;
+                    linalg_gemm_sub(l21.block(r0 - j1, 0, rb, jb), l21.block(0, 0, cols, jb).transpose(),
+                                    a.block(r0, j1, rb, cols), buffer);
+                }
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = i + 1; j < n; ++j)
+                {
+                    a(i, j) = T(0);
+                }
+            }
+        }
+
+        // Householder reflector H = I - tau v v^T with v[0] = 1, such that
+        // H x is a multiple of e_1. The n elements of x are overwritten by
+        // this multiple followed by v[1:].
+        template <class T>
+        inline T linalg_householder(const linalg_matrix<T>& x)
+        {
+            T norm2 = T(0);
+            for (std::size_t i = 1; i < x.rows; ++i)
+            {
+                norm2 += x(i, 0) * x(i, 0);
+            }
+            if (norm2 == T(0))
+            {
+                return T(0);
+            }
+            const T alpha = x(0, 0);
+            const T beta = -std::copysign(std::sqrt(alpha * alpha + norm2), alpha);
+            const T scale = T(1) / (alpha - beta);
+            for (std::size_t i = 1; i < x.rows; ++i)
+            {
+                x(i, 0) *= scale;
+            }
+            x(0, 0) = beta;
+            return (beta - alpha) / beta;
+        }
+
+        // Block reflector H_j0 ... H_j0+jb-1 = I - V T V^T: v is the
+        // (m - j0) x jb matrix of the reflectors stored below the diagonal
+        // of a, t the jb x jb upper triangular factor.
+        template <class T>
+        inline void linalg_larft(const linalg_matrix<T>& a, const T* tau, std::size_t j0, std::size_t jb,
+                                 std::vector<T>& v, std::vector<T>& t)
+        {
+            std::size_t r = a.rows - j0;
+            v.assign(r * jb, T(0));
+            t.assign(jb * jb, T(0));
+            for (std::size_t i = 0; i < r; ++i)
+            {
+                for (std::size_t p = 0; p < jb && p <= i; ++p)
+                {
+                    v[i * jb + p] = p == i ? T(1) : a(j0 + i, j0 + p);
+                }
+            }
+            std::vector<T> z(jb);
+            for (std::size_t i = 0; i < jb; ++i)
+            {
+                t[i * jb + i] = tau[j0 + i];
+                std::fill(z.begin(), z.begin() + static_cast<std::ptrdiff_t>(i), T(0));
+                for (std::size_t row = i; row < r; ++row)
+                {
+                    const T vi = v[row * jb + i];
+                    for (std::size_t p = 0; p < i; ++p)
+                    {
+                        z[p] += v[row * jb + p] * vi;
+                    }
+                }
+                for (std::size_t p = 0; p < i; ++p)
+                {
+                    T acc = T(0);
+                    for (std::size_t q = p; q < i; ++q)
+                    {
+                        acc += t[p * jb + q] * z[q];
+                    }
+                    t[p * jb + i] = -tau[j0 + i] * acc;
+                }
+            }
+        }
+
+        // C = (I - V T V^T) C, or (I - V T^T V^T) C when transpose is true.
+        template <class T>
+        inline void linalg_larfb(const std::vector<T>& v, const std::vector<T>& t, std::size_t jb,
+                                 const linalg_matrix<T>& c, bool transpose)
+        {
+            std::size_t r = c.rows;
+            std::size_t nc = c.cols;
+            if (nc == 0)
+            {
+                return;
+            }
+            std::ptrdiff_t ld = static_cast<std::ptrdiff_t>(jb);
+            std::ptrdiff_t ldw = static_cast<std::ptrdiff_t>(nc);
+            std::vector<T> w(jb * nc, T(0));
+            std::vector<T> tw(jb * nc, T(0));
+            std::vector<T> buffer;
+            gemm(jb, nc, r, v.data(), std::ptrdiff_t(1), ld, c.data, c.row_stride, c.col_stride,
+                 w.data(), ldw, std::ptrdiff_t(1));
+            gemm(jb, nc, jb, t.data(), transpose ? std::ptrdiff_t(1) : ld, transpose ? ld : std::ptrdiff_t(1),
+                 w.data(), ldw, std::ptrdiff_t(1), tw.data(), ldw, std::ptrdiff_t(1));
+            linalg_gemm_sub(linalg_matrix<const T>{v.data(), r, jb, ld, std::ptrdiff_t(1)},
+                            make_linalg_matrix(tw.data(), jb, nc), c, buffer);
+        }
+
+        /**
+         * Householder QR factorization of the m x n matrix a, in place: R is
+         * stored in the upper triangle of a and the reflectors below the
+         * diagonal, with their factors in tau.
+         */
+        template <class T>
+        inline void linalg_geqrf(const linalg_matrix<T>& a, T* tau)
+        {
+            std::size_t m = a.rows;
+            std::size_t n = a.cols;
+            std::size_t k = std::min(m, n);
+            std::vector<T> w, v, t;
+            for (std::size_t j0 = 0; j0 < k; j0 += linalg_block)
+            {
+                std::size_t jb = std::min(linalg_block, k - j0);
+                std::size_t j1 = j0 + jb;
+                for (std::size_t c = j0; c < j1; ++c)
+                {
+                    tau[c] = linalg_householder(a.block(c, c, m - c, 1));
+                    if (tau[c] == T(0) || c + 1 == j1)
+                    {
+                        continue;
+                    }
+                    // apply H_c to the next columns of the panel
+                    w.assign(j1 - c - 1, T(0));
+                    for (std::size_t q = c + 1; q < j1; ++q)
+                    {
+                        w[q - c - 1] = a(c, q);
+                    }
+                    for (std::size_t i = c + 1; i < m; ++i)
+                    {
+                        linalg_axpy(j1 - c - 1, a(i, c), &a(i, c) + a.col_stride, a.col_stride, w.data(), std::ptrdiff_t(1));
+                    }
+                    for (std::size_t q = c + 1; q < j1; ++q)
+                    {
+                        w[q - c - 1] *= tau[c];
+                        a(c, q) -= w[q - c - 1];
+                    }
+                    for (std::size_t i = c + 1; i < m; ++i)
+                    {
+                        linalg_axpy(j1 - c - 1, -a(i, c), w.data(), std::ptrdiff_t(1), &a(i, c) + a.col_stride, a.col_stride);
+                    }
+                }
+                if (j1 < n)
+                {
+                    linalg_larft(a, tau, j0, jb, v, t);
+                    linalg_larfb(v, t, jb, a.block(j0, j1, m - j0, n - j1), true);
+                }
+            }
+        }
+
+        // Applies Q^T (or Q when transpose is false) of a QR factorization
+        // to the rows of c.
+        template <class T>
+        inline void linalg_ormqr(const linalg_matrix<T>& qr, const T* tau, const linalg_matrix<T>& c, bool transpose)
+        {
+            std::size_t k = std::min(qr.rows, qr.cols);
+            std::size_t nb = (k + linalg_block - 1) / linalg_block;
+            std::vector<T> v, t;
+            for (std::size_t s = 0; s < nb; ++s)
+            {
+                std::size_t j0 = (transpose ? s : nb - 1 - s) * linalg_block;
+                std::size_t jb = std::min(linalg_block, k - j0);
+                linalg_larft(qr, tau, j0, jb, v, t);
+                linalg_larfb(v, t, jb, c.block(j0, 0, qr.rows - j0, c.cols), transpose);
+            }
+        }
+
+        // Offsets of the matrices of a stack whose leading dimensions are the
+        // nlead first ones of shape.
+        template <class S>
+        inline std::vector<std::ptrdiff_t> linalg_stack_offsets(const S& shape, const std::vector<std::ptrdiff_t>& strides,
+                                                                std::size_t nlead)
+        {
+            std::vector<std::ptrdiff_t> res(1, 0);
+            for (std::size_t d = 0; d < nlead; ++d)
+            {
+                std::vector<std::ptrdiff_t> next;
+                next.reserve(res.size() * shape[d]);
+                for (std::ptrdiff_t offset : res)
+                {
+                    for (std::size_t i = 0; i < shape[d]; ++i)
+                    {
+                        next.push_back(offset + static_cast<std::ptrdiff_t>(i) * strides[d]);
+                    }
+                }
+                res.swap(next);
+            }
+            return res;
+        }
+
+        // Calls f(first, last) on blocks of the nb matrices of a stack,
+        // computed by several threads when the total work is large enough.
+        template <class F>
+        inline void linalg_for_each(std::size_t nb, std::size_t work, F&& f)
+        {
+            if (nb == 0)
+            {
+                return;
+            }
+            executor ex = default_executor();
+            std::size_t nb_tasks = std::min(std::min(ex.concurrency(), nb), nb * work / gemm_parallel_threshold + 1);
+            std::size_t block = (nb + nb_tasks - 1) / nb_tasks;
+            parallel_for(ex, (nb + block - 1) / block, [&](std::size_t t) {
+                f(t * block, std::min((t + 1) * block, nb));
+            });
+        }
+
+        // Copies the matrix a to a row-major buffer.
+        template <class T>
+        inline void linalg_copy(const linalg_matrix<const T>& a, T* res)
+        {
+            for (std::size_t i = 0; i < a.rows; ++i)
+            {
+                for (std::size_t j = 0; j < a.cols; ++j)
+                {
+                    *res++ = a(i, j);
+                }
+            }
+        }
+
+        /**
+         * Solves the systems of the stack of n x n matrices a, with one
+         * right-hand side per matrix when vector is true and nrhs of them
+         * otherwise, in place of res. When identity is true, res is
+         * initialized with identity matrices, which computes the inverses.
+         */
+        template <class T, class E>
+        inline void linalg_gesv(const E& a, xarray<T>& res, std::size_t nrhs, bool identity, const std::string& fn)
+        {
+            std::size_t dim = a.dimension();
+            std::size_t n = a.shape()[dim - 1];
+            xarray<T> tmp;
+            auto op = linalg_data(a, tmp);
+            auto offsets = linalg_stack_offsets(a.shape(), op.strides, dim - 2);
+            std::ptrdiff_t rs = op.strides[dim - 2];
+            std::ptrdiff_t cs = op.strides[dim - 1];
+            T* out = res.data().data();
+            auto task = [&](std::size_t first, std::size_t last) {
+                std::vector<T> lu(n * n);
+                std::vector<std::size_t> piv(n);
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    linalg_copy(linalg_matrix<const T>{op.data + offsets[i], n, n, rs, cs}, lu.data());
+                    auto mlu = make_linalg_matrix(lu.data(), n, n);
+                    linalg_getrf(mlu, piv.data());
+                    if (linalg_has_zero_diagonal(mlu))
+                    {
+                        throw linalg_error(fn, "singular matrix");
+                    }
+                    auto b = make_linalg_matrix(out + static_cast<std::ptrdiff_t>(i * n * nrhs), n, nrhs);
+                    if (identity)
+                    {
+                        std::fill(b.data, b.data + static_cast<std::ptrdiff_t>(n * nrhs), T(0));
+                        for (std::size_t j = 0; j < n; ++j)
+                        {
+                            b(j, j) = T(1);
+                        }
+                    }
+                    linalg_getrs(mlu, piv.data(), b);
+                }
+            };
+            linalg_for_each(offsets.size(), n * n * (n + nrhs), task);
+        }
+    }
+
+    /******************
+     * factorizations *
+     ******************/
+
+    namespace linalg
+    {
+        /**
+         * @brief LU factorization with partial pivoting, in place.
+         *
+         * Overwrites the 2-D container or strided view \em a with the factors
+         * of P A = L U: the strict lower triangle holds the unit lower
+         * triangular factor L, the upper triangle the factor U. Row i of \em a
+         * was swapped with the row at index i of the returned pivots at the
+         * i-th step, as in LAPACK's getrf. The factorization is blocked and
+         * its trailing updates are matrix products.
+         * @param a the matrix to factor
+         * @return the row pivots
+         */
+        template <class E>
+        inline std::vector<std::size_t> lu_factor(E& a)
+        {
+            auto m = detail::linalg_inplace_matrix(a, "lu_factor");
+            std::vector<std::size_t> piv(std::min(m.rows, m.cols));
+            detail::linalg_getrf(m, piv.data());
+            return piv;
+        }
+
+        /**
+         * @brief Solves a linear system from the LU factorization of its matrix.
+         *
+         * Solves A x = b given the result of lu_factor for A, so that several
+         * right-hand sides can be solved with a single factorization.
+         * @param lu the factors computed by lu_factor
+         * @param piv the pivots returned by lu_factor
+         * @param b a 1-D or 2-D right-hand side
+         * @return the solution, with the shape of \em b
+         */
+        template <class E1, class E2>
+        inline auto lu_solve(const xexpression<E1>& lu, const std::vector<std::size_t>& piv, const xexpression<E2>& b)
+            -> xarray<detail::linalg_value_t<E1, E2>>
+        {
+            using value_type = detail::linalg_value_t<E1, E2>;
+            const E1& f = lu.derived_cast();
+            detail::linalg_check_matrix(f, "lu_solve");
+            detail::linalg_check_square(f, "lu_solve");
+            std::size_t n = f.shape()[0];
+            if (piv.size() != n)
+            {
+                throw detail::linalg_error("lu_solve", "pivots do not match the factors");
+            }
+            detail::linalg_check_rhs(b.derived_cast(), n, "lu_solve");
+            xarray<value_type> tmp;
+            auto m = detail::linalg_input_matrix(f, tmp);
+            if (detail::linalg_has_zero_diagonal(m))
+            {
+                throw detail::linalg_error("lu_solve", "singular matrix");
+            }
+            xarray<value_type> res = b.derived_cast();
+            detail::linalg_getrs(m, piv.data(), detail::linalg_rhs_matrix(res));
+            return res;
+        }
+
+        /**
+         * @brief LU factorization with partial pivoting.
+         *
+         * Computes the factors of A = P L U for the m x n matrix A, with P a
+         * permutation matrix, L an m x k lower triangular matrix with a unit
+         * diagonal and U a k x n upper triangular matrix, k = min(m, n).
+         * @param e the matrix to factor
+         * @return the tuple (P, L, U)
+         */
+        template <class E>
+        inline auto lu(const xexpression<E>& e) -> std::tuple<xarray<detail::linalg_value_t<E>>,
+                                                              xarray<detail::linalg_value_t<E>>,
+                                                              xarray<detail::linalg_value_t<E>>>
+        {
+            using value_type = detail::linalg_value_t<E>;
+            using result_type = xarray<value_type>;
+            using shape_type = typename result_type::shape_type;
+            detail::linalg_check_matrix(e.derived_cast(), "lu");
+            result_type a = e.derived_cast();
+            std::vector<std::size_t> piv = lu_factor(a);
+            std::size_t m = a.shape()[0];
+            std::size_t n = a.shape()[1];
+            std::size_t k = piv.size();
+
+            std::vector<std::size_t> perm(m);
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                perm[i] = i;
+            }
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                std::swap(perm[i], perm[piv[i]]);
+            }
+            result_type p(shape_type({m, m}), value_type(0));
+            result_type l(shape_type({m, k}), value_type(0));
+            result_type u(shape_type({k, n}), value_type(0));
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                p(perm[i], i) = value_type(1);
+                for (std::size_t j = 0; j < std::min(i, k); ++j)
+                {
+                    l(i, j) = a(i, j);
+                }
+                if (i < k)
+                {
+                    l(i, i) = value_type(1);
+                    for (std::size_t j = i; j < n; ++j)
+                    {
+                        u(i, j) = a(i, j);
+                    }
+                }
+            }
+            return std::make_tuple(std::move(p), std::move(l), std::move(u));
+        }
+
+        /**
+         * @brief Cholesky factorization, in place.
+         *
+         * Overwrites the symmetric positive definite 2-D container or strided
+         * view \em a with the lower triangular factor L of A = L L^T. Only the
+         * lower triangle of \em a is read.
+         * @param a the matrix to factor
+         */
+        template <class E>
+        inline void cho_factor(E& a)
+        {
+            auto m = detail::linalg_inplace_matrix(a, "cho_factor");
+            detail::linalg_check_square(a, "cho_factor");
+            detail::linalg_potrf(m, "cho_factor");
+        }
+
+        /**
+         * @brief Solves a linear system from the Cholesky factor of its matrix.
+         * @param c the lower triangular factor computed by cho_factor or cholesky
+         * @param b a 1-D or 2-D right-hand side
+         * @return the solution, with the shape of \em b
+         */
+        template <class E1, class E2>
+        inline auto cho_solve(const xexpression<E1>& c, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>
+        {
+            using value_type = detail::linalg_value_t<E1, E2>;
+            const E1& f = c.derived_cast();
+            detail::linalg_check_matrix(f, "cho_solve");
+            detail::linalg_check_square(f, "cho_solve");
+            detail::linalg_check_rhs(b.derived_cast(), f.shape()[0], "cho_solve");
+            xarray<value_type> tmp;
+            auto m = detail::linalg_input_matrix(f, tmp);
+            if (detail::linalg_has_zero_diagonal(m))
+            {
+                throw detail::linalg_error("cho_solve", "singular matrix");
+            }
+            xarray<value_type> res = b.derived_cast();
+            auto rhs = detail::linalg_rhs_matrix(res);
+            detail::linalg_trsm(m, rhs, true, false);
+            detail::linalg_trsm(m.transpose(), rhs, false, false);
+            return res;
+        }
+
+        /**
+         * @brief Cholesky factorization.
+         *
+         * Returns the lower triangular matrix L such that A = L L^T. Only the
+         * lower triangle of A is read.
+         * @param e the symmetric positive definite matrix to factor
+         * @return an xarray holding L
+         */
+        template <class E>
+        inline auto cholesky(const xexpression<E>& e) -> xarray<detail::linalg_value_t<E>>
+        {
+            detail::linalg_check_matrix(e.derived_cast(), "cholesky");
+            detail::linalg_check_square(e.derived_cast(), "cholesky");
+            xarray<detail::linalg_value_t<E>> res = e.derived_cast();
+            detail::linalg_potrf(detail::linalg_inplace_matrix(res, "cholesky"), "cholesky");
+            return res;
+        }
+
+        /**
+         * @brief QR factorization.
+         *
+         * Computes the reduced factorization A = Q R of the m x n matrix A,
+         * with Q an m x k matrix with orthonormal columns and R a k x n upper
+         * triangular matrix, k = min(m, n). The factorization uses blocked
+         * Householder reflectors.
+         * @param e the matrix to factor
+         * @return the tuple (Q, R)
+         */
+        template <class E>
+        inline auto qr(const xexpression<E>& e) -> std::tuple<xarray<detail::linalg_value_t<E>>,
+                                                              xarray<detail::linalg_value_t<E>>>
+        {
+            using value_type = detail::linalg_value_t<E>;
+            using result_type = xarray<value_type>;
+            using shape_type = typename result_type::shape_type;
+            detail::linalg_check_matrix(e.derived_cast(), "qr");
+            result_type a = e.derived_cast();
+            std::size_t m = a.shape()[0];
+            std::size_t n = a.shape()[1];
+            std::size_t k = std::min(m, n);
+            auto ma = detail::linalg_inplace_matrix(a, "qr");
+            std::vector<value_type> tau(k);
+            detail::linalg_geqrf(ma, tau.data());
+
+            result_type q(shape_type({m, k}), value_type(0));
+            result_type r(shape_type({k, n}), value_type(0));
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                q(i, i) = value_type(1);
+                for (std::size_t j = i; j < n; ++j)
+                {
+                    r(i, j) = a(i, j);
+                }
+            }
+            detail::linalg_ormqr(ma, tau.data(), detail::linalg_inplace_matrix(q, "qr"), false);
+            return std::make_tuple(std::move(q), std::move(r));
+        }
+
+        /**
+         * @brief Solves a triangular linear system.
+         * @param a the lower or upper triangular square matrix
+         * @param b a 1-D or 2-D right-hand side
+         * @param lower whether \em a is lower triangular; the other triangle
+         * is not read
+         * @return the solution, with the shape of \em b
+         */
+        template <class E1, class E2>
+        inline auto solve_triangular(const xexpression<E1>& a, const xexpression<E2>& b, bool lower)
+            -> xarray<detail::linalg_value_t<E1, E2>>
+        {
+            using value_type = detail::linalg_value_t<E1, E2>;
+            const E1& da = a.derived_cast();
+            detail::linalg_check_matrix(da, "solve_triangular");
+            detail::linalg_check_square(da, "solve_triangular");
+            detail::linalg_check_rhs(b.derived_cast(), da.shape()[0], "solve_triangular");
+            xarray<value_type> tmp;
+            auto m = detail::linalg_input_matrix(da, tmp);
+            if (detail::linalg_has_zero_diagonal(m))
+            {
+                throw detail::linalg_error("solve_triangular", "singular matrix");
+            }
+            xarray<value_type> res = b.derived_cast();
+            detail::linalg_trsm(m, detail::linalg_rhs_matrix(res), lower, false);
+            return res;
+        }
+
+        /**
+         * @brief Solves a linear system.
+         *
+         * Solves A x = b by LU factorization with partial pivoting. As with
+         * numpy.linalg.solve, \em a may be a stack of square matrices, in
+         * which case \em b holds one right-hand side per matrix: a vector
+         * when its dimension is one less than the dimension of \em a, a
+         * matrix of right-hand sides otherwise. The systems of a stack are
+         * solved by several threads.
+         * @param a the square matrix, or stack of square matrices
+         * @param b the right-hand sides
+         * @return the solution, with the shape of \em b
+         */
+        template <class E1, class E2>
+        inline auto solve(const xexpression<E1>& a, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>
+        {
+            using value_type = detail::linalg_value_t<E1, E2>;
+            const E1& da = a.derived_cast();
+            const E2& db = b.derived_cast();
+            detail::linalg_check_square(da, "solve");
+            std::size_t dim = da.dimension();
+            std::size_t n = da.shape()[dim - 1];
+            bool vector = db.dimension() + 1 == dim;
+            if ((!vector && db.dimension() != dim) ||
+                !std::equal(da.shape().cbegin(), da.shape().cend() - 2, db.shape().cbegin()) ||
+                db.shape()[dim - 2] != n)
+            {
+                throw detail::linalg_error("solve", "right-hand side does not match the matrix");
+            }
+            xarray<value_type> res = db;
+            std::size_t nrhs = vector ? 1 : db.shape()[dim - 1];
+            detail::linalg_gesv(da, res, nrhs, false, "solve");
+            return res;
+        }
+
+        /**
+         * @brief Inverse of a matrix.
+         *
+         * \em e may be a stack of square matrices, inverted by several
+         * threads.
+         * @param e the square matrix, or stack of square matrices
+         * @return an xarray holding the inverses
+         */
+        template <class E>
+        inline auto inv(const xexpression<E>& e) -> xarray<detail::linalg_value_t<E>>
+        {
+            using value_type = detail::linalg_value_t<E>;
+            const E& de = e.derived_cast();
+            detail::linalg_check_square(de, "inv");
+            xarray<value_type> res(typename xarray<value_type>::shape_type(de.shape().cbegin(), de.shape().cend()));
+            detail::linalg_gesv(de, res, de.shape()[de.dimension() - 1], true, "inv");
+            return res;
+        }
+
+        /**
+         * @brief Determinant of a matrix.
+         *
+         * Computed as the product of the diagonal of the LU factorization.
+         * @param e the square matrix
+         * @return the determinant
+         */
+        template <class E>
+        inline auto det(const xexpression<E>& e) -> detail::linalg_value_t<E>
+        {
+            using value_type = detail::linalg_value_t<E>;
+            detail::linalg_check_matrix(e.derived_cast(), "det");
+            detail::linalg_check_square(e.derived_cast(), "det");
+            xarray<value_type> a = e.derived_cast();
+            std::vector<std::size_t> piv = lu_factor(a);
+            value_type res = value_type(1);
+            for (std::size_t i = 0; i < piv.size(); ++i)
+            {
+                res *= piv[i] == i ? a(i, i) : -a(i, i);
+            }
+            return res;
+        }
+
+        /**
+         * @brief Least-squares solution of a linear system.
+         *
+         * Returns the x minimizing the euclidean norm of b - A x for the
+         * m x n matrix A of full rank, computed with a QR factorization. When
+         * m < n, the system is underdetermined and the solution of minimum
+         * norm is returned. Unlike numpy.linalg.lstsq, the residuals, rank and
+         * singular values are not computed.
+         * @param a the matrix of the system
+         * @param b a 1-D or 2-D right-hand side
+         * @return the solution, with n rows
+         */
+        template <class E1, class E2>
+        inline auto lstsq(const xexpression<E1>& a, const xexpression<E2>& b) -> xarray<detail::linalg_value_t<E1, E2>>
+        {
+            using value_type = detail::linalg_value_t<E1, E2>;
+            using result_type = xarray<value_type>;
+            const E1& da = a.derived_cast();
+            const E2& db = b.derived_cast();
+            detail::linalg_check_matrix(da, "lstsq");
+            std::size_t m = da.shape()[0];
+            std::size_t n = da.shape()[1];
+            detail::linalg_check_rhs(db, m, "lstsq");
+
+            // factor A, or its transpose when the system is underdetermined
+            bool over = m >= n;
+            std::size_t k = std::min(m, n);
+            result_type tmp;
+            auto ma = detail::linalg_input_matrix(da, tmp);
+            typename result_type::shape_type fshape = {over ? m : n, k};
+            result_type f(fshape);
+            detail::linalg_copy(over ? ma : ma.transpose(), f.data().data());
+            auto mf = detail::linalg_inplace_matrix(f, "lstsq");
+            std::vector<value_type> tau(k);
+            detail::linalg_geqrf(mf, tau.data());
+            auto r = mf.block(0, 0, k, k);
+            if (detail::linalg_has_zero_diagonal(r))
+            {
+                throw detail::linalg_error("lstsq", "matrix does not have full rank");
+            }
+
+            typename result_type::shape_type shape(db.shape().cbegin(), db.shape().cend());
+            shape[0] = n;
+            result_type res(shape, value_type(0));
+            auto x = detail::linalg_rhs_matrix(res);
+            if (over)
+            {
+                // x = R^-1 (Q^T b)[:n]
+                result_type c = db;
+                auto mc = detail::linalg_rhs_matrix(c);
+                detail::linalg_ormqr(mf, tau.data(), mc, true);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = 0; j < x.cols; ++j)
+                    {
+                        x(i, j) = mc(i, j);
+                    }
+                }
+                detail::linalg_trsm(r, x, false, false);
+            }
+            else
+            {
+                // x = Q R^-T b
+                auto y = x.block(0, 0, m, x.cols);
+                auto mb = detail::linalg_rhs_matrix(res);
+                result_type c = db;
+                auto mc = detail::linalg_rhs_matrix(c);
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    for (std::size_t j = 0; j < x.cols; ++j)
+                    {
+                        y(i, j) = mc(i, j);
+                    }
+                }
+                detail::linalg_trsm(r.transpose(), y, true, false);
+                detail::linalg_ormqr(mf, tau.data(), mb, false);
+            }
+            return res;
+        }
+    }
+}
+
+#endif
@@ -59,6 +59,10 @@ namespace xt
     template <class E>
     inline A& noalias_proxy<A>::operator=(const xexpression<E>& e)
     {
+        if (detail::record_assign(m_array, e.derived_cast()))
+        {
+            return m_array;
+        }
         return m_array.assign(e);
     }
 
@@ -0,0 +1,688 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+/**
+ * @brief fused norm and dot product reductions
+ */
+
+#ifndef XNORM_HPP
+#define XNORM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xcost.hpp"
+#include "xexecutor.hpp"
+#include "xlinalg.hpp"
+
+namespace xt
+{
+    namespace detail
+    {
+        template <class T>
+        struct norm_real_type
+        {
+            using type = linalg_float_t<T>;
+        };
+
+        template <class T>
+        struct norm_real_type<std::complex<T>>
+        {
+            using type = T;
+        };
+
+        template <class E>
+        using norm_value_t = typename norm_real_type<typename E::value_type>::type;
+    }
+
+    template <class E>
+    auto norm_l1(const xexpression<E>& e) -> detail::norm_value_t<E>;
+
+    template <class E>
+    auto norm_l1(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>;
+
+    template <class E>
+    auto norm_l2(const xexpression<E>& e) -> detail::norm_value_t<E>;
+
+    template <class E>
+    auto norm_l2(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>;
+
+    template <class E>
+    auto norm_linf(const xexpression<E>& e) -> detail::norm_value_t<E>;
+
+    template <class E>
+    auto norm_linf(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>;
+
+    template <class E>
+    auto sum_of_squares(const xexpression<E>& e) -> detail::norm_value_t<E>;
+
+    template <class E>
+    auto sum_of_squares(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>;
+
+    template <class E1, class E2>
+    auto vdot(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> std::common_type_t<typename E1::value_type, typename E2::value_type>;
+
+    /******************
+     * norm internals *
+     ******************/
+
+    namespace detail
+    {
+        inline std::runtime_error norm_error(const std::string& fn, const std::string& msg)
+        {
+            return std::runtime_error(fn + ": " + msg);
+        }
+
+        // Number of accumulators of the vectorized loops
+        constexpr std::size_t norm_lanes = 16;
+        // Number of elements above which the rows are reduced by several
+        // threads.
+        constexpr std::size_t norm_parallel_threshold = std::size_t(1) << 20;
+
+        // Number of tasks reducing the rows of an input of size elements;
+        // the vectorized loops cost about an operation per element.
+        inline std::size_t norm_task_count(std::size_t rows, std::size_t size, const executor& ex)
+        {
+            execution_plan plan = make_execution_plan(rows, size, norm_parallel_threshold, ex.concurrency());
+            return std::min(plan.nb_tasks, ex.concurrency());
+        }
+
+        template <class R, class V>
+        inline R norm_abs(const V& v, std::false_type) noexcept
+        {
+            return static_cast<R>(v < V(0) ? -v : v);
+        }
+
+        template <class R, class V>
+        inline R norm_abs(const V& v, std::true_type) noexcept
+        {
+            return static_cast<R>(v);
+        }
+
+        template <class R, class V>
+        inline R norm_abs(const V& v) noexcept
+        {
+            return norm_abs<R>(v, std::is_unsigned<V>());
+        }
+
+        template <class R, class T>
+        inline R norm_abs(const std::complex<T>& v) noexcept
+        {
+            return static_cast<R>(std::abs(v));
+        }
+
+        // Absolute values of the elements are multiplied by a scale before
+        // being combined; the scale is one except when norm_l2 rescales
+        // elements whose squares overflow or underflow.
+        struct norm_abs_sum
+        {
+            template <class R, class V>
+            static R map(const V& v, R scale) noexcept
+            {
+                return norm_abs<R>(v) * scale;
+            }
+
+            template <class R>
+            static R combine(R a, R b) noexcept
+            {
+                return a + b;
+            }
+        };
+
+        struct norm_abs_max
+        {
+            template <class R, class V>
+            static R map(const V& v, R scale) noexcept
+            {
+                return norm_abs<R>(v) * scale;
+            }
+
+            // propagates NaNs
+            template <class R>
+            static R combine(R a, R b) noexcept
+            {
+                return (b > a || b != b) ? b : a;
+            }
+        };
+
+        struct norm_square_sum
+        {
+            template <class R, class V>
+            static R map(const V& v, R scale) noexcept
+            {
+                R x = static_cast<R>(v) * scale;
+                return x * x;
+            }
+
+            template <class R, class T>
+            static R map(const std::complex<T>& v, R scale) noexcept
+            {
+                R re = static_cast<R>(v.real()) * scale;
+                R im = static_cast<R>(v.imag()) * scale;
+                return re * re + im * im;
+            }
+
+            template <class R>
+            static R combine(R a, R b) noexcept
+            {
+                return a + b;
+            }
+        };
+
+        // Reduction of n elements with norm_lanes independent accumulators,
+        // which lets the compiler vectorize the loop without reassociating
+        // floating point operations. Zero is the identity of all the
+        // reductions.
+        template <class Op, class R, class V>
+        inline R norm_reduce_row(const V* x, std::size_t n, std::ptrdiff_t inc, R scale) noexcept
+        {
+            R res = R(0);
+            std::size_t i = 0;
+            if (inc == 1 && n >= norm_lanes)
+            {
+                R acc[norm_lanes] = {};
+                for (; i + norm_lanes <= n; i += norm_lanes)
+                {
+                    for (std::size_t k = 0; k < norm_lanes; ++k)
+                    {
+                        acc[k] = Op::combine(acc[k], Op::map(x[i + k], scale));
+                    }
+                }
+                for (std::size_t k = 0; k < norm_lanes; ++k)
+                {
+                    res = Op::combine(res, acc[k]);
+                }
+            }
+            for (; i < n; ++i)
+            {
+                res = Op::combine(res, Op::map(x[static_cast<std::ptrdiff_t>(i) * inc], scale));
+            }
+            return res;
+        }
+
+        // Layout of a reduction: the input is traversed row by row along its
+        // last dimension, and each element is combined into the element of
+        // the result at the offset given by res_strides, whose value is
+        // zero along the reduced axes.
+        struct norm_layout
+        {
+            std::vector<std::size_t> shape;
+            std::vector<std::ptrdiff_t> strides;
+            std::vector<std::ptrdiff_t> res_strides;
+            std::size_t rows;
+        };
+
+        // Combines the rows first to last of the input into res, scale
+        // having the layout of res when it is not null.
+        template <class Op, class R, class V>
+        inline void norm_reduce_rows(const V* data, const norm_layout& l, R* res, const R* scale,
+                                     std::size_t first, std::size_t last)
+        {
+            std::size_t outer = l.shape.size() - 1;
+            std::size_t n = l.shape[outer];
+            std::ptrdiff_t inc = l.strides[outer];
+            std::ptrdiff_t res_inc = l.res_strides[outer];
+            std::vector<std::size_t> index(outer);
+            std::ptrdiff_t offset = 0;
+            std::ptrdiff_t res_offset = 0;
+            std::size_t rem = first;
+            for (std::size_t d = outer; d-- > 0;)
+            {
+                index[d] = rem % l.shape[d];
+                rem /= l.shape[d];
+                offset += static_cast<std::ptrdiff_t>(index[d]) * l.strides[d];
+                res_offset += static_cast<std::ptrdiff_t>(index[d]) * l.res_strides[d];
+            }
+
+            for (std::size_t r = first; r < last; ++r)
+            {
+                const V* x = data + offset;
+                R* out = res + res_offset;
+                if (res_inc == 0)
+                {
+                    R s = scale ? scale[res_offset] : R(1);
+                    *out = Op::combine(*out, norm_reduce_row<Op>(x, n, inc, s));
+                }
+                else
+                {
+                    for (std::size_t j = 0; j < n; ++j)
+                    {
+                        std::ptrdiff_t o = static_cast<std::ptrdiff_t>(j) * res_inc;
+                        R s = scale ? scale[res_offset + o] : R(1);
+                        out[o] = Op::combine(out[o], Op::map(x[static_cast<std::ptrdiff_t>(j) * inc], s));
+                    }
+                }
+                for (std::size_t d = outer; d-- > 0;)
+                {
+                    offset += l.strides[d];
+                    res_offset += l.res_strides[d];
+                    if (++index[d] != l.shape[d])
+                    {
+                        break;
+                    }
+                    index[d] = 0;
+                    offset -= l.strides[d] * static_cast<std::ptrdiff_t>(l.shape[d]);
+                    res_offset -= l.res_strides[d] * static_cast<std::ptrdiff_t>(l.shape[d]);
+                }
+            }
+        }
+
+        /**
+         * Reduces the input into the res_size elements of res, initialized
+         * to zero. Large inputs are split in blocks of rows reduced by
+         * several threads, each one in its own copy of the result when
+         * blocks may share elements of the result.
+         */
+        template <class Op, class R, class V>
+        inline void norm_reduce(const V* data, const norm_layout& l, R* res, std::size_t res_size, const R* scale)
+        {
+            std::size_t size = l.rows * l.shape.back();
+            executor ex = default_executor();
+            std::size_t nb_tasks = norm_task_count(l.rows, size, ex);
+            if (nb_tasks < 2)
+            {
+                norm_reduce_rows<Op>(data, l, res, scale, 0, l.rows);
+                return;
+            }
+
+            // blocks write to disjoint elements when no outer axis is reduced
+            bool shared = std::find(l.res_strides.cbegin(), l.res_strides.cend() - 1, std::ptrdiff_t(0)) !=
+                          l.res_strides.cend() - 1;
+            std::size_t block = (l.rows + nb_tasks - 1) / nb_tasks;
+            std::vector<std::vector<R>> partials(shared ? nb_tasks : 0, std::vector<R>(res_size, R(0)));
+            auto task = [&](std::size_t t) {
+                R* out = shared ? partials[t].data() : res;
+                std::size_t first = t * block;
+                norm_reduce_rows<Op>(data, l, out, scale, first, std::min(first + block, l.rows));
+            };
+            parallel_for(ex, (l.rows + block - 1) / block, task);
+            for (const auto& partial : partials)
+            {
+                for (std::size_t i = 0; i < res_size; ++i)
+                {
+                    res[i] = Op::combine(res[i], partial[i]);
+                }
+            }
+        }
+
+        template <class E>
+        inline std::vector<bool> norm_reduced_axes(const E& e, const std::vector<std::size_t>& axes, const std::string& fn)
+        {
+            std::vector<bool> res(e.dimension(), false);
+            for (std::size_t axis : axes)
+            {
+                if (axis >= e.dimension())
+                {
+                    throw norm_error(fn, "axis " + std::to_string(axis) + " out of range");
+                }
+                if (res[axis])
+                {
+                    throw norm_error(fn, "repeated axis " + std::to_string(axis));
+                }
+                res[axis] = true;
+            }
+            return res;
+        }
+
+        // Layout of the reduction of e along the axes flagged in reduced
+        // into a row-major result of the given strides.
+        template <class E, class S>
+        inline norm_layout make_norm_layout(const E& e, const std::vector<std::ptrdiff_t>& strides,
+                                            const std::vector<bool>& reduced, const S& res_strides)
+        {
+            norm_layout l;
+            l.shape.assign(e.shape().cbegin(), e.shape().cend());
+            l.strides = strides;
+            std::size_t k = 0;
+            for (std::size_t d = 0; d < l.shape.size(); ++d)
+            {
+                l.res_strides.push_back(reduced[d] ? std::ptrdiff_t(0) : static_cast<std::ptrdiff_t>(res_strides[k++]));
+            }
+            if (l.shape.empty())
+            {
+                l.shape.push_back(1);
+                l.strides.push_back(0);
+                l.res_strides.push_back(0);
+            }
+            l.rows = compute_size(l.shape) / std::max(l.shape.back(), std::size_t(1));
+            if (l.shape.back() == 0)
+            {
+                l.rows = 0;
+            }
+            return l;
+        }
+
+        // Reduction of e along the given axes, the result having the shape
+        // of e without these axes. When euclidean is true, Op is the sum of
+        // squares and the result holds the Euclidean norms.
+        template <class Op, class E>
+        inline xarray<norm_value_t<E>> norm_axes(const E& e, const std::vector<std::size_t>& axes, const std::string& fn,
+                                                 bool euclidean = false)
+        {
+            using value_type = typename E::value_type;
+            using real_type = norm_value_t<E>;
+            std::vector<bool> reduced = norm_reduced_axes(e, axes, fn);
+            typename xarray<real_type>::shape_type shape;
+            for (std::size_t d = 0; d < e.dimension(); ++d)
+            {
+                if (!reduced[d])
+                {
+                    shape.push_back(e.shape()[d]);
+                }
+            }
+            xarray<real_type> res(shape, real_type(0));
+            if (e.size() == 0)
+            {
+                return res;
+            }
+            xarray<value_type> tmp;
+            auto op = linalg_data(e, tmp);
+            norm_layout l = make_norm_layout(e, op.strides, reduced, res.strides());
+            real_type* out = res.data().data();
+            std::size_t size = res.size();
+            norm_reduce<Op>(op.data, l, out, size, static_cast<const real_type*>(nullptr));
+            if (!euclidean)
+            {
+                return res;
+            }
+
+            // Euclidean norms. Sums of squares that overflowed or underflowed
+            // are recomputed with the elements of their lane scaled by the
+            // inverse of its largest absolute value.
+            const real_type huge = std::numeric_limits<real_type>::max();
+            const real_type tiny = std::numeric_limits<real_type>::min() / std::numeric_limits<real_type>::epsilon();
+            bool invalid = std::any_of(out, out + size, [huge, tiny](real_type v) {
+                return !(v <= huge) || v < tiny;
+            });
+            if (invalid)
+            {
+                std::vector<real_type> max(size, real_type(0));
+                norm_reduce<norm_abs_max>(op.data, l, max.data(), size, static_cast<const real_type*>(nullptr));
+                std::vector<real_type> scale(size);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    scale[i] = max[i] > real_type(0) && max[i] <= huge ? real_type(1) / max[i] : real_type(1);
+                    out[i] = real_type(0);
+                }
+                norm_reduce<Op>(op.data, l, out, size, static_cast<const real_type*>(scale.data()));
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    out[i] = scale[i] != real_type(1) ? max[i] * std::sqrt(out[i]) : std::sqrt(out[i]);
+                }
+            }
+            else
+            {
+                std::transform(out, out + size, out, [](real_type v) { return std::sqrt(v); });
+            }
+            return res;
+        }
+
+        template <class E>
+        inline std::vector<std::size_t> norm_all_axes(const E& e)
+        {
+            std::vector<std::size_t> res(e.dimension());
+            for (std::size_t d = 0; d < res.size(); ++d)
+            {
+                res[d] = d;
+            }
+            return res;
+        }
+
+        template <class T>
+        inline T vdot_mul(const T& a, const T& b) noexcept
+        {
+            return a * b;
+        }
+
+        // conj(a) * b, without the checks of std::complex multiplication
+        template <class T>
+        inline std::complex<T> vdot_mul(const std::complex<T>& a, const std::complex<T>& b) noexcept
+        {
+            return std::complex<T>(a.real() * b.real() + a.imag() * b.imag(),
+                                   a.real() * b.imag() - a.imag() * b.real());
+        }
+
+        template <class T>
+        inline T vdot_rows(const T* a, const T* b, const norm_layout& la, const norm_layout& lb,
+                           std::size_t first, std::size_t last)
+        {
+            std::size_t outer = la.shape.size() - 1;
+            std::size_t n = la.shape[outer];
+            std::ptrdiff_t inc_a = la.strides[outer];
+            std::ptrdiff_t inc_b = lb.strides[outer];
+            T res = T(0);
+            for (std::size_t r = first; r < last; ++r)
+            {
+                std::ptrdiff_t offset_a = 0;
+                std::ptrdiff_t offset_b = 0;
+                std::size_t rem = r;
+                for (std::size_t d = outer; d-- > 0;)
+                {
+                    std::ptrdiff_t i = static_cast<std::ptrdiff_t>(rem % la.shape[d]);
+                    rem /= la.shape[d];
+                    offset_a += i * la.strides[d];
+                    offset_b += i * lb.strides[d];
+                }
+                const T* x = a + offset_a;
+                const T* y = b + offset_b;
+                std::size_t i = 0;
+                if (inc_a == 1 && inc_b == 1 && n >= norm_lanes)
+                {
+                    T acc[norm_lanes] = {};
+                    for (; i + norm_lanes <= n; i += norm_lanes)
+                    {
+                        for (std::size_t k = 0; k < norm_lanes; ++k)
+                        {
+                            acc[k] += vdot_mul(x[i + k], y[i + k]);
+                        }
+                    }
+                    for (std::size_t k = 0; k < norm_lanes; ++k)
+                    {
+                        res += acc[k];
+                    }
+                }
+                for (; i < n; ++i)
+                {
+                    res += vdot_mul(x[static_cast<std::ptrdiff_t>(i) * inc_a], y[static_cast<std::ptrdiff_t>(i) * inc_b]);
+                }
+            }
+            return res;
+        }
+    }
+
+    /*********
+     * norms *
+     *********/
+
+    /**
+     * @ingroup red_functions
+     * @brief L1 norm of an expression.
+     *
+     * Returns the sum of the absolute values of the elements of \em e,
+     * computed in a single vectorized pass, without building the
+     * intermediate expression of abs. Containers and strided views are read
+     * in place, and large expressions are reduced by several threads.
+     * @param e an \ref xexpression
+     * @return the norm, a real number
+     */
+    template <class E>
+    inline auto norm_l1(const xexpression<E>& e) -> detail::norm_value_t<E>
+    {
+        const E& de = e.derived_cast();
+        return detail::norm_axes<detail::norm_abs_sum>(de, detail::norm_all_axes(de), "norm_l1").data()[0];
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief L1 norms along given axes.
+     * @param e an \ref xexpression
+     * @param axes the axes along which the norms are computed
+     * @return an xarray of the norms, without the reduced axes
+     */
+    template <class E>
+    inline auto norm_l1(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>
+    {
+        return detail::norm_axes<detail::norm_abs_sum>(e.derived_cast(), axes, "norm_l1");
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Euclidean norm of an expression.
+     *
+     * Returns the square root of the sum of the squares of the absolute
+     * values of the elements of \em e. The sum of squares is computed in a
+     * single vectorized pass; when it overflows or underflows, it is
+     * recomputed with elements scaled by the inverse of their largest
+     * absolute value, so that the norm is accurate over the whole range of
+     * the value type.
+     * @param e an \ref xexpression
+     * @return the norm, a real number
+     */
+    template <class E>
+    inline auto norm_l2(const xexpression<E>& e) -> detail::norm_value_t<E>
+    {
+        const E& de = e.derived_cast();
+        return detail::norm_axes<detail::norm_square_sum>(de, detail::norm_all_axes(de), "norm_l2", true).data()[0];
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Euclidean norms along given axes.
+     * @param e an \ref xexpression
+     * @param axes the axes along which the norms are computed
+     * @return an xarray of the norms, without the reduced axes
+     */
+    template <class E>
+    inline auto norm_l2(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>
+    {
+        return detail::norm_axes<detail::norm_square_sum>(e.derived_cast(), axes, "norm_l2", true);
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Infinity norm of an expression.
+     *
+     * Returns the largest absolute value of the elements of \em e, or NaN
+     * if \em e holds a NaN.
+     * @param e an \ref xexpression
+     * @return the norm, a real number
+     */
+    template <class E>
+    inline auto norm_linf(const xexpression<E>& e) -> detail::norm_value_t<E>
+    {
+        const E& de = e.derived_cast();
+        return detail::norm_axes<detail::norm_abs_max>(de, detail::norm_all_axes(de), "norm_linf").data()[0];
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Infinity norms along given axes.
+     * @param e an \ref xexpression
+     * @param axes the axes along which the norms are computed
+     * @return an xarray of the norms, without the reduced axes
+     */
+    template <class E>
+    inline auto norm_linf(const xexpression<E>& e, const std::vector<std::size_t>& axes) -> xarray<detail::norm_value_t<E>>
+    {
+        return detail::norm_axes<detail::norm_abs_max>(e.derived_cast(), axes, "norm_linf");
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Sum of the squares of the absolute values of the elements.
+     *
+     * Fused equivalent of sum(e * e) for real expressions, computed in a
+     * single vectorized pass.
+     * @param e an \ref xexpression
+     * @return the sum, a real number
+     */
+    template <class E>
+    inline auto sum_of_squares(const xexpression<E>& e) -> detail::norm_value_t<E>
+    {
+        const E& de = e.derived_cast();
+        return detail::norm_axes<detail::norm_square_sum>(de, detail::norm_all_axes(de), "sum_of_squares").data()[0];
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Sums of squares along given axes.
+     * @param e an \ref xexpression
+     * @param axes the axes along which the sums are computed
+     * @return an xarray of the sums, without the reduced axes
+     */
+    template <class E>
+    inline auto sum_of_squares(const xexpression<E>& e, const std::vector<std::size_t>& axes)
+        -> xarray<detail::norm_value_t<E>>
+    {
+        return detail::norm_axes<detail::norm_square_sum>(e.derived_cast(), axes, "sum_of_squares");
+    }
+
+    /**
+     * @ingroup red_functions
+     * @brief Dot product of two expressions of the same shape.
+     *
+     * Returns the sum of the products of the elements of \em e1 and
+     * \em e2, the elements of \em e1 being conjugated when they are complex,
+     * like numpy.vdot. The products are accumulated in a single vectorized
+     * pass over the operands, read in place when they are containers or
+     * strided views.
+     * @param e1 the first operand
+     * @param e2 the second operand
+     * @return the dot product
+     */
+    template <class E1, class E2>
+    inline auto vdot(const xexpression<E1>& e1, const xexpression<E2>& e2)
+        -> std::common_type_t<typename E1::value_type, typename E2::value_type>
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        const E1& a = e1.derived_cast();
+        const E2& b = e2.derived_cast();
+        if (a.dimension() != b.dimension() || !std::equal(a.shape().cbegin(), a.shape().cend(), b.shape().cbegin()))
+        {
+            throw detail::norm_error("vdot", "operands must have the same shape");
+        }
+        if (a.size() == 0)
+        {
+            return value_type(0);
+        }
+        xarray<value_type> tmp_a, tmp_b;
+        auto op_a = detail::linalg_data(a, tmp_a);
+        auto op_b = detail::linalg_data(b, tmp_b);
+        std::vector<bool> reduced(a.dimension(), true);
+        std::vector<std::ptrdiff_t> none;
+        detail::norm_layout la = detail::make_norm_layout(a, op_a.strides, reduced, none);
+        detail::norm_layout lb = detail::make_norm_layout(b, op_b.strides, reduced, none);
+
+        std::size_t rows = la.rows;
+        std::size_t size = rows * la.shape.back();
+        executor ex = default_executor();
+        std::size_t nb_tasks = detail::norm_task_count(rows, size, ex);
+        std::size_t block = nb_tasks == 0 ? 1 : (rows + nb_tasks - 1) / nb_tasks;
+        std::vector<value_type> partials((rows + block - 1) / block, value_type(0));
+        parallel_for(ex, partials.size(), [&](std::size_t t) {
+            partials[t] = detail::vdot_rows(op_a.data, op_b.data, la, lb, t * block, std::min((t + 1) * block, rows));
+        });
+        value_type res = value_type(0);
+        for (const auto& partial : partials)
+        {
+            res += partial;
+        }
+        return res;
+    }
+}
+
+#endif
@@ -0,0 +1,862 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XNPY_HPP
+#define XNPY_HPP
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "xarray.hpp"
+#include "xcontainer.hpp"
+#include "xexpression.hpp"
+#include "xstrides.hpp"
+#include "xutils.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define XTENSOR_NPY_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace xt
+{
+
+    /***********************
+     * npy file read/write *
+     ***********************/
+
+    template <class E>
+    void dump_npy(std::ostream& stream, const xexpression<E>& e);
+
+    template <class E>
+    void dump_npy(const std::string& filename, const xexpression<E>& e);
+
+    template <class E>
+    void load_npy(std::istream& stream, E& e);
+
+    template <class E>
+    void load_npy(const std::string& filename, E& e);
+
+    template <class T>
+    xarray<T> load_npy(std::istream& stream);
+
+    template <class T>
+    xarray<T> load_npy(const std::string& filename);
+
+    namespace detail
+    {
+        inline bool is_big_endian() noexcept
+        {
+            const std::uint16_t one = 1;
+            unsigned char first;
+            std::memcpy(&first, &one, 1);
+            return first == 0;
+        }
+
+        template <class T>
+        struct npy_kind
+        {
+            static constexpr char value = std::is_same<T, bool>::value ? 'b' :
+                                          std::is_floating_point<T>::value ? 'f' :
+                                          std::is_signed<T>::value ? 'i' : 'u';
+        };
+
+        template <class T>
+        struct npy_kind<std::complex<T>>
+        {
+            static constexpr char value = 'c';
+        };
+
+        template <class T>
+        inline std::string npy_descr()
+        {
+            static_assert(std::is_arithmetic<T>::value || is_complex<T>::value,
+                          "npy files only hold arithmetic and complex types");
+            char order = sizeof(T) == 1 ? '|' : (is_big_endian() ? '>' : '<');
+            return std::string(1, order) + npy_kind<T>::value + std::to_string(sizeof(T));
+        }
+
+        struct npy_header
+        {
+            char byte_order;
+            char kind;
+            std::size_t word_size;
+            bool fortran_order;
+            std::vector<std::size_t> shape;
+
+            std::size_t size() const
+            {
+                return compute_size(shape);
+            }
+
+            bool swap_bytes() const
+            {
+                return word_size > 1 && ((byte_order == '<' && is_big_endian()) ||
+                                         (byte_order == '>' && !is_big_endian()));
+            }
+
+            // Size of the words whose bytes are swapped: the real and the
+            // imaginary parts of complex numbers are swapped separately.
+            std::size_t swap_size() const
+            {
+                return kind == 'c' ? word_size / 2 : word_size;
+            }
+
+            template <class T>
+            bool holds() const
+            {
+                return kind == npy_kind<T>::value && word_size == sizeof(T);
+            }
+        };
+
+        inline std::runtime_error npy_error(const std::string& msg)
+        {
+            return std::runtime_error("npy: " + msg);
+        }
+
+        // Returns the text following the key in the header dictionary,
+        // with leading blanks and the colon removed.
+        inline std::string npy_value(const std::string& dict, const std::string& key)
+        {
+            std::size_t pos = dict.find("'" + key + "'");
+            if (pos == std::string::npos)
+            {
+                throw npy_error("missing key '" + key + "' in header");
+            }
+            pos = dict.find(':', pos);
+            pos = dict.find_first_not_of(" ", pos + 1);
+            return dict.substr(pos);
+        }
+
+        inline npy_header parse_npy_header(const std::string& dict)
+        {
+            npy_header header;
+
+            std::string descr = npy_value(dict, "descr");
+            std::size_t last = descr.find(descr[0], 1);
+            if (last == std::string::npos || last < 4)
+            {
+                throw npy_error("invalid descr in header");
+            }
+            descr = descr.substr(1, last - 1);
+            header.byte_order = descr[0];
+            header.kind = descr[1];
+            header.word_size = static_cast<std::size_t>(std::stoul(descr.substr(2)));
+
+            header.fortran_order = npy_value(dict, "fortran_order").compare(0, 4, "True") == 0;
+
+            std::string shape = npy_value(dict, "shape");
+            shape = shape.substr(1, shape.find(')') - 1);
+            std::istringstream shape_stream(shape);
+            std::string item;
+            while (std::getline(shape_stream, item, ','))
+            {
+                if (item.find_first_of("0123456789") != std::string::npos)
+                {
+                    header.shape.push_back(static_cast<std::size_t>(std::stoull(item)));
+                }
+            }
+            return header;
+        }
+
+        inline npy_header read_npy_header(std::istream& stream)
+        {
+            char magic[8];
+            stream.read(magic, 8);
+            if (!stream || std::memcmp(magic, "\x93NUMPY", 6) != 0)
+            {
+                throw npy_error("not a npy file");
+            }
+
+            unsigned char len[4] = {0, 0, 0, 0};
+            std::size_t len_size = magic[6] == 1 ? 2 : 4;
+            stream.read(reinterpret_cast<char*>(len), static_cast<std::streamsize>(len_size));
+            std::size_t header_len = std::size_t(len[0]) | std::size_t(len[1]) << 8 |
+                                     std::size_t(len[2]) << 16 | std::size_t(len[3]) << 24;
+
+            std::string dict(header_len, ' ');
+            stream.read(&dict[0], static_cast<std::streamsize>(header_len));
+            if (!stream)
+            {
+                throw npy_error("truncated header");
+            }
+            return parse_npy_header(dict);
+        }
+
+        template <class S>
+        inline void write_npy_header(std::ostream& stream, const std::string& descr, bool fortran_order, const S& shape)
+        {
+            std::string dict = "{'descr': '" + descr + "', 'fortran_order': " +
+                               (fortran_order ? "True" : "False") + ", 'shape': (";
+            for (std::size_t i = 0; i < shape.size(); ++i)
+            {
+                dict += std::to_string(shape[i]) + (shape.size() == 1 ? ",)" : (i + 1 == shape.size() ? ")" : ", "));
+            }
+            dict += shape.size() == 0 ? "), }" : ", }";
+
+            // the data is aligned on 64 bytes; version 2.0 is only used when
+            // the header does not fit a 16-bit length
+            std::size_t len_size = dict.size() + 11 > 65535 ? 4 : 2;
+            std::size_t total = 8 + len_size + dict.size() + 1;
+            dict.append((64 - total % 64) % 64, ' ');
+            dict += '\n';
+
+            std::size_t header_len = dict.size();
+            char preamble[12] = {'\x93', 'N', 'U', 'M', 'P', 'Y', char(len_size == 2 ? 1 : 2), 0};
+            for (std::size_t i = 0; i < len_size; ++i)
+            {
+                preamble[8 + i] = static_cast<char>((header_len >> (8 * i)) & 0xff);
+            }
+            stream.write(preamble, static_cast<std::streamsize>(8 + len_size));
+            stream.write(dict.data(), static_cast<std::streamsize>(dict.size()));
+        }
+
+        // Elements are streamed through a buffer of this many bytes when
+        // they cannot be read or written in place.
+        constexpr std::size_t npy_chunk_size = 1 << 16;
+
+        template <class S, class ST>
+        inline bool is_column_major(const S& shape, const ST& strides)
+        {
+            ST column_major_strides = strides;
+            compute_strides(shape, layout::column_major, column_major_strides);
+            return std::equal(strides.cbegin(), strides.cend(), column_major_strides.cbegin());
+        }
+
+        template <class It>
+        inline void write_npy_elements(std::ostream& stream, It first, std::size_t size)
+        {
+            using value_type = typename std::iterator_traits<It>::value_type;
+            constexpr std::size_t chunk = npy_chunk_size / sizeof(value_type);
+            std::vector<char> buffer(chunk * sizeof(value_type));
+            while (size != 0)
+            {
+                std::size_t n = std::min(size, chunk);
+                for (std::size_t i = 0; i < n; ++i, ++first)
+                {
+                    const value_type v = *first;
+                    std::memcpy(&buffer[i * sizeof(value_type)], &v, sizeof(value_type));
+                }
+                stream.write(buffer.data(), static_cast<std::streamsize>(n * sizeof(value_type)));
+                size -= n;
+            }
+        }
+
+        template <class E>
+        inline void dump_npy_container(std::ostream& stream, const E& e, std::false_type)
+        {
+            using value_type = typename E::value_type;
+            write_npy_header(stream, npy_descr<value_type>(), false, e.shape());
+            write_npy_elements(stream, e.cxbegin(), compute_size(e.shape()));
+        }
+
+        template <class E>
+        inline void dump_npy_container(std::ostream& stream, const E& e, std::true_type)
+        {
+            using value_type = typename E::value_type;
+            bool fortran_order = !e.is_contiguous() && is_column_major(e.shape(), e.strides());
+            if (!e.is_contiguous() && !fortran_order)
+            {
+                dump_npy_container(stream, e, std::false_type());
+                return;
+            }
+            write_npy_header(stream, npy_descr<value_type>(), fortran_order, e.shape());
+            stream.write(reinterpret_cast<const char*>(e.data().data()),
+                         static_cast<std::streamsize>(e.size() * sizeof(value_type)));
+        }
+
+        template <class E>
+        inline void dump_npy_impl(std::ostream& stream, const E& e, std::true_type)
+        {
+            dump_npy_container(stream, e, has_raw_data<typename E::container_type>());
+        }
+
+        template <class E>
+        inline void dump_npy_impl(std::ostream& stream, const E& e, std::false_type)
+        {
+            dump_npy_container(stream, e, std::false_type());
+        }
+
+        // Reverses the byte order of size elements of the dtype of header.
+        inline void swap_npy_bytes(char* first, std::size_t size, const npy_header& header)
+        {
+            std::size_t swap_size = header.swap_size();
+            std::size_t nb_words = size * (header.word_size / swap_size);
+            for (std::size_t i = 0; i < nb_words; ++i, first += swap_size)
+            {
+                std::reverse(first, first + swap_size);
+            }
+        }
+
+        template <class T, class S, bool = is_complex<T>::value, bool = is_complex<S>::value>
+        struct npy_caster
+        {
+            static T cast(const S& s)
+            {
+                return static_cast<T>(s);
+            }
+        };
+
+        template <class T, class S>
+        struct npy_caster<T, S, true, false>
+        {
+            static T cast(const S& s)
+            {
+                return T(static_cast<typename T::value_type>(s));
+            }
+        };
+
+        template <class T, class S>
+        struct npy_caster<T, S, true, true>
+        {
+            static T cast(const S& s)
+            {
+                return T(s);
+            }
+        };
+
+        template <class T, class S>
+        struct npy_caster<T, S, false, true>
+        {
+            static T cast(const S&)
+            {
+                throw npy_error("cannot convert complex data to a real type");
+            }
+        };
+
+        // Reads size elements stored as S in the stream, and writes them
+        // converted to T at d_first.
+        template <class S, class O>
+        inline void read_npy_elements(std::istream& stream, const npy_header& header, O d_first, std::size_t size)
+        {
+            using value_type = typename std::iterator_traits<O>::value_type;
+            constexpr std::size_t chunk = npy_chunk_size / sizeof(S);
+            std::vector<char> buffer(chunk * sizeof(S));
+            bool swap = header.swap_bytes();
+            while (size != 0)
+            {
+                std::size_t n = std::min(size, chunk);
+                stream.read(buffer.data(), static_cast<std::streamsize>(n * sizeof(S)));
+                if (!stream)
+                {
+                    throw npy_error("truncated data");
+                }
+                if (swap)
+                {
+                    swap_npy_bytes(buffer.data(), n, header);
+                }
+                for (std::size_t i = 0; i < n; ++i, ++d_first)
+                {
+                    S s;
+                    std::memcpy(&s, &buffer[i * sizeof(S)], sizeof(S));
+                    *d_first = npy_caster<value_type, S>::cast(s);
+                }
+                size -= n;
+            }
+        }
+
+        template <class O>
+        inline void read_npy_converted(std::istream& stream, const npy_header& header, O d_first, std::size_t size)
+        {
+            std::string dtype = header.kind + std::to_string(header.word_size);
+            if (header.holds<bool>())
+                read_npy_elements<bool>(stream, header, d_first, size);
+            else if (dtype == "i1")
+                read_npy_elements<std::int8_t>(stream, header, d_first, size);
+            else if (dtype == "i2")
+                read_npy_elements<std::int16_t>(stream, header, d_first, size);
+            else if (dtype == "i4")
+                read_npy_elements<std::int32_t>(stream, header, d_first, size);
+            else if (dtype == "i8")
+                read_npy_elements<std::int64_t>(stream, header, d_first, size);
+            else if (dtype == "u1")
+                read_npy_elements<std::uint8_t>(stream, header, d_first, size);
+            else if (dtype == "u2")
+                read_npy_elements<std::uint16_t>(stream, header, d_first, size);
+            else if (dtype == "u4")
+                read_npy_elements<std::uint32_t>(stream, header, d_first, size);
+            else if (dtype == "u8")
+                read_npy_elements<std::uint64_t>(stream, header, d_first, size);
+            else if (header.holds<float>())
+                read_npy_elements<float>(stream, header, d_first, size);
+            else if (header.holds<double>())
+                read_npy_elements<double>(stream, header, d_first, size);
+            else if (header.holds<long double>())
+                read_npy_elements<long double>(stream, header, d_first, size);
+            else if (header.holds<std::complex<float>>())
+                read_npy_elements<std::complex<float>>(stream, header, d_first, size);
+            else if (header.holds<std::complex<double>>())
+                read_npy_elements<std::complex<double>>(stream, header, d_first, size);
+            else
+                throw npy_error("unsupported dtype " + dtype);
+        }
+
+        template <class E>
+        inline void read_npy_data(std::istream& stream, const npy_header& header, E& e, std::true_type)
+        {
+            using value_type = typename E::value_type;
+            if (header.holds<value_type>())
+            {
+                std::size_t size = e.size();
+                stream.read(reinterpret_cast<char*>(e.data().data()),
+                            static_cast<std::streamsize>(size * sizeof(value_type)));
+                if (!stream)
+                {
+                    throw npy_error("truncated data");
+                }
+                if (header.swap_bytes())
+                {
+                    swap_npy_bytes(reinterpret_cast<char*>(e.data().data()), size, header);
+                }
+            }
+            else
+            {
+                read_npy_converted(stream, header, e.data().begin(), e.size());
+            }
+        }
+
+        template <class E>
+        inline void read_npy_data(std::istream& stream, const npy_header& header, E& e, std::false_type)
+        {
+            read_npy_converted(stream, header, e.data().begin(), e.size());
+        }
+
+        inline std::ifstream open_npy(const std::string& filename)
+        {
+            std::ifstream stream(filename, std::ios::in | std::ios::binary);
+            if (!stream)
+            {
+                throw npy_error("cannot open " + filename);
+            }
+            return stream;
+        }
+    }
+
+    /**
+     * @name npy files
+     */
+    //@{
+    /**
+     * Writes an expression to a stream in the npy format. Containers
+     * stored contiguously in row-major or column-major order are written
+     * in one block; other expressions are evaluated and written chunk by
+     * chunk, without building a temporary.
+     * @param stream the output stream, opened in binary mode
+     * @param e the expression to write
+     */
+    template <class E>
+    inline void dump_npy(std::ostream& stream, const xexpression<E>& e)
+    {
+        detail::dump_npy_impl(stream, e.derived_cast(), detail::is_container<E>());
+    }
+
+    /**
+     * Writes an expression to a npy file.
+     * @param filename the name of the file
+     * @param e the expression to write
+     */
+    template <class E>
+    inline void dump_npy(const std::string& filename, const xexpression<E>& e)
+    {
+        std::ofstream stream(filename, std::ios::out | std::ios::binary);
+        if (!stream)
+        {
+            throw detail::npy_error("cannot open " + filename);
+        }
+        dump_npy(stream, e);
+    }
+
+    /**
+     * Reads npy data from a stream into a container, which is reshaped
+     * to the shape and the layout of the data. Data of another dtype
+     * than the value type of the container is converted.
+     * @param stream the input stream, opened in binary mode
+     * @param e the container to read into
+     */
+    template <class E>
+    inline void load_npy(std::istream& stream, E& e)
+    {
+        detail::npy_header header = detail::read_npy_header(stream);
+        using shape_type = typename E::shape_type;
+        shape_type shape = make_sequence<shape_type>(header.shape.size(), 0);
+        if (shape.size() != header.shape.size())
+        {
+            throw detail::npy_error("dimension mismatch, the file holds an array of dimension " +
+                                    std::to_string(header.shape.size()));
+        }
+        std::copy(header.shape.cbegin(), header.shape.cend(), shape.begin());
+        e.reshape(shape, header.fortran_order ? layout::column_major : layout::row_major);
+        detail::read_npy_data(stream, header, e, detail::has_raw_data<typename E::container_type>());
+    }
+
+    /**
+     * Reads a npy file into a container.
+     * @param filename the name of the file
+     * @param e the container to read into
+     */
+    template <class E>
+    inline void load_npy(const std::string& filename, E& e)
+    {
+        std::ifstream stream = detail::open_npy(filename);
+        load_npy(stream, e);
+    }
+
+    /**
+     * Reads npy data from a stream and returns it as an xarray.
+     * @tparam T the value type of the returned array
+     * @param stream the input stream, opened in binary mode
+     */
+    template <class T>
+    inline xarray<T> load_npy(std::istream& stream)
+    {
+        xarray<T> res;
+        load_npy(stream, res);
+        return res;
+    }
+
+    /**
+     * Reads a npy file and returns it as an xarray.
+     * @tparam T the value type of the returned array
+     * @param filename the name of the file
+     */
+    template <class T>
+    inline xarray<T> load_npy(const std::string& filename)
+    {
+        xarray<T> res;
+        load_npy(filename, res);
+        return res;
+    }
+    //@}
+
+    /****************************
+     * xnpy_mapping declaration *
+     ****************************/
+
+    namespace detail
+    {
+        // Read-only memory mapping of a whole file. Platforms without
+        // mmap read the file into memory instead.
+        class npy_file_mapping
+        {
+
+        public:
+
+            explicit npy_file_mapping(const std::string& filename);
+            ~npy_file_mapping();
+
+            npy_file_mapping(const npy_file_mapping&) = delete;
+            npy_file_mapping& operator=(const npy_file_mapping&) = delete;
+
+            char* data() noexcept;
+            std::size_t size() const noexcept;
+
+        private:
+
+            char* p_data;
+            std::size_t m_size;
+#ifndef XTENSOR_NPY_MMAP
+            std::vector<char> m_buffer;
+#endif
+        };
+
+        // Container interface over the elements of a mapped file, as
+        // required by xarray_adaptor. It cannot be resized.
+        template <class T>
+        class npy_buffer
+        {
+
+        public:
+
+            using value_type = T;
+            using reference = T&;
+            using const_reference = const T&;
+            using pointer = T*;
+            using const_pointer = const T*;
+            using size_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator = pointer;
+            using const_iterator = const_pointer;
+
+            npy_buffer(std::shared_ptr<npy_file_mapping> mapping, std::size_t offset, size_type size);
+
+            size_type size() const noexcept;
+            void resize(size_type size);
+
+            reference operator[](size_type i);
+            const_reference operator[](size_type i) const;
+
+            pointer data() noexcept;
+            const_pointer data() const noexcept;
+
+            iterator begin() noexcept;
+            iterator end() noexcept;
+            const_iterator begin() const noexcept;
+            const_iterator end() const noexcept;
+            const_iterator cbegin() const noexcept;
+            const_iterator cend() const noexcept;
+
+        private:
+
+            std::shared_ptr<npy_file_mapping> p_mapping;
+            pointer p_data;
+            size_type m_size;
+        };
+    }
+
+    /**
+     * @class xnpy_mapping
+     * @brief Memory-mapped npy file.
+     *
+     * The xnpy_mapping class maps a npy file in memory and gives access
+     * to its elements through an xarray_adaptor, without copying them.
+     * The mapping is private: modifications made through the adaptor are
+     * not written back to the file. The dtype of the file must be \c T,
+     * in the native byte order.
+     *
+     * @tparam T the value type of the elements in the file
+     */
+    template <class T>
+    class xnpy_mapping
+    {
+
+    public:
+
+        using buffer_type = detail::npy_buffer<T>;
+        using adaptor_type = xarray_adaptor<buffer_type>;
+
+        explicit xnpy_mapping(const std::string& filename);
+
+        xnpy_mapping(const xnpy_mapping&) = delete;
+        xnpy_mapping& operator=(const xnpy_mapping&) = delete;
+
+        adaptor_type& adaptor() noexcept;
+        const adaptor_type& adaptor() const noexcept;
+
+    private:
+
+        using shape_type = typename adaptor_type::shape_type;
+
+        buffer_type make_buffer(const std::string& filename);
+
+        shape_type m_shape;
+        layout m_layout;
+        buffer_type m_buffer;
+        adaptor_type m_adaptor;
+    };
+
+    /***********************************
+     * npy_file_mapping implementation *
+     ***********************************/
+
+    namespace detail
+    {
+#ifdef XTENSOR_NPY_MMAP
+        inline npy_file_mapping::npy_file_mapping(const std::string& filename)
+            : p_data(nullptr), m_size(0)
+        {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd == -1)
+            {
+                throw npy_error("cannot open " + filename);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) == -1)
+            {
+                ::close(fd);
+                throw npy_error("cannot stat " + filename);
+            }
+            m_size = static_cast<std::size_t>(st.st_size);
+            void* addr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED)
+            {
+                throw npy_error("cannot map " + filename);
+            }
+            p_data = static_cast<char*>(addr);
+        }
+
+        inline npy_file_mapping::~npy_file_mapping()
+        {
+            ::munmap(p_data, m_size);
+        }
+#else
+        inline npy_file_mapping::npy_file_mapping(const std::string& filename)
+        {
+            std::ifstream stream = open_npy(filename);
+            m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            p_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+
+        inline npy_file_mapping::~npy_file_mapping()
+        {
+        }
+#endif
+
+        inline char* npy_file_mapping::data() noexcept
+        {
+            return p_data;
+        }
+
+        inline std::size_t npy_file_mapping::size() const noexcept
+        {
+            return m_size;
+        }
+
+        template <class T>
+        inline npy_buffer<T>::npy_buffer(std::shared_ptr<npy_file_mapping> mapping, std::size_t offset, size_type size)
+            : p_mapping(std::move(mapping)), p_data(reinterpret_cast<pointer>(p_mapping->data() + offset)), m_size(size)
+        {
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::size() const noexcept -> size_type
+        {
+            return m_size;
+        }
+
+        template <class T>
+        inline void npy_buffer<T>::resize(size_type size)
+        {
+            if (size != m_size)
+            {
+                throw npy_error("a mapped buffer cannot be resized");
+            }
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::operator[](size_type i) -> reference
+        {
+            return p_data[i];
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::operator[](size_type i) const -> const_reference
+        {
+            return p_data[i];
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::data() noexcept -> pointer
+        {
+            return p_data;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::data() const noexcept -> const_pointer
+        {
+            return p_data;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::begin() noexcept -> iterator
+        {
+            return p_data;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::end() noexcept -> iterator
+        {
+            return p_data + m_size;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::begin() const noexcept -> const_iterator
+        {
+            return p_data;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::end() const noexcept -> const_iterator
+        {
+            return p_data + m_size;
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::cbegin() const noexcept -> const_iterator
+        {
+            return begin();
+        }
+
+        template <class T>
+        inline auto npy_buffer<T>::cend() const noexcept -> const_iterator
+        {
+            return end();
+        }
+    }
+
+    /*******************************
+     * xnpy_mapping implementation *
+     *******************************/
+
+    /**
+     * Maps the specified npy file in memory.
+     * @param filename the name of the file
+     */
+    template <class T>
+    inline xnpy_mapping<T>::xnpy_mapping(const std::string& filename)
+        : m_shape(), m_layout(layout::row_major), m_buffer(make_buffer(filename)),
+          m_adaptor(m_buffer, m_shape, m_layout)
+    {
+    }
+
+    /**
+     * Returns an adaptor on the elements of the mapped file.
+     */
+    template <class T>
+    inline auto xnpy_mapping<T>::adaptor() noexcept -> adaptor_type&
+    {
+        return m_adaptor;
+    }
+
+    /**
+     * Returns a constant adaptor on the elements of the mapped file.
+     */
+    template <class T>
+    inline auto xnpy_mapping<T>::adaptor() const noexcept -> const adaptor_type&
+    {
+        return m_adaptor;
+    }
+
+    template <class T>
+    inline auto xnpy_mapping<T>::make_buffer(const std::string& filename) -> buffer_type
+    {
+        std::ifstream stream = detail::open_npy(filename);
+        detail::npy_header header = detail::read_npy_header(stream);
+        if (!header.holds<T>() || header.swap_bytes())
+        {
+            throw detail::npy_error("the data of " + filename + " cannot be mapped as " + detail::npy_descr<T>());
+        }
+        std::size_t offset = static_cast<std::size_t>(stream.tellg());
+        m_shape.assign(header.shape.cbegin(), header.shape.cend());
+        m_layout = header.fortran_order ? layout::column_major : layout::row_major;
+
+        auto mapping = std::make_shared<detail::npy_file_mapping>(filename);
+        if (mapping->size() < offset + header.size() * sizeof(T))
+        {
+            throw detail::npy_error("truncated data in " + filename);
+        }
+        return buffer_type(std::move(mapping), offset, header.size());
+    }
+}
+
+#endif
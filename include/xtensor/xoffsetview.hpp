@@ -343,6 +343,10 @@ namespace xt
     template <class E>
     inline auto xoffsetview<CT, M, I>::operator=(const E& e) -> disable_xexpression<E, self_type>&
     {
+        if (detail::record_assign(*this, xscalar<E>(e)))
+        {
+            return *this;
+        }
         std::fill(begin(), end(), e);
         return *this;
     }
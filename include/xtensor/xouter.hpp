@@ -0,0 +1,742 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XOUTER_HPP
+#define XOUTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xexecutor.hpp"
+#include "xexpression.hpp"
+#include "xfunction.hpp"
+#include "xiterable.hpp"
+#include "xstrides.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+
+    /***************
+     * outer, kron *
+     ***************/
+
+    template <class E1, class E2>
+    auto outer(E1&& e1, E2&& e2) noexcept;
+
+    template <class E1, class E2>
+    auto kron(E1&& e1, E2&& e2) noexcept;
+
+    /**********
+     * xouter *
+     **********/
+
+    template <class CT1, class CT2>
+    class xouter;
+
+    template <class CT1, class CT2>
+    class xouter_stepper;
+
+    template <class CT1, class CT2>
+    struct xiterable_inner_types<xouter<CT1, CT2>>
+    {
+        using inner_shape_type = std::vector<std::size_t>;
+        using const_stepper = xouter_stepper<CT1, CT2>;
+        using stepper = const_stepper;
+        using const_broadcast_iterator = xiterator<const_stepper, inner_shape_type*>;
+        using broadcast_iterator = const_broadcast_iterator;
+        using const_iterator = const_broadcast_iterator;
+        using iterator = const_iterator;
+    };
+
+    /**
+     * @class xouter
+     * @brief Outer product of two expressions.
+     *
+     * The xouter class implements the product of each element of a first
+     * expression with each element of a second one. Each dimension of the
+     * result spans a dimension of the first expression, a dimension of the
+     * second one, or both: in the latter case, its index \c i maps to the
+     * index <tt>i / n</tt> in the first expression and <tt>i % n</tt> in the
+     * second one, \c n being the extent of the second expression along this
+     * dimension. Its stepper steps the steppers of both expressions, which
+     * are never broadcast to the shape of the result. xouter is not meant to
+     * be used directly, but only with the \ref outer and \ref kron helper
+     * functions.
+     *
+     * @tparam CT1 the closure type of the first expression
+     * @tparam CT2 the closure type of the second expression
+     *
+     * @sa outer, kron
+     */
+    template <class CT1, class CT2>
+    class xouter : public xexpression<xouter<CT1, CT2>>,
+                   public xexpression_const_iterable<xouter<CT1, CT2>>
+    {
+
+    public:
+
+        using self_type = xouter<CT1, CT2>;
+        using first_expression_type = std::decay_t<CT1>;
+        using second_expression_type = std::decay_t<CT2>;
+
+        using value_type = detail::common_value_type_t<first_expression_type, second_expression_type>;
+        using reference = value_type;
+        using const_reference = value_type;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using iterable_base = xexpression_const_iterable<self_type>;
+        using inner_shape_type = typename iterable_base::inner_shape_type;
+        using shape_type = inner_shape_type;
+
+        using stepper = typename iterable_base::stepper;
+        using const_stepper = typename iterable_base::const_stepper;
+
+        using broadcast_iterator = typename iterable_base::broadcast_iterator;
+        using const_broadcast_iterator = typename iterable_base::const_broadcast_iterator;
+
+        using iterator = typename iterable_base::iterator;
+        using const_iterator = typename iterable_base::const_iterator;
+
+        xouter(CT1 e1, CT2 e2, size_type dim, size_type first_begin, size_type second_begin) noexcept;
+
+        size_type size() const noexcept;
+        size_type dimension() const noexcept;
+        const inner_shape_type& shape() const noexcept;
+
+        template <class... Args>
+        const_reference operator()(Args... args) const;
+        const_reference operator[](const xindex& index) const;
+        const_reference operator[](size_type i) const;
+
+        template <class It>
+        const_reference element(It first, It last) const;
+
+        template <class S>
+        bool broadcast_shape(S& shape) const;
+
+        template <class S>
+        bool is_trivial_broadcast(const S& strides) const noexcept;
+
+        template <class S>
+        const_stepper stepper_begin(const S& shape) const noexcept;
+        template <class S>
+        const_stepper stepper_end(const S& shape) const noexcept;
+
+        template <class E>
+        void assign_to(E& e) const;
+
+    private:
+
+        bool in_first(size_type dim) const noexcept;
+        bool in_second(size_type dim) const noexcept;
+        size_type second_extent(size_type dim) const noexcept;
+
+        template <class V, class O>
+        void assign_rows(const V* a, const std::vector<size_type>& a_strides,
+                         const V* b, const std::vector<size_type>& b_strides,
+                         O* out, size_type first_row, size_type last_row) const;
+
+        CT1 m_e1;
+        CT2 m_e2;
+        size_type m_first_begin;
+        size_type m_second_begin;
+        size_type m_first_dim;
+        size_type m_second_dim;
+        inner_shape_type m_shape;
+        inner_shape_type m_second_extent;
+
+        friend class xouter_stepper<CT1, CT2>;
+    };
+
+    /******************
+     * xouter_stepper *
+     ******************/
+
+    template <class CT1, class CT2>
+    class xouter_stepper
+    {
+
+    public:
+
+        using self_type = xouter_stepper<CT1, CT2>;
+        using xouter_type = xouter<CT1, CT2>;
+
+        using value_type = typename xouter_type::value_type;
+        using reference = typename xouter_type::const_reference;
+        using pointer = typename xouter_type::const_pointer;
+        using size_type = typename xouter_type::size_type;
+        using difference_type = typename xouter_type::difference_type;
+        using shape_type = typename xouter_type::shape_type;
+
+        using first_stepper = typename std::decay_t<CT1>::const_stepper;
+        using second_stepper = typename std::decay_t<CT2>::const_stepper;
+
+        xouter_stepper() = default;
+        xouter_stepper(const xouter_type* e, first_stepper s1, second_stepper s2, size_type offset);
+
+        reference operator*() const;
+
+        void step(size_type dim, size_type n = 1);
+        void step_back(size_type dim, size_type n = 1);
+        void reset(size_type dim);
+
+        void to_end();
+
+        bool equal(const self_type& rhs) const;
+
+    private:
+
+        const xouter_type* p_e;
+        first_stepper m_s1;
+        second_stepper m_s2;
+        size_type m_offset;
+        // position in the second expression along the dimensions shared by
+        // both expressions
+        std::vector<size_type> m_index;
+    };
+
+    template <class CT1, class CT2>
+    bool operator==(const xouter_stepper<CT1, CT2>& lhs,
+                    const xouter_stepper<CT1, CT2>& rhs);
+
+    template <class CT1, class CT2>
+    bool operator!=(const xouter_stepper<CT1, CT2>& lhs,
+                    const xouter_stepper<CT1, CT2>& rhs);
+
+    /******************************
+     * outer, kron implementation *
+     ******************************/
+
+    /**
+     * @brief Returns the outer product of two expressions.
+     *
+     * The shape of the result is the concatenation of the shapes of \p e1
+     * and \p e2, and <tt>outer(e1, e2)(i..., j...)</tt> is
+     * <tt>e1(i...) * e2(j...)</tt>, as with \c numpy.multiply.outer. For
+     * 1-D expressions, this is \c numpy.outer. The result is lazy: its
+     * elements are computed when they are accessed, or when it is assigned
+     * to a container, in which case the rows of the result are written as
+     * rows of \p e2 scaled by an element of \p e1.
+     *
+     * The returned expression either holds a const reference to \p e1 and
+     * \p e2 or a copy, depending on whether they are lvalues or rvalues.
+     */
+    template <class E1, class E2>
+    inline auto outer(E1&& e1, E2&& e2) noexcept
+    {
+        using outer_type = xouter<const_xclosure_t<E1>, const_xclosure_t<E2>>;
+        std::size_t dim1 = e1.dimension();
+        std::size_t dim2 = e2.dimension();
+        return outer_type(std::forward<E1>(e1), std::forward<E2>(e2), dim1 + dim2, 0, dim1);
+    }
+
+    /**
+     * @brief Returns the Kronecker product of two expressions.
+     *
+     * The expression of lower dimension is prepended with dimensions of
+     * extent 1, and the result is made of blocks with the shape of \p e2,
+     * each one being \p e2 scaled by an element of \p e1, as with
+     * \c numpy.kron. The result is lazy: its elements are computed when
+     * they are accessed, or when it is assigned to a container, in which
+     * case the rows of the blocks are written as scaled rows of \p e2.
+     *
+     * The returned expression either holds a const reference to \p e1 and
+     * \p e2 or a copy, depending on whether they are lvalues or rvalues.
+     */
+    template <class E1, class E2>
+    inline auto kron(E1&& e1, E2&& e2) noexcept
+    {
+        using kron_type = xouter<const_xclosure_t<E1>, const_xclosure_t<E2>>;
+        std::size_t dim1 = e1.dimension();
+        std::size_t dim2 = e2.dimension();
+        std::size_t dim = std::max(dim1, dim2);
+        return kron_type(std::forward<E1>(e1), std::forward<E2>(e2), dim, dim - dim1, dim - dim2);
+    }
+
+    namespace detail
+    {
+        constexpr std::size_t outer_parallel_threshold = std::size_t(1) << 20;
+
+        template <class S>
+        inline std::vector<std::size_t> outer_row_major_strides(const S& shape)
+        {
+            std::vector<std::size_t> res(shape.size(), std::size_t(1));
+            for (std::size_t i = shape.size(); i > 1; --i)
+            {
+                res[i - 2] = res[i - 1] * shape[i - 1];
+            }
+            return res;
+        }
+    }
+
+    /*************************
+     * xouter implementation *
+     *************************/
+
+    /**
+     * @name Constructor
+     */
+    //@{
+    /**
+     * Constructs the product of the specified expressions.
+     * @param e1 the first expression
+     * @param e2 the second expression
+     * @param dim the number of dimensions of the product
+     * @param first_begin the dimension of the product matching the first
+     * dimension of \p e1
+     * @param second_begin the dimension of the product matching the first
+     * dimension of \p e2
+     */
+    template <class CT1, class CT2>
+    inline xouter<CT1, CT2>::xouter(CT1 e1, CT2 e2, size_type dim, size_type first_begin, size_type second_begin) noexcept
+        : m_e1(e1), m_e2(e2), m_first_begin(first_begin), m_second_begin(second_begin),
+          m_first_dim(m_e1.dimension()), m_second_dim(m_e2.dimension()),
+          m_shape(dim, size_type(1)), m_second_extent(dim, size_type(1))
+    {
+        for (size_type d = 0; d < dim; ++d)
+        {
+            if (in_second(d))
+            {
+                m_second_extent[d] = m_e2.shape()[d - m_second_begin];
+            }
+            m_shape[d] = m_second_extent[d] * (in_first(d) ? m_e1.shape()[d - m_first_begin] : size_type(1));
+        }
+    }
+    //@}
+
+    /**
+     * @name Size and shape
+     */
+    //@{
+    /**
+     * Returns the size of the expression.
+     */
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::size() const noexcept -> size_type
+    {
+        return compute_size(shape());
+    }
+
+    /**
+     * Returns the number of dimensions of the expression.
+     */
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::dimension() const noexcept -> size_type
+    {
+        return m_shape.size();
+    }
+
+    /**
+     * Returns the shape of the expression.
+     */
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::shape() const noexcept -> const inner_shape_type&
+    {
+        return m_shape;
+    }
+    //@}
+
+    /**
+     * @name Data
+     */
+    //@{
+    /**
+     * Returns the element at the specified position in the expression.
+     * @param args a list of indices specifying the position in the expression. Indices
+     * must be unsigned integers, the number of indices should be equal or greater than
+     * the number of dimensions of the expression.
+     */
+    template <class CT1, class CT2>
+    template <class... Args>
+    inline auto xouter<CT1, CT2>::operator()(Args... args) const -> const_reference
+    {
+        std::array<size_type, sizeof...(Args)> index = {{static_cast<size_type>(args)...}};
+        return element(index.cbegin(), index.cend());
+    }
+
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::operator[](const xindex& index) const -> const_reference
+    {
+        return element(index.cbegin(), index.cend());
+    }
+
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::operator[](size_type i) const -> const_reference
+    {
+        return operator()(i);
+    }
+
+    /**
+     * Returns the element at the specified position in the expression.
+     * @param first iterator starting the sequence of indices
+     * @param last iterator ending the sequence of indices
+     * The number of indices in the sequence should be equal to or greater
+     * than the number of dimensions of the expression.
+     */
+    template <class CT1, class CT2>
+    template <class It>
+    inline auto xouter<CT1, CT2>::element(It, It last) const -> const_reference
+    {
+        It first = last;
+        first -= dimension();
+        xindex index1(m_first_dim);
+        xindex index2(m_second_dim);
+        for (size_type d = 0; d < dimension(); ++d, ++first)
+        {
+            size_type i = static_cast<size_type>(*first);
+            if (in_second(d))
+            {
+                index2[d - m_second_begin] = i % second_extent(d);
+                i /= second_extent(d);
+            }
+            if (in_first(d))
+            {
+                index1[d - m_first_begin] = i;
+            }
+        }
+        return value_type(m_e1.element(index1.cbegin(), index1.cend())) *
+               value_type(m_e2.element(index2.cbegin(), index2.cend()));
+    }
+
+    /**
+     * Writes the product into the buffer of the row-major contiguous
+     * container \c e, which must have the shape of the expression. The
+     * operands are evaluated once, then each row of the result is written
+     * as a row of the second operand scaled by an element of the first one.
+     * Large products are split in blocks of rows written by several threads.
+     * @param e the container to fill
+     */
+    template <class CT1, class CT2>
+    template <class E>
+    inline void xouter<CT1, CT2>::assign_to(E& e) const
+    {
+        if (e.size() == 0)
+        {
+            return;
+        }
+        std::vector<value_type> a(m_e1.size());
+        std::vector<value_type> b(m_e2.size());
+        std::copy(m_e1.cbegin(), m_e1.cend(), a.begin());
+        std::copy(m_e2.cbegin(), m_e2.cend(), b.begin());
+        std::vector<size_type> a_strides = detail::outer_row_major_strides(m_e1.shape());
+        std::vector<size_type> b_strides = detail::outer_row_major_strides(m_e2.shape());
+        auto* out = e.data().data();
+
+        size_type size = e.size();
+        size_type rows = dimension() == 0 || m_shape.back() == 0 ? size_type(1) : size / m_shape.back();
+        executor ex = default_executor();
+        size_type nb_tasks = std::min(std::min(ex.concurrency(), rows), size / detail::outer_parallel_threshold + 1);
+        size_type block = (rows + nb_tasks - 1) / nb_tasks;
+        parallel_for(ex, (rows + block - 1) / block, [&](size_type t) {
+            assign_rows(a.data(), a_strides, b.data(), b_strides, out, t * block, std::min((t + 1) * block, rows));
+        });
+    }
+    //@}
+
+    /**
+     * @name Broadcasting
+     */
+    //@{
+    /**
+     * Broadcast the shape of the expression to the specified parameter.
+     * @param shape the result shape
+     * @return a boolean indicating whether the broadcasting is trivial
+     */
+    template <class CT1, class CT2>
+    template <class S>
+    inline bool xouter<CT1, CT2>::broadcast_shape(S& shape) const
+    {
+        return xt::broadcast_shape(m_shape, shape);
+    }
+
+    /**
+     * Compares the specified strides with those of the container to see whether
+     * the broadcasting is trivial.
+     * @return a boolean indicating whether the broadcasting is trivial
+     */
+    template <class CT1, class CT2>
+    template <class S>
+    inline bool xouter<CT1, CT2>::is_trivial_broadcast(const S& /*strides*/) const noexcept
+    {
+        return false;
+    }
+    //@}
+
+    template <class CT1, class CT2>
+    template <class S>
+    inline auto xouter<CT1, CT2>::stepper_begin(const S& shape) const noexcept -> const_stepper
+    {
+        size_type offset = shape.size() - dimension();
+        return const_stepper(this, m_e1.stepper_begin(m_e1.shape()), m_e2.stepper_begin(m_e2.shape()), offset);
+    }
+
+    template <class CT1, class CT2>
+    template <class S>
+    inline auto xouter<CT1, CT2>::stepper_end(const S& shape) const noexcept -> const_stepper
+    {
+        size_type offset = shape.size() - dimension();
+        return const_stepper(this, m_e1.stepper_end(m_e1.shape()), m_e2.stepper_end(m_e2.shape()), offset);
+    }
+
+    template <class CT1, class CT2>
+    inline bool xouter<CT1, CT2>::in_first(size_type dim) const noexcept
+    {
+        return dim >= m_first_begin && dim - m_first_begin < m_first_dim;
+    }
+
+    template <class CT1, class CT2>
+    inline bool xouter<CT1, CT2>::in_second(size_type dim) const noexcept
+    {
+        return dim >= m_second_begin && dim - m_second_begin < m_second_dim;
+    }
+
+    template <class CT1, class CT2>
+    inline auto xouter<CT1, CT2>::second_extent(size_type dim) const noexcept -> size_type
+    {
+        return m_second_extent[dim];
+    }
+
+    template <class CT1, class CT2>
+    template <class V, class O>
+    inline void xouter<CT1, CT2>::assign_rows(const V* a, const std::vector<size_type>& a_strides,
+                                              const V* b, const std::vector<size_type>& b_strides,
+                                              O* out, size_type first_row, size_type last_row) const
+    {
+        if (dimension() == 0)
+        {
+            out[0] = static_cast<O>(a[0] * b[0]);
+            return;
+        }
+
+        size_type last = dimension() - 1;
+        size_type extent1 = in_first(last) ? m_e1.shape()[last - m_first_begin] : size_type(1);
+        size_type extent2 = second_extent(last);
+        size_type row_size = extent1 * extent2;
+        std::vector<size_type> index(last, size_type(0));
+        size_type row = first_row;
+        for (size_type d = last; d > 0; --d)
+        {
+            index[d - 1] = row % m_shape[d - 1];
+            row /= m_shape[d - 1];
+        }
+
+        for (row = first_row; row < last_row; ++row)
+        {
+            size_type offset1 = 0;
+            size_type offset2 = 0;
+            for (size_type d = 0; d < last; ++d)
+            {
+                size_type i = index[d];
+                if (in_second(d))
+                {
+                    offset2 += (i % second_extent(d)) * b_strides[d - m_second_begin];
+                    i /= second_extent(d);
+                }
+                if (in_first(d))
+                {
+                    offset1 += i * a_strides[d - m_first_begin];
+                }
+            }
+
+            const V* a_row = a + offset1;
+            const V* b_row = b + offset2;
+            O* out_row = out + row * row_size;
+            if (extent2 == 1)
+            {
+                V s = b_row[0];
+                for (size_type j = 0; j < extent1; ++j)
+                {
+                    out_row[j] = static_cast<O>(a_row[j] * s);
+                }
+            }
+            else
+            {
+                for (size_type i = 0; i < extent1; ++i, out_row += extent2)
+                {
+                    V s = a_row[i];
+                    for (size_type j = 0; j < extent2; ++j)
+                    {
+                        out_row[j] = static_cast<O>(s * b_row[j]);
+                    }
+                }
+            }
+
+            for (size_type d = last; d > 0; --d)
+            {
+                if (++index[d - 1] != m_shape[d - 1])
+                {
+                    break;
+                }
+                index[d - 1] = 0;
+            }
+        }
+    }
+
+    /*********************************
+     * xouter_stepper implementation *
+     *********************************/
+
+    template <class CT1, class CT2>
+    inline xouter_stepper<CT1, CT2>::xouter_stepper(const xouter_type* e, first_stepper s1, second_stepper s2, size_type offset)
+        : p_e(e), m_s1(s1), m_s2(s2), m_offset(offset), m_index(e->dimension(), size_type(0))
+    {
+    }
+
+    template <class CT1, class CT2>
+    inline auto xouter_stepper<CT1, CT2>::operator*() const -> reference
+    {
+        return value_type(*m_s1) * value_type(*m_s2);
+    }
+
+    template <class CT1, class CT2>
+    inline void xouter_stepper<CT1, CT2>::step(size_type dim, size_type n)
+    {
+        if (dim < m_offset)
+        {
+            return;
+        }
+        size_type d = dim - m_offset;
+        bool first = p_e->in_first(d);
+        if (!p_e->in_second(d))
+        {
+            if (first)
+            {
+                m_s1.step(d - p_e->m_first_begin, n);
+            }
+            return;
+        }
+
+        size_type d2 = d - p_e->m_second_begin;
+        if (!first)
+        {
+            m_s2.step(d2, n);
+            return;
+        }
+
+        size_type extent = p_e->second_extent(d);
+        size_type i = m_index[d] + n;
+        if (i < extent)
+        {
+            m_s2.step(d2, n);
+            m_index[d] = i;
+            return;
+        }
+        size_type carry = i / extent;
+        i %= extent;
+        if (i > m_index[d])
+        {
+            m_s2.step(d2, i - m_index[d]);
+        }
+        else
+        {
+            m_s2.step_back(d2, m_index[d] - i);
+        }
+        m_index[d] = i;
+        m_s1.step(d - p_e->m_first_begin, carry);
+    }
+
+    template <class CT1, class CT2>
+    inline void xouter_stepper<CT1, CT2>::step_back(size_type dim, size_type n)
+    {
+        if (dim < m_offset)
+        {
+            return;
+        }
+        size_type d = dim - m_offset;
+        bool first = p_e->in_first(d);
+        if (!p_e->in_second(d))
+        {
+            if (first)
+            {
+                m_s1.step_back(d - p_e->m_first_begin, n);
+            }
+            return;
+        }
+
+        size_type d2 = d - p_e->m_second_begin;
+        if (!first || n <= m_index[d])
+        {
+            m_s2.step_back(d2, n);
+            if (first)
+            {
+                m_index[d] -= n;
+            }
+            return;
+        }
+
+        size_type extent = p_e->second_extent(d);
+        size_type borrow = (n - m_index[d] + extent - 1) / extent;
+        size_type i = m_index[d] + borrow * extent - n;
+        if (i > m_index[d])
+        {
+            m_s2.step(d2, i - m_index[d]);
+        }
+        else
+        {
+            m_s2.step_back(d2, m_index[d] - i);
+        }
+        m_index[d] = i;
+        m_s1.step_back(d - p_e->m_first_begin, borrow);
+    }
+
+    template <class CT1, class CT2>
+    inline void xouter_stepper<CT1, CT2>::reset(size_type dim)
+    {
+        if (dim < m_offset)
+        {
+            return;
+        }
+        size_type d = dim - m_offset;
+        if (p_e->in_first(d))
+        {
+            m_s1.reset(d - p_e->m_first_begin);
+        }
+        if (p_e->in_second(d))
+        {
+            m_s2.reset(d - p_e->m_second_begin);
+        }
+        m_index[d] = 0;
+    }
+
+    template <class CT1, class CT2>
+    inline void xouter_stepper<CT1, CT2>::to_end()
+    {
+        m_s1.to_end();
+        m_s2.to_end();
+    }
+
+    template <class CT1, class CT2>
+    inline bool xouter_stepper<CT1, CT2>::equal(const self_type& rhs) const
+    {
+        return p_e == rhs.p_e && m_s1 == rhs.m_s1 && m_s2 == rhs.m_s2;
+    }
+
+    template <class CT1, class CT2>
+    inline bool operator==(const xouter_stepper<CT1, CT2>& lhs,
+                           const xouter_stepper<CT1, CT2>& rhs)
+    {
+        return lhs.equal(rhs);
+    }
+
+    template <class CT1, class CT2>
+    inline bool operator!=(const xouter_stepper<CT1, CT2>& lhs,
+                           const xouter_stepper<CT1, CT2>& rhs)
+    {
+        return !(lhs.equal(rhs));
+    }
+}
+
+#endif
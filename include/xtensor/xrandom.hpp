@@ -13,11 +13,23 @@
 #ifndef XRANDOM_HPP
 #define XRANDOM_HPP
 
-#include <utility>
-#include <random>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "xarray.hpp"
 #include "xgenerator.hpp"
+#include "xstrides.hpp"
+#include "xtensor.hpp"
 
 namespace xt
 {
@@ -33,6 +45,11 @@ namespace xt
         default_engine_type& get_default_random_engine();
         void seed(seed_type seed);
 
+        class philox4x32;
+
+        template <class E>
+        struct is_counter_based_engine;
+
         template <class T, class S, class E = random::default_engine_type>
         auto rand(const S& shape, T lower = 0, T upper = 1,
                   E& engine = random::get_default_random_engine());
@@ -45,6 +62,30 @@ namespace xt
         auto randn(const S& shape, T mean = 0, T std_dev = 1,
                    E& engine = random::get_default_random_engine());
 
+        template <class T, class S, class E = random::default_engine_type>
+        auto exponential(const S& shape, T rate = 1,
+                         E& engine = random::get_default_random_engine());
+
+        template <class T, class S, class E = random::default_engine_type>
+        auto gamma(const S& shape, T alpha = 1, T beta = 1,
+                   E& engine = random::get_default_random_engine());
+
+        template <class T, class S, class E = random::default_engine_type>
+        auto beta(const S& shape, T a = 1, T b = 1,
+                  E& engine = random::get_default_random_engine());
+
+        template <class T, class S, class E = random::default_engine_type>
+        auto binomial(const S& shape, T trials = 1, double prob = 0.5,
+                      E& engine = random::get_default_random_engine());
+
+        template <class T, class S, class E = random::default_engine_type>
+        auto poisson(const S& shape, double rate = 1.0,
+                     E& engine = random::get_default_random_engine());
+
+        template <class T, class S, class E = random::default_engine_type>
+        auto bernoulli(const S& shape, double prob = 0.5,
+                       E& engine = random::get_default_random_engine());
+
 #ifdef X_OLD_CLANG
         template <class T, class I, class E = random::default_engine_type>
         auto rand(std::initializer_list<I> shape, T lower = 0, T upper = 1,
@@ -58,6 +99,30 @@ namespace xt
         template <class T, class I, class E = random::default_engine_type>
         auto randn(std::initializer_list<I>, T mean = 0, T std_dev = 1,
                    E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto exponential(std::initializer_list<I> shape, T rate = 1,
+                         E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto gamma(std::initializer_list<I> shape, T alpha = 1, T beta = 1,
+                   E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto beta(std::initializer_list<I> shape, T a = 1, T b = 1,
+                  E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto binomial(std::initializer_list<I> shape, T trials = 1, double prob = 0.5,
+                      E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto poisson(std::initializer_list<I> shape, double rate = 1.0,
+                     E& engine = random::get_default_random_engine());
+
+        template <class T, class I, class E = random::default_engine_type>
+        auto bernoulli(std::initializer_list<I> shape, double prob = 0.5,
+                       E& engine = random::get_default_random_engine());
 #else
         template <class T, class I, std::size_t L, class E = random::default_engine_type>
         auto rand(const I(&shape)[L], T lower = 0, T upper = 1,
@@ -70,37 +135,773 @@ namespace xt
         template <class T, class I, std::size_t L, class E = random::default_engine_type>
         auto randn(const I(&shape)[L], T mean = 0, T std_dev = 1,
                    E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto exponential(const I(&shape)[L], T rate = 1,
+                         E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto gamma(const I(&shape)[L], T alpha = 1, T beta = 1,
+                   E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto beta(const I(&shape)[L], T a = 1, T b = 1,
+                  E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto binomial(const I(&shape)[L], T trials = 1, double prob = 0.5,
+                      E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto poisson(const I(&shape)[L], double rate = 1.0,
+                     E& engine = random::get_default_random_engine());
+
+        template <class T, class I, std::size_t L, class E = random::default_engine_type>
+        auto bernoulli(const I(&shape)[L], double prob = 0.5,
+                       E& engine = random::get_default_random_engine());
 #endif
 
+        template <class T, class E = random::default_engine_type>
+        void shuffle(xexpression<T>& e, E& engine = random::get_default_random_engine());
+
+        template <class T, class E = random::default_engine_type>
+        std::enable_if_t<std::is_integral<T>::value, xtensor<T, 1>>
+        permutation(T e, E& engine = random::get_default_random_engine());
+
+        template <class T, class E = random::default_engine_type>
+        xarray<typename T::value_type> permutation(const xexpression<T>& e,
+                                                   E& engine = random::get_default_random_engine());
+
+        template <class T, class E = random::default_engine_type>
+        xtensor<typename T::value_type, 1> choice(const xexpression<T>& e, std::size_t n, bool replace = true,
+                                                  E& engine = random::get_default_random_engine());
+
+    }
+
+    /**************************
+     * philox4x32 declaration *
+     **************************/
+
+    namespace random
+    {
+        /**
+         * @class philox4x32
+         * @brief Counter-based random number engine.
+         *
+         * The philox4x32 class implements the Philox-4x32-10 bijection of
+         * Salmon et al. Contrary to sequential engines such as std::mt19937,
+         * it holds no mutable state: the random bits of the element at flat
+         * index \c i only depend on the seed, the stream and \c i. Random
+         * expressions built with this engine are therefore reproducible
+         * whatever the order, the number of times or the number of threads
+         * used to evaluate them.
+         */
+        class philox4x32
+        {
+        public:
+
+            using result_type = std::uint32_t;
+            using counter_type = std::array<std::uint32_t, 4>;
+            using key_type = std::array<std::uint32_t, 2>;
+
+            explicit philox4x32(std::uint64_t seed = 0, std::uint32_t stream = 0) noexcept;
+
+            void seed(std::uint64_t seed, std::uint32_t stream = 0) noexcept;
+
+            const key_type& key() const noexcept;
+            std::uint32_t stream() const noexcept;
+
+            counter_type operator()(std::uint64_t index, std::uint32_t draw = 0) const noexcept;
+
+            static counter_type bijection(counter_type counter, key_type key) noexcept;
+
+        private:
+
+            key_type m_key;
+            std::uint32_t m_stream;
+        };
+
+        template <class E>
+        struct is_counter_based_engine : std::false_type
+        {
+        };
+
+        template <>
+        struct is_counter_based_engine<philox4x32> : std::true_type
+        {
+        };
     }
 
     namespace detail
     {
-        template <class T>
+        template <class T, class D, class E>
         struct random_impl
         {
             using value_type = T;
 
-            random_impl(std::function<value_type()>&& generator) :
-                m_generator(std::move(generator))
+            // The distribution is constructed from its parameters here, not
+            // copied from an object built by the caller: some distributions,
+            // such as std::poisson_distribution, leave the members they do not
+            // need for their parameters uninitialized, and copying such a local
+            // object raises -Wmaybe-uninitialized. random_impl, and the
+            // distribution with it, is still copied into the xgenerator.
+            template <class... Args>
+            random_impl(E& engine, Args&&... args)
+                : m_dist(std::forward<Args>(args)...), p_engine(&engine)
             {
             }
 
             template <class... Args>
             inline value_type operator()(Args...) const
             {
-                return m_generator();
+                return static_cast<value_type>(m_dist(*p_engine));
             }
 
             template <class It>
             inline value_type element(It, It) const
             {
-                return m_generator();
+                return static_cast<value_type>(m_dist(*p_engine));
+            }
+
+            template <class EX>
+            inline void assign_to(EX& e) const
+            {
+                auto& data = e.data();
+                std::size_t size = e.size();
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    data[i] = static_cast<value_type>(m_dist(*p_engine));
+                }
+            }
+
+        private:
+            mutable D m_dist;
+            E* p_engine;
+        };
+
+        /****************************
+         * beta_distribution class *
+         ****************************/
+
+        // The standard library has no beta distribution; it is sampled
+        // as X / (X + Y) with X ~ Gamma(a, 1) and Y ~ Gamma(b, 1).
+        template <class T>
+        class beta_distribution
+        {
+        public:
+
+            using result_type = T;
+
+            beta_distribution(T a, T b)
+                : m_x(a, T(1)), m_y(b, T(1))
+            {
+            }
+
+            T a() const noexcept
+            {
+                return m_x.alpha();
+            }
+
+            T b() const noexcept
+            {
+                return m_y.alpha();
+            }
+
+            template <class E>
+            T operator()(E& engine)
+            {
+                T x = m_x(engine);
+                T y = m_y(engine);
+                return x / (x + y);
+            }
+
+        private:
+
+            std::gamma_distribution<T> m_x;
+            std::gamma_distribution<T> m_y;
+        };
+
+        /*************************
+         * counter_stream class *
+         *************************/
+
+        // Maps 64 random bits to [0, 1). Single precision uses 24 bits, other
+        // types use 53 bits so the result is never rounded to 1.
+        template <class T>
+        struct unit_interval
+        {
+            static inline T get(std::uint64_t bits) noexcept
+            {
+                return T(double(bits >> 11) * (1.0 / 9007199254740992.0));
+            }
+        };
+
+        template <>
+        struct unit_interval<float>
+        {
+            static inline float get(std::uint64_t bits) noexcept
+            {
+                return float(bits >> 40) * (1.f / 16777216.f);
+            }
+        };
+
+        // Sequence of random bits private to one element: it walks through
+        // the successive draws of the element's counter, so rejection
+        // samplers can consume as many bits as they need while the result
+        // still only depends on the seed and the index of the element.
+        class counter_stream
+        {
+        public:
+
+            counter_stream(const random::philox4x32& engine, std::uint64_t index) noexcept
+                : p_engine(&engine), m_index(index), m_draw(0), m_position(4)
+            {
+            }
+
+            inline std::uint64_t bits() noexcept
+            {
+                if (m_position == 4)
+                {
+                    m_block = (*p_engine)(m_index, m_draw++);
+                    m_position = 0;
+                }
+                std::uint64_t res = (std::uint64_t(m_block[m_position]) << 32) | m_block[m_position + 1];
+                m_position += 2;
+                return res;
+            }
+
+            template <class T>
+            inline T uniform() noexcept
+            {
+                return unit_interval<T>::get(bits());
+            }
+
+            // Box-Muller transform
+            template <class T>
+            inline T normal() noexcept
+            {
+                T u1 = T(1) - uniform<T>();
+                T u2 = uniform<T>();
+                return std::sqrt(T(-2) * std::log(u1)) * std::cos(T(6.283185307179586476925) * u2);
+            }
+
+        private:
+
+            const random::philox4x32* p_engine;
+            std::uint64_t m_index;
+            std::uint32_t m_draw;
+            std::size_t m_position;
+            random::philox4x32::counter_type m_block;
+        };
+
+        /*********************
+         * counter samplers *
+         *********************/
+
+        // Marsaglia and Tsang method, with the boost u^(1 / alpha) for alpha < 1
+        template <class T>
+        inline T gamma_sample(counter_stream& s, T alpha)
+        {
+            if (alpha < T(1))
+            {
+                T u = s.uniform<T>();
+                return gamma_sample(s, alpha + T(1)) * std::pow(u, T(1) / alpha);
+            }
+            T d = alpha - T(1) / T(3);
+            T c = T(1) / std::sqrt(T(9) * d);
+            while (true)
+            {
+                T x, v;
+                do
+                {
+                    x = s.normal<T>();
+                    v = T(1) + c * x;
+                } while (v <= T(0));
+                v = v * v * v;
+                T u = s.uniform<T>();
+                T x2 = x * x;
+                if (u < T(1) - T(0.0331) * x2 * x2 || std::log(u) < T(0.5) * x2 + d * (T(1) - v + std::log(v)))
+                {
+                    return d * v;
+                }
+            }
+        }
+
+        // Knuth's multiplication method for small means, Hormann's PTRS
+        // transformed rejection otherwise
+        inline double poisson_sample(counter_stream& s, double mean)
+        {
+            if (mean < 10.)
+            {
+                double limit = std::exp(-mean);
+                double prod = s.uniform<double>();
+                double k = 0.;
+                while (prod > limit)
+                {
+                    prod *= s.uniform<double>();
+                    k += 1.;
+                }
+                return k;
+            }
+            double slam = std::sqrt(mean);
+            double loglam = std::log(mean);
+            double b = 0.931 + 2.53 * slam;
+            double a = -0.059 + 0.02483 * b;
+            double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+            double vr = 0.9277 - 3.6224 / (b - 2.);
+            while (true)
+            {
+                double u = s.uniform<double>() - 0.5;
+                double v = s.uniform<double>();
+                double us = 0.5 - std::fabs(u);
+                double k = std::floor((2. * a / us + b) * u + mean + 0.43);
+                if (us >= 0.07 && v <= vr)
+                {
+                    return k;
+                }
+                if (k < 0. || (us < 0.013 && v > us))
+                {
+                    continue;
+                }
+                if (std::log(v) + std::log(invalpha) - std::log(a / (us * us) + b) <= -mean + k * loglam - std::lgamma(k + 1.))
+                {
+                    return k;
+                }
+            }
+        }
+
+        // Inversion for small n * p, Hormann's BTRS transformed rejection otherwise
+        inline double binomial_sample(counter_stream& s, double n, double p)
+        {
+            if (p > 0.5)
+            {
+                return n - binomial_sample(s, n, 1. - p);
+            }
+            if (p <= 0. || n <= 0.)
+            {
+                return 0.;
+            }
+            double q = 1. - p;
+            if (n * p < 30.)
+            {
+                double qn = std::pow(q, n);
+                double r = p / q;
+                double g = r * (n + 1.);
+                while (true)
+                {
+                    double u = s.uniform<double>();
+                    double px = qn;
+                    double k = 0.;
+                    while (u > px && k <= n)
+                    {
+                        u -= px;
+                        k += 1.;
+                        px *= g / k - r;
+                    }
+                    if (k <= n)
+                    {
+                        return k;
+                    }
+                }
+            }
+            double spq = std::sqrt(n * p * q);
+            double b = 1.15 + 2.53 * spq;
+            double a = -0.0873 + 0.0248 * b + 0.01 * p;
+            double c = n * p + 0.5;
+            double vr = 0.92 - 4.2 / b;
+            double alpha = (2.83 + 5.1 / b) * spq;
+            double lpq = std::log(p / q);
+            double m = std::floor((n + 1.) * p);
+            double h = std::lgamma(m + 1.) + std::lgamma(n - m + 1.);
+            while (true)
+            {
+                double u = s.uniform<double>() - 0.5;
+                double v = s.uniform<double>();
+                double us = 0.5 - std::fabs(u);
+                double k = std::floor((2. * a / us + b) * u + c);
+                if (k < 0. || k > n)
+                {
+                    continue;
+                }
+                if (us >= 0.07 && v <= vr)
+                {
+                    return k;
+                }
+                v = std::log(v * alpha / (a / (us * us) + b));
+                if (v <= h - std::lgamma(k + 1.) - std::lgamma(n - k + 1.) + (k - m) * lpq)
+                {
+                    return k;
+                }
+            }
+        }
+
+        /*********************************
+         * counter_distribution classes *
+         *********************************/
+
+        // Transforms the distributions into functions of the engine and
+        // the flat index of the element.
+        template <class D>
+        struct counter_distribution;
+
+        template <class T>
+        struct counter_distribution<std::uniform_real_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::uniform_real_distribution<T>& dist)
+                : m_lower(dist.a()), m_range(dist.b() - dist.a())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const noexcept
+            {
+                return m_lower + m_range * counter_stream(engine, index).uniform<T>();
+            }
+
+        private:
+            T m_lower;
+            T m_range;
+        };
+
+        template <class T>
+        struct counter_distribution<std::uniform_int_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::uniform_int_distribution<T>& dist)
+                : m_lower(dist.a()),
+                  m_range(std::uint64_t(dist.b()) - std::uint64_t(dist.a()) + 1)
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const noexcept
+            {
+                std::uint64_t bits = counter_stream(engine, index).bits();
+                std::uint64_t offset = m_range == 0 ? bits : bits % m_range;
+                return static_cast<T>(std::uint64_t(m_lower) + offset);
+            }
+
+        private:
+            T m_lower;
+            std::uint64_t m_range;
+        };
+
+        template <class T>
+        struct counter_distribution<std::normal_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::normal_distribution<T>& dist)
+                : m_mean(dist.mean()), m_std_dev(dist.stddev())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const noexcept
+            {
+                return m_mean + m_std_dev * counter_stream(engine, index).normal<T>();
+            }
+
+        private:
+            T m_mean;
+            T m_std_dev;
+        };
+
+        template <class T>
+        struct counter_distribution<std::exponential_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::exponential_distribution<T>& dist)
+                : m_rate(dist.lambda())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const noexcept
+            {
+                return -std::log(T(1) - counter_stream(engine, index).uniform<T>()) / m_rate;
+            }
+
+        private:
+            T m_rate;
+        };
+
+        template <class T>
+        struct counter_distribution<std::gamma_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::gamma_distribution<T>& dist)
+                : m_alpha(dist.alpha()), m_beta(dist.beta())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const
+            {
+                counter_stream s(engine, index);
+                return m_beta * gamma_sample(s, m_alpha);
+            }
+
+        private:
+            T m_alpha;
+            T m_beta;
+        };
+
+        template <class T>
+        struct counter_distribution<beta_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const beta_distribution<T>& dist)
+                : m_a(dist.a()), m_b(dist.b())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const
+            {
+                counter_stream s(engine, index);
+                T x = gamma_sample(s, m_a);
+                T y = gamma_sample(s, m_b);
+                return x / (x + y);
+            }
+
+        private:
+            T m_a;
+            T m_b;
+        };
+
+        template <class T>
+        struct counter_distribution<std::binomial_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::binomial_distribution<T>& dist)
+                : m_trials(double(dist.t())), m_prob(dist.p())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const
+            {
+                counter_stream s(engine, index);
+                return static_cast<T>(binomial_sample(s, m_trials, m_prob));
             }
 
         private:
-            std::function<value_type()> m_generator;
+            double m_trials;
+            double m_prob;
         };
+
+        template <class T>
+        struct counter_distribution<std::poisson_distribution<T>>
+        {
+            using result_type = T;
+
+            counter_distribution(const std::poisson_distribution<T>& dist)
+                : m_mean(dist.mean())
+            {
+            }
+
+            inline T operator()(const random::philox4x32& engine, std::uint64_t index) const
+            {
+                counter_stream s(engine, index);
+                return static_cast<T>(poisson_sample(s, m_mean));
+            }
+
+        private:
+            double m_mean;
+        };
+
+        template <>
+        struct counter_distribution<std::bernoulli_distribution>
+        {
+            using result_type = bool;
+
+            counter_distribution(const std::bernoulli_distribution& dist)
+                : m_prob(dist.p())
+            {
+            }
+
+            inline bool operator()(const random::philox4x32& engine, std::uint64_t index) const noexcept
+            {
+                return counter_stream(engine, index).uniform<double>() < m_prob;
+            }
+
+        private:
+            double m_prob;
+        };
+
+        /*****************************
+         * counter_random_impl class *
+         *****************************/
+
+        template <class T, class D>
+        struct counter_random_impl
+        {
+            using value_type = T;
+            using size_type = std::size_t;
+
+            template <class S>
+            counter_random_impl(D&& dist, const random::philox4x32& engine, const S& shape)
+                : m_dist(std::move(dist)), m_engine(engine),
+                  m_strides(std::size_t(std::distance(std::begin(shape), std::end(shape))))
+            {
+                std::vector<size_type> sh(std::begin(shape), std::end(shape));
+                compute_strides(sh, layout::row_major, m_strides);
+            }
+
+            template <class... Args>
+            inline value_type operator()(Args... args) const
+            {
+                return static_cast<value_type>(m_dist(m_engine, data_offset<size_type>(m_strides, static_cast<size_type>(args)...)));
+            }
+
+            template <class It>
+            inline value_type element(It first, It last) const
+            {
+                return static_cast<value_type>(m_dist(m_engine, element_offset<size_type>(m_strides, first, last)));
+            }
+
+            template <class E>
+            inline void assign_to(E& e) const
+            {
+                auto& data = e.data();
+                size_type size = e.size();
+                for (size_type i = 0; i < size; ++i)
+                {
+                    data[i] = static_cast<value_type>(m_dist(m_engine, i));
+                }
+            }
+
+        private:
+            D m_dist;
+            random::philox4x32 m_engine;
+            std::vector<size_type> m_strides;
+        };
+
+        template <class T, class D, class S, class E, class... Args>
+        inline auto make_random(const S& shape, E& engine, std::false_type, Args&&... args)
+        {
+            return make_xgenerator(random_impl<T, D, E>(engine, std::forward<Args>(args)...), shape);
+        }
+
+        template <class T, class D, class S, class E, class... Args>
+        inline auto make_random(const S& shape, E& engine, std::true_type, Args&&... args)
+        {
+            using distribution_type = counter_distribution<D>;
+            return make_xgenerator(counter_random_impl<T, distribution_type>(distribution_type(D(std::forward<Args>(args)...)), engine, shape), shape);
+        }
+
+        // Builds a random expression drawing from a distribution of type D
+        // constructed from args.
+        template <class T, class D, class S, class E, class... Args>
+        inline auto make_random(const S& shape, E& engine, Args&&... args)
+        {
+            using is_counter = random::is_counter_based_engine<std::remove_const_t<E>>;
+            return make_random<T, D>(shape, engine, typename is_counter::type(), std::forward<Args>(args)...);
+        }
+
+        // Returns a random index in [0, upper], used by the permutation
+        // functions; with a counter-based engine, it depends on the step only.
+        template <class E>
+        inline std::size_t random_index(E& engine, std::size_t, std::size_t upper, std::false_type)
+        {
+            return std::uniform_int_distribution<std::size_t>(0, upper)(engine);
+        }
+
+        template <class E>
+        inline std::size_t random_index(E& engine, std::size_t step, std::size_t upper, std::true_type)
+        {
+            std::uint64_t bits = counter_stream(engine, step).bits();
+            std::uint64_t range = std::uint64_t(upper) + 1;
+            return std::size_t(range == 0 ? bits : bits % range);
+        }
+
+        template <class E>
+        inline std::size_t random_index(E& engine, std::size_t step, std::size_t upper)
+        {
+            using is_counter = random::is_counter_based_engine<std::remove_const_t<E>>;
+            return random_index(engine, step, upper, is_counter());
+        }
+    }
+
+    /*****************************
+     * philox4x32 implementation *
+     *****************************/
+
+    namespace random
+    {
+        /**
+         * Builds a philox4x32 engine.
+         * @param seed the 64 bits seed, used as the key of the bijection
+         * @param stream the index of the stream; engines with the same seed
+         *        and different streams generate independent sequences
+         */
+        inline philox4x32::philox4x32(std::uint64_t seed, std::uint32_t stream) noexcept
+        {
+            this->seed(seed, stream);
+        }
+
+        /**
+         * Reseeds the engine.
+         * @param seed the 64 bits seed
+         * @param stream the index of the stream
+         */
+        inline void philox4x32::seed(std::uint64_t seed, std::uint32_t stream) noexcept
+        {
+            m_key = {{std::uint32_t(seed), std::uint32_t(seed >> 32)}};
+            m_stream = stream;
+        }
+
+        /**
+         * Returns the key of the engine.
+         */
+        inline auto philox4x32::key() const noexcept -> const key_type&
+        {
+            return m_key;
+        }
+
+        /**
+         * Returns the stream of the engine.
+         */
+        inline std::uint32_t philox4x32::stream() const noexcept
+        {
+            return m_stream;
+        }
+
+        /**
+         * Returns the 128 random bits associated with the element at flat index
+         * @p index.
+         * @param index the flat index of the element
+         * @param draw the index of the draw for this element; distributions
+         *        needing more than 128 bits per element use successive draws
+         */
+        inline auto philox4x32::operator()(std::uint64_t index, std::uint32_t draw) const noexcept -> counter_type
+        {
+            counter_type counter = {{std::uint32_t(index), std::uint32_t(index >> 32), draw, m_stream}};
+            return bijection(counter, m_key);
+        }
+
+        /**
+         * Applies the ten rounds of the Philox-4x32 bijection to @p counter
+         * with the given @p key.
+         */
+        inline auto philox4x32::bijection(counter_type counter, key_type key) noexcept -> counter_type
+        {
+            constexpr std::uint64_t mul0 = 0xD2511F53;
+            constexpr std::uint64_t mul1 = 0xCD9E8D57;
+            constexpr std::uint32_t weyl0 = 0x9E3779B9;
+            constexpr std::uint32_t weyl1 = 0xBB67AE85;
+            for (std::size_t round = 0; round < 10; ++round)
+            {
+                std::uint64_t p0 = mul0 * counter[0];
+                std::uint64_t p1 = mul1 * counter[2];
+                counter = {{std::uint32_t(p1 >> 32) ^ counter[1] ^ key[0], std::uint32_t(p1),
+                            std::uint32_t(p0 >> 32) ^ counter[3] ^ key[1], std::uint32_t(p0)}};
+                key[0] += weyl0;
+                key[1] += weyl1;
+            }
+            return counter;
+        }
     }
     
     namespace random
@@ -138,8 +939,7 @@ namespace xt
         template <class T, class S, class E>
         inline auto rand(const S& shape, T lower, T upper, E& engine)
         {
-            std::uniform_real_distribution<T> dist(lower, upper);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_real_distribution<T>>(shape, engine, lower, upper);
         }
 
         /**
@@ -157,8 +957,7 @@ namespace xt
         template <class T, class S, class E>
         inline auto randint(const S& shape, T lower, T upper, E& engine)
         {
-            std::uniform_int_distribution<T> dist(lower, upper - 1);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_int_distribution<T>>(shape, engine, lower, upper - 1);
         }
 
         /**
@@ -177,53 +976,340 @@ namespace xt
         template <class T, class S, class E>
         inline auto randn(const S& shape, T mean, T std_dev, E& engine)
         {
-            std::normal_distribution<T> dist(mean, std_dev);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::normal_distribution<T>>(shape, engine, mean, std_dev);
+        }
+
+        /**
+         * xexpression with specified @p shape containing numbers sampled from
+         * the exponential distribution with rate @p rate.
+         *
+         * Numbers are drawn from @c std::exponential_distribution.
+         *
+         * @param shape shape of resulting xexpression
+         * @param rate rate (lambda) of the exponential distribution
+         * @param engine random number engine
+         * @tparam T number type to use
+         */
+        template <class T, class S, class E>
+        inline auto exponential(const S& shape, T rate, E& engine)
+        {
+            return detail::make_random<T, std::exponential_distribution<T>>(shape, engine, rate);
+        }
+
+        /**
+         * xexpression with specified @p shape containing numbers sampled from
+         * the gamma distribution with shape @p alpha and scale @p beta.
+         *
+         * Numbers are drawn from @c std::gamma_distribution.
+         *
+         * @param shape shape of resulting xexpression
+         * @param alpha shape parameter of the gamma distribution
+         * @param beta scale parameter of the gamma distribution
+         * @param engine random number engine
+         * @tparam T number type to use
+         */
+        template <class T, class S, class E>
+        inline auto gamma(const S& shape, T alpha, T beta, E& engine)
+        {
+            return detail::make_random<T, std::gamma_distribution<T>>(shape, engine, alpha, beta);
+        }
+
+        /**
+         * xexpression with specified @p shape containing numbers sampled from
+         * the beta distribution with parameters @p a and @p b.
+         *
+         * Numbers are computed as X / (X + Y), where X and Y are drawn from
+         * @c std::gamma_distribution with shapes @p a and @p b.
+         *
+         * @param shape shape of resulting xexpression
+         * @param a first shape parameter of the beta distribution
+         * @param b second shape parameter of the beta distribution
+         * @param engine random number engine
+         * @tparam T number type to use
+         */
+        template <class T, class S, class E>
+        inline auto beta(const S& shape, T a, T b, E& engine)
+        {
+            return detail::make_random<T, detail::beta_distribution<T>>(shape, engine, a, b);
+        }
+
+        /**
+         * xexpression with specified @p shape containing the number of successes
+         * of @p trials independent trials with success probability @p prob.
+         *
+         * Numbers are drawn from @c std::binomial_distribution.
+         *
+         * @param shape shape of resulting xexpression
+         * @param trials number of trials
+         * @param prob probability of success of each trial
+         * @param engine random number engine
+         * @tparam T integer type to use
+         */
+        template <class T, class S, class E>
+        inline auto binomial(const S& shape, T trials, double prob, E& engine)
+        {
+            return detail::make_random<T, std::binomial_distribution<T>>(shape, engine, trials, prob);
+        }
+
+        /**
+         * xexpression with specified @p shape containing numbers sampled from
+         * the Poisson distribution with mean @p rate.
+         *
+         * Numbers are drawn from @c std::poisson_distribution.
+         *
+         * @param shape shape of resulting xexpression
+         * @param rate mean of the Poisson distribution
+         * @param engine random number engine
+         * @tparam T integer type to use
+         */
+        template <class T, class S, class E>
+        inline auto poisson(const S& shape, double rate, E& engine)
+        {
+            return detail::make_random<T, std::poisson_distribution<T>>(shape, engine, rate);
+        }
+
+        /**
+         * xexpression with specified @p shape containing the outcomes of
+         * Bernoulli trials with success probability @p prob.
+         *
+         * Numbers are drawn from @c std::bernoulli_distribution.
+         *
+         * @param shape shape of resulting xexpression
+         * @param prob probability of success
+         * @param engine random number engine
+         * @tparam T type to use, typically bool or an integer type
+         */
+        template <class T, class S, class E>
+        inline auto bernoulli(const S& shape, double prob, E& engine)
+        {
+            return detail::make_random<T, std::bernoulli_distribution>(shape, engine, prob);
         }
 
 #ifdef X_OLD_CLANG
         template <class T, class I, class E>
         inline auto rand(std::initializer_list<I> shape, T lower, T upper, E& engine)
         {
-            std::uniform_real_distribution<T> dist(lower, upper);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_real_distribution<T>>(shape, engine, lower, upper);
         }
 
         template <class T, class I, class E>
         inline auto randint(std::initializer_list<I> shape, T lower, T upper, E& engine)
         {
-            std::uniform_int_distribution<T> dist(lower, upper - 1);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_int_distribution<T>>(shape, engine, lower, upper - 1);
         }
 
         template <class T, class I, class E>
         inline auto randn(std::initializer_list<I> shape, T mean, T std_dev, E& engine)
         {
-            std::normal_distribution<T> dist(mean, std_dev);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::normal_distribution<T>>(shape, engine, mean, std_dev);
+        }
+
+        template <class T, class I, class E>
+        inline auto exponential(std::initializer_list<I> shape, T rate, E& engine)
+        {
+            return detail::make_random<T, std::exponential_distribution<T>>(shape, engine, rate);
+        }
+
+        template <class T, class I, class E>
+        inline auto gamma(std::initializer_list<I> shape, T alpha, T beta, E& engine)
+        {
+            return detail::make_random<T, std::gamma_distribution<T>>(shape, engine, alpha, beta);
+        }
+
+        template <class T, class I, class E>
+        inline auto beta(std::initializer_list<I> shape, T a, T b, E& engine)
+        {
+            return detail::make_random<T, detail::beta_distribution<T>>(shape, engine, a, b);
+        }
+
+        template <class T, class I, class E>
+        inline auto binomial(std::initializer_list<I> shape, T trials, double prob, E& engine)
+        {
+            return detail::make_random<T, std::binomial_distribution<T>>(shape, engine, trials, prob);
+        }
+
+        template <class T, class I, class E>
+        inline auto poisson(std::initializer_list<I> shape, double rate, E& engine)
+        {
+            return detail::make_random<T, std::poisson_distribution<T>>(shape, engine, rate);
+        }
+
+        template <class T, class I, class E>
+        inline auto bernoulli(std::initializer_list<I> shape, double prob, E& engine)
+        {
+            return detail::make_random<T, std::bernoulli_distribution>(shape, engine, prob);
         }
 #else
         template <class T, class I, std::size_t L, class E>
         inline auto rand(const I(&shape)[L], T lower, T upper, E& engine)
         {
-            std::uniform_real_distribution<T> dist(lower, upper);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_real_distribution<T>>(shape, engine, lower, upper);
         }
 
         template <class T, class I, std::size_t L, class E>
         inline auto randint(const I(&shape)[L], T lower, T upper, E& engine)
         {
-            std::uniform_int_distribution<T> dist(lower, upper - 1);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::uniform_int_distribution<T>>(shape, engine, lower, upper - 1);
         }
 
         template <class T, class I, std::size_t L, class E>
         inline auto randn(const I(&shape)[L], T mean, T std_dev, E& engine)
         {
-            std::normal_distribution<T> dist(mean, std_dev);
-            return detail::make_xgenerator(detail::random_impl<T>(std::bind(dist, std::ref(engine))), shape);
+            return detail::make_random<T, std::normal_distribution<T>>(shape, engine, mean, std_dev);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto exponential(const I(&shape)[L], T rate, E& engine)
+        {
+            return detail::make_random<T, std::exponential_distribution<T>>(shape, engine, rate);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto gamma(const I(&shape)[L], T alpha, T beta, E& engine)
+        {
+            return detail::make_random<T, std::gamma_distribution<T>>(shape, engine, alpha, beta);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto beta(const I(&shape)[L], T a, T b, E& engine)
+        {
+            return detail::make_random<T, detail::beta_distribution<T>>(shape, engine, a, b);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto binomial(const I(&shape)[L], T trials, double prob, E& engine)
+        {
+            return detail::make_random<T, std::binomial_distribution<T>>(shape, engine, trials, prob);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto poisson(const I(&shape)[L], double rate, E& engine)
+        {
+            return detail::make_random<T, std::poisson_distribution<T>>(shape, engine, rate);
+        }
+
+        template <class T, class I, std::size_t L, class E>
+        inline auto bernoulli(const I(&shape)[L], double prob, E& engine)
+        {
+            return detail::make_random<T, std::bernoulli_distribution>(shape, engine, prob);
         }
 #endif
+
+        /**
+         * Randomly permutes the elements of the container @p e along its
+         * first axis, in place.
+         * @param e the container to shuffle
+         * @param engine random number engine
+         */
+        template <class T, class E>
+        inline void shuffle(xexpression<T>& e, E& engine)
+        {
+            T& de = e.derived_cast();
+            if (de.dimension() == 0 || de.shape()[0] < 2)
+            {
+                return;
+            }
+
+            if (!de.is_contiguous())
+            {
+                xarray<typename T::value_type> tmp = de;
+                shuffle(tmp, engine);
+                de = tmp;
+                return;
+            }
+
+            std::size_t nb_rows = de.shape()[0];
+            std::size_t row_size = de.size() / nb_rows;
+            auto first = de.data().begin();
+            for (std::size_t i = nb_rows - 1; i > 0; --i)
+            {
+                std::size_t j = detail::random_index(engine, i, i);
+                if (j != i)
+                {
+                    auto row = first + static_cast<std::ptrdiff_t>(i * row_size);
+                    std::swap_ranges(row, row + static_cast<std::ptrdiff_t>(row_size),
+                                     first + static_cast<std::ptrdiff_t>(j * row_size));
+                }
+            }
+        }
+
+        /**
+         * Returns a random permutation of the integers in [0, @p e).
+         * @param e the number of elements to permute
+         * @param engine random number engine
+         */
+        template <class T, class E>
+        inline std::enable_if_t<std::is_integral<T>::value, xtensor<T, 1>>
+        permutation(T e, E& engine)
+        {
+            using result_type = xtensor<T, 1>;
+            typename result_type::shape_type shape = {static_cast<std::size_t>(e)};
+            result_type res(shape);
+            std::iota(res.data().begin(), res.data().end(), T(0));
+            shuffle(res, engine);
+            return res;
+        }
+
+        /**
+         * Returns a copy of @p e randomly permuted along its first axis.
+         * @param e the expression to permute
+         * @param engine random number engine
+         */
+        template <class T, class E>
+        inline xarray<typename T::value_type> permutation(const xexpression<T>& e, E& engine)
+        {
+            xarray<typename T::value_type> res = e;
+            shuffle(res, engine);
+            return res;
+        }
+
+        /**
+         * Returns @p n elements randomly drawn from the one-dimensional
+         * expression @p e.
+         * @param e the expression to sample from
+         * @param n the number of elements to draw
+         * @param replace if true (the default), an element can be drawn
+         *        several times
+         * @param engine random number engine
+         */
+        template <class T, class E>
+        inline xtensor<typename T::value_type, 1> choice(const xexpression<T>& e, std::size_t n,
+                                                         bool replace, E& engine)
+        {
+            const T& de = e.derived_cast();
+            if (de.dimension() != 1)
+            {
+                throw std::runtime_error("choice: expression must be one-dimensional");
+            }
+            std::size_t size = de.shape()[0];
+            if (n != 0 && (size == 0 || (!replace && n > size)))
+            {
+                throw std::runtime_error("choice: cannot draw more elements than the population holds");
+            }
+
+            using result_type = xtensor<typename T::value_type, 1>;
+            typename result_type::shape_type shape = {n};
+            result_type res(shape);
+            if (replace)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    res(i) = de(detail::random_index(engine, i, size - 1));
+                }
+            }
+            else
+            {
+                std::vector<std::size_t> indices(size);
+                std::iota(indices.begin(), indices.end(), std::size_t(0));
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    std::size_t j = i + detail::random_index(engine, i, size - 1 - i);
+                    std::swap(indices[i], indices[j]);
+                    res(i) = de(indices[i]);
+                }
+            }
+            return res;
+        }
     }
 }
 
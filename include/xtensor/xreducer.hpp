@@ -131,6 +131,7 @@ namespace xt
         size_type size() const noexcept;
         size_type dimension() const noexcept;
         const inner_shape_type& shape() const noexcept;
+        const xexpression_type& expression() const noexcept;
 
         template <class... Args>
         const_reference operator()(Args... args) const;
@@ -466,6 +467,15 @@ namespace xt
     {
         return m_shape;
     }
+
+    /**
+     * Returns the reduced expression.
+     */
+    template <class F, class CT, class X>
+    inline auto xreducer<F, CT, X>::expression() const noexcept -> const xexpression_type&
+    {
+        return m_e;
+    }
     //@}
 
     /**
@@ -214,6 +214,7 @@ namespace xt
 
         self_type& operator++() noexcept;
         self_type operator++(int) noexcept;
+        self_type& operator+=(difference_type n) noexcept;
 
         reference operator*() const noexcept;
 
@@ -554,6 +555,12 @@ namespace xt
         return *this;
     }
 
+    template <bool is_const, class CT>
+    inline auto xscalar_iterator<is_const, CT>::operator+=(difference_type) noexcept -> self_type&
+    {
+        return *this;
+    }
+
     template <bool is_const, class CT>
     inline auto xscalar_iterator<is_const, CT>::operator++(int) noexcept -> self_type
     {
@@ -14,6 +14,7 @@
 
 #include "xexpression.hpp"
 #include "xassign.hpp"
+#include "xtask_graph.hpp"
 
 namespace xt
 {
@@ -66,6 +67,9 @@ namespace xt
         template <class E>
         derived_type& assign(const xexpression<E>&);
 
+        template <class E>
+        derived_type& assign(const xexpression<E>&, const executor&);
+
         template <class E>
         derived_type& plus_assign(const xexpression<E>&);
 
@@ -120,6 +124,9 @@ namespace xt
         template <class E>
         derived_type& assign_xexpression(const xexpression<E>& e);
 
+        template <class E>
+        derived_type& assign_xexpression(const xexpression<E>& e, const executor& ex);
+
         template <class E>
         derived_type& computed_assign(const xexpression<E>& e);
 
@@ -168,6 +175,9 @@ namespace xt
         template <class E>
         derived_type& assign_xexpression(const xexpression<E>& e);
 
+        template <class E>
+        derived_type& assign_xexpression(const xexpression<E>& e, const executor& ex);
+
         template <class E>
         derived_type& computed_assign(const xexpression<E>& e);
 
@@ -215,6 +225,9 @@ namespace xt
         template <class E>
         derived_type& assign_xexpression(const xexpression<E>& e);
 
+        template <class E>
+        derived_type& assign_xexpression(const xexpression<E>& e, const executor& ex);
+
         template <class E>
         derived_type& computed_assign(const xexpression<E>& e);
 
@@ -253,6 +266,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator+=(const E& e) -> disable_xexpression<E, derived_type&>
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) + E(e));
+        }
         return this->derived_cast().scalar_computed_assign(e, std::plus<>());
     }
 
@@ -265,6 +282,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator-=(const E& e) -> disable_xexpression<E, derived_type&>
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) - E(e));
+        }
         return this->derived_cast().scalar_computed_assign(e, std::minus<>());
     }
 
@@ -277,6 +298,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator*=(const E& e) -> disable_xexpression<E, derived_type&>
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) * E(e));
+        }
         return this->derived_cast().scalar_computed_assign(e, std::multiplies<>());
     }
 
@@ -289,6 +314,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator/=(const E& e) -> disable_xexpression<E, derived_type&>
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) / E(e));
+        }
         return this->derived_cast().scalar_computed_assign(e, std::divides<>());
     }
 
@@ -301,6 +330,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator+=(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) + detail::deferred_closure(e.derived_cast()));
+        }
         return operator=(this->derived_cast() + e.derived_cast());
     }
 
@@ -313,6 +346,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator-=(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) - detail::deferred_closure(e.derived_cast()));
+        }
         return operator=(this->derived_cast() - e.derived_cast());
     }
 
@@ -325,6 +362,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator*=(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) * detail::deferred_closure(e.derived_cast()));
+        }
         return operator=(this->derived_cast() * e.derived_cast());
     }
 
@@ -337,6 +378,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator/=(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) / detail::deferred_closure(e.derived_cast()));
+        }
         return operator=(this->derived_cast() / e.derived_cast());
     }
     //@}
@@ -357,6 +402,23 @@ namespace xt
         return this->derived_cast().assign_xexpression(e);
     }
 
+    /**
+     * Assigns the xexpression \c e to \c *this, splitting the work over
+     * the tasks of the executor \c ex. Ensures no temporary will be used
+     * to perform the assignment. The elements of \c e are computed
+     * concurrently: \c e must not hold generators drawing values from a
+     * shared random engine.
+     * @param e the xexpression to assign.
+     * @param ex the executor running the assignment.
+     * @return a reference to \c *this.
+     */
+    template <class D>
+    template <class E>
+    inline auto xsemantic_base<D>::assign(const xexpression<E>& e, const executor& ex) -> derived_type&
+    {
+        return this->derived_cast().assign_xexpression(e, ex);
+    }
+
     /**
      * Adds the xexpression \c e to \c *this. Ensures no temporary
      * will be used to perform the assignment.
@@ -367,6 +429,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::plus_assign(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) + detail::deferred_closure(e.derived_cast()));
+        }
         return this->derived_cast().computed_assign(this->derived_cast() + e.derived_cast());
     }
 
@@ -380,6 +446,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::minus_assign(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) - detail::deferred_closure(e.derived_cast()));
+        }
         return this->derived_cast().computed_assign(this->derived_cast() - e.derived_cast());
     }
 
@@ -393,6 +463,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::multiplies_assign(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) * detail::deferred_closure(e.derived_cast()));
+        }
         return this->derived_cast().computed_assign(this->derived_cast() * e.derived_cast());
     }
 
@@ -406,6 +480,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::divides_assign(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::is_recording())
+        {
+            return operator=(detail::deferred_closure(this->derived_cast()) / detail::deferred_closure(e.derived_cast()));
+        }
         return this->derived_cast().computed_assign(this->derived_cast() / e.derived_cast());
     }
 
@@ -413,6 +491,10 @@ namespace xt
     template <class E>
     inline auto xsemantic_base<D>::operator=(const xexpression<E>& e) -> derived_type&
     {
+        if (detail::record_assign(this->derived_cast(), e.derived_cast()))
+        {
+            return this->derived_cast();
+        }
         temporary_type tmp(e);
         return this->derived_cast().assign_temporary(tmp);
     }
@@ -442,6 +524,14 @@ namespace xt
         return this->derived_cast();
     }
 
+    template <class D>
+    template <class E>
+    inline auto xcontainer_semantic<D>::assign_xexpression(const xexpression<E>& e, const executor& ex) -> derived_type&
+    {
+        xt::assign_xexpression(*this, e, ex);
+        return this->derived_cast();
+    }
+
     template <class D>
     template <class E>
     inline auto xcontainer_semantic<D>::computed_assign(const xexpression<E>& e) -> derived_type&
@@ -489,6 +579,14 @@ namespace xt
         return this->derived_cast();
     }
 
+    template <class D>
+    template <class E>
+    inline auto xadaptor_semantic<D>::assign_xexpression(const xexpression<E>& e, const executor& ex) -> derived_type&
+    {
+        xt::assign_xexpression(*this, e, ex);
+        return this->derived_cast();
+    }
+
     template <class D>
     template <class E>
     inline auto xadaptor_semantic<D>::computed_assign(const xexpression<E>& e) -> derived_type&
@@ -537,6 +635,15 @@ namespace xt
         return this->derived_cast();
     }
 
+    template <class D>
+    template <class E>
+    inline auto xview_semantic<D>::assign_xexpression(const xexpression<E>& e, const executor& ex) -> derived_type&
+    {
+        xt::assert_compatible_shape(*this, e);
+        xt::assign_data(*this, e, false, ex);
+        return this->derived_cast();
+    }
+
     template <class D>
     template <class E>
     inline auto xview_semantic<D>::computed_assign(const xexpression<E>& e) -> derived_type&
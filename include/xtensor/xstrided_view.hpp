@@ -0,0 +1,628 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSTRIDED_VIEW_HPP
+#define XSTRIDED_VIEW_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtensor_forward.hpp"
+#include "xexpression.hpp"
+#include "xiterable.hpp"
+#include "xscalar.hpp"
+#include "xsemantic.hpp"
+#include "xstrides.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+
+    /*****************************
+     * xstrided_view declaration *
+     *****************************/
+
+    template <class CT>
+    class xstrided_view;
+
+    template <class CT>
+    struct xcontainer_inner_types<xstrided_view<CT>>
+    {
+        using xexpression_type = std::decay_t<CT>;
+        using temporary_type = xarray<typename xexpression_type::value_type>;
+    };
+
+    template <bool is_const, class CT>
+    class xstrided_view_stepper;
+
+    template <class CT>
+    struct xiterable_inner_types<xstrided_view<CT>>
+    {
+        using xexpression_type = std::decay_t<CT>;
+        using inner_shape_type = std::vector<typename xexpression_type::size_type>;
+        using stepper = xstrided_view_stepper<false, CT>;
+        using const_stepper = xstrided_view_stepper<true, CT>;
+        using broadcast_iterator = xiterator<stepper, inner_shape_type*>;
+        using const_broadcast_iterator = xiterator<const_stepper, inner_shape_type*>;
+        using iterator = broadcast_iterator;
+        using const_iterator = const_broadcast_iterator;
+    };
+
+    /**
+     * @class xstrided_view
+     * @brief View of a container described by a shape, signed strides and
+     * an offset.
+     *
+     * The xstrided_view class gives access to the buffer of a container
+     * through an arbitrary set of strides, which may be negative or span
+     * several dimensions of the underlying container. It is the result of
+     * \ref flip and \ref diagonal when they are applied to containers.
+     *
+     * @tparam CT the closure type of the container to adapt
+     *
+     * @sa flip, diagonal
+     */
+    template <class CT>
+    class xstrided_view : public xview_semantic<xstrided_view<CT>>,
+                          public xexpression_iterable<xstrided_view<CT>>
+    {
+
+    public:
+
+        using self_type = xstrided_view<CT>;
+        using xexpression_type = std::decay_t<CT>;
+        using semantic_base = xview_semantic<self_type>;
+
+        using value_type = typename xexpression_type::value_type;
+        using reference = std::conditional_t<std::is_const<std::remove_reference_t<CT>>::value,
+                                             typename xexpression_type::const_reference,
+                                             typename xexpression_type::reference>;
+        using const_reference = typename xexpression_type::const_reference;
+        using pointer = typename xexpression_type::pointer;
+        using const_pointer = typename xexpression_type::const_pointer;
+        using size_type = typename xexpression_type::size_type;
+        using difference_type = typename xexpression_type::difference_type;
+
+        using iterable_base = xexpression_iterable<self_type>;
+        using inner_shape_type = typename iterable_base::inner_shape_type;
+        using shape_type = inner_shape_type;
+        using strides_type = std::vector<difference_type>;
+        using container_type = std::conditional_t<std::is_const<std::remove_reference_t<CT>>::value,
+                                                  const typename xexpression_type::container_type,
+                                                  typename xexpression_type::container_type>;
+
+        using stepper = typename iterable_base::stepper;
+        using const_stepper = typename iterable_base::const_stepper;
+
+        using broadcast_iterator = typename iterable_base::broadcast_iterator;
+        using const_broadcast_iterator = typename iterable_base::const_broadcast_iterator;
+
+        using iterator = typename iterable_base::iterator;
+        using const_iterator = typename iterable_base::const_iterator;
+
+        xstrided_view(CT e, shape_type&& shape, strides_type&& strides, difference_type offset) noexcept;
+
+        template <class E>
+        self_type& operator=(const xexpression<E>& e);
+
+        template <class E>
+        disable_xexpression<E, self_type>& operator=(const E& e);
+
+        template <class T>
+        void fill(const T& value);
+
+        size_type dimension() const noexcept;
+
+        size_type size() const noexcept;
+        const inner_shape_type& shape() const noexcept;
+        const strides_type& strides() const noexcept;
+        difference_type offset() const noexcept;
+
+        container_type& data() noexcept;
+        const container_type& data() const noexcept;
+
+        template <class... Args>
+        reference operator()(Args... args);
+        reference operator[](const xindex& index);
+        reference operator[](size_type i);
+        template <class It>
+        reference element(It first, It last);
+
+        template <class... Args>
+        const_reference operator()(Args... args) const;
+        const_reference operator[](const xindex& index) const;
+        const_reference operator[](size_type i) const;
+        template <class It>
+        const_reference element(It first, It last) const;
+
+        template <class E>
+        void assign_to(E& e) const;
+
+        template <class ST>
+        bool broadcast_shape(ST& shape) const;
+
+        template <class ST>
+        bool is_trivial_broadcast(const ST& strides) const;
+
+        template <class ST>
+        stepper stepper_begin(const ST& shape);
+        template <class ST>
+        stepper stepper_end(const ST& shape);
+
+        template <class ST>
+        const_stepper stepper_begin(const ST& shape) const;
+        template <class ST>
+        const_stepper stepper_end(const ST& shape) const;
+
+    private:
+
+        CT m_e;
+        inner_shape_type m_shape;
+        strides_type m_strides;
+        difference_type m_offset;
+
+        using temporary_type = typename xcontainer_inner_types<self_type>::temporary_type;
+
+        template <class T>
+        T data_begin(T first) const noexcept;
+
+        void assign_temporary_impl(temporary_type& tmp);
+
+        friend class xview_semantic<xstrided_view<CT>>;
+        friend class xstrided_view_stepper<false, CT>;
+        friend class xstrided_view_stepper<true, CT>;
+    };
+
+    /*************************************
+     * xstrided_view_stepper declaration *
+     *************************************/
+
+    template <bool is_const, class CT>
+    class xstrided_view_stepper
+    {
+
+    public:
+
+        using view_type = std::conditional_t<is_const,
+                                             const xstrided_view<CT>,
+                                             xstrided_view<CT>>;
+        using xexpression_type = std::decay_t<CT>;
+        using container_type = typename xexpression_type::container_type;
+        using subiterator_type = std::conditional_t<is_const || std::is_const<std::remove_reference_t<CT>>::value,
+                                                    typename container_type::const_iterator,
+                                                    typename container_type::iterator>;
+
+        using value_type = typename std::iterator_traits<subiterator_type>::value_type;
+        using reference = typename std::iterator_traits<subiterator_type>::reference;
+        using pointer = typename std::iterator_traits<subiterator_type>::pointer;
+        using difference_type = typename std::iterator_traits<subiterator_type>::difference_type;
+        using size_type = typename view_type::size_type;
+
+        using shape_type = typename view_type::shape_type;
+
+        xstrided_view_stepper() = default;
+        xstrided_view_stepper(view_type* view, subiterator_type it, size_type offset);
+
+        reference operator*() const;
+
+        void step(size_type dim, size_type n = 1);
+        void step_back(size_type dim, size_type n = 1);
+        void reset(size_type dim);
+
+        void to_end();
+
+        bool equal(const xstrided_view_stepper& rhs) const;
+
+    private:
+
+        view_type* p_view;
+        subiterator_type m_it;
+        size_type m_offset;
+    };
+
+    template <bool is_const, class CT>
+    bool operator==(const xstrided_view_stepper<is_const, CT>& lhs,
+                    const xstrided_view_stepper<is_const, CT>& rhs);
+
+    template <bool is_const, class CT>
+    bool operator!=(const xstrided_view_stepper<is_const, CT>& lhs,
+                    const xstrided_view_stepper<is_const, CT>& rhs);
+
+    /********************************
+     * xstrided_view implementation *
+     ********************************/
+
+    /**
+     * @name Constructor
+     */
+    //@{
+    /**
+     * Constructs a strided view on the specified container.
+     * @param e the container to adapt
+     * @param shape the shape of the view
+     * @param strides the strides of the view, in number of elements of
+     *        the underlying buffer
+     * @param offset the position of the first element of the view in the
+     *        underlying buffer
+     */
+    template <class CT>
+    inline xstrided_view<CT>::xstrided_view(CT e, shape_type&& shape, strides_type&& strides, difference_type offset) noexcept
+        : m_e(e), m_shape(std::move(shape)), m_strides(std::move(strides)), m_offset(offset)
+    {
+    }
+    //@}
+
+    /**
+     * @name Extended copy semantic
+     */
+    //@{
+    /**
+     * The extended assignment operator.
+     */
+    template <class CT>
+    template <class E>
+    inline auto xstrided_view<CT>::operator=(const xexpression<E>& e) -> self_type&
+    {
+        if (detail::is_constant_expression<E>::value)
+        {
+            xt::assert_compatible_shape(*this, e);
+            if (detail::fill(*this, e.derived_cast(), detail::is_fillable_with<self_type, E>()))
+            {
+                return *this;
+            }
+        }
+
+        bool cond = (e.derived_cast().shape().size() == dimension())
+                    && std::equal(shape().begin(), shape().end(), e.derived_cast().shape().begin());
+        if (!cond)
+        {
+            semantic_base::operator=(broadcast(e.derived_cast(), shape()));
+        }
+        else
+        {
+            semantic_base::operator=(e);
+        }
+        return *this;
+    }
+    //@}
+
+    template <class CT>
+    template <class E>
+    inline auto xstrided_view<CT>::operator=(const E& e) -> disable_xexpression<E, self_type>&
+    {
+        if (detail::record_assign(*this, xscalar<E>(e)))
+        {
+            return *this;
+        }
+        fill(e);
+        return *this;
+    }
+
+    /**
+     * Fills the view with the given value.
+     * @param value the value to fill the view with
+     */
+    template <class CT>
+    template <class T>
+    inline void xstrided_view<CT>::fill(const T& value)
+    {
+        strided_fill(data_begin(m_e.data().begin()), m_shape, m_strides, value);
+    }
+
+    /**
+     * @name Size and shape
+     */
+    //@{
+    /**
+     * Returns the number of dimensions of the view.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::dimension() const noexcept -> size_type
+    {
+        return m_shape.size();
+    }
+
+    /**
+     * Returns the size of the view.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::size() const noexcept -> size_type
+    {
+        return compute_size(shape());
+    }
+
+    /**
+     * Returns the shape of the view.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::shape() const noexcept -> const inner_shape_type&
+    {
+        return m_shape;
+    }
+
+    /**
+     * Returns the strides of the view.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::strides() const noexcept -> const strides_type&
+    {
+        return m_strides;
+    }
+
+    /**
+     * Returns the position of the first element of the view in the
+     * underlying buffer.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::offset() const noexcept -> difference_type
+    {
+        return m_offset;
+    }
+
+    /**
+     * Returns the buffer of the underlying container. The first element
+     * of the view is located at offset() in this buffer.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::data() noexcept -> container_type&
+    {
+        return m_e.data();
+    }
+
+    /**
+     * Returns a constant reference to the buffer of the underlying container.
+     * The first element of the view is located at offset() in this buffer.
+     */
+    template <class CT>
+    inline auto xstrided_view<CT>::data() const noexcept -> const container_type&
+    {
+        return m_e.data();
+    }
+    //@}
+
+    /**
+     * @name Data
+     */
+    //@{
+    /**
+     * Returns a reference to the element at the specified position in the view.
+     * @param args a list of indices specifying the position in the view. Indices
+     * must be unsigned integers, the number of indices should be equal to the number
+     * of dimensions of the view.
+     */
+    template <class CT>
+    template <class... Args>
+    inline auto xstrided_view<CT>::operator()(Args... args) -> reference
+    {
+        return m_e.data()[m_offset + data_offset<difference_type>(m_strides, static_cast<difference_type>(args)...)];
+    }
+
+    template <class CT>
+    inline auto xstrided_view<CT>::operator[](const xindex& index) -> reference
+    {
+        return element(index.cbegin(), index.cend());
+    }
+
+    template <class CT>
+    inline auto xstrided_view<CT>::operator[](size_type i) -> reference
+    {
+        return operator()(i);
+    }
+
+    template <class CT>
+    template <class It>
+    inline auto xstrided_view<CT>::element(It first, It last) -> reference
+    {
+        return m_e.data()[m_offset + element_offset<difference_type>(m_strides, first, last)];
+    }
+
+    /**
+     * Returns a constant reference to the element at the specified position in the view.
+     * @param args a list of indices specifying the position in the view. Indices must be
+     * unsigned integers, the number of indices should be equal to the number of dimensions
+     * of the view.
+     */
+    template <class CT>
+    template <class... Args>
+    inline auto xstrided_view<CT>::operator()(Args... args) const -> const_reference
+    {
+        return m_e.data()[m_offset + data_offset<difference_type>(m_strides, static_cast<difference_type>(args)...)];
+    }
+
+    template <class CT>
+    inline auto xstrided_view<CT>::operator[](const xindex& index) const -> const_reference
+    {
+        return element(index.cbegin(), index.cend());
+    }
+
+    template <class CT>
+    inline auto xstrided_view<CT>::operator[](size_type i) const -> const_reference
+    {
+        return operator()(i);
+    }
+
+    template <class CT>
+    template <class It>
+    inline auto xstrided_view<CT>::element(It first, It last) const -> const_reference
+    {
+        return m_e.data()[m_offset + element_offset<difference_type>(m_strides, first, last)];
+    }
+
+    /**
+     * Copies the elements of the view into the buffer of the row-major
+     * contiguous container \c e, which must have the shape of the view.
+     */
+    template <class CT>
+    template <class E>
+    inline void xstrided_view<CT>::assign_to(E& e) const
+    {
+        strided_copy(data_begin(m_e.data().cbegin()), m_shape, m_strides, e.data().begin());
+    }
+    //@}
+
+    /**
+     * @name Broadcasting
+     */
+    //@{
+    /**
+     * Broadcast the shape of the view to the specified parameter.
+     * @param shape the result shape
+     * @return a boolean indicating whether the broadcasting is trivial
+     */
+    template <class CT>
+    template <class ST>
+    inline bool xstrided_view<CT>::broadcast_shape(ST& shape) const
+    {
+        return xt::broadcast_shape(m_shape, shape);
+    }
+
+    /**
+     * Compares the specified strides with those of the view to see whether
+     * the broadcasting is trivial.
+     * @return a boolean indicating whether the broadcasting is trivial
+     */
+    template <class CT>
+    template <class ST>
+    inline bool xstrided_view<CT>::is_trivial_broadcast(const ST& /*strides*/) const
+    {
+        return false;
+    }
+    //@}
+
+    template <class CT>
+    template <class T>
+    inline T xstrided_view<CT>::data_begin(T first) const noexcept
+    {
+        return first + m_offset;
+    }
+
+    template <class CT>
+    inline void xstrided_view<CT>::assign_temporary_impl(temporary_type& tmp)
+    {
+        std::copy(tmp.cbegin(), tmp.cend(), this->xbegin());
+    }
+
+    /***************
+     * stepper api *
+     ***************/
+
+    template <class CT>
+    template <class ST>
+    inline auto xstrided_view<CT>::stepper_begin(const ST& shape) -> stepper
+    {
+        size_type offset = shape.size() - dimension();
+        if (size() == 0)
+        {
+            return stepper_end(shape);
+        }
+        return stepper(this, data_begin(m_e.data().begin()), offset);
+    }
+
+    template <class CT>
+    template <class ST>
+    inline auto xstrided_view<CT>::stepper_end(const ST& shape) -> stepper
+    {
+        size_type offset = shape.size() - dimension();
+        return stepper(this, m_e.data().end(), offset);
+    }
+
+    template <class CT>
+    template <class ST>
+    inline auto xstrided_view<CT>::stepper_begin(const ST& shape) const -> const_stepper
+    {
+        size_type offset = shape.size() - dimension();
+        if (size() == 0)
+        {
+            return stepper_end(shape);
+        }
+        return const_stepper(this, data_begin(m_e.data().cbegin()), offset);
+    }
+
+    template <class CT>
+    template <class ST>
+    inline auto xstrided_view<CT>::stepper_end(const ST& shape) const -> const_stepper
+    {
+        size_type offset = shape.size() - dimension();
+        return const_stepper(this, m_e.data().cend(), offset);
+    }
+
+    /****************************************
+     * xstrided_view_stepper implementation *
+     ****************************************/
+
+    template <bool is_const, class CT>
+    inline xstrided_view_stepper<is_const, CT>::xstrided_view_stepper(view_type* view, subiterator_type it, size_type offset)
+        : p_view(view), m_it(it), m_offset(offset)
+    {
+    }
+
+    template <bool is_const, class CT>
+    inline auto xstrided_view_stepper<is_const, CT>::operator*() const -> reference
+    {
+        return *m_it;
+    }
+
+    template <bool is_const, class CT>
+    inline void xstrided_view_stepper<is_const, CT>::step(size_type dim, size_type n)
+    {
+        if (dim >= m_offset)
+        {
+            m_it += static_cast<difference_type>(n) * p_view->m_strides[dim - m_offset];
+        }
+    }
+
+    template <bool is_const, class CT>
+    inline void xstrided_view_stepper<is_const, CT>::step_back(size_type dim, size_type n)
+    {
+        if (dim >= m_offset)
+        {
+            m_it -= static_cast<difference_type>(n) * p_view->m_strides[dim - m_offset];
+        }
+    }
+
+    template <bool is_const, class CT>
+    inline void xstrided_view_stepper<is_const, CT>::reset(size_type dim)
+    {
+        if (dim >= m_offset)
+        {
+            dim -= m_offset;
+            m_it -= static_cast<difference_type>(p_view->m_shape[dim] - 1) * p_view->m_strides[dim];
+        }
+    }
+
+    template <bool is_const, class CT>
+    inline void xstrided_view_stepper<is_const, CT>::to_end()
+    {
+        m_it = p_view->m_e.data().end();
+    }
+
+    template <bool is_const, class CT>
+    inline bool xstrided_view_stepper<is_const, CT>::equal(const xstrided_view_stepper& rhs) const
+    {
+        return p_view == rhs.p_view && m_it == rhs.m_it && m_offset == rhs.m_offset;
+    }
+
+    template <bool is_const, class CT>
+    inline bool operator==(const xstrided_view_stepper<is_const, CT>& lhs,
+                           const xstrided_view_stepper<is_const, CT>& rhs)
+    {
+        return lhs.equal(rhs);
+    }
+
+    template <bool is_const, class CT>
+    inline bool operator!=(const xstrided_view_stepper<is_const, CT>& lhs,
+                           const xstrided_view_stepper<is_const, CT>& rhs)
+    {
+        return !(lhs.equal(rhs));
+    }
+}
+
+#endif
@@ -9,9 +9,12 @@
 #ifndef XSTRIDES_HPP
 #define XSTRIDES_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <numeric>
 #include <functional>
+#include <iterator>
+#include <vector>
 #include "xexception.hpp"
 
 namespace xt
@@ -66,6 +69,16 @@ namespace xt
     template <class S1, class S2>
     bool broadcastable(const S1& s1, S2& s2);
 
+    /*****************
+     * strided loops *
+     *****************/
+
+    template <class It, class S, class ST, class T>
+    void strided_fill(It first, const S& shape, const ST& strides, const T& value);
+
+    template <class It, class S, class ST, class O>
+    O strided_copy(It first, const S& shape, const ST& strides, O d_first);
+
     /******************
      * Implementation *
      ******************/
@@ -211,6 +224,110 @@ namespace xt
         }
         return true;
     }
+
+    namespace detail
+    {
+        // Walks the strided buffer starting at first, calling f on each of
+        // its innermost rows with the row start, size and stride. The outer
+        // dimensions are walked like an odometer.
+        template <class It, class S, class ST, class F>
+        inline void strided_loop(It first, const S& shape, const ST& strides, F&& f)
+        {
+            using difference_type = typename std::iterator_traits<It>::difference_type;
+            std::size_t dim = shape.size();
+            if (dim == 0)
+            {
+                f(first, difference_type(1), difference_type(1));
+                return;
+            }
+            if (std::find(shape.cbegin(), shape.cend(), 0) != shape.cend())
+            {
+                return;
+            }
+
+            difference_type inner_size = static_cast<difference_type>(shape[dim - 1]);
+            difference_type inner_stride = static_cast<difference_type>(strides[dim - 1]);
+            std::vector<std::size_t> index(dim - 1, 0);
+            while (true)
+            {
+                f(first, inner_size, inner_stride);
+
+                std::size_t d = dim - 1;
+                for (; d != 0; --d)
+                {
+                    difference_type stride = static_cast<difference_type>(strides[d - 1]);
+                    if (++index[d - 1] != shape[d - 1])
+                    {
+                        first += stride;
+                        break;
+                    }
+                    index[d - 1] = 0;
+                    first -= stride * static_cast<difference_type>(shape[d - 1] - 1);
+                }
+                if (d == 0)
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    /**
+     * Assigns @p value to the elements of a strided buffer.
+     * @param first iterator to the first element of the buffer
+     * @param shape the shape of the strided expression
+     * @param strides the strides of the strided expression
+     * @param value the value to assign
+     */
+    template <class It, class S, class ST, class T>
+    inline void strided_fill(It first, const S& shape, const ST& strides, const T& value)
+    {
+        using difference_type = typename std::iterator_traits<It>::difference_type;
+        auto fill_row = [&value](It row, difference_type size, difference_type stride) {
+            if (stride == 1)
+            {
+                std::fill(row, row + size, value);
+            }
+            else
+            {
+                for (difference_type i = 0; i < size; ++i)
+                {
+                    row[i * stride] = value;
+                }
+            }
+        };
+        detail::strided_loop(first, shape, strides, fill_row);
+    }
+
+    /**
+     * Copies the elements of a strided buffer, in row-major order, to
+     * the range beginning at @p d_first. Strides may be negative.
+     * @param first iterator to the first element of the buffer
+     * @param shape the shape of the strided expression
+     * @param strides the strides of the strided expression
+     * @param d_first the beginning of the destination range
+     * @return an iterator past the last element copied
+     */
+    template <class It, class S, class ST, class O>
+    inline O strided_copy(It first, const S& shape, const ST& strides, O d_first)
+    {
+        using difference_type = typename std::iterator_traits<It>::difference_type;
+        auto copy_row = [&d_first](It row, difference_type size, difference_type stride) {
+            if (stride == 1)
+            {
+                d_first = std::copy(row, row + size, d_first);
+            }
+            else
+            {
+                for (difference_type i = 0; i < size; ++i, ++d_first)
+                {
+                    *d_first = row[i * stride];
+                }
+            }
+        };
+        detail::strided_loop(first, shape, strides, copy_row);
+        return d_first;
+    }
 }
 
 #endif
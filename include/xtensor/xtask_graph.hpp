@@ -0,0 +1,771 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+/**
+ * @brief deferred evaluation of sequences of assignments
+ */
+
+#ifndef XTASK_GRAPH_HPP
+#define XTASK_GRAPH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xassign.hpp"
+#include "xexecutor.hpp"
+#include "xtensor_forward.hpp"
+#include "xutils.hpp"
+
+namespace xt
+{
+    template <class F, class R, class... CT>
+    class xfunction;
+
+    template <class CT>
+    class xscalar;
+
+    template <class CT, class X>
+    class xbroadcast;
+
+    class task_graph;
+
+    /***********************
+     * deferred statements *
+     ***********************/
+
+    namespace detail
+    {
+        // Memory read or written by a statement. Elementwise buffers are
+        // containers accessed at the index of the assigned element.
+        struct deferred_buffer
+        {
+            const char* m_first;
+            const char* m_last;
+            bool m_elementwise;
+        };
+
+        enum class deferred_dependency
+        {
+            none,
+            elementwise,
+            other
+        };
+
+        class deferred_statement
+        {
+
+        public:
+
+            virtual ~deferred_statement() = default;
+
+            // runs the whole statement
+            virtual void run(const executor& ex) = 0;
+            // assigns the elements [first, last) in row-major order
+            virtual void run(std::size_t first, std::size_t last) = 0;
+
+            bool fusable() const noexcept;
+
+            std::vector<std::size_t> m_shape;
+            std::size_t m_size;
+            std::vector<deferred_buffer> m_writes;
+            std::vector<deferred_buffer> m_reads;
+            bool m_known;
+            bool m_aliased;
+        };
+
+        deferred_dependency dependency(const deferred_statement& s1, const deferred_statement& s2);
+
+        // Statements hold containers by reference and other expressions,
+        // which only reference containers, by value.
+        template <class E>
+        using deferred_closure_t = std::conditional_t<is_container<std::decay_t<E>>::value,
+                                                      const std::decay_t<E>&, std::decay_t<E>>;
+
+        template <class E>
+        using deferred_lhs_closure_t = std::conditional_t<is_container<E>::value, E&, E>;
+
+        template <class E>
+        deferred_closure_t<E> deferred_closure(const E& e);
+
+        template <class CT1, class CT2>
+        class deferred_assign : public deferred_statement
+        {
+
+        public:
+
+            template <class E1, class E2>
+            deferred_assign(E1& e1, const E2& e2, bool trivial);
+
+            void run(const executor& ex) override;
+            void run(std::size_t first, std::size_t last) override;
+
+        private:
+
+            using lhs_type = std::decay_t<CT1>;
+            using rhs_type = std::decay_t<CT2>;
+            using linear_type = std::integral_constant<bool, is_container<lhs_type>::value &&
+                                                             is_linear_expression<rhs_type>::value>;
+
+            bool is_linear(std::true_type) const;
+            bool is_linear(std::false_type) const;
+
+            CT1 m_e1;
+            CT2 m_e2;
+            bool m_trivial;
+            bool m_linear;
+        };
+
+        struct deferred_group
+        {
+            std::vector<std::size_t> m_statements;
+            std::size_t m_level;
+            bool m_fusable;
+        };
+
+        // number of elements of the blocks in which fused statements are
+        // evaluated one after the other
+        constexpr std::size_t deferred_block_size = std::size_t(1) << 12;
+
+        task_graph*& recording_graph() noexcept;
+        bool is_recording() noexcept;
+
+        template <class E1, class E2>
+        bool record_assign(E1& e1, const E2& e2);
+    }
+
+    /**************
+     * task_graph *
+     **************/
+
+    /**
+     * @class task_graph
+     * @brief Graph of deferred assignments.
+     *
+     * A task_graph holds the assignments recorded in a \ref deferred_scope.
+     * When it is run, the assignments are ordered according to the buffers
+     * they read and write: independent assignments run concurrently on the
+     * executor, and the assignments of the same shape that only depend on
+     * each other elementwise are fused, i.e. evaluated block by block so that
+     * the buffers they share stay in cache.
+     *
+     * @code{.cpp}
+     * xt::task_graph graph;
+     * {
+     *     xt::deferred_scope scope(graph);
+     *     t = a * b;
+     *     u = t + c;
+     *     v = sqrt(t) - u;
+     * }
+     * graph.run(pool);
+     * @endcode
+     *
+     * The containers and lvalue expressions involved in the recorded
+     * assignments must outlive the call to run, and their values are
+     * unspecified until it returns.
+     *
+     * @sa deferred_scope
+     */
+    class task_graph
+    {
+
+    public:
+
+        using size_type = std::size_t;
+
+        task_graph() = default;
+        ~task_graph() = default;
+
+        task_graph(const task_graph&) = delete;
+        task_graph& operator=(const task_graph&) = delete;
+
+        size_type size() const noexcept;
+        bool empty() const noexcept;
+
+        void run();
+        void run(const executor& ex);
+        void clear() noexcept;
+
+    private:
+
+        using statement_ptr = std::unique_ptr<detail::deferred_statement>;
+
+        template <class E1, class E2>
+        void record(E1& e1, const E2& e2);
+
+        template <class E1, class E2>
+        bool prepare(E1& e1, const E2& e2, std::true_type);
+
+        template <class E1, class E2>
+        bool prepare(E1& e1, const E2& e2, std::false_type);
+
+        bool is_used(const std::vector<detail::deferred_buffer>& buffers) const;
+
+        std::vector<detail::deferred_group> build_groups() const;
+
+        std::vector<statement_ptr> m_statements;
+
+        template <class E1, class E2>
+        friend bool detail::record_assign(E1& e1, const E2& e2);
+    };
+
+    /**
+     * @class deferred_scope
+     * @brief Records the assignments of the current thread in a task_graph.
+     *
+     * While a deferred_scope object is alive, the assignments of expressions
+     * to containers and views made by the thread that created it, including
+     * computed assignments and assignments through \ref noalias, are not
+     * evaluated but recorded in its graph. Copies and moves of containers,
+     * resizes and element accesses are still performed immediately, and must
+     * not be used on the containers of the recorded assignments before the
+     * graph is run. Functions that are not lazy, such as dot or fft, must be
+     * called outside of the scope.
+     *
+     * @sa task_graph
+     */
+    class deferred_scope
+    {
+
+    public:
+
+        explicit deferred_scope(task_graph& graph) noexcept;
+        ~deferred_scope();
+
+        deferred_scope(const deferred_scope&) = delete;
+        deferred_scope& operator=(const deferred_scope&) = delete;
+
+    private:
+
+        task_graph* p_previous;
+    };
+
+    /*************************************
+     * deferred_statement implementation *
+     *************************************/
+
+    namespace detail
+    {
+        inline bool deferred_statement::fusable() const noexcept
+        {
+            return m_known && !m_aliased &&
+                std::all_of(m_writes.cbegin(), m_writes.cend(), [](const deferred_buffer& b) { return b.m_elementwise; });
+        }
+
+        inline bool overlap(const deferred_buffer& b1, const deferred_buffer& b2) noexcept
+        {
+            return b1.m_first < b2.m_last && b2.m_first < b1.m_last;
+        }
+
+        inline deferred_dependency dependency(const std::vector<deferred_buffer>& writes,
+                                              const std::vector<deferred_buffer>& buffers)
+        {
+            deferred_dependency res = deferred_dependency::none;
+            for (const auto& w : writes)
+            {
+                for (const auto& b : buffers)
+                {
+                    if (overlap(w, b))
+                    {
+                        if (!w.m_elementwise || !b.m_elementwise || w.m_first != b.m_first || w.m_last != b.m_last)
+                        {
+                            return deferred_dependency::other;
+                        }
+                        res = deferred_dependency::elementwise;
+                    }
+                }
+            }
+            return res;
+        }
+
+        // Dependency of s2 on s1, which is recorded before s2.
+        inline deferred_dependency dependency(const deferred_statement& s1, const deferred_statement& s2)
+        {
+            if (!s1.m_known || !s2.m_known)
+            {
+                return deferred_dependency::other;
+            }
+            deferred_dependency res = deferred_dependency::none;
+            for (auto d : {dependency(s1.m_writes, s2.m_reads),
+                           dependency(s1.m_writes, s2.m_writes),
+                           dependency(s2.m_writes, s1.m_reads)})
+            {
+                if (d == deferred_dependency::other)
+                {
+                    return d;
+                }
+                if (d == deferred_dependency::elementwise)
+                {
+                    res = d;
+                }
+            }
+            if (res == deferred_dependency::elementwise && s1.m_shape != s2.m_shape)
+            {
+                res = deferred_dependency::other;
+            }
+            return res;
+        }
+
+        /*******************
+         * collect_buffers *
+         *******************/
+
+        // Appends the buffers read by an expression evaluated with the given
+        // shape; returns false if the expression may read memory that
+        // can't be determined.
+
+        template <class E, class S>
+        bool collect_buffers(const E& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers);
+
+        template <class CT, class S>
+        bool collect_buffers(const xscalar<CT>& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers);
+
+        template <class F, class R, class... CT, class S>
+        bool collect_buffers(const xfunction<F, R, CT...>& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers);
+
+        template <class CT, class... SL, class S>
+        bool collect_buffers(const xview<CT, SL...>& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers);
+
+        template <class CT, class X, class S>
+        bool collect_buffers(const xbroadcast<CT, X>& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers);
+
+        template <class E, class S>
+        inline bool collect_container_buffers(const E& e, const S& shape, bool elementwise,
+                                              std::vector<deferred_buffer>& buffers, std::true_type)
+        {
+            const char* first = reinterpret_cast<const char*>(e.data().data());
+            const char* last = reinterpret_cast<const char*>(e.data().data() + e.data().size());
+            bool same_shape = e.dimension() == shape.size() &&
+                std::equal(e.shape().cbegin(), e.shape().cend(), shape.cbegin());
+            buffers.push_back({first, last, elementwise && same_shape});
+            return true;
+        }
+
+        template <class E, class S>
+        inline bool collect_container_buffers(const E&, const S&, bool, std::vector<deferred_buffer>&, std::false_type)
+        {
+            return false;
+        }
+
+        template <class E, class S>
+        inline bool collect_buffers(const E& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers)
+        {
+            return collect_container_buffers(e, shape, elementwise, buffers, is_container<E>());
+        }
+
+        template <class CT, class S>
+        inline bool collect_buffers(const xscalar<CT>&, const S&, bool, std::vector<deferred_buffer>&)
+        {
+            return true;
+        }
+
+        template <class F, class R, class... CT, class S>
+        inline bool collect_buffers(const xfunction<F, R, CT...>& e, const S& shape, bool elementwise, std::vector<deferred_buffer>& buffers)
+        {
+            bool known = true;
+            for_each([&](const auto& arg) { known = collect_buffers(arg, shape, elementwise, buffers) && known; },
+                     e.arguments());
+            return known;
+        }
+
+        template <class CT, class... SL, class S>
+        inline bool collect_buffers(const xview<CT, SL...>& e, const S& shape, bool, std::vector<deferred_buffer>& buffers)
+        {
+            return collect_buffers(e.expression(), shape, false, buffers);
+        }
+
+        template <class CT, class X, class S>
+        inline bool collect_buffers(const xbroadcast<CT, X>& e, const S& shape, bool, std::vector<deferred_buffer>& buffers)
+        {
+            return collect_buffers(e.expression(), shape, false, buffers);
+        }
+
+        /**********************************
+         * deferred_assign implementation *
+         **********************************/
+
+        template <class E>
+        inline deferred_closure_t<E> deferred_closure(const E& e)
+        {
+            return e;
+        }
+
+        template <class CT1, class CT2>
+        template <class E1, class E2>
+        inline deferred_assign<CT1, CT2>::deferred_assign(E1& e1, const E2& e2, bool trivial)
+            : m_e1(e1), m_e2(e2), m_trivial(trivial)
+        {
+            const auto& shape = m_e1.shape();
+            m_shape.assign(shape.cbegin(), shape.cend());
+            m_size = m_e1.size();
+            bool writes_known = collect_buffers(m_e1, shape, true, m_writes);
+            bool reads_known = collect_buffers(m_e2, shape, true, m_reads);
+            m_known = writes_known && reads_known;
+            m_aliased = !reads_known ||
+                (writes_known ? dependency(m_writes, m_reads) == deferred_dependency::other : !m_reads.empty());
+            m_linear = trivial && is_linear(linear_type());
+        }
+
+        template <class CT1, class CT2>
+        inline void deferred_assign<CT1, CT2>::run(const executor& ex)
+        {
+            if (m_aliased)
+            {
+                typename xcontainer_inner_types<lhs_type>::temporary_type tmp(m_e2);
+                m_e1.assign_temporary(tmp);
+            }
+            else
+            {
+                assign_data(m_e1, m_e2, m_trivial, ex);
+            }
+        }
+
+        template <class CT1, class CT2>
+        inline void deferred_assign<CT1, CT2>::run(std::size_t first, std::size_t last)
+        {
+            // the blocks are already run concurrently by the graph
+            if (first == 0 && last == m_size)
+            {
+                if (!assign_shortcut(m_e1, m_e2))
+                {
+                    assign_serial(m_e1, m_e2, m_trivial && is_trivial_broadcast(m_e1, m_e2));
+                }
+            }
+            else if (m_linear)
+            {
+                assign_block(m_e1, m_e2, first, last, linear_type());
+            }
+            else
+            {
+                assign_block(m_e1, m_e2, first, last, std::false_type());
+            }
+        }
+
+        template <class CT1, class CT2>
+        inline bool deferred_assign<CT1, CT2>::is_linear(std::true_type) const
+        {
+            return m_e2.is_trivial_broadcast(m_e1.strides());
+        }
+
+        template <class CT1, class CT2>
+        inline bool deferred_assign<CT1, CT2>::is_linear(std::false_type) const
+        {
+            return false;
+        }
+
+        /*************
+         * recording *
+         *************/
+
+        inline task_graph*& recording_graph() noexcept
+        {
+            static thread_local task_graph* p = nullptr;
+            return p;
+        }
+
+        inline bool is_recording() noexcept
+        {
+            return recording_graph() != nullptr;
+        }
+
+        // Records the assignment of e2 to e1 if a deferred_scope is active
+        // on the current thread.
+        template <class E1, class E2>
+        inline bool record_assign(E1& e1, const E2& e2)
+        {
+            task_graph* graph = recording_graph();
+            if (graph == nullptr)
+            {
+                return false;
+            }
+            graph->record(e1, e2);
+            return true;
+        }
+
+        // Stops the recording on the current thread.
+        class recording_pause
+        {
+
+        public:
+
+            recording_pause() noexcept
+                : p_graph(recording_graph())
+            {
+                recording_graph() = nullptr;
+            }
+
+            ~recording_pause()
+            {
+                recording_graph() = p_graph;
+            }
+
+            recording_pause(const recording_pause&) = delete;
+            recording_pause& operator=(const recording_pause&) = delete;
+
+        private:
+
+            task_graph* p_graph;
+        };
+    }
+
+    /*****************************
+     * task_graph implementation *
+     *****************************/
+
+    /**
+     * Returns the number of recorded assignments.
+     */
+    inline auto task_graph::size() const noexcept -> size_type
+    {
+        return m_statements.size();
+    }
+
+    /**
+     * Returns true if no assignment has been recorded.
+     */
+    inline bool task_graph::empty() const noexcept
+    {
+        return m_statements.empty();
+    }
+
+    /**
+     * Runs the recorded assignments on the default executor.
+     */
+    inline void task_graph::run()
+    {
+        run(default_executor());
+    }
+
+    /**
+     * Runs the recorded assignments on the executor \c ex and clears the
+     * graph. If an assignment throws, the assignments that depend on it
+     * are not run, the graph is cleared and the exception is rethrown.
+     * @param ex the executor running the assignments
+     */
+    inline void task_graph::run(const executor& ex)
+    {
+        detail::recording_pause pause;
+        std::vector<statement_ptr> statements;
+        std::vector<detail::deferred_group> groups = build_groups();
+        std::swap(statements, m_statements);
+
+        std::size_t nb_levels = 0;
+        for (const auto& g : groups)
+        {
+            nb_levels = std::max(nb_levels, g.m_level + 1);
+        }
+
+        // (group, block) pairs; whole statements use the block npos
+        constexpr std::size_t npos = std::size_t(-1);
+        std::vector<std::pair<const detail::deferred_group*, std::size_t>> tasks;
+        for (std::size_t level = 0; level < nb_levels; ++level)
+        {
+            tasks.clear();
+            for (const auto& g : groups)
+            {
+                if (g.m_level != level)
+                {
+                    continue;
+                }
+                if (g.m_statements.size() == 1)
+                {
+                    tasks.emplace_back(&g, npos);
+                }
+                else
+                {
+                    std::size_t size = statements[g.m_statements.front()]->m_size;
+                    std::size_t nb_blocks = (size + detail::deferred_block_size - 1) / detail::deferred_block_size;
+                    for (std::size_t k = 0; k < nb_blocks; ++k)
+                    {
+                        tasks.emplace_back(&g, k);
+                    }
+                }
+            }
+            parallel_for(ex, tasks.size(), [&tasks, &statements, &ex](std::size_t t) {
+                const detail::deferred_group& g = *tasks[t].first;
+                std::size_t k = tasks[t].second;
+                if (k == npos)
+                {
+                    statements[g.m_statements.front()]->run(ex);
+                    return;
+                }
+                std::size_t size = statements[g.m_statements.front()]->m_size;
+                std::size_t first = k * detail::deferred_block_size;
+                std::size_t last = std::min(size, first + detail::deferred_block_size);
+                for (std::size_t i : g.m_statements)
+                {
+                    statements[i]->run(first, last);
+                }
+            });
+        }
+    }
+
+    /**
+     * Discards the recorded assignments.
+     */
+    inline void task_graph::clear() noexcept
+    {
+        m_statements.clear();
+    }
+
+    template <class E1, class E2>
+    inline void task_graph::record(E1& e1, const E2& e2)
+    {
+        using statement_type = detail::deferred_assign<detail::deferred_lhs_closure_t<E1>, detail::deferred_closure_t<E2>>;
+        bool trivial = prepare(e1, e2, detail::is_container<E1>());
+        m_statements.push_back(statement_ptr(new statement_type(e1, e2, trivial)));
+    }
+
+    // Resizes a container to the shape of the expression assigned to it,
+    // after running the recorded statements using its buffer if the
+    // resize reallocates it.
+    template <class E1, class E2>
+    inline bool task_graph::prepare(E1& e1, const E2& e2, std::true_type)
+    {
+        using shape_type = typename E1::shape_type;
+        using size_type = typename E1::size_type;
+        size_type dim = e2.dimension();
+        shape_type shape = make_sequence<shape_type>(dim, size_type(1));
+        bool trivial_broadcast = e2.broadcast_shape(shape);
+        if (shape.size() != e1.dimension() || !std::equal(shape.cbegin(), shape.cend(), e1.shape().cbegin()))
+        {
+            std::vector<detail::deferred_buffer> buffers;
+            detail::collect_buffers(e1, e1.shape(), false, buffers);
+            if (is_used(buffers))
+            {
+                run();
+            }
+            e1.reshape(shape);
+        }
+        return trivial_broadcast;
+    }
+
+    template <class E1, class E2>
+    inline bool task_graph::prepare(E1& e1, const E2& e2, std::false_type)
+    {
+        assert_compatible_shape(e1, e2);
+        return false;
+    }
+
+    inline bool task_graph::is_used(const std::vector<detail::deferred_buffer>& buffers) const
+    {
+        for (const auto& s : m_statements)
+        {
+            if (!s->m_known ||
+                detail::dependency(buffers, s->m_reads) != detail::deferred_dependency::none ||
+                detail::dependency(buffers, s->m_writes) != detail::deferred_dependency::none)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Groups the statements and assigns them levels such that a group only
+    // depends on groups of lower levels. A statement joins an existing
+    // group of the same shape when this doesn't change the level of the
+    // group, and when it only depends elementwise on its statements.
+    inline std::vector<detail::deferred_group> task_graph::build_groups() const
+    {
+        using detail::deferred_dependency;
+        std::vector<detail::deferred_group> groups;
+        std::vector<std::size_t> group_of(m_statements.size());
+        std::vector<deferred_dependency> deps;
+        for (std::size_t j = 0; j < m_statements.size(); ++j)
+        {
+            const detail::deferred_statement& sj = *m_statements[j];
+
+            // strongest dependency of sj on each group
+            deps.assign(groups.size(), deferred_dependency::none);
+            for (std::size_t i = 0; i < j; ++i)
+            {
+                deferred_dependency d = detail::dependency(*m_statements[i], sj);
+                deferred_dependency& gd = deps[group_of[i]];
+                if (d == deferred_dependency::other || (d == deferred_dependency::elementwise && gd == deferred_dependency::none))
+                {
+                    gd = d;
+                }
+            }
+
+            // highest level of the groups sj depends on, and the number of
+            // such groups at this level
+            bool has_deps = false;
+            std::size_t max_level = 0;
+            std::size_t nb_max = 0;
+            for (std::size_t g = 0; g < groups.size(); ++g)
+            {
+                if (deps[g] == deferred_dependency::none)
+                {
+                    continue;
+                }
+                if (!has_deps || groups[g].m_level > max_level)
+                {
+                    max_level = groups[g].m_level;
+                    nb_max = 0;
+                }
+                has_deps = true;
+                nb_max += groups[g].m_level == max_level;
+            }
+
+            std::size_t target = groups.size();
+            if (sj.fusable())
+            {
+                for (std::size_t g = groups.size(); g != 0; --g)
+                {
+                    const detail::deferred_group& group = groups[g - 1];
+                    if (!group.m_fusable || m_statements[group.m_statements.front()]->m_shape != sj.m_shape)
+                    {
+                        continue;
+                    }
+                    bool valid = deps[g - 1] == deferred_dependency::none ?
+                        !has_deps || group.m_level > max_level :
+                        deps[g - 1] == deferred_dependency::elementwise && nb_max == 1 && group.m_level == max_level;
+                    if (valid)
+                    {
+                        target = g - 1;
+                        break;
+                    }
+                }
+            }
+            if (target == groups.size())
+            {
+                groups.push_back({{}, has_deps ? max_level + 1 : 0, sj.fusable()});
+            }
+            groups[target].m_statements.push_back(j);
+            group_of[j] = target;
+        }
+        return groups;
+    }
+
+    /*********************************
+     * deferred_scope implementation *
+     *********************************/
+
+    /**
+     * Starts recording the assignments of the current thread in \c graph.
+     * Scopes can be nested; the innermost one records the assignments.
+     */
+    inline deferred_scope::deferred_scope(task_graph& graph) noexcept
+        : p_previous(detail::recording_graph())
+    {
+        detail::recording_graph() = &graph;
+    }
+
+    /**
+     * Stops recording; the graph is not run.
+     */
+    inline deferred_scope::~deferred_scope()
+    {
+        detail::recording_graph() = p_previous;
+    }
+}
+
+#endif
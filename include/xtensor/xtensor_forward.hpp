@@ -11,12 +11,16 @@
 
 #include <vector>
 #include <memory>
+#include <type_traits>
 
 namespace xt
 {
     template <class C>
     struct xcontainer_inner_types;
 
+    template <class D>
+    class xcontainer;
+
     template <class T, class EA = std::allocator<T>, class SA = std::allocator<typename std::vector<T, EA>::size_type>>
     class xarray;
 
@@ -25,6 +29,17 @@ namespace xt
 
     template <class CT, class... S>
     class xview;
+
+    namespace detail
+    {
+        template <class D>
+        std::true_type is_container_impl(const xcontainer<D>*);
+
+        std::false_type is_container_impl(...);
+
+        template <class T>
+        using is_container = decltype(is_container_impl(std::declval<std::remove_const_t<T>*>()));
+    }
 }
 
 #endif
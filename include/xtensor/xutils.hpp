@@ -32,6 +32,9 @@ namespace xt
     template <class F, class... T>
     void for_each(F&& f, std::tuple<T...>& t) noexcept(noexcept(std::declval<F>()));
 
+    template <class F, class... T>
+    void for_each(F&& f, const std::tuple<T...>& t) noexcept(noexcept(std::declval<F>()));
+
     template <class F, class R, class... T>
     R accumulate(F&& f, R init, const std::tuple<T...>& t) noexcept(noexcept(std::declval<F>()));
 
@@ -41,6 +44,9 @@ namespace xt
     template <class... T>
     struct and_;
 
+    template <class... T>
+    struct make_void;
+
     template <std::size_t I, class... Args>
     constexpr decltype(auto) argument(Args&&... args) noexcept;
 
@@ -125,6 +131,20 @@ namespace xt
             f(std::get<I>(t));
             for_each_impl<I + 1, F, T...>(std::forward<F>(f), t);
         }
+
+        template <std::size_t I, class F, class... T>
+        inline typename std::enable_if<I == sizeof...(T), void>::type
+        for_each_impl(F&& /*f*/, const std::tuple<T...>& /*t*/) noexcept(noexcept(std::declval<F>()))
+        {
+        }
+
+        template <std::size_t I, class F, class... T>
+        inline typename std::enable_if<I < sizeof...(T), void>::type
+        for_each_impl(F&& f, const std::tuple<T...>& t) noexcept(noexcept(std::declval<F>()))
+        {
+            f(std::get<I>(t));
+            for_each_impl<I + 1, F, T...>(std::forward<F>(f), t);
+        }
     }
 
     template <class F, class... T>
@@ -133,6 +153,12 @@ namespace xt
         detail::for_each_impl<0, F, T...>(std::forward<F>(f), t);
     }
 
+    template <class F, class... T>
+    inline void for_each(F&& f, const std::tuple<T...>& t) noexcept(noexcept(std::declval<F>()))
+    {
+        detail::for_each_impl<0, F, T...>(std::forward<F>(f), t);
+    }
+
     /*****************************
      * accumulate implementation *
      *****************************/
@@ -191,6 +217,20 @@ namespace xt
     {
     };
 
+    /****************************
+     * make_void implementation *
+     ****************************/
+
+    // equivalent to std::void_t in c++17
+    template <class... T>
+    struct make_void
+    {
+        using type = void;
+    };
+
+    template <class... T>
+    using void_t = typename make_void<T...>::type;
+
     /***************************
      * argument implementation *
      ***************************/
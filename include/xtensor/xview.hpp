@@ -19,6 +19,7 @@
 #include "xtensor_forward.hpp"
 #include "xbroadcast.hpp"
 #include "xiterable.hpp"
+#include "xscalar.hpp"
 #include "xsemantic.hpp"
 #include "xview_utils.hpp"
 
@@ -112,11 +113,15 @@ namespace xt
         template <class E>
         disable_xexpression<E, self_type>& operator=(const E& e);
 
+        template <class T>
+        void fill(const T& value);
+
         size_type dimension() const noexcept;
 
         size_type size() const noexcept;
         const inner_shape_type& shape() const noexcept;
         const slice_type& slices() const noexcept;
+        const xexpression_type& expression() const noexcept;
 
         template <class... Args>
         reference operator()(Args... args);
@@ -190,12 +195,81 @@ namespace xt
 
         void assign_temporary_impl(temporary_type& tmp);
 
+        template <class T>
+        void fill_impl(const T& value, std::true_type);
+
+        template <class T>
+        void fill_impl(const T& value, std::false_type);
+
         friend class xview_semantic<xview<CT, S...>>;
     };
 
     template <class E, class... S>
     auto view(E&& e, S&&... slices);
 
+    namespace detail
+    {
+        // Computes the strides of a view on a strided expression from the
+        // strides of the expression, and the offset of its first element.
+        template <class EST, class ST>
+        class view_strides_builder
+        {
+
+        public:
+
+            using size_type = typename ST::value_type;
+
+            view_strides_builder(const EST& e_strides, ST& strides)
+                : m_e_strides(e_strides), m_strides(strides), m_e_index(0), m_index(0), m_offset(0)
+            {
+            }
+
+            template <class T>
+            disable_xslice<T> operator()(const T& squeeze)
+            {
+                m_offset += m_e_strides[m_e_index++] * static_cast<size_type>(squeeze);
+            }
+
+            template <class T>
+            void operator()(const xnewaxis<T>&)
+            {
+                m_strides[m_index++] = 0;
+            }
+
+            template <class T>
+            void operator()(const xslice<T>& slice)
+            {
+                m_offset += m_e_strides[m_e_index] * static_cast<size_type>(value(slice, 0));
+                m_strides[m_index++] = m_e_strides[m_e_index++] * static_cast<size_type>(step_size(slice));
+            }
+
+            size_type finish()
+            {
+                while (m_e_index != m_e_strides.size())
+                {
+                    m_strides[m_index++] = m_e_strides[m_e_index++];
+                }
+                return m_offset;
+            }
+
+        private:
+
+            const EST& m_e_strides;
+            ST& m_strides;
+            std::size_t m_e_index;
+            std::size_t m_index;
+            size_type m_offset;
+        };
+
+        template <class EST, class ST, class... S>
+        inline typename ST::value_type view_strides(const EST& e_strides, const std::tuple<S...>& slices, ST& strides)
+        {
+            view_strides_builder<EST, ST> builder(e_strides, strides);
+            for_each(builder, slices);
+            return builder.finish();
+        }
+    }
+
     /*****************************
      * xview_stepper declaration *
      *****************************/
@@ -330,6 +404,15 @@ namespace xt
     template <class E>
     inline auto xview<CT, S...>::operator=(const xexpression<E>& e) -> self_type&
     {
+        if (detail::is_constant_expression<E>::value)
+        {
+            xt::assert_compatible_shape(*this, e);
+            if (detail::fill(*this, e.derived_cast(), detail::is_fillable_with<self_type, E>()))
+            {
+                return *this;
+            }
+        }
+
         bool cond = (e.derived_cast().shape().size() == dimension())
                     && std::equal(shape().begin(), shape().end(), e.derived_cast().shape().begin());
         if(!cond)
@@ -348,10 +431,27 @@ namespace xt
     template <class E>
     inline auto xview<CT, S...>::operator=(const E& e) -> disable_xexpression<E, self_type>&
     {
-        std::fill(this->begin(), this->end(), e);
+        if (detail::record_assign(*this, xscalar<E>(e)))
+        {
+            return *this;
+        }
+        fill(e);
         return *this;
     }
 
+    /**
+     * Fills the view with the given value. When the viewed expression is a
+     * container, the elements are written directly through the strides of
+     * the view.
+     * @param value the value to fill the view with
+     */
+    template <class CT, class... S>
+    template <class T>
+    inline void xview<CT, S...>::fill(const T& value)
+    {
+        fill_impl(value, detail::is_container<xexpression_type>());
+    }
+
     /**
      * @name Size and shape
      */
@@ -391,6 +491,15 @@ namespace xt
     {
         return m_slices;
     }
+
+    /**
+     * Returns the underlying expression of the view.
+     */
+    template <class CT, class... S>
+    inline auto xview<CT, S...>::expression() const noexcept -> const xexpression_type&
+    {
+        return m_e;
+    }
     //@}
 
     /**
@@ -580,6 +689,22 @@ namespace xt
         return index;
     }
 
+    template <class CT, class... S>
+    template <class T>
+    inline void xview<CT, S...>::fill_impl(const T& value, std::true_type)
+    {
+        inner_shape_type strides = m_shape;
+        size_type offset = detail::view_strides(m_e.strides(), m_slices, strides);
+        strided_fill(m_e.data().begin() + static_cast<difference_type>(offset), m_shape, strides, value);
+    }
+
+    template <class CT, class... S>
+    template <class T>
+    inline void xview<CT, S...>::fill_impl(const T& value, std::false_type)
+    {
+        std::fill(this->begin(), this->end(), value);
+    }
+
     template <class CT, class... S>
     inline void xview<CT, S...>::assign_temporary_impl(temporary_type& tmp)
     {
@@ -707,6 +832,7 @@ namespace xt
         {
             auto size_func = [](const auto& s) noexcept { return get_size(s); };
             auto step_func = [](const auto& s) noexcept { return step_size(s); };
+            dim -= m_offset;
             size_type index = integral_skip<S...>(dim);
             if (!is_newaxis_slice(index))
             {
@@ -747,7 +873,7 @@ namespace xt
         if (dim >= m_offset)
         {
             auto func = [](const auto& s) noexcept { return step_size(s); };
-            size_type index = integral_skip<S...>(dim);
+            size_type index = integral_skip<S...>(dim - m_offset);
             if (!is_newaxis_slice(index))
             {
                 size_type step_size = index < sizeof...(S) ?
@@ -172,5 +172,19 @@ namespace xt
         xarray<int> a;
         EXPECT_EQ(0, a());
     }
-}
 
+    TEST(xarray, fill)
+    {
+        xarray<double> a({ 3, 4 }, 2.);
+        a.fill(0.);
+        EXPECT_EQ(xarray<double>({ 3, 4 }, 0.), a);
+        a.fill(-0.);
+        EXPECT_TRUE(std::signbit(a(2, 3)));
+        a = broadcast(3.5, { 5, 2 });
+        EXPECT_EQ(xarray<double>({ 5, 2 }, 3.5), a);
+
+        xarray<bool> b({ 2, 2 }, true);
+        b.fill(false);
+        EXPECT_EQ(xarray<bool>({ 2, 2 }, false), b);
+    }
+}
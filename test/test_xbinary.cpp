@@ -0,0 +1,115 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xbinary.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    // 64-byte aligned storage, as a shared memory region would be
+    struct aligned_storage
+    {
+        explicit aligned_storage(size_t size)
+            : m_data(size / sizeof(std::max_align_t) + 64)
+        {
+        }
+
+        char* data()
+        {
+            char* p = reinterpret_cast<char*>(m_data.data());
+            return p + (64 - reinterpret_cast<std::uintptr_t>(p) % 64) % 64;
+        }
+
+        std::vector<std::max_align_t> m_data;
+    };
+
+    TEST(xbinary, round_trip)
+    {
+        xarray<double> a = {{1., 2., 3.}, {4., 5., 6.}};
+        size_t size = binary_size(a);
+        ASSERT_EQ(128u + 6 * sizeof(double), size);
+
+        aligned_storage storage(size);
+        ASSERT_EQ(size, dump_binary(storage.data(), size, a));
+
+        xbinary_view<double> v(storage.data(), size);
+        ASSERT_EQ(a.shape(), v.adaptor().shape());
+        ASSERT_EQ(a, v.adaptor());
+        ASSERT_EQ(size, v.size());
+
+        // the adaptor refers to the buffer
+        v.adaptor()(1, 1) = 10.;
+        xbinary_view<double> w(storage.data(), size);
+        ASSERT_EQ(10., w.adaptor()(1, 1));
+
+        ASSERT_THROW(xbinary_view<float> wrong(storage.data(), size), std::runtime_error);
+        ASSERT_THROW(dump_binary(storage.data(), size - 1, a), std::runtime_error);
+    }
+
+    TEST(xbinary, layout)
+    {
+        xarray<int>::shape_type shape = {2, 3};
+        xarray<int> a(shape, layout::column_major);
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            a.data()[i] = int(i);
+        }
+        aligned_storage storage(binary_size(a));
+        dump_binary(storage.data(), binary_size(a), a);
+        xbinary_view<int> v(storage.data(), binary_size(a));
+        ASSERT_EQ(a.strides(), v.adaptor().strides());
+        ASSERT_EQ(a, v.adaptor());
+
+        auto e = view(a, 1, all()) + 1;
+        aligned_storage storage_e(binary_size(e));
+        dump_binary(storage_e.data(), binary_size(e), e);
+        xbinary_view<int> ve(storage_e.data(), binary_size(e));
+        xarray<int> expected = {2, 4, 6};
+        ASSERT_EQ(expected, ve.adaptor());
+    }
+
+    TEST(xbinary, in_place)
+    {
+        std::vector<size_t> shape = {3, 4};
+        size_t size = binary_size<float>(shape);
+        aligned_storage storage(size);
+        {
+            xbinary_view<float> producer(storage.data(), size, {3, 4});
+            producer.adaptor() = ones<float>({3, 4}) * 2.f;
+            ASSERT_THROW(producer.adaptor().reshape({2, 2}), std::runtime_error);
+        }
+        xbinary_view<float> consumer(storage.data(), size);
+        ASSERT_EQ(xarray<float>(ones<float>({3, 4}) * 2.f), consumer.adaptor());
+    }
+
+    TEST(xbinary, stream)
+    {
+        xtensor<double, 3> a = zeros<double>({2, 2, 2});
+        a(1, 0, 1) = 3.5;
+        std::stringstream stream;
+        dump_binary(stream, a);
+        ASSERT_EQ(binary_size(a), stream.str().size());
+        xarray<double> b = load_binary<double>(stream);
+        ASSERT_EQ(a, b);
+
+        std::stringstream vstream;
+        dump_binary(vstream, view(a, 1));
+        xarray<double> c = load_binary<double>(vstream);
+        ASSERT_EQ(xarray<double>(view(a, 1)), c);
+    }
+}
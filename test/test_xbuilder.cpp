@@ -9,6 +9,7 @@
 #include "gtest/gtest.h"
 #include "xtensor/xbuilder.hpp"
 #include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
 
 #include "xtensor/xio.hpp"
 #include <iostream>
@@ -170,6 +171,51 @@ namespace xt
         ASSERT_EQ(true, e.element(idx2.begin(), idx2.end()));
     }
 
+    TEST(xbuilder, eye_assign)
+    {
+        for (int k = -4; k < 5; ++k)
+        {
+            auto e = eye<double>({2, 3, 4}, k);
+            xarray<double> res = e;
+            ASSERT_TRUE(std::equal(res.xbegin(), res.xend(), e.xbegin()));
+            xtensor<double, 3> tres = e;
+            ASSERT_TRUE(std::equal(tres.xbegin(), tres.xend(), e.xbegin()));
+        }
+
+        xarray<bool> b = eye(4, -1);
+        ASSERT_EQ(true, b(1, 0));
+        ASSERT_EQ(true, b(3, 2));
+        ASSERT_EQ(false, b(2, 2));
+    }
+
+    TEST(xbuilder, range_assign)
+    {
+        auto a = arange<double>(2., 9., 0.5);
+        xarray<double> ares = a;
+        ASSERT_EQ(a.shape()[0], ares.shape()[0]);
+        for (std::size_t i = 0; i < ares.size(); ++i)
+        {
+            ASSERT_DOUBLE_EQ(a(i), ares(i));
+        }
+
+        auto l = linspace<float>(-1.f, 1.f, 21);
+        xtensor<float, 1> lres = l;
+        ASSERT_EQ(l.shape()[0], lres.shape()[0]);
+        for (std::size_t i = 0; i < lres.size(); ++i)
+        {
+            ASSERT_NEAR(l(i), lres(i), 1e-6);
+        }
+
+        auto g = logspace<double>(0., 3., 7, 2.);
+        xarray<double> gres = g;
+        ASSERT_EQ(g.shape()[0], gres.shape()[0]);
+        for (std::size_t i = 0; i < gres.size(); ++i)
+        {
+            ASSERT_DOUBLE_EQ(g(i), gres(i));
+        }
+        ASSERT_DOUBLE_EQ(8., gres(6));
+    }
+
     TEST(xbuilder, concatenate)
     {
         xarray<double> a = arange<double>(12);
@@ -234,6 +280,77 @@ namespace xt
         ASSERT_TRUE(t == ar);
     }
 
+    TEST(xbuilder, concatenate_assign)
+    {
+        xarray<double> a = arange<double>(12);
+        a.reshape({2, 2, 3});
+        xarray<double> b = arange<double>(12, 24);
+        b.reshape({2, 2, 3});
+        xarray<double> bt = b;
+        bt.transpose({1, 0, 2});
+
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            auto c = concatenate(xtuple(a, bt, a + b), axis);
+            xarray<double> res = c;
+            ASSERT_EQ(c.shape(), res.shape());
+            ASSERT_TRUE(std::equal(res.xbegin(), res.xend(), c.xbegin()));
+        }
+
+        xtensor<double, 3> t = concatenate(xtuple(a, b), 1);
+        ASSERT_EQ(b(1, 1, 2), t(1, 3, 2));
+        ASSERT_EQ(a(1, 0, 1), t(1, 0, 1));
+    }
+
+    TEST(xbuilder, stack_assign)
+    {
+        xarray<double> a = arange<double>(6);
+        a.reshape({2, 3});
+        xarray<double> b = arange<double>(6, 12);
+        b.reshape({2, 3});
+        xarray<double> bt = arange<double>(6, 12);
+        bt.reshape({3, 2});
+        bt.transpose();
+
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            auto s = stack(xtuple(a, b, bt, a * b), axis);
+            xarray<double> res = s;
+            ASSERT_EQ(s.shape(), res.shape());
+            ASSERT_TRUE(std::equal(res.xbegin(), res.xend(), s.xbegin()));
+        }
+
+        xtensor<double, 3> t = stack(xtuple(a, b), 2);
+        ASSERT_EQ(b(1, 2), t(1, 2, 1));
+        ASSERT_EQ(a(0, 1), t(0, 1, 0));
+    }
+
+    TEST(xbuilder, parallel_assign)
+    {
+        thread_pool pool(4);
+        executor_scope scope(pool);
+
+        xarray<double> a = arange<double>(1 << 20);
+        a.reshape({1 << 10, 1 << 10});
+        xarray<double> b = a + 1.;
+
+        for (std::size_t axis = 0; axis < 2; ++axis)
+        {
+            auto c = concatenate(xtuple(a, b), axis);
+            xarray<double> res = c;
+            ASSERT_EQ(c.shape(), res.shape());
+            ASSERT_TRUE(std::equal(res.xbegin(), res.xend(), c.xbegin()));
+        }
+
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            auto s = stack(xtuple(a, b), axis);
+            xarray<double> res = s;
+            ASSERT_EQ(s.shape(), res.shape());
+            ASSERT_TRUE(std::equal(res.xbegin(), res.xend(), s.xbegin()));
+        }
+    }
+
     TEST(xbuilder, meshgrid)
     {
         auto mesh = meshgrid(linspace<double>(0.0, 1.0, 3), linspace<double>(0.0, 1.0, 2));
@@ -243,6 +360,36 @@ namespace xt
         ASSERT_TRUE(all(equal(std::get<1>(mesh), expect1)));
     }
 
+    TEST(xbuilder, meshgrid_3d)
+    {
+        xarray<int> x = {1, 2};
+        xarray<int> y = {3, 4, 5};
+        auto mesh = meshgrid(x, y, arange<int>(4));
+        xarray<int> m0 = std::get<0>(mesh);
+        xarray<int> m1 = std::get<1>(mesh);
+        xarray<int> m2 = std::get<2>(mesh);
+        std::vector<std::size_t> expected_shape = {2, 3, 4};
+        ASSERT_EQ(expected_shape, m0.shape());
+        ASSERT_EQ(expected_shape, m1.shape());
+        ASSERT_EQ(expected_shape, m2.shape());
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                for (std::size_t k = 0; k < 4; ++k)
+                {
+                    ASSERT_EQ(x(i), m0(i, j, k));
+                    ASSERT_EQ(y(j), m1(i, j, k));
+                    ASSERT_EQ(int(k), m2(i, j, k));
+                }
+            }
+        }
+
+        // the grid refers to its lvalue inputs
+        x(1) = 7;
+        ASSERT_EQ(7, std::get<0>(mesh)(1, 2, 3));
+    }
+
     TEST(xbuilder, triu)
     {
         xarray<double> e = xt::arange<double>(1, 10);
@@ -0,0 +1,160 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xreducer.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xchunked.hpp"
+
+namespace xt
+{
+    using std::size_t;
+    using shape_t = std::vector<std::size_t>;
+
+    inline std::size_t file_size(const std::string& filename)
+    {
+        std::ifstream stream(filename, std::ios::in | std::ios::binary | std::ios::ate);
+        return static_cast<std::size_t>(stream.tellg());
+    }
+
+    TEST(xchunked, append)
+    {
+        std::string filename = "test_xchunked_append.xtc";
+        xarray<double> a = arange<double>(70);
+        a.reshape({10, 7});
+        {
+            xchunked_writer<double> writer(filename, {4, 3}, chunk_compression::rle);
+            writer.append(view(a, range(0, 3), all()));
+            writer.append(view(a, range(3, 6), all()));
+            ASSERT_EQ(shape_t({6, 7}), writer.shape());
+        }
+        {
+            xchunked_writer<double> writer(filename);
+            ASSERT_EQ(shape_t({6, 7}), writer.shape());
+            writer.append(view(a, range(6, 10), all()));
+            ASSERT_THROW(writer.append(zeros<double>({2, 3})), broadcast_error);
+        }
+
+        xchunked_reader<double> reader(filename);
+        ASSERT_EQ(shape_t({10, 7}), reader.shape());
+        ASSERT_EQ(shape_t({4, 3}), reader.chunk_shape());
+        ASSERT_EQ(9u, reader.nb_chunks());
+        ASSERT_EQ(a(9, 6), reader.chunk(8)(1, 0));
+
+        auto c = load_chunked<double>(filename);
+        ASSERT_EQ(a.shape(), c.shape());
+        ASSERT_EQ(a(5, 4), c(5, 4));
+        ASSERT_EQ(a(9, 0), c(9, 0));
+        xarray<double> b = c;
+        ASSERT_EQ(a, b);
+
+        // other value types are converted element by element
+        xarray<long double> l = c;
+        ASSERT_EQ(xarray<long double>(a), l);
+        std::remove(filename.c_str());
+    }
+
+    TEST(xchunked, for_each_chunk)
+    {
+        std::string filename = "test_xchunked_for_each.xtc";
+        xarray<int> a = arange<int>(60);
+        a.reshape({3, 4, 5});
+        {
+            xchunked_writer<int> writer(filename, {2, 2, 2});
+            writer.append(a);
+        }
+
+        xchunked_reader<int> reader(filename);
+        ASSERT_EQ(12u, reader.nb_chunks());
+        size_t count = 0;
+        size_t nb_elements = 0;
+        reader.for_each_chunk([&](const shape_t& origin, const xarray<int>& chunk) {
+            ASSERT_EQ(a(origin[0], origin[1], origin[2]), chunk(0, 0, 0));
+            ++count;
+            nb_elements += chunk.size();
+        });
+        ASSERT_EQ(12u, count);
+        ASSERT_EQ(a.size(), nb_elements);
+
+        auto c = load_chunked<int>(filename);
+        ASSERT_EQ(sum(a)(), sum(c)());
+        ASSERT_EQ(xarray<int>(sum(a, {1})), xarray<int>(sum(c, {1})));
+        ASSERT_THROW(xchunked_reader<double> wrong(filename), std::runtime_error);
+        std::remove(filename.c_str());
+    }
+
+    TEST(xchunked, compression)
+    {
+        std::string raw = "test_xchunked_raw.xtc";
+        std::string packed = "test_xchunked_packed.xtc";
+        xarray<double> a = zeros<double>({64, 64});
+        a(10, 10) = 1.5;
+        {
+            xchunked_writer<double> raw_writer(raw, {16, 16});
+            raw_writer.append(a);
+            xchunked_writer<double> packed_writer(packed, {16, 16}, chunk_compression::rle);
+            packed_writer.append(a);
+        }
+        ASSERT_LT(file_size(packed) * 10, file_size(raw));
+
+        xarray<double> b = load_chunked<double>(packed);
+        ASSERT_EQ(a, b);
+        std::remove(raw.c_str());
+        std::remove(packed.c_str());
+    }
+
+    TEST(xchunked, concurrent_access)
+    {
+        std::string filename = "test_xchunked_concurrent.xtc";
+        xarray<double> a = arange<double>(2000);
+        a.reshape({40, 50});
+        {
+            xchunked_writer<double> writer(filename, {8, 8});
+            writer.append(a);
+        }
+
+        // a single chunk in the cache, so that the threads evict each
+        // other's chunks
+        xchunked_reader<double> reader(filename, 1);
+        std::vector<size_t> errors(4, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < errors.size(); ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (size_t i = t; i < 40; i += 2)
+                {
+                    for (size_t j = 0; j < 50; ++j)
+                    {
+                        size_t idx[2] = {i, j};
+                        if (reader.element(std::begin(idx), std::end(idx)) != a(i, j))
+                        {
+                            ++errors[t];
+                        }
+                    }
+                    if (reader.chunk((i / 8) * 7)(i % 8, 0) != a(i, 0))
+                    {
+                        ++errors[t];
+                    }
+                }
+            });
+        }
+        for (auto& th : threads)
+        {
+            th.join();
+        }
+        ASSERT_EQ(std::vector<size_t>(4, 0), errors);
+        std::remove(filename.c_str());
+    }
+}
@@ -0,0 +1,227 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xconvolve.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    // valid correlation of 2-D expressions with explicit padding and strides
+    template <class E1, class E2>
+    xarray<double> naive_correlate(const E1& a, const E2& k, size_t pad0, size_t pad1, size_t s0, size_t s1)
+    {
+        size_t h = a.shape()[0] + 2 * pad0;
+        size_t w = a.shape()[1] + 2 * pad1;
+        size_t kh = k.shape()[0];
+        size_t kw = k.shape()[1];
+        xarray<double> res = zeros<double>({(h - kh) / s0 + 1, (w - kw) / s1 + 1});
+        for (size_t i = 0; i < res.shape()[0]; ++i)
+        {
+            for (size_t j = 0; j < res.shape()[1]; ++j)
+            {
+                for (size_t p = 0; p < kh; ++p)
+                {
+                    for (size_t q = 0; q < kw; ++q)
+                    {
+                        size_t r = i * s0 + p;
+                        size_t c = j * s1 + q;
+                        if (r >= pad0 && r < pad0 + a.shape()[0] && c >= pad1 && c < pad1 + a.shape()[1])
+                        {
+                            res(i, j) += a(r - pad0, c - pad1) * k(p, q);
+                        }
+                    }
+                }
+            }
+        }
+        return res;
+    }
+
+    template <class E1, class E2>
+    void expect_near(const E1& expected, const E2& actual, double tol)
+    {
+        ASSERT_EQ(expected.shape(), actual.shape());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(expected.data()[i], actual.data()[i], tol);
+        }
+    }
+
+    TEST(xconvolve, convolve_1d)
+    {
+        xarray<double> a = {1., 2., 3.};
+        xarray<double> v = {0., 1., 0.5};
+
+        xarray<double> full = {0., 1., 2.5, 4., 1.5};
+        xarray<double> same = {1., 2.5, 4.};
+        xarray<double> valid = {2.5};
+        ASSERT_EQ(full, convolve(a, v));
+        ASSERT_EQ(same, convolve(a, v, convolve_mode::same));
+        ASSERT_EQ(valid, convolve(a, v, convolve_mode::valid));
+
+        xarray<int> ia = {1, 2, 3};
+        xarray<int> iv = {1, 1};
+        xarray<int> isame = {1, 3, 5};
+        ASSERT_EQ(isame, convolve(ia, iv, convolve_mode::same));
+
+        xarray<double> strided = {0., 2.5, 1.5};
+        ASSERT_EQ(strided, convolve(a, v, convolve_mode::full, {2}));
+        xarray<double> padded = {1., 2.5, 4.};
+        ASSERT_EQ(padded, convolve(a, v, {1}));
+    }
+
+    TEST(xconvolve, correlate_1d)
+    {
+        xarray<double> a = {1., 2., 3.};
+        xarray<double> v = {0., 1., 0.5};
+
+        xarray<double> valid = {3.5};
+        xarray<double> same = {2., 3.5, 3.};
+        xarray<double> full = {0.5, 2., 3.5, 3., 0.};
+        ASSERT_EQ(valid, correlate(a, v));
+        ASSERT_EQ(same, correlate(a, v, convolve_mode::same));
+        ASSERT_EQ(full, correlate(a, v, convolve_mode::full));
+
+        // long kernels are split in chunks and computed with gemm
+        xarray<double> x2 = random::rand<double>({1, 3000});
+        xarray<double> k2 = random::rand<double>({1, 600});
+        xarray<double> x = view(x2, 0);
+        xarray<double> k = view(k2, 0);
+        xarray<double> expected = view(naive_correlate(x2, k2, 0, 0, 1, 1), 0);
+        expect_near(expected, correlate(x, k), 1e-10);
+        xarray<double> fexpected = view(naive_correlate(x2, k2, 0, 599, 1, 1), 0);
+        expect_near(fexpected, correlate(x, k, convolve_mode::full), 1e-10);
+    }
+
+    TEST(xconvolve, long_kernel)
+    {
+        // as in numpy, the operands are swapped, and the result of a
+        // correlation reversed
+        xarray<double> a = {1., 2.};
+        xarray<double> v = {1., 2., 3., 4.};
+
+        xarray<double> full = {1., 4., 7., 10., 8.};
+        xarray<double> same = {1., 4., 7., 10.};
+        xarray<double> valid = {4., 7., 10.};
+        ASSERT_EQ(full, convolve(a, v));
+        ASSERT_EQ(same, convolve(a, v, convolve_mode::same));
+        ASSERT_EQ(valid, convolve(a, v, convolve_mode::valid));
+        ASSERT_EQ(same, convolve(v, a, convolve_mode::same));
+
+        xarray<double> cfull = {4., 11., 8., 5., 2.};
+        xarray<double> csame = {11., 8., 5., 2.};
+        xarray<double> cvalid = {11., 8., 5.};
+        ASSERT_EQ(cfull, correlate(a, v, convolve_mode::full));
+        ASSERT_EQ(csame, correlate(a, v, convolve_mode::same));
+        ASSERT_EQ(cvalid, correlate(a, v));
+
+        xarray<double> b = {1., 2., 3.};
+        xarray<double> w = {1., 1., 1., 1.};
+        xarray<double> bsame = {3., 6., 6., 5.};
+        ASSERT_EQ(bsame, convolve(b, w, convolve_mode::same));
+        ASSERT_EQ(bsame, correlate(b, w, convolve_mode::same));
+
+        xarray<double> m = random::rand<double>({4, 5});
+        xarray<double> k = random::rand<double>({6, 9});
+        for (auto mode : {convolve_mode::full, convolve_mode::same, convolve_mode::valid})
+        {
+            expect_near(convolve(k, m, mode), convolve(m, k, mode), 1e-12);
+            expect_near(xarray<double>(flip(flip(correlate(k, m, mode), 0), 1)), correlate(m, k, mode), 1e-12);
+        }
+        std::vector<size_t> shape = {3, 5};
+        ASSERT_EQ(shape, correlate(m, k).shape());
+    }
+
+    TEST(xconvolve, correlate_2d)
+    {
+        xarray<double> a = random::rand<double>({67, 301});
+        xarray<double> k3 = random::rand<double>({3, 3});
+        xarray<double> k11 = random::rand<double>({11, 11});
+        xarray<double> k41 = random::rand<double>({9, 41});
+
+        expect_near(naive_correlate(a, k3, 0, 0, 1, 1), correlate(a, k3), 1e-12);
+        expect_near(naive_correlate(a, k3, 1, 1, 1, 1), correlate(a, k3, convolve_mode::same), 1e-12);
+        expect_near(naive_correlate(a, k3, 2, 1, 2, 3), correlate(a, k3, {2, 1}, {2, 3}), 1e-12);
+
+        expect_near(naive_correlate(a, k11, 0, 0, 1, 1), correlate(a, k11), 1e-10);
+        expect_near(naive_correlate(a, k11, 10, 10, 1, 1), correlate(a, k11, convolve_mode::full), 1e-10);
+        expect_near(naive_correlate(a, k11, 5, 5, 3, 2), correlate(a, k11, {5, 5}, {3, 2}), 1e-10);
+
+        expect_near(naive_correlate(a, k41, 0, 0, 1, 1), correlate(a, k41), 1e-10);
+        expect_near(naive_correlate(a, k41, 4, 20, 1, 1), correlate(a, k41, convolve_mode::same), 1e-10);
+
+        // convolution flips the kernel
+        xarray<double> fk11 = flip(flip(k11, 0), 1);
+        expect_near(correlate(a, fk11, convolve_mode::same), convolve(a, k11, convolve_mode::same), 1e-10);
+        auto va = view(a, range(3, 40), all());
+        expect_near(naive_correlate(xarray<double>(va), k3, 0, 0, 1, 1), correlate(va, k3), 1e-12);
+    }
+
+    TEST(xconvolve, correlate_3d)
+    {
+        xarray<float> a = random::rand<float>({9, 10, 11});
+        xarray<float> k = random::rand<float>({3, 4, 5});
+        xarray<float> res = correlate(a, k, convolve_mode::valid, {1, 2, 1});
+        std::vector<size_t> shape = {7, 4, 7};
+        ASSERT_EQ(shape, res.shape());
+        for (size_t i = 0; i < 7; ++i)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                for (size_t l = 0; l < 7; ++l)
+                {
+                    double expected = 0.;
+                    for (size_t p = 0; p < 3; ++p)
+                    {
+                        for (size_t q = 0; q < 4; ++q)
+                        {
+                            for (size_t r = 0; r < 5; ++r)
+                            {
+                                expected += a(i + p, 2 * j + q, l + r) * k(p, q, r);
+                            }
+                        }
+                    }
+                    ASSERT_NEAR(expected, res(i, j, l), 1e-4);
+                }
+            }
+        }
+
+        xarray<float> k40 = random::rand<float>({2, 4, 40});
+        xarray<float> b = random::rand<float>({3, 5, 100});
+        xarray<float> res40 = correlate(b, k40);
+        for (size_t l = 0; l < 61; l += 20)
+        {
+            double expected = 0.;
+            for (size_t q = 0; q < 4; ++q)
+            {
+                for (size_t r = 0; r < 40; ++r)
+                {
+                    expected += b(1, 1 + q, l + r) * k40(0, q, r) + b(2, 1 + q, l + r) * k40(1, q, r);
+                }
+            }
+            ASSERT_NEAR(expected, res40(1, 1, l), 1e-3);
+        }
+
+        xarray<float> ones3 = ones<float>({3, 3, 3});
+        xarray<float> sums = convolve(ones<float>({4, 4, 4}), ones3, convolve_mode::same);
+        ASSERT_EQ(8.f, sums(0, 0, 0));
+        ASSERT_EQ(27.f, sums(1, 1, 1));
+
+        ASSERT_THROW(correlate(k, a, {0, 0, 0}), std::runtime_error);
+        ASSERT_THROW(correlate(a, k, {1, 1}), std::runtime_error);
+        ASSERT_THROW(correlate(a, k, convolve_mode::valid, {1, 0, 1}), std::runtime_error);
+        ASSERT_THROW(correlate(a, xarray<float>(ones<float>({3, 3}))), std::runtime_error);
+    }
+}
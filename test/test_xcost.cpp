@@ -0,0 +1,215 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xchunked.hpp"
+#include "xtensor/xcost.hpp"
+#include "xtensor/xexecutor.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xreducer.hpp"
+#include "xtensor/xvectorize.hpp"
+#include "xtensor/xview.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    // executor running the tasks inline and counting them
+    struct cost_counting_executor
+    {
+        std::size_t concurrency() const
+        {
+            return 4;
+        }
+
+        void execute(std::function<void()> task) const
+        {
+            ++m_count;
+            task();
+        }
+
+        mutable std::atomic<std::size_t> m_count{0};
+    };
+
+    // sets the thresholds of the cost model for the duration of a test
+    struct thresholds_guard
+    {
+        explicit thresholds_guard(const execution_thresholds& th)
+            : m_previous(get_execution_thresholds())
+        {
+            set_execution_thresholds(th);
+        }
+
+        ~thresholds_guard()
+        {
+            set_execution_thresholds(m_previous);
+        }
+
+        execution_thresholds m_previous;
+    };
+
+    TEST(xcost, element_cost)
+    {
+        xarray<double> a = random::rand<double>({20, 30});
+        EXPECT_EQ(1u, element_cost(a));
+        EXPECT_EQ(3u, element_cost(a + a));
+        EXPECT_EQ(2u, element_cost(a * 2.));
+        EXPECT_EQ(6u, element_cost(a / a));
+        EXPECT_EQ(element_cost(a + a) + 16u, element_cost(exp(a + a)));
+        EXPECT_EQ(element_cost(a), element_cost(view(a, 1, all())) - 1u);
+
+        // reducers account for the number of reduced elements
+        EXPECT_EQ(30u * 2u, element_cost(sum(a, {1})));
+        EXPECT_EQ(600u * 3u, element_cost(sum(a * 2.)));
+        EXPECT_EQ(3u, xexpression_cost<decltype(sum(a * 2.))>::value);
+    }
+
+    TEST(xcost, thresholds)
+    {
+        execution_thresholds th;
+        th.parallel_cost = 10;
+        th.default_parallel_cost = 20;
+        th.task_cost = 0;
+        thresholds_guard guard(th);
+        execution_thresholds res = get_execution_thresholds();
+        EXPECT_EQ(10u, res.parallel_cost);
+        EXPECT_EQ(20u, res.default_parallel_cost);
+        EXPECT_EQ(1u, res.task_cost);
+    }
+
+    TEST(xcost, assign)
+    {
+        xarray<double> a = random::rand<double>({100, 40});
+        xarray<double> b = random::rand<double>({40});
+        xarray<double> expected = a * b + 2. * a;
+
+        // small assignments run on the calling thread
+        cost_counting_executor counting;
+        xarray<double> res;
+        res.assign(a * b + 2. * a, counting);
+        EXPECT_EQ(0u, counting.m_count.load());
+        EXPECT_EQ(expected, res);
+
+        execution_thresholds th;
+        th.parallel_cost = 1000;
+        th.task_cost = 1000;
+        thresholds_guard guard(th);
+
+        xarray<double> pres;
+        pres.assign(a * b + 2. * a, counting);
+        EXPECT_LT(0u, counting.m_count.load());
+        EXPECT_EQ(expected, pres);
+
+        // reducers are evaluated by tasks holding their own copy
+        thread_pool pool(4);
+        xarray<double> c = random::rand<double>({50, 60, 30});
+        xarray<double> s = sum(c, {2});
+        xarray<double> ps;
+        ps.assign(sum(c, {2}), pool);
+        EXPECT_EQ(s, ps);
+
+        // expressions drawing from a sequential engine are not split
+        counting.m_count = 0;
+        xarray<double> r;
+        r.assign(a + random::rand<double>({100, 40}), counting);
+        EXPECT_EQ(0u, counting.m_count.load());
+    }
+
+    TEST(xcost, default_executor)
+    {
+        xarray<double> a = random::rand<double>({100, 40});
+        xarray<double> expected = sqrt(a) + a;
+
+        cost_counting_executor counting;
+        executor_scope scope(counting);
+        xarray<double> res = sqrt(a) + a;
+        EXPECT_EQ(0u, counting.m_count.load());
+
+        // whatever their size, since their functors may hold state
+        std::size_t calls = 0;
+        auto f = vectorize([&calls](double x) { ++calls; return x + 1.; });
+        xarray<double> big = zeros<double>({size_t(1) << 21});
+        xarray<double> fres = f(big);
+        EXPECT_EQ(0u, counting.m_count.load());
+        EXPECT_EQ(big.size(), calls);
+        {
+            thread_pool pool(4);
+            executor_scope pool_scope(pool);
+            calls = 0;
+            fres = f(big);
+            EXPECT_EQ(big.size(), calls);
+        }
+
+        execution_thresholds th;
+        th.default_parallel_cost = 1000;
+        th.task_cost = 10000;
+        thresholds_guard guard(th);
+        xarray<double> pres = sqrt(a) + a;
+        EXPECT_LT(0u, counting.m_count.load());
+        EXPECT_EQ(expected, pres);
+
+        // views as left hand side
+        xarray<double> dst = zeros<double>({110, 40});
+        view(dst, range(5, 105), all()) = sqrt(a) + a;
+        xarray<double> vexpected = zeros<double>({110, 40});
+        {
+            executor_scope serial(serial_executor{});
+            view(vexpected, range(5, 105), all()) = sqrt(a) + a;
+        }
+        EXPECT_EQ(vexpected, dst);
+    }
+
+    TEST(xcost, generators)
+    {
+        execution_thresholds th;
+        th.parallel_cost = 1000;
+        th.default_parallel_cost = 1000;
+        th.task_cost = 1000;
+        thresholds_guard guard(th);
+
+        // generators are split only when their functor declares it
+        cost_counting_executor counting;
+        xarray<double> r;
+        r.assign(arange<double>(10000) + 1., counting);
+        EXPECT_LT(0u, counting.m_count.load());
+        EXPECT_EQ(10000., r(9999));
+
+        std::string filename = "test_xcost_generators.xtc";
+        xarray<double> a = random::rand<double>({200, 150});
+        {
+            xchunked_writer<double> writer(filename, {16, 16});
+            writer.append(a);
+        }
+        auto c = load_chunked<double>(filename);
+        counting.m_count = 0;
+        r.assign(c + 1., counting);
+        EXPECT_EQ(0u, counting.m_count.load());
+
+        // evaluated with several threads, the default executor being a
+        // single thread on some machines
+        thread_pool pool(8);
+        executor_scope scope(pool);
+        xarray<double> expected = a + 1.;
+        xarray<double> b = c + 1.;
+        EXPECT_EQ(expected, b);
+        xarray<double> s = sum(c + 1., {1});
+        EXPECT_EQ(xarray<double>(sum(expected, {1})), s);
+        xarray<double> pr = arange<double>(100000) * 2.;
+        EXPECT_EQ(2. * 99999., pr(99999));
+        std::remove(filename.c_str());
+    }
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xcsv.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    TEST(xcsv, load)
+    {
+        std::stringstream stream("x,y,z\n1.5, -2, 3e2\n\n4,.25,-6.5E-1\r\n");
+        xarray<double> a = load_csv<double>(stream, ',', 1);
+        xarray<double> expected = {{1.5, -2., 300.}, {4., 0.25, -0.65}};
+        ASSERT_EQ(expected, a);
+
+        std::stringstream istream("1;2\n-3;4\n");
+        xtensor<int, 2> b;
+        load_csv(istream, b, ';');
+        xtensor<int, 2> expected_b = {{1, 2}, {-3, 4}};
+        ASSERT_EQ(expected_b, b);
+
+        std::stringstream empty("");
+        ASSERT_EQ(0u, load_csv<double>(empty).size());
+    }
+
+    TEST(xcsv, parse_float)
+    {
+        const char* values[] = {"0.1", "123456789.123456789", "1e-300", "2.2250738585072014e-308",
+                                "9007199254740993", "-0", "1e23", "0.000001234", "3.14159265358979323846"};
+        std::string text;
+        for (const char* v : values)
+        {
+            text += v;
+            text += '\n';
+        }
+        std::stringstream stream(text);
+        xarray<double> a = load_csv<double>(stream);
+        ASSERT_EQ(9u, a.shape()[0]);
+        for (size_t i = 0; i < 9; ++i)
+        {
+            ASSERT_EQ(std::strtod(values[i], nullptr), a(i, 0));
+        }
+
+        std::stringstream special("nan,inf,-inf\n");
+        xarray<double> b = load_csv<double>(special);
+        ASSERT_TRUE(std::isnan(b(0, 0)));
+        ASSERT_EQ(std::numeric_limits<double>::infinity(), b(0, 1));
+        ASSERT_EQ(-std::numeric_limits<double>::infinity(), b(0, 2));
+    }
+
+    TEST(xcsv, errors)
+    {
+        std::stringstream missing("1,2\n3\n");
+        ASSERT_THROW(load_csv<double>(missing), std::runtime_error);
+        std::stringstream extra("1,2\n3,4,5\n");
+        ASSERT_THROW(load_csv<double>(extra), std::runtime_error);
+        std::stringstream invalid("1,a\n");
+        ASSERT_THROW(load_csv<double>(invalid), std::runtime_error);
+        std::stringstream overflow("300\n");
+        ASSERT_THROW(load_csv<unsigned char>(overflow), std::runtime_error);
+        std::stringstream negative("-1\n");
+        ASSERT_THROW(load_csv<unsigned int>(negative), std::runtime_error);
+    }
+
+    TEST(xcsv, file)
+    {
+        // several parsing tasks
+        std::string filename = "test_xcsv_file.csv";
+        size_t nb_rows = 200000;
+        {
+            std::ofstream out(filename);
+            out << std::setprecision(17);
+            out << "a,b,c,d\n";
+            for (size_t i = 0; i < nb_rows; ++i)
+            {
+                out << i << ',' << double(i) / 4 << ',' << -double(i) << ",1e-3\n";
+            }
+        }
+        xarray<double> a = load_csv<double>(filename, ',', 1);
+        ASSERT_EQ(nb_rows, a.shape()[0]);
+        ASSERT_EQ(4u, a.shape()[1]);
+        for (size_t i = 0; i < nb_rows; i += 997)
+        {
+            ASSERT_EQ(double(i), a(i, 0));
+            ASSERT_EQ(double(i) / 4, a(i, 1));
+            ASSERT_EQ(-double(i), a(i, 2));
+            ASSERT_EQ(1e-3, a(i, 3));
+        }
+        ASSERT_EQ(double(nb_rows - 1), a(nb_rows - 1, 0));
+        std::remove(filename.c_str());
+    }
+
+    TEST(xcsv, blocks)
+    {
+        std::stringstream stream("# header\n1,2\n3,4\n5,6\n\n7,8\n9,10\n");
+        std::vector<xarray<int>> blocks;
+        load_csv_blocks<int>(stream, 2, [&blocks](const xarray<int>& block) { blocks.push_back(block); }, ',', 1);
+        ASSERT_EQ(3u, blocks.size());
+        xarray<int> expected_0 = {{1, 2}, {3, 4}};
+        xarray<int> expected_2 = {{9, 10}};
+        ASSERT_EQ(expected_0, blocks[0]);
+        ASSERT_EQ(expected_2, blocks[2]);
+
+        std::stringstream mismatch("1,2\n3,4\n5\n");
+        ASSERT_THROW(load_csv_blocks<int>(mismatch, 2, [](const xarray<int>&) {}), std::runtime_error);
+    }
+}
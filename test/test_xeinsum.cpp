@@ -0,0 +1,111 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xeinsum.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    template <class E1, class E2>
+    void expect_near(const E1& expected, const E2& actual, double tolerance = 1e-10)
+    {
+        ASSERT_EQ(expected.dimension(), actual.dimension());
+        ASSERT_TRUE(std::equal(expected.shape().cbegin(), expected.shape().cend(), actual.shape().cbegin()));
+        xarray<double> e = expected;
+        xarray<double> a = actual;
+        for (size_t i = 0; i < e.size(); ++i)
+        {
+            ASSERT_NEAR(e.data()[i], a.data()[i], tolerance);
+        }
+    }
+
+    TEST(xeinsum, single)
+    {
+        xarray<double> a = {{1., 2., 3.}, {4., 5., 6.}, {7., 8., 9.}};
+        ASSERT_EQ(15., einsum("ii", a)());
+        ASSERT_EQ(45., einsum("ij->", a)());
+        xarray<double> diag = {1., 5., 9.};
+        ASSERT_EQ(diag, einsum("ii->i", a));
+        xarray<double> cols = {12., 15., 18.};
+        ASSERT_EQ(cols, einsum("ij->j", a));
+        xarray<double> t = {{1., 4., 7.}, {2., 5., 8.}, {3., 6., 9.}};
+        ASSERT_EQ(t, einsum("ij->ji", a));
+    }
+
+    TEST(xeinsum, pair)
+    {
+        xarray<double> a = random::rand<double>({4, 5});
+        xarray<double> b = random::rand<double>({5, 3});
+        expect_near(dot(a, b), einsum("ij,jk->ik", a, b));
+        expect_near(dot(a, b), einsum("ij,jk", a, b));
+        expect_near(einsum("ij->ji", dot(a, b)), einsum("ij,jk->ki", a, b));
+
+        xarray<double> u = {1., 2., 3.};
+        xarray<double> v = {4., 5.};
+        xarray<double> outer = {{4., 5.}, {8., 10.}, {12., 15.}};
+        ASSERT_EQ(outer, einsum("i,j->ij", u, v));
+        ASSERT_EQ(14., einsum("i,i", u, u)());
+        xarray<double> prod = {1., 4., 9.};
+        ASSERT_EQ(prod, einsum("i,i->i", u, u));
+
+        xarray<double> x = random::rand<double>({2, 3, 4});
+        xarray<double> y = random::rand<double>({2, 4, 5});
+        expect_near(matmul(x, y), einsum("bij,bjk->bik", x, y));
+        // operand read through a strided view
+        expect_near(matmul(flip(x, 2), y), einsum("bij,bjk->bik", flip(x, 2), y));
+    }
+
+    TEST(xeinsum, chain)
+    {
+        xarray<double> a = random::rand<double>({10, 3});
+        xarray<double> b = random::rand<double>({3, 20});
+        xarray<double> c = random::rand<double>({20, 2});
+        xarray<double> d = random::rand<double>({2, 7});
+        xarray<double> expected = dot(dot(dot(a, b), c), d);
+        expect_near(expected, einsum("ij,jk,kl,lm->im", a, b, c, d));
+
+        // contraction in which a subscript appears in three operands
+        xarray<double> e = random::rand<double>({4});
+        xarray<double> res = einsum("ij,jk,j->ik", a, b, xarray<double>(random::rand<double>({3})));
+        ASSERT_EQ(10u, res.shape()[0]);
+        ASSERT_EQ(20u, res.shape()[1]);
+        xarray<double> s = einsum("i,i,i->", e, e, e);
+        ASSERT_NEAR(double(sum(e * e * e)()), s(), 1e-12);
+    }
+
+    TEST(xeinsum, plan)
+    {
+        std::array<size_t, 256> sizes;
+        sizes['i'] = 1000;
+        sizes['j'] = 2;
+        sizes['k'] = 1000;
+        sizes['l'] = 2;
+        // contracting a and b first costs 4e6 multiply-adds and creates a
+        // 1000 x 1000 intermediate, contracting b and c first costs 8e3
+        std::vector<std::string> labels = {"ij", "jk", "kl"};
+        auto path = detail::einsum_plan(labels, "il", sizes);
+        ASSERT_EQ(2u, path.size());
+        ASSERT_EQ(std::make_pair(size_t(1), size_t(2)), path[0]);
+
+        ASSERT_THROW(einsum("ij,jk", random::rand<double>({2, 3}), random::rand<double>({4, 2})), std::runtime_error);
+        ASSERT_THROW(einsum("ijk", random::rand<double>({2, 3})), std::runtime_error);
+        ASSERT_THROW(einsum("ij->k", random::rand<double>({2, 3})), std::runtime_error);
+        ASSERT_THROW(einsum("...i", random::rand<double>({2, 3})), std::runtime_error);
+    }
+}
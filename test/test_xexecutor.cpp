@@ -0,0 +1,291 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbroadcast.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xchunked.hpp"
+#include "xtensor/xcsv.hpp"
+#include "xtensor/xeval.hpp"
+#include "xtensor/xexecutor.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xreducer.hpp"
+#include "xtensor/xview.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    // executor running the tasks inline and counting them
+    struct counting_executor
+    {
+        std::size_t concurrency() const
+        {
+            return 4;
+        }
+
+        void execute(std::function<void()> task) const
+        {
+            ++m_count;
+            task();
+        }
+
+        mutable std::atomic<std::size_t> m_count{0};
+    };
+
+    TEST(xexecutor, parallel_for)
+    {
+        thread_pool pool(4);
+        EXPECT_EQ(4u, pool.size());
+        std::vector<int> res(1000, 0);
+        parallel_for(pool, res.size(), [&res](size_t i) { res[i] = static_cast<int>(i); });
+        for (size_t i = 0; i < res.size(); ++i)
+        {
+            ASSERT_EQ(static_cast<int>(i), res[i]);
+        }
+
+        // nested loops complete even when all the workers are busy
+        std::atomic<size_t> count(0);
+        parallel_for(pool, 16, [&pool, &count](size_t) {
+            parallel_for(pool, 100, [&count](size_t) { ++count; });
+        });
+        EXPECT_EQ(1600u, count.load());
+
+        // the first exception is rethrown once all the calls have completed
+        std::atomic<size_t> calls(0);
+        EXPECT_THROW(parallel_for(pool, 100, [&calls](size_t i) {
+            ++calls;
+            if (i == 42)
+            {
+                throw std::runtime_error("parallel_for");
+            }
+        }), std::runtime_error);
+        EXPECT_EQ(100u, calls.load());
+
+        // serial executor
+        serial_executor serial;
+        std::vector<size_t> order;
+        parallel_for(serial, 5, [&order](size_t i) { order.push_back(i); });
+        std::vector<size_t> expected = {0, 1, 2, 3, 4};
+        EXPECT_EQ(expected, order);
+    }
+
+    TEST(xexecutor, default_executor)
+    {
+        counting_executor counting;
+        {
+            executor_scope scope(counting);
+            EXPECT_EQ(4u, default_executor().concurrency());
+            std::atomic<size_t> count(0);
+            parallel_for(default_executor(), 10, [&count](size_t) { ++count; });
+            EXPECT_EQ(10u, count.load());
+            EXPECT_EQ(3u, counting.m_count.load());
+        }
+
+        executor previous = default_executor();
+        set_default_executor(serial_executor());
+        EXPECT_EQ(1u, default_executor().concurrency());
+        {
+            executor_scope scope(counting);
+            EXPECT_EQ(4u, default_executor().concurrency());
+        }
+        EXPECT_EQ(1u, default_executor().concurrency());
+        set_default_executor(previous);
+        EXPECT_EQ(previous.concurrency(), default_executor().concurrency());
+    }
+
+    TEST(xexecutor, executor_scope)
+    {
+        // the functions without executor parameter run on the scoped executor
+        counting_executor counting;
+        executor_scope scope(counting);
+
+        xarray<double> a = arange<double>(1 << 20);
+        a.reshape({1 << 10, 1 << 10});
+        size_t count = counting.m_count.load();
+        xarray<double> c = concatenate(xtuple(a, a), 1);
+        EXPECT_LT(count, counting.m_count.load());
+        EXPECT_EQ(a(3, 5), c(3, (1 << 10) + 5));
+
+        std::ostringstream out;
+        for (size_t i = 0; i < 200000; ++i)
+        {
+            out << i << "," << 2 * i << "\n";
+        }
+        std::istringstream in(out.str());
+        count = counting.m_count.load();
+        xarray<size_t> m = load_csv<size_t>(in);
+        EXPECT_LT(count, counting.m_count.load());
+        EXPECT_EQ(200000u, m.shape()[0]);
+        EXPECT_EQ(2 * 199999u, m(199999, 1));
+
+        std::string filename = "test_xexecutor_scope.xtc";
+        {
+            xarray<double> b = arange<double>(64);
+            b.reshape({8, 8});
+            xchunked_writer<double> writer(filename, {4, 4});
+            writer.append(b);
+        }
+        {
+            xchunked_reader<double> reader(filename);
+            count = counting.m_count.load();
+            size_t nb_read = 0;
+            reader.for_each_raw_chunk([&nb_read](size_t, const std::vector<char>&) { ++nb_read; });
+            EXPECT_EQ(reader.nb_chunks(), nb_read);
+            EXPECT_EQ(count + reader.nb_chunks(), counting.m_count.load());
+        }
+        std::remove(filename.c_str());
+    }
+
+    TEST(xexecutor, submit)
+    {
+        thread_pool pool(2);
+        xfuture<int> f = submit(pool, []() { return 42; });
+        EXPECT_TRUE(f.valid());
+        EXPECT_EQ(42, f.get());
+        EXPECT_FALSE(f.valid());
+
+        int value = 0;
+        xfuture<void> v = submit(pool, [&value]() { value = 3; });
+        v.wait();
+        EXPECT_TRUE(v.is_ready());
+        EXPECT_EQ(3, value);
+        v.get();
+
+        xfuture<int> e = submit(pool, []() -> int { throw std::runtime_error("submit"); });
+        EXPECT_THROW(e.get(), std::runtime_error);
+
+        // results of tasks run by a serial executor are ready immediately
+        xfuture<std::vector<int>> s = submit(serial_executor(), []() { return std::vector<int>(3, 1); });
+        EXPECT_TRUE(s.is_ready());
+        EXPECT_EQ(3u, s.get().size());
+    }
+
+    TEST(xexecutor, assign)
+    {
+        thread_pool pool(4);
+        xarray<double> a = random::rand<double>({300, 400});
+        xarray<double> b = random::rand<double>({400});
+
+        xarray<double> expected = a * b + 2. * a;
+        xarray<double> res;
+        res.assign(a * b + 2. * a, pool);
+        EXPECT_EQ(expected, res);
+
+        // non contiguous right hand side
+        xarray<double> t = view(a, range(0, 300, 2), all());
+        xarray<double> tres;
+        tres.assign(view(a, range(0, 300, 2), all()) + 1., pool);
+        EXPECT_EQ(t + 1., tres);
+
+        xtensor<double, 2> bc;
+        bc.assign(broadcast(b, {300, 400}), pool);
+        EXPECT_EQ(xarray<double>(broadcast(b, {300, 400})), xarray<double>(bc));
+
+        // view as left hand side
+        xarray<double> dst = zeros<double>({310, 400});
+        auto v = view(dst, range(5, 305), all());
+        v.assign(a - b, pool);
+        xarray<double> dst_expected = zeros<double>({310, 400});
+        view(dst_expected, range(5, 305), all()) = a - b;
+        EXPECT_EQ(dst_expected, dst);
+
+        // reducer
+        xarray<double> c = random::rand<double>({200, 300, 4});
+        xarray<double> s = sum(c, {2});
+        xarray<double> ps;
+        ps.assign(sum(c, {2}), pool);
+        EXPECT_EQ(s, ps);
+
+        // custom executor
+        counting_executor counting;
+        xarray<double> cres;
+        cres.assign(a * b + 2. * a, counting);
+        EXPECT_EQ(expected, cres);
+        EXPECT_LT(0u, counting.m_count.load());
+    }
+
+    TEST(xexecutor, eval)
+    {
+        thread_pool pool(3);
+        xarray<double> a = random::rand<double>({500, 200});
+        auto&& same = eval(a, pool);
+        EXPECT_EQ(&a, &same);
+
+        auto&& e = eval(a * 3. + 1., pool);
+        bool type_eq = std::is_same<decltype(e), xarray<double>&&>::value;
+        EXPECT_TRUE(type_eq);
+        xarray<double> expected = a * 3. + 1.;
+        EXPECT_EQ(expected, e);
+
+        xtensor<double, 2> t = a;
+        auto&& te = eval(t * t, pool);
+        bool ttype_eq = std::is_same<decltype(te), xtensor<double, 2>&&>::value;
+        EXPECT_TRUE(ttype_eq);
+        xtensor<double, 2> texpected = t * t;
+        EXPECT_EQ(texpected, te);
+    }
+
+    TEST(xexecutor, eval_async)
+    {
+        thread_pool pool(4);
+        xarray<double> a = random::rand<double>({300, 200});
+        xarray<double> b = random::rand<double>({200});
+
+        auto f = eval_async(a * b + 1., pool);
+        bool type_eq = std::is_same<decltype(f), xfuture<xarray<double>>>::value;
+        EXPECT_TRUE(type_eq);
+        // work done by the caller while the expression is evaluated
+        xarray<double> c = random::rand<double>({300, 200});
+        xarray<double> res = f.get();
+        EXPECT_FALSE(f.valid());
+        EXPECT_EQ(xarray<double>(a * b + 1.), res);
+
+        xtensor<double, 2> t = a;
+        auto tf = eval_async(sum(t, {1}) * 2., pool);
+        bool ttype_eq = std::is_same<decltype(tf), xfuture<xtensor<double, 1>>>::value;
+        EXPECT_TRUE(ttype_eq);
+        xtensor<double, 1> texpected = sum(t, {1}) * 2.;
+        EXPECT_EQ(texpected, tf.get());
+
+        // containers are copied into the result
+        auto cf = eval_async(c);
+        EXPECT_EQ(c, cf.get());
+    }
+
+    TEST(xexecutor, assign_async)
+    {
+        thread_pool pool(4);
+        xarray<double> a = random::rand<double>({400, 300});
+        xarray<double> res;
+        xfuture<void> f = assign_async(res, 2. * a - 1., pool);
+        f.wait();
+        EXPECT_TRUE(f.is_ready());
+        f.get();
+        EXPECT_EQ(xarray<double>(2. * a - 1.), res);
+
+        // view as left hand side
+        xarray<double> dst = zeros<double>({410, 300});
+        xfuture<void> vf = assign_async(view(dst, range(5, 405), all()), a + 1.);
+        vf.get();
+        xarray<double> dst_expected = zeros<double>({410, 300});
+        view(dst_expected, range(5, 405), all()) = a + 1.;
+        EXPECT_EQ(dst_expected, dst);
+    }
+}
@@ -0,0 +1,186 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xfft.hpp"
+
+namespace xt
+{
+    using std::size_t;
+    using cplx = std::complex<double>;
+
+    // direct computation of the transform of the lanes along the last axis
+    template <class E>
+    xarray<cplx> naive_dft(const E& e, bool inverse)
+    {
+        xarray<cplx> a = e;
+        xarray<cplx> res(a.shape());
+        size_t n = a.shape().back();
+        size_t lanes = a.size() / n;
+        double sign = inverse ? 1. : -1.;
+        for (size_t l = 0; l < lanes; ++l)
+        {
+            for (size_t k = 0; k < n; ++k)
+            {
+                cplx acc = 0.;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    double phase = sign * 2. * M_PI * double((j * k) % n) / double(n);
+                    acc += a.data()[l * n + j] * cplx(std::cos(phase), std::sin(phase));
+                }
+                res.data()[l * n + k] = inverse ? acc / double(n) : acc;
+            }
+        }
+        return res;
+    }
+
+    template <class E1, class E2>
+    void expect_near(const E1& expected, const E2& actual, double tol)
+    {
+        ASSERT_EQ(expected.shape(), actual.shape());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(std::real(expected.data()[i]), std::real(actual.data()[i]), tol);
+            ASSERT_NEAR(std::imag(expected.data()[i]), std::imag(actual.data()[i]), tol);
+        }
+    }
+
+    xarray<cplx> random_complex(const std::vector<size_t>& shape)
+    {
+        xarray<double> re = random::rand<double>(shape);
+        xarray<double> im = random::rand<double>(shape);
+        xarray<cplx> res(shape);
+        for (size_t i = 0; i < res.size(); ++i)
+        {
+            res.data()[i] = cplx(re.data()[i], im.data()[i]);
+        }
+        return res;
+    }
+
+    TEST(xfft, fft_1d)
+    {
+        xarray<double> a = {1., 2., 3., 4.};
+        xarray<cplx> expected = {cplx(10., 0.), cplx(-2., 2.), cplx(-2., 0.), cplx(-2., -2.)};
+        expect_near(expected, fft::fft(a), 1e-12);
+
+        // radices 2, 3, 4, 5, generic odd ones and Bluestein
+        for (size_t n : {1, 2, 3, 5, 6, 7, 8, 12, 17, 30, 45, 64, 97, 121, 210, 1000})
+        {
+            xarray<cplx> x = random_complex({n});
+            expect_near(naive_dft(x, false), fft::fft(x), 1e-9);
+            expect_near(naive_dft(x, true), fft::ifft(x), 1e-9);
+            expect_near(x, fft::ifft(fft::fft(x)), 1e-12);
+        }
+
+        xarray<float> f = random::rand<float>({37});
+        xarray<std::complex<float>> ff = fft::fft(f);
+        expect_near(naive_dft(f, false), ff, 1e-4);
+    }
+
+    TEST(xfft, fft_axis)
+    {
+        xarray<cplx> x = random_complex({6, 7, 10});
+        expect_near(naive_dft(x, false), fft::fft(x, 2), 1e-10);
+
+        xarray<cplx> res = fft::fft(x, 1);
+        for (size_t i = 0; i < 6; ++i)
+        {
+            for (size_t k = 0; k < 10; ++k)
+            {
+                xarray<cplx> lane = view(x, i, all(), k);
+                xarray<cplx> t = naive_dft(lane, false);
+                for (size_t j = 0; j < 7; ++j)
+                {
+                    ASSERT_NEAR(t(j).real(), res(i, j, k).real(), 1e-10);
+                    ASSERT_NEAR(t(j).imag(), res(i, j, k).imag(), 1e-10);
+                }
+            }
+        }
+
+        // strided views are read in place
+        auto v = view(x, range(1, 5), 3, all());
+        expect_near(naive_dft(xarray<cplx>(v), false), fft::fft(v), 1e-10);
+
+        // an empty expression has no lane to transform
+        xarray<double> e = zeros<double>({0, 3});
+        std::vector<size_t> e_shape = {0, 3};
+        EXPECT_EQ(e_shape, fft::fft(e, 1).shape());
+        EXPECT_EQ(0u, fft::rfft(e).size());
+        EXPECT_EQ(0u, fft::irfft(xarray<cplx>(e)).size());
+
+        ASSERT_THROW(fft::fft(x, 3), std::runtime_error);
+    }
+
+    TEST(xfft, rfft)
+    {
+        for (size_t n : {1, 2, 3, 4, 9, 16, 30, 34, 67, 100})
+        {
+            xarray<double> x = random::rand<double>(std::vector<size_t>{3, n});
+            xarray<cplx> full = naive_dft(x, false);
+            xarray<cplx> expected = view(full, all(), range(size_t(0), n / 2 + 1));
+            xarray<cplx> res = fft::rfft(x);
+            expect_near(expected, res, 1e-10);
+            expect_near(x, fft::irfft(res, n, 1), 1e-12);
+        }
+
+        xarray<double> a = {1., 2., 3., 4.};
+        xarray<cplx> expected = {cplx(10., 0.), cplx(-2., 2.), cplx(-2., 0.)};
+        expect_near(expected, fft::rfft(a), 1e-12);
+        expect_near(a, fft::irfft(expected), 1e-12);
+
+        xarray<int> ia = {1, 2, 3, 4};
+        expect_near(expected, fft::rfft(ia), 1e-12);
+    }
+
+    TEST(xfft, fftn)
+    {
+        xarray<cplx> x = random_complex({4, 6, 5});
+        xarray<cplx> res = fft::fftn(x);
+        xarray<cplx> expected = fft::fft(fft::fft(fft::fft(x, 0), 1), 2);
+        expect_near(expected, res, 1e-10);
+        expect_near(x, fft::ifftn(res), 1e-12);
+
+        xarray<double> r = random::rand<double>({5, 3, 8});
+        xarray<cplx> rres = fft::rfftn(r);
+        xarray<cplx> rfull = fft::fftn(r);
+        expect_near(xarray<cplx>(view(rfull, all(), all(), range(0, 5))), rres, 1e-10);
+        expect_near(r, fft::irfftn(rres), 1e-12);
+
+        // lanes distributed over several threads
+        xarray<cplx> big = random_complex({64, 4096});
+        expect_near(big, fft::ifft(fft::fft(big)), 1e-12);
+    }
+
+    TEST(xfft, xtensor)
+    {
+        xtensor<double, 1> a = {1., 2., 3., 4.};
+        xarray<cplx> expected = {cplx(10., 0.), cplx(-2., 2.), cplx(-2., 0.), cplx(-2., -2.)};
+        expect_near(expected, fft::fft(a), 1e-12);
+        expect_near(xarray<cplx>(view(expected, range(size_t(0), size_t(3)))), fft::rfft(a), 1e-12);
+
+        xarray<double> aa = a;
+        xtensor<cplx, 1> c = {cplx(10., 0.), cplx(-2., 2.), cplx(-2., 0.)};
+        expect_near(aa, fft::irfft(c), 1e-12);
+        xtensor<cplx, 1> ce = expected;
+        expect_near(aa, fft::ifft(ce), 1e-12);
+
+        xtensor<double, 2> m = random::rand<double>({3, 8});
+        xarray<double> ma = m;
+        expect_near(fft::fftn(ma), fft::fftn(m), 1e-12);
+        expect_near(fft::rfft(ma, 0), fft::rfft(m, 0), 1e-12);
+        expect_near(ma, fft::irfftn(fft::rfftn(m)), 1e-12);
+    }
+}
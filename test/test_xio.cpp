@@ -8,6 +8,7 @@
 
 #include "gtest/gtest.h"
 
+#include <cmath>
 #include <vector>
 #include <algorithm>
 #include <sstream>
@@ -80,6 +81,38 @@ namespace xt
         EXPECT_EQ("{{1, 2, 3, 4}}", out_4.str());
     }
 
+    TEST(xio, column_major)
+    {
+        xarray<double> c({2, 3}, layout::column_major);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                c(i, j) = double(3 * i + j + 1);
+            }
+        }
+        std::stringstream out;
+        out << c;
+        EXPECT_EQ("{{ 1.,  2.,  3.},\n { 4.,  5.,  6.}}", out.str());
+    }
+
+    TEST(xio, nan_inf_only)
+    {
+        double inf = std::numeric_limits<double>::infinity();
+
+        std::stringstream out_nan;
+        out_nan << xarray<double>{std::nan("xnan")};
+        EXPECT_EQ("{nan.}", out_nan.str());
+
+        std::stringstream out_inf;
+        out_inf << xarray<double>{inf, -inf};
+        EXPECT_EQ("{inf., -inf.}", out_inf.str());
+
+        std::stringstream out_tiny;
+        out_tiny << xarray<double>{2.5e-5, inf};
+        EXPECT_EQ("{ 0.000025,       inf}", out_tiny.str());
+    }
+
     TEST(xio, random_nan_inf)
     {
         xt::random::seed(123);
@@ -246,5 +279,26 @@ namespace xt
 
         EXPECT_EQ(custom_formatter_result, out.str());
     }
-}
 
+    TEST(xio, large)
+    {
+        // longer than the blocks in which the text is written
+        xt::print_options::set_threshold(100000);
+        xt::xarray<int> e = xt::ones<int>({100000});
+        std::stringstream out;
+        out << e;
+        std::string res = out.str();
+        // 25 elements per line, each line break adds a newline and an indent
+        EXPECT_EQ(100000u * 3u + 3999u * 2u, res.size());
+        EXPECT_EQ("{1, 1, 1", res.substr(0, 8));
+        EXPECT_EQ("1, 1, 1}", res.substr(res.size() - 8));
+        xt::print_options::set_threshold(1000);
+
+        xt::print_options::set_edge_items(1);
+        xt::xarray<double> a = xt::arange<double>(2000);
+        std::stringstream out_edge;
+        out_edge << a;
+        EXPECT_EQ("{    0., ...,  1999.}", out_edge.str());
+        xt::print_options::set_edge_items(3);
+    }
+}
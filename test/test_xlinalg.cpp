@@ -0,0 +1,483 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xlinalg.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    template <class E1, class E2>
+    xarray<double> naive_dot(const E1& a, const E2& b)
+    {
+        size_t m = a.shape()[0];
+        size_t k = a.shape()[1];
+        size_t n = b.shape()[1];
+        xarray<double> res = zeros<double>({m, n});
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                for (size_t p = 0; p < k; ++p)
+                {
+                    res(i, j) += a(i, p) * b(p, j);
+                }
+            }
+        }
+        return res;
+    }
+
+    TEST(xlinalg, dot)
+    {
+        xarray<double> a = {{1., 2., 3.}, {4., 5., 6.}};
+        xarray<double> b = {{1., 2.}, {3., 4.}, {5., 6.}};
+        xarray<double> expected = {{22., 28.}, {49., 64.}};
+        ASSERT_EQ(expected, dot(a, b));
+
+        xtensor<int, 2> ia = {{1, 2}, {3, 4}};
+        xtensor<int, 2> ib = {{1, 0}, {0, 1}};
+        xarray<int> iexpected = {{1, 2}, {3, 4}};
+        ASSERT_EQ(iexpected, dot(ia, ib));
+
+        xarray<double> rexpected = {{1., 2.}, {3., 4.}};
+        ASSERT_EQ(rexpected, dot(ia, ib * 1.));
+
+        ASSERT_THROW(dot(a, a), std::runtime_error);
+        ASSERT_THROW(dot(a, xarray<double>(ones<double>({3, 2, 1}))), std::runtime_error);
+    }
+
+    TEST(xlinalg, dot_vector)
+    {
+        xarray<double> a = {{1., 2., 3.}, {4., 5., 6.}};
+        xarray<double> v = {1., 0., -1.};
+        xarray<double> w = {1., 2.};
+
+        xarray<double> av = {-2., -2.};
+        ASSERT_EQ(av, dot(a, v));
+        xarray<double> wa = {9., 12., 15.};
+        ASSERT_EQ(wa, dot(w, a));
+
+        auto vv = dot(v, v);
+        ASSERT_EQ(0u, vv.dimension());
+        ASSERT_EQ(2., vv());
+    }
+
+    TEST(xlinalg, dot_blocks)
+    {
+        // sizes crossing the register and cache blocks, large enough to
+        // run on several threads
+        xarray<double> a = random::rand<double>({203, 517});
+        xarray<double> b = random::rand<double>({517, 131});
+        xarray<double> res = dot(a, b);
+        xarray<double> expected = naive_dot(a, b);
+        ASSERT_EQ(expected.shape(), res.shape());
+        for (size_t i = 0; i < res.size(); ++i)
+        {
+            ASSERT_NEAR(expected.data()[i], res.data()[i], 1e-9);
+        }
+
+        xarray<float> fa = random::rand<float>({37, 300});
+        xarray<float> fb = random::rand<float>({300, 19});
+        xarray<float> fres = dot(fa, fb);
+        xarray<double> fexpected = naive_dot(fa, fb);
+        for (size_t i = 0; i < fres.size(); ++i)
+        {
+            ASSERT_NEAR(fexpected.data()[i], fres.data()[i], 1e-3);
+        }
+    }
+
+    TEST(xlinalg, dot_strided)
+    {
+        xarray<double> a = random::rand<double>({9, 13});
+        xarray<double> b = random::rand<double>({13, 7});
+
+        xarray<double> ca(a.shape(), layout::column_major);
+        for (size_t i = 0; i < a.shape()[0]; ++i)
+        {
+            for (size_t j = 0; j < a.shape()[1]; ++j)
+            {
+                ca(i, j) = a(i, j);
+            }
+        }
+        auto fb = flip(b, 0);
+        auto va = view(a, range(1, 8), all());
+        auto expected = naive_dot(a, b);
+
+        xarray<double> res = dot(ca, b);
+        xarray<double> fres = dot(flip(a, 1), fb);
+        xarray<double> vres = dot(va, b);
+        xarray<double> fexpected = naive_dot(flip(a, 1), fb);
+        xarray<double> vexpected = naive_dot(xarray<double>(va), b);
+        for (size_t i = 0; i < res.size(); ++i)
+        {
+            ASSERT_NEAR(expected.data()[i], res.data()[i], 1e-12);
+            ASSERT_NEAR(fexpected.data()[i], fres.data()[i], 1e-12);
+        }
+        for (size_t i = 0; i < vres.size(); ++i)
+        {
+            ASSERT_NEAR(vexpected.data()[i], vres.data()[i], 1e-12);
+        }
+    }
+
+    TEST(xlinalg, matmul)
+    {
+        xarray<double> a = random::rand<double>({2, 3, 4, 5});
+        xarray<double> b = random::rand<double>({3, 5, 6});
+        xarray<double> res = matmul(a, b);
+        std::vector<size_t> shape = {2, 3, 4, 6};
+        ASSERT_EQ(shape, res.shape());
+        for (size_t i = 0; i < 2; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                xarray<double> expected = naive_dot(xarray<double>(view(a, i, j)), xarray<double>(view(b, j)));
+                xarray<double> actual = view(res, i, j);
+                for (size_t l = 0; l < expected.size(); ++l)
+                {
+                    ASSERT_NEAR(expected.data()[l], actual.data()[l], 1e-12);
+                }
+            }
+        }
+
+        // broadcast of a single matrix against a stack
+        xarray<double> c = random::rand<double>({5, 2});
+        xarray<double> rc = matmul(a, c);
+        xarray<double> expected = naive_dot(xarray<double>(view(a, 1, 2)), c);
+        xarray<double> actual = view(rc, 1, 2);
+        for (size_t l = 0; l < expected.size(); ++l)
+        {
+            ASSERT_NEAR(expected.data()[l], actual.data()[l], 1e-12);
+        }
+
+        xarray<double> v = {1., 1., 1., 1., 1.};
+        xarray<double> av = matmul(a, v);
+        std::vector<size_t> vshape = {2, 3, 4};
+        ASSERT_EQ(vshape, av.shape());
+        ASSERT_NEAR(sum(view(a, 1, 0, 3))(), av(1, 0, 3), 1e-12);
+
+        ASSERT_THROW(matmul(a, a), std::runtime_error);
+        ASSERT_THROW(matmul(a, xarray<double>(ones<double>({2, 5, 1}))), broadcast_error);
+    }
+
+    TEST(xlinalg, matmul_fixed)
+    {
+        // batches of fixed-size products, with compile-time ranks
+        xtensor<float, 3> a = random::rand<float>({300, 8, 8});
+        xtensor<float, 3> b = random::rand<float>({300, 8, 8});
+        xtensor<float, 2> i4 = eye<float>(4);
+        xtensor<float, 3> res = matmul(a, b);
+        for (size_t k = 0; k < 300; k += 37)
+        {
+            xarray<double> expected = naive_dot(xarray<float>(view(a, k)), xarray<float>(view(b, k)));
+            for (size_t i = 0; i < 8; ++i)
+            {
+                for (size_t j = 0; j < 8; ++j)
+                {
+                    ASSERT_NEAR(expected(i, j), res(k, i, j), 1e-4);
+                }
+            }
+        }
+
+        xtensor<float, 3> a4 = random::rand<float>({5, 4, 4});
+        xtensor<float, 3> r4 = matmul(flip(a4, 2), i4);
+        ASSERT_EQ(xarray<float>(flip(a4, 2)), xarray<float>(r4));
+
+        xtensor<double, 2> a16 = random::rand<double>({16, 16});
+        xtensor<double, 2> b16 = random::rand<double>({16, 16});
+        xtensor<double, 2> r16 = matmul(a16, b16);
+        xarray<double> e16 = naive_dot(a16, b16);
+        for (size_t i = 0; i < r16.size(); ++i)
+        {
+            ASSERT_NEAR(e16.data()[i], r16.data()[i], 1e-12);
+        }
+    }
+
+    template <class E1, class E2>
+    void expect_near(const E1& expected, const E2& actual, double tol)
+    {
+        ASSERT_EQ(expected.dimension(), actual.dimension());
+        ASSERT_TRUE(std::equal(expected.shape().cbegin(), expected.shape().cend(), actual.shape().cbegin()));
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(expected.data()[i], actual.data()[i], tol);
+        }
+    }
+
+    template <class E>
+    xarray<double> naive_transpose(const E& a)
+    {
+        xarray<double> res = zeros<double>({a.shape()[1], a.shape()[0]});
+        for (size_t i = 0; i < a.shape()[0]; ++i)
+        {
+            for (size_t j = 0; j < a.shape()[1]; ++j)
+            {
+                res(j, i) = a(i, j);
+            }
+        }
+        return res;
+    }
+
+    // product of a matrix and a vector
+    template <class E1, class E2>
+    xarray<double> naive_dot_vector(const E1& a, const E2& x)
+    {
+        xarray<double> res = zeros<double>({a.shape()[0]});
+        for (size_t i = 0; i < a.shape()[0]; ++i)
+        {
+            for (size_t j = 0; j < x.size(); ++j)
+            {
+                res(i) += a(i, j) * x(j);
+            }
+        }
+        return res;
+    }
+
+    // well conditioned random matrix
+    xarray<double> random_matrix(size_t m, size_t n)
+    {
+        xarray<double> res = random::rand<double>({m, n}, -1., 1.);
+        for (size_t i = 0; i < std::min(m, n); ++i)
+        {
+            res(i, i) += double(std::max(m, n));
+        }
+        return res;
+    }
+
+    TEST(xlinalg, lu)
+    {
+        for (size_t n : {1, 5, 70, 150})
+        {
+            xarray<double> a = random::rand<double>({n, n});
+            auto f = linalg::lu(a);
+            xarray<double> l = std::get<1>(f);
+            xarray<double> u = std::get<2>(f);
+            expect_near(a, naive_dot(std::get<0>(f), naive_dot(l, u)), 1e-10);
+            for (size_t i = 0; i < n; ++i)
+            {
+                ASSERT_EQ(1., l(i, i));
+                for (size_t j = 0; j < i; ++j)
+                {
+                    ASSERT_EQ(0., u(i, j));
+                    ASSERT_LE(std::abs(l(i, j)), 1.);
+                }
+            }
+        }
+
+        xarray<double> r = random::rand<double>({90, 70});
+        auto f = linalg::lu(r);
+        expect_near(r, naive_dot(std::get<0>(f), naive_dot(std::get<1>(f), std::get<2>(f))), 1e-10);
+
+        // in place factorization, reused for several right-hand sides
+        xarray<double> a = random_matrix(100, 100);
+        xarray<double> fa = a;
+        std::vector<size_t> piv = linalg::lu_factor(fa);
+        xarray<double> b = random::rand<double>({100});
+        xarray<double> x = linalg::lu_solve(fa, piv, b);
+        expect_near(b, naive_dot_vector(a, x), 1e-10);
+    }
+
+    TEST(xlinalg, cholesky)
+    {
+        xarray<double> m = random::rand<double>({130, 130});
+        xarray<double> a = naive_dot(m, naive_transpose(m));
+        for (size_t i = 0; i < 130; ++i)
+        {
+            a(i, i) += 1.;
+        }
+        xarray<double> l = linalg::cholesky(a);
+        expect_near(a, naive_dot(l, naive_transpose(l)), 1e-9);
+        ASSERT_EQ(0., l(3, 100));
+
+        xarray<double> b = random::rand<double>({130, 3});
+        xarray<double> c = a;
+        linalg::cho_factor(c);
+        expect_near(l, c, 1e-12);
+        expect_near(b, naive_dot(a, linalg::cho_solve(c, b)), 1e-9);
+
+        xarray<double> indefinite = {{1., 2.}, {2., 1.}};
+        ASSERT_THROW(linalg::cholesky(indefinite), std::runtime_error);
+    }
+
+    TEST(xlinalg, qr)
+    {
+        for (auto shape : {std::vector<size_t>{5, 5}, std::vector<size_t>{150, 80}, std::vector<size_t>{40, 100}})
+        {
+            xarray<double> a = random::rand<double>(shape);
+            auto f = linalg::qr(a);
+            xarray<double> q = std::get<0>(f);
+            xarray<double> r = std::get<1>(f);
+            size_t k = std::min(shape[0], shape[1]);
+            ASSERT_EQ(k, q.shape()[1]);
+            expect_near(a, naive_dot(q, r), 1e-10);
+            expect_near(xarray<double>(eye<double>(k)), naive_dot(naive_transpose(q), q), 1e-10);
+            for (size_t i = 0; i < k; ++i)
+            {
+                for (size_t j = 0; j < i; ++j)
+                {
+                    ASSERT_EQ(0., r(i, j));
+                }
+            }
+        }
+    }
+
+    TEST(xlinalg, solve)
+    {
+        xarray<double> a = {{3., 1.}, {1., 2.}};
+        xarray<double> b = {9., 8.};
+        xarray<double> expected = {2., 3.};
+        expect_near(expected, linalg::solve(a, b), 1e-14);
+
+        xarray<double> a200 = random_matrix(200, 200);
+        xarray<double> b200 = random::rand<double>({200, 7});
+        expect_near(b200, naive_dot(a200, linalg::solve(a200, b200)), 1e-10);
+
+        xarray<int> ia = {{2, 0}, {0, 4}};
+        xarray<int> ib = {2, 2};
+        xarray<double> iexpected = {1., 0.5};
+        expect_near(iexpected, linalg::solve(ia, ib), 1e-15);
+
+        // stacks of systems, read through a strided view
+        xarray<double> stack = random::rand<double>({12, 30, 30}, -1., 1.);
+        stack += 30. * xarray<double>(eye<double>(30));
+        xarray<double> rhs = random::rand<double>({6, 30});
+        auto even = view(stack, range(0, 12, 2), all(), all());
+        xarray<double> x = linalg::solve(even, rhs);
+        for (size_t k = 0; k < 6; ++k)
+        {
+            xarray<double> ak = view(stack, 2 * k, all(), all());
+            xarray<double> xk = linalg::solve(ak, xarray<double>(view(rhs, k, all())));
+            expect_near(xk, xarray<double>(view(x, k, all())), 1e-12);
+        }
+
+        xarray<double> singular = {{1., 2.}, {2., 4.}};
+        ASSERT_THROW(linalg::solve(singular, b), std::runtime_error);
+        ASSERT_THROW(linalg::solve(a, xarray<double>(ones<double>({3}))), std::runtime_error);
+        ASSERT_THROW(linalg::solve(xarray<double>(ones<double>({2, 3})), b), std::runtime_error);
+    }
+
+    TEST(xlinalg, solve_triangular)
+    {
+        xarray<double> a = random_matrix(150, 150);
+        xarray<double> b = random::rand<double>({150, 2});
+        xarray<double> lower = a;
+        xarray<double> upper = a;
+        for (size_t i = 0; i < 150; ++i)
+        {
+            for (size_t j = 0; j < 150; ++j)
+            {
+                if (j > i)
+                {
+                    lower(i, j) = 0.;
+                }
+                else if (j < i)
+                {
+                    upper(i, j) = 0.;
+                }
+            }
+        }
+        expect_near(b, naive_dot(lower, linalg::solve_triangular(a, b)), 1e-10);
+        expect_near(b, naive_dot(upper, linalg::solve_triangular(a, b, false)), 1e-10);
+    }
+
+    TEST(xlinalg, inv_det)
+    {
+        xarray<double> a = {{4., 7.}, {2., 6.}};
+        xarray<double> expected = {{0.6, -0.7}, {-0.2, 0.4}};
+        expect_near(expected, linalg::inv(a), 1e-14);
+        ASSERT_NEAR(10., linalg::det(a), 1e-13);
+
+        xarray<double> p = {{0., 1., 0.}, {0., 0., 1.}, {1., 0., 0.}};
+        ASSERT_NEAR(1., linalg::det(p), 1e-15);
+        xarray<double> s = {{0., 1.}, {1., 0.}};
+        ASSERT_NEAR(-1., linalg::det(s), 1e-15);
+
+        xarray<double> a100 = random_matrix(100, 100);
+        expect_near(xarray<double>(eye<double>(100)), naive_dot(a100, linalg::inv(a100)), 1e-12);
+
+        xarray<double> stack = random::rand<double>({4, 3, 3}) + 3. * xarray<double>(eye<double>(3));
+        xarray<double> invs = linalg::inv(stack);
+        for (size_t k = 0; k < 4; ++k)
+        {
+            expect_near(xarray<double>(linalg::inv(xarray<double>(view(stack, k, all(), all())))),
+                         xarray<double>(view(invs, k, all(), all())), 1e-14);
+        }
+    }
+
+    TEST(xlinalg, lstsq)
+    {
+        // line fit
+        xarray<double> a = {{0., 1.}, {1., 1.}, {2., 1.}, {3., 1.}};
+        xarray<double> b = {-1., 0.2, 0.9, 2.1};
+        xarray<double> expected = {1., -0.95};
+        expect_near(expected, linalg::lstsq(a, b), 1e-12);
+
+        // normal equations
+        xarray<double> m = random::rand<double>({300, 90});
+        xarray<double> y = random::rand<double>({300, 2});
+        xarray<double> x = linalg::lstsq(m, y);
+        xarray<double> mt = naive_transpose(m);
+        expect_near(naive_dot(mt, y), naive_dot(mt, naive_dot(m, x)), 1e-9);
+
+        // minimum norm solution of an underdetermined system
+        xarray<double> u = random::rand<double>({70, 100});
+        xarray<double> v = random::rand<double>({70});
+        xarray<double> xu = linalg::lstsq(u, v);
+        ASSERT_EQ(size_t(100), xu.shape()[0]);
+        xarray<double> w = linalg::solve(naive_dot(u, naive_transpose(u)), v);
+        expect_near(naive_dot_vector(naive_transpose(u), w), xu, 1e-9);
+    }
+
+    TEST(xlinalg, xtensor_operands)
+    {
+        xtensor<double, 2> a = {{4., 7.}, {2., 6.}};
+        xtensor<double, 1> b = {1., 2.};
+        xarray<double> aa = a;
+        xarray<double> ab = b;
+
+        expect_near(linalg::inv(aa), linalg::inv(a), 1e-14);
+        ASSERT_NEAR(10., linalg::det(a), 1e-13);
+        expect_near(linalg::solve(aa, ab), linalg::solve(a, b), 1e-14);
+        expect_near(linalg::solve_triangular(aa, ab), linalg::solve_triangular(a, b), 1e-14);
+
+        xtensor<double, 2> fa = a;
+        std::vector<size_t> piv = linalg::lu_factor(fa);
+        expect_near(ab, naive_dot_vector(aa, linalg::lu_solve(fa, piv, b)), 1e-14);
+
+        xtensor<double, 2> spd = {{4., 2.}, {2., 3.}};
+        xarray<double> l = linalg::cholesky(spd);
+        expect_near(xarray<double>(spd), naive_dot(l, naive_transpose(l)), 1e-14);
+        xtensor<double, 2> c = spd;
+        linalg::cho_factor(c);
+        expect_near(ab, naive_dot_vector(xarray<double>(spd), linalg::cho_solve(c, b)), 1e-14);
+
+        xtensor<double, 2> m = {{0., 1.}, {1., 1.}, {2., 1.}, {3., 1.}};
+        xtensor<double, 1> y = {-1., 0.2, 0.9, 2.1};
+        xarray<double> expected = {1., -0.95};
+        expect_near(expected, linalg::lstsq(m, y), 1e-12);
+        xtensor<double, 2> y2 = {{-1., 1.}, {0.2, 1.}, {0.9, 1.}, {2.1, 1.}};
+        xarray<double> expected2 = {{1., 0.}, {-0.95, 1.}};
+        expect_near(expected2, linalg::lstsq(m, y2), 1e-12);
+
+        auto f = linalg::qr(m);
+        expect_near(xarray<double>(m), naive_dot(std::get<0>(f), std::get<1>(f)), 1e-12);
+        auto g = linalg::lu(m);
+        expect_near(xarray<double>(m), naive_dot(std::get<0>(g), naive_dot(std::get<1>(g), std::get<2>(g))), 1e-12);
+    }
+}
@@ -0,0 +1,149 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xnorm.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    template <class E1, class E2>
+    void expect_near(const E1& expected, const E2& actual, double tol)
+    {
+        ASSERT_EQ(expected.shape(), actual.shape());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(expected.data()[i], actual.data()[i], tol);
+        }
+    }
+
+    TEST(xnorm, norms)
+    {
+        xarray<double> a = {{1., -2., 3.}, {-4., 5., -6.}};
+        EXPECT_DOUBLE_EQ(21., norm_l1(a));
+        EXPECT_DOUBLE_EQ(std::sqrt(91.), norm_l2(a));
+        EXPECT_DOUBLE_EQ(6., norm_linf(a));
+        EXPECT_DOUBLE_EQ(91., sum_of_squares(a));
+
+        xarray<int> ia = {3, -4};
+        EXPECT_DOUBLE_EQ(5., norm_l2(ia));
+        EXPECT_DOUBLE_EQ(7., norm_l1(ia));
+        xarray<unsigned int> ua = {3u, 4u};
+        EXPECT_DOUBLE_EQ(4., norm_linf(ua));
+
+        xarray<std::complex<double>> c = {std::complex<double>(3., 4.), std::complex<double>(0., -1.)};
+        EXPECT_DOUBLE_EQ(6., norm_l1(c));
+        EXPECT_DOUBLE_EQ(std::sqrt(26.), norm_l2(c));
+        EXPECT_DOUBLE_EQ(5., norm_linf(c));
+
+        // expressions are evaluated, views are read in place
+        EXPECT_DOUBLE_EQ(42., norm_l1(a * 2.));
+        EXPECT_DOUBLE_EQ(15., norm_l1(view(a, 1, all())));
+
+        xarray<float> big = random::rand<float>({1000, 333}, -1.f, 1.f);
+        double expected = 0.;
+        for (float v : big.data())
+        {
+            expected += double(v) * double(v);
+        }
+        EXPECT_NEAR(expected, sum_of_squares(big), expected * 1e-5);
+        EXPECT_NEAR(std::sqrt(expected), norm_l2(big), 1e-2);
+
+        xarray<double> nan = {1., std::numeric_limits<double>::quiet_NaN(), 2.};
+        EXPECT_TRUE(std::isnan(norm_linf(nan)));
+    }
+
+    TEST(xnorm, scaling)
+    {
+        xarray<double> huge = {3e200, 4e200};
+        EXPECT_DOUBLE_EQ(5e200, norm_l2(huge));
+        xarray<double> tiny = {3e-200, 4e-200};
+        EXPECT_DOUBLE_EQ(5e-200, norm_l2(tiny));
+        xarray<double> lanes = {{3e200, 4e200}, {3., 4.}};
+        xarray<double> expected = {5e200, 5.};
+        xarray<double> res = norm_l2(lanes, {1});
+        EXPECT_DOUBLE_EQ(expected(0), res(0));
+        EXPECT_DOUBLE_EQ(expected(1), res(1));
+        xarray<double> inf = {1., std::numeric_limits<double>::infinity()};
+        EXPECT_EQ(std::numeric_limits<double>::infinity(), norm_l2(inf));
+    }
+
+    TEST(xnorm, axes)
+    {
+        xarray<double> a = random::rand<double>({4, 5, 37}, -1., 1.);
+        expect_near(xarray<double>(sum(abs(a), {2})), norm_l1(a, {2}), 1e-12);
+        expect_near(xarray<double>(sum(a * a, {0})), sum_of_squares(a, {0}), 1e-12);
+        expect_near(xarray<double>(sqrt(sum(a * a, {0, 2}))), norm_l2(a, {0, 2}), 1e-12);
+        xarray<double> linf = norm_linf(a, {1});
+        for (size_t i = 0; i < 4; ++i)
+        {
+            for (size_t k = 0; k < 37; ++k)
+            {
+                double m = 0.;
+                for (size_t j = 0; j < 5; ++j)
+                {
+                    m = std::max(m, std::abs(a(i, j, k)));
+                }
+                ASSERT_EQ(m, linf(i, k));
+            }
+        }
+
+        auto v = view(a, range(size_t(1), size_t(4)), all(), 3);
+        expect_near(xarray<double>(sum(abs(v), {1})), norm_l1(v, {1}), 1e-12);
+
+        // empty inputs give zeros
+        xarray<double> e = zeros<double>({0, 3});
+        xarray<double> e_expected = zeros<double>({3});
+        EXPECT_EQ(e_expected, norm_l2(e, {0}));
+        EXPECT_EQ(0u, norm_l2(e, {1}).size());
+        EXPECT_EQ(0u, norm_linf(e, {1}).size());
+        EXPECT_EQ(0., norm_l1(e));
+        EXPECT_EQ(0., vdot(e, e));
+
+        ASSERT_THROW(norm_l1(a, {3}), std::runtime_error);
+        ASSERT_THROW(norm_l1(a, {1, 1}), std::runtime_error);
+    }
+
+    TEST(xnorm, vdot)
+    {
+        xarray<double> a = {{1., 2.}, {3., 4.}};
+        xarray<double> b = {{5., 6.}, {7., 8.}};
+        EXPECT_DOUBLE_EQ(70., vdot(a, b));
+        EXPECT_DOUBLE_EQ(70., vdot(a, b * 1.));
+
+        using cplx = std::complex<double>;
+        xarray<cplx> c = {cplx(1., 2.), cplx(3., 4.)};
+        xarray<cplx> d = {cplx(5., 6.), cplx(7., 8.)};
+        cplx res = vdot(c, d);
+        EXPECT_DOUBLE_EQ(70., res.real());
+        EXPECT_DOUBLE_EQ(-8., res.imag());
+
+        xarray<double> x = random::rand<double>({300, 70});
+        xarray<double> y = random::rand<double>({300, 70});
+        double expected = 0.;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            expected += x.data()[i] * y.data()[i];
+        }
+        EXPECT_NEAR(expected, vdot(x, y), 1e-9);
+
+        ASSERT_THROW(vdot(a, xarray<double>(ones<double>({4}))), std::runtime_error);
+    }
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xnpy.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    TEST(xnpy, header)
+    {
+        xarray<double> a = {1., 2., 3.};
+        std::stringstream stream;
+        dump_npy(stream, a);
+        std::string content = stream.str();
+
+        ASSERT_EQ(std::string("\x93NUMPY\x01\x00", 8), content.substr(0, 8));
+        ASSERT_EQ(0u, (content.size() - 3 * sizeof(double)) % 64);
+        ASSERT_NE(std::string::npos, content.find("'descr': '<f8'"));
+        ASSERT_NE(std::string::npos, content.find("'fortran_order': False"));
+        ASSERT_NE(std::string::npos, content.find("'shape': (3,)"));
+    }
+
+    TEST(xnpy, round_trip)
+    {
+        xarray<double> a = {{1.5, 2., 3.}, {4., 5., 6.25}};
+        std::stringstream stream;
+        dump_npy(stream, a);
+        xarray<double> b = load_npy<double>(stream);
+        ASSERT_EQ(a, b);
+
+        xtensor<int, 3> t = {{{1, 2}, {3, 4}}, {{5, 6}, {7, 8}}};
+        std::stringstream tstream;
+        dump_npy(tstream, t);
+        xtensor<int, 3> u;
+        load_npy(tstream, u);
+        ASSERT_EQ(t, u);
+
+        xarray<bool> c = {true, false, true};
+        std::stringstream cstream;
+        dump_npy(cstream, c);
+        ASSERT_EQ(c, load_npy<bool>(cstream));
+
+        xarray<std::complex<double>> z = zeros<std::complex<double>>({2, 2});
+        z(0, 1) = std::complex<double>(2., 1.);
+        z(1, 0) = std::complex<double>(0., -1.);
+        std::stringstream zstream;
+        dump_npy(zstream, z);
+        ASSERT_EQ(z, load_npy<std::complex<double>>(zstream));
+    }
+
+    TEST(xnpy, layout)
+    {
+        xarray<int>::shape_type shape = {2, 3};
+        xarray<int> a(shape, layout::column_major);
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            a.data()[i] = int(i);
+        }
+        std::stringstream stream;
+        dump_npy(stream, a);
+        ASSERT_NE(std::string::npos, stream.str().find("'fortran_order': True"));
+
+        xarray<int> b = load_npy<int>(stream);
+        ASSERT_EQ(a, b);
+        ASSERT_EQ(a.strides(), b.strides());
+
+        auto v = view(a, all(), range(0, 2));
+        std::stringstream vstream;
+        dump_npy(vstream, v);
+        xarray<int> c = load_npy<int>(vstream);
+        ASSERT_EQ(xarray<int>(v), c);
+        ASSERT_TRUE(c.is_contiguous());
+    }
+
+    TEST(xnpy, conversion)
+    {
+        xarray<int> a = {{1, 2}, {3, 4}};
+        std::stringstream stream;
+        dump_npy(stream, a);
+        xarray<double> b = load_npy<double>(stream);
+        xarray<double> expected = {{1., 2.}, {3., 4.}};
+        ASSERT_EQ(expected, b);
+
+        std::stringstream zstream;
+        dump_npy(zstream, zeros<std::complex<double>>({2, 2}));
+        ASSERT_THROW(load_npy<double>(zstream), std::runtime_error);
+
+        std::stringstream tstream;
+        dump_npy(tstream, a);
+        xtensor<int, 1> t;
+        ASSERT_THROW(load_npy(tstream, t), std::runtime_error);
+    }
+
+    namespace
+    {
+        // npy content of a one-dimensional array, written by hand
+        std::string npy_content(const std::string& descr, size_t size, const std::string& data)
+        {
+            std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (" +
+                               std::to_string(size) + ",), }";
+            dict.append(128 - 10 - dict.size() - 1, ' ');
+            dict += '\n';
+            std::string content = std::string("\x93NUMPY\x01\x00", 8);
+            content += char(dict.size());
+            content += char(0);
+            content += dict;
+            return content + data;
+        }
+
+        std::string big_endian_bytes(double d)
+        {
+            std::string bytes(sizeof(double), '\0');
+            std::memcpy(&bytes[0], &d, sizeof(double));
+            const int one = 1;
+            if (*reinterpret_cast<const char*>(&one) == 1)
+            {
+                std::reverse(bytes.begin(), bytes.end());
+            }
+            return bytes;
+        }
+    }
+
+    TEST(xnpy, byte_order)
+    {
+        std::stringstream stream(npy_content(">i4", 2, std::string("\x00\x00\x01\x02\xff\xff\xff\xfe", 8)));
+        xarray<int> a = load_npy<int>(stream);
+        xarray<int> expected = {258, -2};
+        ASSERT_EQ(expected, a);
+    }
+
+    TEST(xnpy, complex_byte_order)
+    {
+        std::string data = big_endian_bytes(1.) + big_endian_bytes(2.) +
+                           big_endian_bytes(-0.5) + big_endian_bytes(3.);
+        xarray<std::complex<double>> expected = {std::complex<double>(1., 2.), std::complex<double>(-0.5, 3.)};
+
+        std::stringstream stream(npy_content(">c16", 2, data));
+        xarray<std::complex<double>> z = load_npy<std::complex<double>>(stream);
+        ASSERT_EQ(expected, z);
+
+        // converted on load
+        std::stringstream cstream(npy_content(">c16", 2, data));
+        xarray<std::complex<float>> zf = load_npy<std::complex<float>>(cstream);
+        ASSERT_EQ(std::complex<float>(-0.5f, 3.f), zf(1));
+
+        std::stringstream rstream;
+        dump_npy(rstream, z);
+        ASSERT_EQ(expected, load_npy<std::complex<double>>(rstream));
+    }
+
+    TEST(xnpy, mapping)
+    {
+        std::string filename = "test_xnpy_mapping.npy";
+        xarray<double> a = arange<double>(12);
+        a.reshape({3, 4});
+        dump_npy(filename, a);
+
+        {
+            xnpy_mapping<double> mapping(filename);
+            auto& m = mapping.adaptor();
+            ASSERT_EQ(a.shape(), m.shape());
+            ASSERT_EQ(a, m);
+            m(1, 1) = 100.;
+            ASSERT_EQ(100., m(1, 1));
+            ASSERT_THROW(xnpy_mapping<float> wrong(filename), std::runtime_error);
+        }
+
+        // the mapping is private, the file is unchanged
+        ASSERT_EQ(a, load_npy<double>(filename));
+        std::remove(filename.c_str());
+    }
+}
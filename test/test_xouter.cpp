@@ -0,0 +1,168 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <vector>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xview.hpp"
+#include "xtensor/xouter.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    // direct computation of the Kronecker product of two expressions
+    // of the same dimension
+    xarray<double> naive_kron(const xarray<double>& a, const xarray<double>& b)
+    {
+        std::vector<size_t> shape(a.dimension());
+        for (size_t d = 0; d < a.dimension(); ++d)
+        {
+            shape[d] = a.shape()[d] * b.shape()[d];
+        }
+        xarray<double> res(shape);
+        xindex index(a.dimension()), ia(a.dimension()), ib(a.dimension());
+        for (size_t k = 0; k < res.size(); ++k)
+        {
+            size_t r = k;
+            for (size_t d = a.dimension(); d > 0; --d)
+            {
+                index[d - 1] = r % shape[d - 1];
+                r /= shape[d - 1];
+                ia[d - 1] = index[d - 1] / b.shape()[d - 1];
+                ib[d - 1] = index[d - 1] % b.shape()[d - 1];
+            }
+            res[index] = a[ia] * b[ib];
+        }
+        return res;
+    }
+
+    TEST(xouter, outer)
+    {
+        xarray<double> a = {1., 2., 3.};
+        xarray<double> b = {4., 5.};
+        xarray<double> expected = {{4., 5.}, {8., 10.}, {12., 15.}};
+        auto o = outer(a, b);
+        ASSERT_EQ(expected.shape(), o.shape());
+        EXPECT_EQ(15., o(2, 1));
+        xarray<double> res = o;
+        EXPECT_EQ(expected, res);
+        xarray<double> lazy = o + 0.;
+        EXPECT_EQ(expected, lazy);
+
+        xarray<double> m = random::rand<double>({3, 4});
+        xarray<double> v = random::rand<double>({5});
+        xarray<double> mv = outer(m, v);
+        xarray<double> mv_expected = view(m, all(), all(), newaxis()) * view(v, newaxis(), newaxis(), all());
+        ASSERT_EQ(mv_expected.shape(), mv.shape());
+        EXPECT_EQ(mv_expected, mv);
+        xarray<double> vm = outer(v, m) * 1.;
+        xarray<double> vm_expected = view(v, all(), newaxis(), newaxis()) * m;
+        EXPECT_EQ(vm_expected, vm);
+
+        // mixed value types and lazy operands
+        xarray<int> ia = {1, 2};
+        xtensor<double, 1> tb = {0.5, 1.5};
+        xarray<double> mixed = outer(ia, tb * 2.);
+        xarray<double> mixed_expected = {{1., 3.}, {2., 6.}};
+        EXPECT_EQ(mixed_expected, mixed);
+        xtensor<double, 2> t = outer(tb, tb);
+        EXPECT_EQ(2.25, t(1, 1));
+
+        // parallel evaluation
+        xarray<float> x = random::rand<float>({3000});
+        xarray<float> y = random::rand<float>({700});
+        xarray<float> big = outer(x, y);
+        EXPECT_EQ(x(2999) * y(699), big(2999, 699));
+        EXPECT_EQ(x(1234) * y(5), big(1234, 5));
+
+        // empty operands
+        xarray<double> e = zeros<double>({0});
+        xarray<double> eb = outer(e, b);
+        std::vector<size_t> eb_shape = {0, 2};
+        EXPECT_EQ(eb_shape, eb.shape());
+        xarray<double> be = outer(b, e);
+        std::vector<size_t> be_shape = {2, 0};
+        EXPECT_EQ(be_shape, be.shape());
+        xarray<double> ek = kron(e, b);
+        EXPECT_EQ(0u, ek.size());
+    }
+
+    TEST(xouter, kron)
+    {
+        xarray<double> a = {{1., 2.}, {3., 4.}};
+        xarray<double> b = {{0., 5.}, {6., 7.}};
+        xarray<double> expected = {{0., 5., 0., 10.},
+                                   {6., 7., 12., 14.},
+                                   {0., 15., 0., 20.},
+                                   {18., 21., 24., 28.}};
+        xarray<double> res = kron(a, b);
+        EXPECT_EQ(expected, res);
+        xarray<double> lazy = kron(a, b) + 0.;
+        EXPECT_EQ(expected, lazy);
+        EXPECT_EQ(21., kron(a, b)(3, 1));
+
+        xarray<double> c = random::rand<double>({2, 3, 4});
+        xarray<double> d = random::rand<double>({3, 1, 5});
+        xarray<double> cd_expected = naive_kron(c, d);
+        xarray<double> cd = kron(c, d);
+        EXPECT_EQ(cd_expected, cd);
+        xarray<double> cd_lazy = 1. * kron(c, d);
+        EXPECT_EQ(cd_expected, cd_lazy);
+
+        // operands of different dimensions
+        xarray<double> v = random::rand<double>({3});
+        xarray<double> v2 = view(v, newaxis(), all());
+        xarray<double> vd = kron(v, c);
+        xarray<double> vd_expected = naive_kron(xarray<double>(view(v, newaxis(), newaxis(), all())), c);
+        EXPECT_EQ(vd_expected, vd);
+        xarray<double> dv = kron(a, v) * 1.;
+        EXPECT_EQ(naive_kron(a, v2), dv);
+    }
+
+    TEST(xouter, stepper)
+    {
+        xarray<double> a = random::rand<double>({3, 4});
+        xarray<double> b = random::rand<double>({2, 5});
+        auto k = kron(a, b);
+        xarray<double> expected = k;
+
+        // broadcasting to a shape of higher dimension
+        xarray<double> c = random::rand<double>({2, 6, 20});
+        xarray<double> sum = c + k;
+        xarray<double> sum_expected = c + expected;
+        ASSERT_EQ(sum_expected.shape(), sum.shape());
+        for (size_t i = 0; i < sum.size(); ++i)
+        {
+            ASSERT_NEAR(sum_expected.data()[i], sum.data()[i], 1e-12);
+        }
+
+        // assignment to a view goes through the stepper
+        xarray<double> dst = zeros<double>({8, 20});
+        view(dst, range(1, 7), all()) = k;
+        EXPECT_EQ(expected, xarray<double>(view(dst, range(1, 7), all())));
+
+        std::vector<size_t> shape = {6, 20};
+        auto st = k.stepper_begin(shape);
+        st.step(1, 13);
+        EXPECT_EQ(expected(0, 13), *st);
+        st.step(1, 4);
+        EXPECT_EQ(expected(0, 17), *st);
+        st.step_back(1, 12);
+        EXPECT_EQ(expected(0, 5), *st);
+        st.step(0, 5);
+        EXPECT_EQ(expected(5, 5), *st);
+        st.step_back(0, 3);
+        EXPECT_EQ(expected(2, 5), *st);
+        st.step_back(1, 5);
+        EXPECT_EQ(expected(2, 0), *st);
+    }
+}
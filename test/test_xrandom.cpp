@@ -9,6 +9,8 @@
 #include "gtest/gtest.h"
 #include "xtensor/xrandom.hpp"
 #include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
 
 namespace xt
 {
@@ -47,4 +49,165 @@ namespace xt
         ASSERT_NE(p1, p2);
         ASSERT_NE(p1, p3);
     }
+
+    TEST(xrandom, philox)
+    {
+        using counter_type = random::philox4x32::counter_type;
+        using key_type = random::philox4x32::key_type;
+
+        counter_type c0 = {{0u, 0u, 0u, 0u}};
+        key_type k0 = {{0u, 0u}};
+        counter_type r0 = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}};
+        ASSERT_EQ(r0, random::philox4x32::bijection(c0, k0));
+
+        counter_type c1 = {{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}};
+        key_type k1 = {{0xffffffffu, 0xffffffffu}};
+        counter_type r1 = {{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}};
+        ASSERT_EQ(r1, random::philox4x32::bijection(c1, k1));
+
+        counter_type c2 = {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+        key_type k2 = {{0xa4093822u, 0x299f31d0u}};
+        counter_type r2 = {{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+        ASSERT_EQ(r2, random::philox4x32::bijection(c2, k2));
+    }
+
+    TEST(xrandom, counter_based)
+    {
+        random::philox4x32 engine(42);
+        auto r = random::rand<double>({4, 5}, 0., 1., engine);
+        xarray<double> a = r;
+        xarray<double> b = r;
+        ASSERT_EQ(a, b);
+        ASSERT_NE(a(0, 0), a(0, 1));
+        ASSERT_EQ(a(2, 3), r(2, 3));
+
+        // non contiguous evaluation gives the same values
+        xtensor<double, 2> c({4, 5}, 0.);
+        auto v = view(c, all(), range(0, 5));
+        v = r;
+        ASSERT_EQ(a, c);
+        xarray<double> d = r + 0.;
+        ASSERT_EQ(a, d);
+
+        random::philox4x32 other_stream(42, 1);
+        xarray<double> e = random::rand<double>({4, 5}, 0., 1., other_stream);
+        ASSERT_NE(a, e);
+
+        auto ri = random::randint<int>({100}, -3, 3, engine);
+        xarray<int> i = ri;
+        for (std::size_t k = 0; k < i.size(); ++k)
+        {
+            ASSERT_GE(i(k), -3);
+            ASSERT_LT(i(k), 3);
+            ASSERT_EQ(ri(k), i(k));
+        }
+
+        xarray<float> n = random::randn<float>({1000}, 1.f, 2.f, engine);
+        float mean = 0.f;
+        for (std::size_t k = 0; k < n.size(); ++k)
+        {
+            mean += n(k);
+        }
+        mean /= float(n.size());
+        ASSERT_NEAR(1.f, mean, 0.3f);
+    }
+
+    template <class C>
+    double sample_mean(const C& c)
+    {
+        double res = 0.;
+        for (std::size_t k = 0; k < c.size(); ++k)
+        {
+            res += double(c(k));
+        }
+        return res / double(c.size());
+    }
+
+    TEST(xrandom, distributions)
+    {
+        random::seed(0);
+        random::philox4x32 engine(7);
+
+        xarray<double> e1 = random::exponential<double>({10000}, 2.);
+        xarray<double> e2 = random::exponential<double>({10000}, 2., engine);
+        ASSERT_NEAR(0.5, sample_mean(e1), 0.05);
+        ASSERT_NEAR(0.5, sample_mean(e2), 0.05);
+
+        xarray<double> g1 = random::gamma<double>({10000}, 3., 2.);
+        xarray<double> g2 = random::gamma<double>({10000}, 3., 2., engine);
+        xarray<double> g3 = random::gamma<double>({10000}, 0.5, 1., engine);
+        ASSERT_NEAR(6., sample_mean(g1), 0.3);
+        ASSERT_NEAR(6., sample_mean(g2), 0.3);
+        ASSERT_NEAR(0.5, sample_mean(g3), 0.05);
+
+        xarray<double> b1 = random::beta<double>({10000}, 2., 6.);
+        xarray<double> b2 = random::beta<double>({10000}, 2., 6., engine);
+        ASSERT_NEAR(0.25, sample_mean(b1), 0.02);
+        ASSERT_NEAR(0.25, sample_mean(b2), 0.02);
+
+        xarray<int> n1 = random::binomial<int>({10000}, 20, 0.3);
+        xarray<int> n2 = random::binomial<int>({10000}, 20, 0.3, engine);
+        xarray<int> n3 = random::binomial<int>({10000}, 1000, 0.6, engine);
+        ASSERT_NEAR(6., sample_mean(n1), 0.2);
+        ASSERT_NEAR(6., sample_mean(n2), 0.2);
+        ASSERT_NEAR(600., sample_mean(n3), 1.);
+
+        xarray<int> p1 = random::poisson<int>({10000}, 4.);
+        xarray<int> p2 = random::poisson<int>({10000}, 4., engine);
+        xarray<int> p3 = random::poisson<int>({10000}, 50., engine);
+        ASSERT_NEAR(4., sample_mean(p1), 0.15);
+        ASSERT_NEAR(4., sample_mean(p2), 0.15);
+        ASSERT_NEAR(50., sample_mean(p3), 0.5);
+
+        xarray<bool> l1 = random::bernoulli<bool>({10000}, 0.2);
+        xarray<int> l2 = random::bernoulli<int>({10000}, 0.2, engine);
+        ASSERT_NEAR(0.2, sample_mean(l1), 0.02);
+        ASSERT_NEAR(0.2, sample_mean(l2), 0.02);
+
+        auto g = random::gamma<double>({3, 4}, 2., 1., engine);
+        xarray<double> ga = g;
+        xarray<double> gb = g + 0.;
+        ASSERT_EQ(ga, gb);
+    }
+
+    TEST(xrandom, permutations)
+    {
+        xarray<int> a = {{0, 0}, {1, 1}, {2, 2}, {3, 3}, {4, 4}};
+        random::shuffle(a);
+        std::vector<int> seen(5, 0);
+        for (std::size_t i = 0; i < 5; ++i)
+        {
+            ASSERT_EQ(a(i, 0), a(i, 1));
+            ++seen[std::size_t(a(i, 0))];
+        }
+        ASSERT_EQ(std::vector<int>(5, 1), seen);
+
+        random::philox4x32 engine(3);
+        xtensor<std::size_t, 1> p1 = random::permutation<std::size_t>(10, engine);
+        xtensor<std::size_t, 1> p2 = random::permutation<std::size_t>(10, engine);
+        ASSERT_EQ(p1, p2);
+        std::vector<std::size_t> sorted(p1.data().begin(), p1.data().end());
+        std::sort(sorted.begin(), sorted.end());
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            ASSERT_EQ(i, sorted[i]);
+        }
+
+        xarray<int> pa = random::permutation(a);
+        ASSERT_EQ(a.shape(), pa.shape());
+
+        xarray<double> b = {1., 2., 3., 4., 5.};
+        auto c1 = random::choice(b, 20);
+        ASSERT_EQ(20u, c1.size());
+        for (std::size_t i = 0; i < c1.size(); ++i)
+        {
+            ASSERT_NE(std::find(b.xbegin(), b.xend(), c1(i)), b.xend());
+        }
+
+        auto c2 = random::choice(b, 5, false);
+        std::vector<double> c2s(c2.data().begin(), c2.data().end());
+        std::sort(c2s.begin(), c2s.end());
+        ASSERT_TRUE(std::equal(c2s.begin(), c2s.end(), b.xbegin()));
+        ASSERT_THROW(random::choice(b, 6, false), std::runtime_error);
+    }
 }
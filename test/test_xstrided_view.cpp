@@ -0,0 +1,117 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xstrided_view.hpp"
+
+namespace xt
+{
+    using std::size_t;
+    using shape_t = std::vector<std::size_t>;
+
+    TEST(xstrided_view, flip)
+    {
+        xarray<double> a = {{1, 2, 3}, {4, 5, 6}};
+        auto v = flip(a, 1);
+        ASSERT_EQ(-1, v.strides()[1]);
+        ASSERT_EQ(2, v.offset());
+        ASSERT_EQ(shape_t({2, 3}), v.shape());
+        ASSERT_EQ(3, v(0, 0));
+        ASSERT_EQ(4, v(1, 2));
+
+        xarray<double> expected = {{3, 2, 1}, {6, 5, 4}};
+        xarray<double> b = v;
+        ASSERT_EQ(expected, b);
+
+        xarray<double> c = v + a;
+        xarray<double> expected_sum = {{4, 4, 4}, {10, 10, 10}};
+        ASSERT_EQ(expected_sum, c);
+
+        v(0, 0) = 10;
+        ASSERT_EQ(10, a(0, 2));
+    }
+
+    TEST(xstrided_view, flip_tensor)
+    {
+        xarray<int> e = arange<int>(24);
+        e.reshape({2, 3, 4});
+        xtensor<int, 3> a = e;
+        xtensor<int, 3> b = flip(a, 2);
+        xtensor<int, 3> c = flip(b, 2);
+        ASSERT_EQ(a, c);
+        ASSERT_EQ(3, b(0, 0, 0));
+        ASSERT_EQ(20, b(1, 2, 3));
+    }
+
+    TEST(xstrided_view, diagonal)
+    {
+        xarray<int> a = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+        auto d = diagonal(a);
+        ASSERT_EQ(4, d.strides()[0]);
+        ASSERT_EQ(shape_t({3}), d.shape());
+
+        d = 0;
+        xarray<int> expected = {{0, 2, 3}, {4, 0, 6}, {7, 8, 0}};
+        ASSERT_EQ(expected, a);
+
+        xarray<int> u = {10, 20};
+        diagonal(a, 1) = u;
+        xarray<int> expected_2 = {{0, 10, 3}, {4, 0, 20}, {7, 8, 0}};
+        ASSERT_EQ(expected_2, a);
+
+        ASSERT_EQ(shape_t({0}), diagonal(a, 4).shape());
+        xarray<int> empty = diagonal(a, -4);
+        ASSERT_EQ(0, empty.size());
+    }
+
+    TEST(xstrided_view, broadcast)
+    {
+        xarray<double> a = {1, 2, 3};
+        xarray<double> b = zeros<double>({2, 3});
+        b += flip(a, 0);
+        xarray<double> expected = {{3, 2, 1}, {3, 2, 1}};
+        ASSERT_EQ(expected, b);
+    }
+
+    TEST(xstrided_view, trilu_blocks)
+    {
+        xarray<double> a = arange<double>(18);
+        a.reshape({3, 3, 2});
+        xarray<double> l = tril(a);
+        xarray<double> u = triu(a + 0, 1);
+        xarray<double> expected_l = {{{0, 1}, {0, 0}, {0, 0}},
+                                     {{6, 7}, {8, 9}, {0, 0}},
+                                     {{12, 13}, {14, 15}, {16, 17}}};
+        xarray<double> expected_u = {{{0, 0}, {2, 3}, {4, 5}},
+                                     {{0, 0}, {0, 0}, {10, 11}},
+                                     {{0, 0}, {0, 0}, {0, 0}}};
+        ASSERT_EQ(expected_l, l);
+        ASSERT_EQ(expected_u, u);
+
+        xarray<double> m = arange<double>(12);
+        m.reshape({3, 4});
+        xarray<double> low = tril(m, -5);
+        ASSERT_EQ(xarray<double>(zeros<double>({3, 4})), low);
+        xarray<double> up = triu(m, -5);
+        ASSERT_EQ(m, up);
+    }
+
+    TEST(xstrided_view, diag)
+    {
+        xarray<double> a = {1, 2};
+        xarray<double> d = diag(a, -1);
+        xarray<double> expected = {{0, 0, 0}, {1, 0, 0}, {0, 2, 0}};
+        ASSERT_EQ(expected, d);
+        xarray<double> d2 = diag(a, 1);
+        xarray<double> expected_2 = {{0, 1, 0}, {0, 0, 2}, {0, 0, 0}};
+        ASSERT_EQ(expected_2, d2);
+    }
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+* Copyright (c) 2016, Johan Mabille and Sylvain Corlay                     *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "gtest/gtest.h"
+#include <cstddef>
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xexecutor.hpp"
+#include "xtensor/xnoalias.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xreducer.hpp"
+#include "xtensor/xtask_graph.hpp"
+#include "xtensor/xview.hpp"
+
+namespace xt
+{
+    using std::size_t;
+
+    TEST(xtask_graph, fused_statements)
+    {
+        thread_pool pool(4);
+        xarray<double> a = random::rand<double>({300, 200});
+        xarray<double> b = random::rand<double>({300, 200});
+        xtensor<double, 2> c = random::rand<double>({300, 200});
+        xarray<double> c0 = c;
+        xarray<double> t, u, v;
+
+        task_graph graph;
+        EXPECT_TRUE(graph.empty());
+        {
+            deferred_scope scope(graph);
+            t = a * b;
+            u = t + c;
+            v = sqrt(t) - u;
+            v += a * 2.;
+            u *= 3.;
+            c = v + u;
+        }
+        EXPECT_EQ(6u, graph.size());
+        EXPECT_EQ(t.shape(), a.shape());
+        graph.run(pool);
+        EXPECT_TRUE(graph.empty());
+
+        xarray<double> te = a * b;
+        xarray<double> ue = te + c0;
+        xarray<double> ve = sqrt(te) - ue;
+        ve += a * 2.;
+        ue *= 3.;
+        xarray<double> ce = ve + ue;
+        EXPECT_EQ(te, t);
+        EXPECT_EQ(ue, u);
+        EXPECT_EQ(ve, v);
+        EXPECT_EQ(ce, xarray<double>(c));
+    }
+
+    TEST(xtask_graph, dependencies)
+    {
+        xarray<double> a = random::rand<double>({50, 40});
+        xarray<double> b = random::rand<double>({50, 40});
+        xarray<double> a0 = a;
+        xarray<double> b0 = b;
+        xarray<double> t, u, r;
+
+        task_graph graph;
+        {
+            deferred_scope scope(graph);
+            // write after read
+            t = a + 1.;
+            a = b * 2.;
+            u = a + t;
+            // broadcast of a row of the assigned container
+            u = u + view(u, 0, all());
+            // reducers are run after the statements they read
+            r = sum(u, {1});
+            view(b, range(0, 10), all()) = 0.;
+            noalias(t) = b - 1.;
+        }
+        graph.run(serial_executor());
+
+        xarray<double> ae = b0 * 2.;
+        xarray<double> ue = ae + (a0 + 1.);
+        ue = ue + view(ue, 0, all());
+        xarray<double> be = b0;
+        view(be, range(0, 10), all()) = 0.;
+        EXPECT_EQ(ae, a);
+        EXPECT_EQ(ue, u);
+        EXPECT_EQ(xarray<double>(sum(ue, {1})), r);
+        EXPECT_EQ(be, b);
+        EXPECT_EQ(xarray<double>(be - 1.), t);
+    }
+
+    TEST(xtask_graph, resize)
+    {
+        xarray<double> a = random::rand<double>({20, 30});
+        xarray<double> t, s;
+        task_graph graph;
+        {
+            deferred_scope scope(graph);
+            t = a + 1.;
+            s = t * 2.;
+            // t is reallocated: the statements reading it run first
+            t = view(a, 0, all());
+            EXPECT_EQ(1u, graph.size());
+        }
+        graph.run();
+        EXPECT_EQ(xarray<double>((a + 1.) * 2.), s);
+        EXPECT_EQ(xarray<double>(view(a, 0, all())), t);
+    }
+
+    TEST(xtask_graph, scopes)
+    {
+        xarray<double> a = random::rand<double>({4, 5});
+        xarray<double> b = random::rand<double>({3, 5});
+        xarray<double> c = zeros<double>({4, 5});
+        xarray<double> d;
+        task_graph graph;
+        {
+            deferred_scope scope(graph);
+            c = a + 1.;
+            {
+                // nested scopes record in the innermost graph
+                task_graph inner;
+                deferred_scope inner_scope(inner);
+                d = b * 0.;
+                EXPECT_EQ(1u, inner.size());
+                inner.clear();
+            }
+            EXPECT_EQ(b.shape(), d.shape());
+            EXPECT_EQ(1u, graph.size());
+        }
+        graph.run();
+        EXPECT_EQ(xarray<double>(a + 1.), c);
+
+        // assignments are immediate outside of the scope
+        c = a * 2.;
+        EXPECT_TRUE(graph.empty());
+        EXPECT_EQ(a(1, 1) * 2., c(1, 1));
+    }
+}
@@ -452,5 +452,13 @@ namespace xt
         t v8e = {3,5};
         EXPECT_TRUE(v8e == v8);
     }
-}
 
+    TEST(xview, broadcast_view)
+    {
+        xarray<double> a = {{1, 2, 3}, {4, 5, 6}};
+        auto v = view(a, 1, range(1, 3));
+        xarray<double> b = broadcast(v, std::vector<std::size_t>({3, 2}));
+        xarray<double> expected = {{5, 6}, {5, 6}, {5, 6}};
+        EXPECT_EQ(expected, b);
+    }
+}
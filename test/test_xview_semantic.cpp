@@ -10,6 +10,7 @@
 #include "xtensor/xview.hpp"
 #include "test_xsemantic.hpp"
 #include "xtensor/xnoalias.hpp"
+#include "xtensor/xbuilder.hpp"
 namespace xt
 {
 
@@ -424,5 +425,39 @@ namespace xt
 
         EXPECT_EQ(res, a);
     }
-}
 
+    TEST(xview_semantic, scalar_fill)
+    {
+        xarray<int> a = { { 1,  2,  3,  4 },
+                          { 5,  6,  7,  8 },
+                          { 9, 10, 11, 12 } };
+        xarray<int> b = a;
+        view(a, all(), 3) = 0;
+        view(b, range(0, 3, 2), range(0, 4, 2), newaxis()) = xscalar<int>(-1);
+        xarray<int> resa = { { 1,  2,  3, 0 },
+                             { 5,  6,  7, 0 },
+                             { 9, 10, 11, 0 } };
+        xarray<int> resb = { { -1, 2, -1,  4 },
+                             {  5, 6,  7,  8 },
+                             { -1, 10, -1, 12 } };
+        EXPECT_EQ(resa, a);
+        EXPECT_EQ(resb, b);
+
+        xarray<double> c({ 2, 3, 4 }, 1.);
+        c.transpose();
+        auto vc = view(c, 1, all());
+        vc = zeros<double>({ 3 });
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                EXPECT_EQ(i == 1 ? 0. : 1., c(i, j, 0));
+                EXPECT_EQ(i == 1 ? 0. : 1., c(i, j, 1));
+            }
+        }
+
+        xarray<int> d = { 1, 2, 3 };
+        auto vd = view(d, range(0, 2));
+        EXPECT_THROW(vd = broadcast(0, { 3 }), broadcast_error);
+    }
+}